@@ -0,0 +1,280 @@
+/********************************************************************************
+ *    Copyright (C) 2014 GSI Helmholtzzentrum fuer Schwerionenforschung GmbH    *
+ *                                                                              *
+ *              This software is distributed under the terms of the             *
+ *         GNU Lesser General Public Licence version 3 (LGPL) version 3,        *
+ *                  copied verbatim in the file "LICENSE"                       *
+ ********************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+
+#include "fLmd.h"
+#include "fLmdMap.h"
+
+uint32_t fLmdMapScan(sLmdMap*, lmdoff_t);
+uint32_t fLmdMapReadIndex(sLmdMap*);
+
+//===============================================================
+uint32_t fLmdMapOpen(
+  sLmdMap* pLmdMap,
+  char*    Filename,
+  uint32_t iUseOffset)       // LMD__[NO_]INDEX
+{
+  struct stat sStat;
+  sMbsFileHeader* pHead;
+  lmdoff_t first;
+  uint32_t iReturn;
+
+  memset(pLmdMap,0,sizeof(sLmdMap));
+  pLmdMap->iFile=-1;
+  strncpy(pLmdMap->cFile, Filename, sizeof(pLmdMap->cFile)-1);
+
+  if((pLmdMap->iFile=open(Filename,O_RDONLY))<0) {
+    printf("fLmdMapOpen: File not found: %s\n",Filename);
+    return(GETLMD__NOFILE);
+  }
+  if((fstat(pLmdMap->iFile,&sStat)!=0)||((uint64_t)sStat.st_size < sizeof(sMbsFileHeader))) {
+    printf("fLmdMapOpen: LMD format error: no LMD file: %s\n",Filename);
+    fLmdMapClose(pLmdMap);
+    return(GETLMD__NOLMDFILE);
+  }
+  pLmdMap->iMapBytes=(uint64_t)sStat.st_size;
+  // private mapping: swapping the elements only changes our copy of the pages
+  pLmdMap->pMap=(char*)mmap(NULL,pLmdMap->iMapBytes,PROT_READ|PROT_WRITE,MAP_PRIVATE,pLmdMap->iFile,0);
+  if(pLmdMap->pMap==MAP_FAILED) {
+    printf("fLmdMapOpen: mmap failed: %s\n",Filename);
+    pLmdMap->pMap=NULL;
+    fLmdMapClose(pLmdMap);
+    return(LMD__FAILURE);
+  }
+
+  // check type and subtype, and endian
+  pHead=&pLmdMap->sMbsFileHeader;
+  memcpy(pHead,pLmdMap->pMap,sizeof(sMbsFileHeader));
+  if(pHead->iEndian != 1) { pLmdMap->iSwap=1; }
+  if(pLmdMap->iSwap) {
+    fLmdSwap4((uint32_t*)pHead,sizeof(sMbsFileHeader)/4);
+    fLmdSwap8((uint64_t*)&pHead->iTableOffset,1);
+  }
+  if(pHead->iType != LMD__TYPE_FILE_HEADER_101_1) {
+    printf("fLmdMapOpen: LMD format error: no LMD file: %s, type is %0x\n",
+           Filename,pHead->iType);
+    fLmdMapClose(pLmdMap);
+    return(GETLMD__NOLMDFILE);
+  }
+
+  // more of header? Not swapped, caller must know.
+  first=sizeof(sMbsFileHeader);
+  if( (pHead->iUsedWords > 0) && (pHead->iUsedWords < UINT32_MAX/2) ) {
+    if(first+pHead->iUsedWords*2 > pLmdMap->iMapBytes) {
+      printf("fLmdMapOpen: LMD format error: no LMD file: %s\n",Filename);
+      fLmdMapClose(pLmdMap);
+      return(GETLMD__NOLMDFILE);
+    }
+    pLmdMap->cHeader=pLmdMap->pMap+first;
+    first+=pHead->iUsedWords*2;
+  }
+
+  iReturn=GETLMD__NOMORE;
+  if((iUseOffset == LMD__INDEX)&&(pHead->iTableOffset > 0)) {
+    iReturn=fLmdMapReadIndex(pLmdMap);
+    if(iReturn != LMD__SUCCESS) {
+      printf("fLmdMapOpen: Index format error, scanning file: %s\n",Filename);
+    }
+  }
+  if(iReturn != LMD__SUCCESS) {
+    iReturn=fLmdMapScan(pLmdMap,first);
+    if(iReturn != LMD__SUCCESS) {
+      fLmdMapClose(pLmdMap);
+      return(iReturn);
+    }
+  }
+
+  if(pLmdMap->iSwap) {
+    pLmdMap->pSwapped=(uint8_t*)calloc(pLmdMap->iElements+1,1);
+  }
+  return(LMD__SUCCESS);
+}
+//===============================================================
+// offsets from the index table of the file, in 4 byte words
+uint32_t fLmdMapReadIndex(sLmdMap* pLmdMap)
+{
+  sMbsHeader sTableHead;
+  lmdoff_t table;
+  uint32_t i, n, size, off4;
+
+  size=pLmdMap->sMbsFileHeader.iOffsetSize;
+  n=pLmdMap->sMbsFileHeader.iElements+1;
+  table=pLmdMap->sMbsFileHeader.iTableOffset*4;
+  if( ((size != 4)&&(size != 8)) || (table+16+(lmdoff_t)n*size > pLmdMap->iMapBytes) ) {
+    return(GETLMD__NOLMDFILE);
+  }
+  memcpy(&sTableHead,pLmdMap->pMap+table,sizeof(sMbsHeader));
+  if(pLmdMap->iSwap) { fLmdSwap4((uint32_t*)&sTableHead,2); }
+  if(sTableHead.iType != LMD__TYPE_FILE_INDEX_101_2) {
+    printf("fLmdMapReadIndex: LMD format error: no index table: %s, type %0x\n",
+           pLmdMap->cFile,sTableHead.iType);
+    return(GETLMD__NOLMDFILE);
+  }
+
+  // the table may not be aligned for its entries
+  pLmdMap->pOffset=(lmdoff_t*)malloc(n*sizeof(lmdoff_t));
+  if(size == 4) {
+    for(i=0; i<n; i++) {
+      memcpy(&off4,pLmdMap->pMap+table+16+i*4,4);
+      if(pLmdMap->iSwap) { fLmdSwap4(&off4,1); }
+      pLmdMap->pOffset[i]=(lmdoff_t)off4*4;
+    }
+  } else {
+    memcpy(pLmdMap->pOffset,pLmdMap->pMap+table+16,(size_t)n*8);
+    if(pLmdMap->iSwap) {
+      fLmdSwap4((uint32_t*)pLmdMap->pOffset,n*2);
+      fLmdSwap8((uint64_t*)pLmdMap->pOffset,n);
+    }
+    for(i=0; i<n; i++) { pLmdMap->pOffset[i]*=4; }
+  }
+  if(pLmdMap->pOffset[n-1] > pLmdMap->iMapBytes) {
+    printf("fLmdMapReadIndex: index table points behind the end of %s\n",pLmdMap->cFile);
+    free(pLmdMap->pOffset);
+    pLmdMap->pOffset=NULL;
+    return(GETLMD__NOLMDFILE);
+  }
+  pLmdMap->iElements=n-1;
+  pLmdMap->iIndexed=1;
+  return(LMD__SUCCESS);
+}
+//===============================================================
+// offsets by stepping through the element headers
+uint32_t fLmdMapScan(sLmdMap* pLmdMap, lmdoff_t first)
+{
+  sMbsHeader sHead;
+  lmdoff_t pos, elem_sz;
+  uint32_t n=0, alloc=1024;
+
+  pLmdMap->pOffset=(lmdoff_t*)malloc(alloc*sizeof(lmdoff_t));
+  pos=first;
+  while(pos+sizeof(sMbsHeader) <= pLmdMap->iMapBytes) {
+    memcpy(&sHead,pLmdMap->pMap+pos,sizeof(sMbsHeader));
+    if(pLmdMap->iSwap) { fLmdSwap4((uint32_t*)&sHead,2); }
+    if(sHead.iType == LMD__TYPE_FILE_INDEX_101_2) { break; } // file index is last
+    elem_sz=((lmdoff_t)sHead.iWords+4)*2;
+    if(pos+elem_sz > pLmdMap->iMapBytes) {
+      printf("fLmdMapScan: incomplete element at end of %s\n",pLmdMap->cFile);
+      break;
+    }
+    if(n+1 >= alloc) {
+      alloc*=2;
+      pLmdMap->pOffset=(lmdoff_t*)realloc(pLmdMap->pOffset,alloc*sizeof(lmdoff_t));
+    }
+    pLmdMap->pOffset[n++]=pos;
+    pos+=elem_sz;
+  }
+  pLmdMap->pOffset[n]=pos;
+  pLmdMap->iElements=n;
+  pLmdMap->iIndexed=0;
+  return(LMD__SUCCESS);
+}
+//===============================================================
+// element iElement (counting from 0) as pointer into the mapping
+uint32_t fLmdMapGetElement(sLmdMap* pLmdMap, uint32_t iElement, sMbsHeader** element)
+{
+  sMbsHeader* pM;
+  lmdoff_t size;
+
+  *element=NULL;
+  if(iElement >= pLmdMap->iElements) { return(GETLMD__OUTOF_RANGE); }
+  pM=(sMbsHeader*)(pLmdMap->pMap+pLmdMap->pOffset[iElement]);
+  size=pLmdMap->pOffset[iElement+1]-pLmdMap->pOffset[iElement];
+  if(pLmdMap->iSwap && !pLmdMap->pSwapped[iElement]) {
+    fLmdSwap4((uint32_t*)pM,size/4);
+    pLmdMap->pSwapped[iElement]=1;
+  }
+  if(((lmdoff_t)pM->iWords+4)*2 != size) {
+    printf("fLmdMapGetElement: Error Element %u: size from table is %u, header %u\n",
+           iElement,(uint32_t)(size/2),pM->iWords+4);
+    return(GETLMD__SIZE_ERROR);
+  }
+  *element=pM;
+  return(LMD__SUCCESS);
+}
+//===============================================================
+uint32_t fLmdMapElements(sLmdMap* pLmdMap)
+{
+  return(pLmdMap->iElements);
+}
+//===============================================================
+// bytes of the elements iFirst to iLast-1
+uint64_t fLmdMapElementBytes(sLmdMap* pLmdMap, uint32_t iFirst, uint32_t iLast)
+{
+  if(iLast > pLmdMap->iElements) { iLast=pLmdMap->iElements; }
+  if(iFirst >= iLast) { return(0); }
+  return(pLmdMap->pOffset[iLast]-pLmdMap->pOffset[iFirst]);
+}
+//===============================================================
+// access pattern of the elements iFirst to iLast-1, one of LMD__MAP_x
+uint32_t fLmdMapAdvise(sLmdMap* pLmdMap, uint32_t iFirst, uint32_t iLast, uint32_t iAdvice)
+{
+  lmdoff_t begin, end;
+  long page;
+  int advice;
+
+  if(iLast > pLmdMap->iElements) { iLast=pLmdMap->iElements; }
+  if(iFirst >= iLast) { return(LMD__SUCCESS); }
+  switch(iAdvice) {
+  case LMD__MAP_SEQUENTIAL:
+    advice=MADV_SEQUENTIAL;
+    break;
+  case LMD__MAP_RANDOM:
+    advice=MADV_RANDOM;
+    break;
+  case LMD__MAP_WILLNEED:
+    advice=MADV_WILLNEED;
+    break;
+  case LMD__MAP_DONTNEED:
+    advice=MADV_DONTNEED;
+    break;
+  default:
+    advice=MADV_NORMAL;
+  }
+  // madvise needs page aligned addresses. Pages shared with elements outside
+  // the range are not given up.
+  page=sysconf(_SC_PAGESIZE);
+  begin=pLmdMap->pOffset[iFirst];
+  end=pLmdMap->pOffset[iLast];
+  if(advice == MADV_DONTNEED) {
+    begin=(begin+page-1)/page*page;
+    end=end/page*page;
+    // swapped pages are private copies, they would be read again unswapped
+    if(pLmdMap->iSwap || end <= begin) { return(LMD__SUCCESS); }
+  } else {
+    begin=begin/page*page;
+  }
+  if(madvise(pLmdMap->pMap+begin,end-begin,advice) != 0) {
+    return(LMD__FAILURE);
+  }
+  return(LMD__SUCCESS);
+}
+//===============================================================
+uint32_t fLmdMapClose(sLmdMap* pLmdMap)
+{
+  uint32_t iReturn=LMD__SUCCESS;
+  if(pLmdMap->pOffset  != NULL) { free(pLmdMap->pOffset); }
+  if(pLmdMap->pSwapped != NULL) { free(pLmdMap->pSwapped); }
+  if(pLmdMap->pMap != NULL) { munmap(pLmdMap->pMap,pLmdMap->iMapBytes); }
+  if(pLmdMap->iFile >= 0) {
+    if(close(pLmdMap->iFile) != 0) { iReturn=LMD__CLOSE_ERR; }
+  }
+  pLmdMap->pOffset=NULL;
+  pLmdMap->pSwapped=NULL;
+  pLmdMap->pMap=NULL;
+  pLmdMap->cHeader=NULL;
+  pLmdMap->iFile=-1;
+  pLmdMap->iElements=0;
+  return(iReturn);
+}
@@ -0,0 +1,59 @@
+/********************************************************************************
+ *    Copyright (C) 2014 GSI Helmholtzzentrum fuer Schwerionenforschung GmbH    *
+ *                                                                              *
+ *              This software is distributed under the terms of the             *
+ *         GNU Lesser General Public Licence version 3 (LGPL) version 3,        *
+ *                  copied verbatim in the file "LICENSE"                       *
+ ********************************************************************************/
+/* Memory mapped reading of LMD files (format with sMbsFileHeader, as written
+ * by fLmdPutOpen). The file is mapped once, the elements are returned as
+ * pointers into the mapping, no data is copied.
+ * The element offsets are taken from the index table of the file, files
+ * without table are scanned once at open. Any element can be accessed
+ * directly by its number.
+ * After fLmdMapOpen the control structure is only read, so several threads
+ * can get elements of the same mapped file, as long as they do not access
+ * the same elements of a file which has to be swapped. */
+#ifndef MbsLmdMap
+#define MbsLmdMap
+
+#include "sMbs.h"
+
+/* status codes as in fLmd.h, which can not be included together with
+ * f_evt.h in C++ */
+#define LMD__SUCCESS        0
+#define LMD__FAILURE        1
+#define LMD__CLOSE_ERR      3
+#define GETLMD__NOFILE      2
+#define GETLMD__NOLMDFILE   4
+#define GETLMD__OUTOF_RANGE 9
+#define GETLMD__SIZE_ERROR 10
+
+#define LMD__MAP_NORMAL     0
+#define LMD__MAP_SEQUENTIAL 1
+#define LMD__MAP_RANDOM     2
+#define LMD__MAP_WILLNEED   3
+#define LMD__MAP_DONTNEED   4
+
+typedef struct {
+  int      iFile;         /* file descriptor */
+  char*    pMap;          /* mapped file */
+  uint64_t iMapBytes;     /* size of the mapping */
+  sMbsFileHeader sMbsFileHeader; /* copy of the file header, swapped */
+  char*    cHeader;       /* additional header data, in the mapping */
+  uint32_t iSwap;         /* > 0: elements are swapped at the first access */
+  uint8_t* pSwapped;      /* element already swapped */
+  uint32_t iElements;     /* number of elements */
+  lmdoff_t* pOffset;      /* byte offsets of the elements, iElements+1 entries */
+  uint32_t iIndexed;      /* offsets taken from the index table of the file */
+  char     cFile[512];    /* file name */
+} sLmdMap;
+
+uint32_t fLmdMapOpen(sLmdMap*,char*,uint32_t);
+uint32_t fLmdMapGetElement(sLmdMap*,uint32_t,sMbsHeader**);
+uint32_t fLmdMapElements(sLmdMap*);
+uint64_t fLmdMapElementBytes(sLmdMap*,uint32_t,uint32_t);
+uint32_t fLmdMapAdvise(sLmdMap*,uint32_t,uint32_t,uint32_t);
+uint32_t fLmdMapClose(sLmdMap*);
+
+#endif
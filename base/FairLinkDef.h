@@ -15,6 +15,7 @@
 
 #pragma link C++ class FairBaseContFact;
 #pragma link C++ class FairBaseParSet;
+#pragma link C++ class FairCompactTrajectories+;
 #pragma link C++ class FairGeoParSet;
 #pragma link C++ class FairDetector+;
 #pragma link C++ class FairEventBuilder+;
@@ -49,6 +50,7 @@
 #pragma link C++ class FairVolume+;
 #pragma link C++ class FairVolumeList+;
 #pragma link C++ class FairField+;
+#pragma link C++ class FairFieldMap+;
 #pragma link C++ class FairGenericStack+;
 #pragma link C++ class FairTask+;
 #pragma link C++ class FairFieldFactory+;
@@ -0,0 +1,142 @@
+/********************************************************************************
+ *    Copyright (C) 2014 GSI Helmholtzzentrum fuer Schwerionenforschung GmbH    *
+ *                                                                              *
+ *              This software is distributed under the terms of the             *
+ *         GNU Lesser General Public Licence version 3 (LGPL) version 3,        *
+ *                  copied verbatim in the file "LICENSE"                       *
+ ********************************************************************************/
+/*
+ * File:   FairMQLmdBatch.h
+ *
+ * Message with the sub-events of several LMD events, sent by FairMQLmdSampler
+ * and read by FairMQUnpacker. The message is laid out as
+ *
+ *   FairMQLmdBatchHeader
+ *   sub-event data (32 bit words, without sub-event headers)
+ *   FairMQLmdSubEvtIndex[fNSubEvents], at fIndexOffset
+ *
+ * The index is written behind the data, so the batch is filled in one buffer
+ * which is handed over to the transport when the batch is complete.
+ */
+
+#ifndef FAIRMQLMDBATCH_H
+#define FAIRMQLMDBATCH_H
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+struct FairMQLmdBatchHeader
+{
+    static const uint32_t kMagic = 0x4c4d4442; // "LMDB"
+
+    uint32_t fMagic;
+    uint32_t fNEvents;
+    uint32_t fNSubEvents;
+    uint32_t fIndexOffset; // in bytes from the start of the message
+};
+
+struct FairMQLmdSubEvtIndex
+{
+    uint32_t fEvent;  // LMD event counter of the sampler
+    uint32_t fOffset; // in bytes from the start of the message
+    uint32_t fSize;   // in 32 bit words
+    int16_t fType;
+    int16_t fSubType;
+    int16_t fProcId;
+    int16_t fSubCrate;
+    int16_t fControl;
+    int16_t fReserved;
+};
+
+/// Collects the sub-events of one channel until the batch is sent
+class FairMQLmdBatch
+{
+  public:
+    FairMQLmdBatch()
+        : fBuffer(nullptr)
+        , fIndex()
+        , fNEvents(0)
+        , fLastEvent(0)
+        , fCapacity(1 << 16)
+    {}
+
+    FairMQLmdBatch(const FairMQLmdBatch&) = delete;
+    FairMQLmdBatch& operator=(const FairMQLmdBatch&) = delete;
+
+    ~FairMQLmdBatch()
+    {
+        delete fBuffer;
+    }
+
+    void Add(uint32_t event, const int* data, int size, short type, short subType, short procId, short subCrate, short control)
+    {
+        if (!fBuffer)
+        {
+            fBuffer = new std::vector<char>(sizeof(FairMQLmdBatchHeader));
+            fBuffer->reserve(fCapacity);
+        }
+        if (fIndex.empty() || event != fLastEvent)
+        {
+            fNEvents++;
+            fLastEvent = event;
+        }
+
+        FairMQLmdSubEvtIndex entry = { event, static_cast<uint32_t>(fBuffer->size()), static_cast<uint32_t>(size),
+                                       type, subType, procId, subCrate, control, 0 };
+        fIndex.push_back(entry);
+        const char* bytes = reinterpret_cast<const char*>(data);
+        fBuffer->insert(fBuffer->end(), bytes, bytes + size * sizeof(int));
+    }
+
+    uint32_t GetNEvents() const { return fNEvents; }
+    bool IsEmpty() const { return fIndex.empty(); }
+
+    /// Completes the batch and passes the ownership of the buffer to the caller
+    std::vector<char>* Release()
+    {
+        FairMQLmdBatchHeader header = { FairMQLmdBatchHeader::kMagic, fNEvents, static_cast<uint32_t>(fIndex.size()),
+                                        static_cast<uint32_t>(fBuffer->size()) };
+        const char* index = reinterpret_cast<const char*>(fIndex.data());
+        fBuffer->insert(fBuffer->end(), index, index + fIndex.size() * sizeof(FairMQLmdSubEvtIndex));
+        std::memcpy(fBuffer->data(), &header, sizeof(header));
+
+        std::vector<char>* buffer = fBuffer;
+        fCapacity = buffer->size();
+        fBuffer = nullptr;
+        fIndex.clear();
+        fNEvents = 0;
+        return buffer;
+    }
+
+    /// Header of a received message, nullptr if the message is no batch
+    static const FairMQLmdBatchHeader* GetHeader(const void* data, size_t size)
+    {
+        if (size < sizeof(FairMQLmdBatchHeader))
+        {
+            return nullptr;
+        }
+        const FairMQLmdBatchHeader* header = static_cast<const FairMQLmdBatchHeader*>(data);
+        if (header->fMagic != FairMQLmdBatchHeader::kMagic
+            || header->fIndexOffset + header->fNSubEvents * sizeof(FairMQLmdSubEvtIndex) > size)
+        {
+            return nullptr;
+        }
+        return header;
+    }
+
+    static const FairMQLmdSubEvtIndex* GetIndex(const void* data)
+    {
+        const FairMQLmdBatchHeader* header = static_cast<const FairMQLmdBatchHeader*>(data);
+        return reinterpret_cast<const FairMQLmdSubEvtIndex*>(static_cast<const char*>(data) + header->fIndexOffset);
+    }
+
+  private:
+    std::vector<char>* fBuffer;
+    std::vector<FairMQLmdSubEvtIndex> fIndex;
+    uint32_t fNEvents;
+    uint32_t fLastEvent;
+    size_t fCapacity;
+};
+
+#endif /* !FAIRMQLMDBATCH_H */
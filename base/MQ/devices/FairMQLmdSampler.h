@@ -22,6 +22,7 @@ extern "C"
 #include "s_bufhe_swap.h"
 }
 
+#include <cstring>
 #include <string>
 #include <vector>
 #include <tuple>
@@ -33,7 +34,15 @@ extern "C"
 #include "FairMQDevice.h"
 #include "FairMQMessage.h"
 #include "FairMQProgOptions.h" // device->fConfig
+#include "FairMQLmdBatch.h"
 
+/**
+ * Reads LMD files and sends the sub-events registered with AddSubEvtKey to
+ * their channels. By default each sub-event is sent as a two-part message
+ * (size and a copy of the data). With the option lmd-batch-size > 0 the sub-events of
+ * that many events are collected per channel and sent as one message
+ * (see FairMQLmdBatch.h), which is owned by the transport.
+ */
 class FairMQLmdSampler : public FairMQDevice
 {
   public:
@@ -58,6 +67,8 @@ class FairMQLmdSampler : public FairMQDevice
         , fSubCrate(0)
         , fControl(0)
         , fChanName()
+        , fBatchSize(0)
+        , fBatches()
     {}
 
     FairMQLmdSampler(const FairMQLmdSampler&) = delete;
@@ -123,6 +134,7 @@ class FairMQLmdSampler : public FairMQDevice
         fSubCrate = fConfig->GetValue<short>("lmd-sub-crate");
         fControl = fConfig->GetValue<short>("lmd-control");
         fChanName = fConfig->GetValue<std::string>("lmd-chan-name");
+        fBatchSize = fConfig->GetValue<int>("lmd-batch-size");
     
         AddFile(fFilename);
         // combination of sub-event header value = one special channel
@@ -155,6 +167,13 @@ class FairMQLmdSampler : public FairMQDevice
                 break;
             }
         }
+        for (auto& batch : fBatches)
+        {
+            if (!batch.second.IsEmpty())
+            {
+                SendBatch(batch.first, batch.second);
+            }
+        }
         LOG(INFO) << "Sent " << fMsgCounter << " messages.";
     }
 
@@ -258,8 +277,14 @@ class FairMQLmdSampler : public FairMQDevice
                 // LOG(TRACE) << "array size = " << sebuflength;
                 // LOG(TRACE) << "fEventData = " << *fEventData;
     
-                std::string chanName = fSubEventChanMap.at(key);
+                const std::string& chanName = fSubEventChanMap.at(key);
                 // LOG(TRACE) << "chanName = " << chanName;
+
+                if (fBatchSize > 0)
+                {
+                    fBatches[chanName].Add(fNEvent, fEventData, sebuflength, setype, sesubtype, seprocid, sesubcrate, secontrol);
+                    continue;
+                }
     
                 FairMQParts parts;
     
@@ -270,7 +295,10 @@ class FairMQLmdSampler : public FairMQDevice
                 int* arraySize = new int(sebuflength);
     
                 parts.AddPart(NewMessage(arraySize, sizeof(int), [](void* /*data*/, void* hint) { delete static_cast<int*>(hint); }, arraySize));
-                parts.AddPart(NewMessage(fEventData, sebuflength, [](void* /*data*/, void* /*hint*/) { /*LOG(TRACE) << "empty deleter";*/ }, nullptr));
+                // f_evt overwrites its buffer with the next read, the data is copied
+                FairMQMessagePtr data(NewMessage(sebuflength * sizeof(int)));
+                std::memcpy(data->GetData(), fEventData, sebuflength * sizeof(int));
+                parts.AddPart(std::move(data));
                 Send(parts, chanName);
                 fMsgCounter++;
                 /*
@@ -284,6 +312,15 @@ class FairMQLmdSampler : public FairMQDevice
             }
         }
     
+        // the sub-events of one event are always sent in the same batch
+        for (auto& batch : fBatches)
+        {
+            if (batch.second.GetNEvents() >= static_cast<uint32_t>(fBatchSize))
+            {
+                SendBatch(batch.first, batch.second);
+            }
+        }
+
         // Increment evt counters.
         fNEvent++;
         fCurrentEvent++;
@@ -320,6 +357,14 @@ class FairMQLmdSampler : public FairMQDevice
         return true;
     }
 
+    void SendBatch(const std::string& chanName, FairMQLmdBatch& batch)
+    {
+        std::vector<char>* buffer = batch.Release();
+        FairMQMessagePtr msg(NewMessage(buffer->data(), buffer->size(), [](void* /*data*/, void* hint) { delete static_cast<std::vector<char>*>(hint); }, buffer));
+        Send(msg, chanName);
+        fMsgCounter++;
+    }
+
     void Close()
     {
         f_evt_get_close(fInputChannel);
@@ -350,6 +395,8 @@ class FairMQLmdSampler : public FairMQDevice
     short fSubCrate;
     short fControl;
     std::string fChanName;
+    int fBatchSize;
+    std::map<std::string, FairMQLmdBatch> fBatches;
 };
 
 #endif  /* !FAIRMQLMDSAMPLER_H */
@@ -18,12 +18,18 @@
 #include "FairMQDevice.h"
 #include "FairMQProgOptions.h"
 #include "RootSerializer.h"
+#include "FairMQLmdBatch.h"
 
 #include <stdexcept>
 #include <string>
 #include <tuple>
 #include <map>
 
+/**
+ * Receives the sub-events of one sub-event key from FairMQLmdSampler, either
+ * as two-part messages or as batches (FairMQLmdBatch.h). The output of the
+ * unpacker is sent per sub-event, or per event for batches.
+ */
 template<typename UnpackerType, typename SerializationType = RootSerializer>
 class FairMQUnpacker : public FairMQDevice
 {
@@ -111,15 +117,18 @@ class FairMQUnpacker : public FairMQDevice
 
         while (CheckCurrentState(RUNNING))
         {
-            FairMQMessagePtr msgSize(NewMessage());
-            FairMQMessagePtr msg(NewMessage());
+            FairMQParts parts;
 
-            if (inputChannel.Receive(msgSize) >= 0)
+            if (inputChannel.Receive(parts) >= 0)
             {
-                if (inputChannel.Receive(msg) >= 0)
+                if (parts.Size() == 1)
+                {
+                    UnpackBatch(*(parts.At(0)));
+                }
+                else if (parts.Size() == 2)
                 {
-                    int dataSize = *(static_cast<int*>(msgSize->GetData()));
-                    int* subEvtPtr = static_cast<int*>(msg->GetData());
+                    int dataSize = *(static_cast<int*>(parts.At(0)->GetData()));
+                    int* subEvtPtr = static_cast<int*>(parts.At(1)->GetData());
 
                     // LOG(TRACE) << "array size = " << dataSize;
                     // if (dataSize > 0)
@@ -128,14 +137,66 @@ class FairMQUnpacker : public FairMQDevice
                     // }
 
                     fUnpacker->DoUnpack(subEvtPtr, dataSize);
-                    Serialize<SerializationType>(*msg, fUnpacker->GetOutputData());
-                    Send(msg, "data-out");
-                    fUnpacker->Reset();
+                    SendOutput();
                 }
             }
         }
     }
 
+    void UnpackBatch(FairMQMessage& msg)
+    {
+        char* data = static_cast<char*>(msg.GetData());
+        const FairMQLmdBatchHeader* header = FairMQLmdBatch::GetHeader(data, msg.GetSize());
+        if (!header)
+        {
+            LOG(ERROR) << "FairMQUnpacker: received message is no LMD batch, skipping it";
+            return;
+        }
+
+        short setype;
+        short sesubtype;
+        short seprocid;
+        short sesubcrate;
+        short secontrol;
+        std::tie(setype, sesubtype, seprocid, sesubcrate, secontrol) = fSubEventChanMap.at(fInputChannelName);
+
+        const FairMQLmdSubEvtIndex* index = FairMQLmdBatch::GetIndex(data);
+        bool unpacked = false;
+        for (uint32_t i = 0; i < header->fNSubEvents; i++)
+        {
+            const FairMQLmdSubEvtIndex& sub = index[i];
+            if (sub.fOffset + static_cast<uint64_t>(sub.fSize) * sizeof(int) > header->fIndexOffset)
+            {
+                LOG(ERROR) << "FairMQUnpacker: sub-event " << i << " exceeds the LMD batch, skipping the rest";
+                break;
+            }
+            if (sub.fType == setype && sub.fSubType == sesubtype && sub.fProcId == seprocid && sub.fControl == secontrol
+                && (sesubcrate < 0 || sub.fSubCrate == sesubcrate))
+            {
+                fUnpacker->DoUnpack(reinterpret_cast<int*>(data + sub.fOffset), sub.fSize);
+                unpacked = true;
+            }
+            // the output is sent per event
+            if (unpacked && (i + 1 == header->fNSubEvents || index[i + 1].fEvent != sub.fEvent))
+            {
+                SendOutput();
+                unpacked = false;
+            }
+        }
+        if (unpacked)
+        {
+            SendOutput();
+        }
+    }
+
+    void SendOutput()
+    {
+        FairMQMessagePtr msg(NewMessage());
+        Serialize<SerializationType>(*msg, fUnpacker->GetOutputData());
+        Send(msg, "data-out");
+        fUnpacker->Reset();
+    }
+
     typedef std::tuple<short, short, short, short, short> SubEvtKey;
     std::map<std::string, SubEvtKey> fSubEventChanMap;
 
@@ -0,0 +1,136 @@
+/********************************************************************************
+ *    Copyright (C) 2014 GSI Helmholtzzentrum fuer Schwerionenforschung GmbH    *
+ *                                                                              *
+ *              This software is distributed under the terms of the             *
+ *         GNU Lesser General Public Licence version 3 (LGPL) version 3,        *
+ *                  copied verbatim in the file "LICENSE"                       *
+ ********************************************************************************/
+#include "FairCompactTrajectories.h"
+
+#include "TMath.h"                      // for Nint
+#include "TParticle.h"                  // for TParticle
+
+using std::vector;
+
+ClassImp(FairCompactTrajectories)
+
+FairCompactTrajectories::FairCompactTrajectories(Double_t posQuantum, Double_t timeQuantum)
+  : TNamed("FairCompactTrajectories", "compact MC trajectories"),
+    fPosQuantum(posQuantum),
+    fTimeQuantum(timeQuantum),
+    fPdgCode(),
+    fMotherId(),
+    fPx(),
+    fPy(),
+    fPz(),
+    fEnergy(),
+    fFirstByte(),
+    fNPoints(),
+    fData()
+{
+  for (Int_t i = 0; i < 4; ++i) {
+    fLast[i] = 0;
+  }
+}
+
+FairCompactTrajectories::~FairCompactTrajectories()
+{
+}
+
+void FairCompactTrajectories::Clear(Option_t*)
+{
+  fPdgCode.clear();
+  fMotherId.clear();
+  fPx.clear();
+  fPy.clear();
+  fPz.clear();
+  fEnergy.clear();
+  fFirstByte.clear();
+  fNPoints.clear();
+  fData.clear();
+}
+
+void FairCompactTrajectories::AddTrack(const TParticle* p)
+{
+  fPdgCode.push_back(p->GetPdgCode());
+  fMotherId.push_back(p->GetFirstMother());
+  fPx.push_back(p->Px());
+  fPy.push_back(p->Py());
+  fPz.push_back(p->Pz());
+  fEnergy.push_back(p->Energy());
+  fFirstByte.push_back(fData.size());
+  fNPoints.push_back(0);
+
+  // the first point is stored relative to the origin
+  for (Int_t i = 0; i < 4; ++i) {
+    fLast[i] = 0;
+  }
+}
+
+void FairCompactTrajectories::AddPoint(Double_t x, Double_t y, Double_t z, Double_t t)
+{
+  Long64_t point[4] = { TMath::Nint(x / fPosQuantum),
+                        TMath::Nint(y / fPosQuantum),
+                        TMath::Nint(z / fPosQuantum),
+                        static_cast<Long64_t>(t / fTimeQuantum + 0.5) };
+  for (Int_t i = 0; i < 4; ++i) {
+    Encode(point[i] - fLast[i]);
+    fLast[i] = point[i];
+  }
+  ++fNPoints.back();
+}
+
+void FairCompactTrajectories::GetPoints(Int_t track, vector<Double_t>& points) const
+{
+  points.resize(4 * fNPoints[track]);
+
+  Long64_t last[4] = { 0, 0, 0, 0 };
+  Int_t pos = fFirstByte[track];
+  for (Int_t n = 0; n < fNPoints[track]; ++n) {
+    for (Int_t i = 0; i < 4; ++i) {
+      last[i] += Decode(pos);
+      points[4 * n + i] = last[i] * (i < 3 ? fPosQuantum : fTimeQuantum);
+    }
+  }
+}
+
+void FairCompactTrajectories::GetParticle(Int_t track, TParticle& p) const
+{
+  Double_t vertex[4] = { 0., 0., 0., 0. };
+  if (fNPoints[track] > 0) {
+    Int_t pos = fFirstByte[track];
+    for (Int_t i = 0; i < 4; ++i) {
+      vertex[i] = Decode(pos) * (i < 3 ? fPosQuantum : fTimeQuantum);
+    }
+  }
+
+  p.SetPdgCode(fPdgCode[track]);
+  p.SetFirstMother(fMotherId[track]);
+  p.SetMomentum(fPx[track], fPy[track], fPz[track], fEnergy[track]);
+  p.SetProductionVertex(vertex[0], vertex[1], vertex[2], vertex[3]);
+}
+
+void FairCompactTrajectories::Encode(Long64_t value)
+{
+  // zigzag: small negative and positive differences both give small numbers
+  ULong64_t v = (static_cast<ULong64_t>(value) << 1) ^ static_cast<ULong64_t>(value >> 63);
+  while (v >= 0x80) {
+    fData.push_back(static_cast<UChar_t>(v) | 0x80);
+    v >>= 7;
+  }
+  fData.push_back(static_cast<UChar_t>(v));
+}
+
+Long64_t FairCompactTrajectories::Decode(Int_t& pos) const
+{
+  ULong64_t v = 0;
+  Int_t shift = 0;
+  UChar_t byte;
+  do {
+    byte = fData[pos++];
+    v |= static_cast<ULong64_t>(byte & 0x7F) << shift;
+    shift += 7;
+  } while (byte & 0x80);
+
+  return static_cast<Long64_t>(v >> 1) ^ -static_cast<Long64_t>(v & 1);
+}
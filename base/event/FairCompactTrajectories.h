@@ -0,0 +1,103 @@
+/********************************************************************************
+ *    Copyright (C) 2014 GSI Helmholtzzentrum fuer Schwerionenforschung GmbH    *
+ *                                                                              *
+ *              This software is distributed under the terms of the             *
+ *         GNU Lesser General Public Licence version 3 (LGPL) version 3,        *
+ *                  copied verbatim in the file "LICENSE"                       *
+ ********************************************************************************/
+#ifndef FAIRCOMPACTTRAJECTORIES_H
+#define FAIRCOMPACTTRAJECTORIES_H
+
+#include "TNamed.h"                     // for TNamed
+
+#include "Rtypes.h"                     // for Int_t, Double_t, etc
+
+#include <vector>                       // for vector
+
+class TParticle;
+
+/**
+ * @class FairCompactTrajectories
+ * Compact persistent storage of all trajectories of one event.
+ * Written by the FairTrajFilter instead of the TClonesArray of TGeoTracks
+ * if FairRunSim::SetStoreTraj(kTRUE, kTRUE) was called.
+ * The particle information is kept in one array per quantity, the points of
+ * all tracks are kept in one byte buffer: the coordinates (cm) and the time (s)
+ * are quantized and each point is stored as the difference to the previous
+ * point of the track, as zigzag encoded variable length integers.
+ */
+class FairCompactTrajectories : public TNamed
+{
+
+  public:
+
+    /**
+     * Default constructor.
+     * @param posQuantum - resolution of the stored coordinates in cm.
+     * @param timeQuantum - resolution of the stored time in s.
+     */
+    FairCompactTrajectories(Double_t posQuantum=1e-3, Double_t timeQuantum=1e-12);
+
+    virtual ~FairCompactTrajectories();
+
+    /** Removes all trajectories, the allocated memory is kept for the next event */
+    virtual void Clear(Option_t* option="");
+
+    /** Starts a new trajectory, the following AddPoint() calls belong to it */
+    void AddTrack(const TParticle* p);
+
+    /** Appends a point to the last trajectory */
+    void AddPoint(Double_t x, Double_t y, Double_t z, Double_t t);
+
+    Int_t GetNTracks() const { return fPdgCode.size(); }
+    Int_t GetNPoints(Int_t track) const { return fNPoints[track]; }
+    Int_t GetPdgCode(Int_t track) const { return fPdgCode[track]; }
+    Int_t GetMotherId(Int_t track) const { return fMotherId[track]; }
+
+    /**
+     * Decodes the points of a trajectory.
+     * @param points - filled with x, y, z, t of every point.
+     */
+    void GetPoints(Int_t track, std::vector<Double_t>& points) const;
+
+    /**
+     * Fills a particle with the information of a trajectory.
+     * The vertex is the first point of the trajectory.
+     */
+    void GetParticle(Int_t track, TParticle& p) const;
+
+    Double_t GetPosQuantum() const { return fPosQuantum; }
+    Double_t GetTimeQuantum() const { return fTimeQuantum; }
+
+    /** Size of the encoded points in bytes */
+    Int_t GetDataSize() const { return fData.size(); }
+
+  private:
+
+    void Encode(Long64_t value);
+    Long64_t Decode(Int_t& pos) const;
+
+    Double_t fPosQuantum;
+    Double_t fTimeQuantum;
+
+    std::vector<Int_t> fPdgCode;
+    std::vector<Int_t> fMotherId;
+    std::vector<Float_t> fPx;
+    std::vector<Float_t> fPy;
+    std::vector<Float_t> fPz;
+    std::vector<Float_t> fEnergy;
+    std::vector<Int_t> fFirstByte;
+    std::vector<Int_t> fNPoints;
+    std::vector<UChar_t> fData;
+
+    /** last point of the current track, in quanta */
+    Long64_t fLast[4];//!
+
+    FairCompactTrajectories(const FairCompactTrajectories&);
+    FairCompactTrajectories& operator=(const FairCompactTrajectories&);
+
+    ClassDef(FairCompactTrajectories,1)
+
+};
+
+#endif
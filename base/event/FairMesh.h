@@ -47,6 +47,10 @@ class FairMesh : public TObject
     Double_t GetYmax()  const { return fYmax;  };
     Double_t GetZmax()  const { return fZmax;  };
 
+    Int_t GetNXbin()  const { return NXbin; };
+    Int_t GetNYbin()  const { return NYbin; };
+    Int_t GetNZbin()  const { return NZbin; };
+
 
     /** Modifiers **/
     void SetX(Double_t xmin,Double_t xmax, Int_t nbin ) {
@@ -63,6 +63,13 @@ void FairField::GetFieldValue(const Double_t point[3], Double_t* bField)
   bField[1] = GetBy(point[0], point[1], point[2]);
   bField[2] = GetBz(point[0], point[1], point[2]);
 }
+// -------------------------------------------------------------------------
+void FairField::GetFieldValues(Int_t n, const Double_t* points, Double_t* bField)
+{
+  for (Int_t i = 0; i < n; ++i) {
+    GetFieldValue(points + 3 * i, bField + 3 * i);
+  }
+}
 
 
 ClassImp(FairField)
@@ -101,6 +101,13 @@ class FairField : public TVirtualMagField
     void Field(const Double_t point[3], Double_t* B) {GetFieldValue(point,B);}
 
 
+    /** Get magnetic field for n points
+     ** @param points           Coordinates [cm], x,y,z of each point
+     ** @param bField (return)  Field components [kG], bx,by,bz of each point
+     **/
+    virtual void GetFieldValues(Int_t n, const Double_t* points, Double_t* bField);
+
+
     /** Screen output. To be implemented in the concrete class. **/
     virtual void  Print(Option_t*) const {;}
     virtual void GetBxyz(const Double_t[3], Double_t*) {LOG(WARNING)<<"FairField::GetBxyz Should be implemented in User class"<<FairLogger::endl;}
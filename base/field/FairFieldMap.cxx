@@ -0,0 +1,609 @@
+/********************************************************************************
+ *    Copyright (C) 2014 GSI Helmholtzzentrum fuer Schwerionenforschung GmbH    *
+ *                                                                              *
+ *              This software is distributed under the terms of the             *
+ *         GNU Lesser General Public Licence version 3 (LGPL) version 3,        *
+ *                  copied verbatim in the file "LICENSE"                       *
+ ********************************************************************************/
+// -------------------------------------------------------------------------
+// -----                    FairFieldMap source file                   -----
+// -------------------------------------------------------------------------
+#include "FairFieldMap.h"
+
+#include "FairLogger.h"                 // for FairLogger, LOG
+
+#include "TMath.h"                      // for ATan2, Sqrt
+#include "TSystem.h"                    // for gSystem
+
+#include <fcntl.h>                      // for open, O_RDONLY
+#include <sys/mman.h>                   // for mmap, munmap
+#include <sys/stat.h>                   // for fstat
+#include <unistd.h>                     // for close
+#include <cmath>                        // for floor
+#include <cstring>                      // for memcmp, memcpy, memset
+#include <fstream>                      // for ifstream, ofstream
+
+using namespace std;
+
+namespace {
+  /** Header of the binary map, followed by the field values (4 floats per node) */
+  struct BinaryHeader {
+    char     fMagic[8];
+    Int_t    fVersion;
+    Int_t    fGridType;
+    Int_t    fN[3];
+    Int_t    fSymmetry[3];
+    Int_t    fSign[9];
+    Int_t    fPad;
+    Double_t fMin[3];
+    Double_t fMax[3];
+  };
+
+  const char kMagic[8] = { 'F', 'A', 'I', 'R', 'F', 'M', 'A', 'P' };
+  const Int_t kVersion = 1;
+
+  /** Catmull-Rom weights of the nodes i-1, i, i+1, i+2 at t in [0,1] */
+  inline void CubicWeights(Double_t t, Double_t w[4])
+  {
+    Double_t t2 = t * t;
+    Double_t t3 = t2 * t;
+    w[0] = 0.5 * (-t3 + 2. * t2 - t);
+    w[1] = 0.5 * (3. * t3 - 5. * t2 + 2.);
+    w[2] = 0.5 * (-3. * t3 + 4. * t2 + t);
+    w[3] = 0.5 * (t3 - t2);
+  }
+
+  /** Cell index and position in the cell of a grid coordinate */
+  inline Int_t Cell(Double_t u, Double_t min, Double_t invStep, Int_t n, Double_t& t)
+  {
+    if (n < 2) {
+      t = 0.;
+      return 0;
+    }
+    Double_t s = (u - min) * invStep;
+    Int_t i = static_cast<Int_t>(floor(s));
+    if (i < 0) {
+      i = 0;
+    } else if (i > n - 2) {
+      i = n - 2;
+    }
+    t = s - i;
+    return i;
+  }
+
+  inline Int_t Clamp(Int_t i, Int_t n)
+  {
+    return i < 0 ? 0 : (i >= n ? n - 1 : i);
+  }
+}
+
+// -----   Default constructor   -------------------------------------------
+FairFieldMap::FairFieldMap()
+  : FairField(),
+    fFileName(""),
+    fGridType(kCartesian),
+    fInterpolation(kLinear),
+    fScale(1.),
+    fData(NULL),
+    fOwnData(),
+    fMapped(NULL),
+    fMappedSize(0)
+{
+  fType = 2;
+  for (Int_t a = 0; a < 3; ++a) {
+    fN[a] = 0;
+    fMin[a] = fMax[a] = fInvStep[a] = fPosition[a] = 0.;
+    fSymmetry[a] = 0;
+    for (Int_t c = 0; c < 3; ++c) {
+      fSign[a][c] = 1;
+    }
+  }
+}
+// -------------------------------------------------------------------------
+
+
+
+// -----   Standard constructor   ------------------------------------------
+FairFieldMap::FairFieldMap(const char* name, const char* fileName)
+  : FairField(name),
+    fFileName(fileName),
+    fGridType(kCartesian),
+    fInterpolation(kLinear),
+    fScale(1.),
+    fData(NULL),
+    fOwnData(),
+    fMapped(NULL),
+    fMappedSize(0)
+{
+  fType = 2;
+  for (Int_t a = 0; a < 3; ++a) {
+    fN[a] = 0;
+    fMin[a] = fMax[a] = fInvStep[a] = fPosition[a] = 0.;
+    fSymmetry[a] = 0;
+    for (Int_t c = 0; c < 3; ++c) {
+      fSign[a][c] = 1;
+    }
+  }
+}
+// -------------------------------------------------------------------------
+
+
+
+// -----   Destructor   ----------------------------------------------------
+FairFieldMap::~FairFieldMap()
+{
+  ResetData();
+}
+// -------------------------------------------------------------------------
+
+
+
+// -----   Public method Init   --------------------------------------------
+void FairFieldMap::Init()
+{
+  if (fData || fFileName.IsNull()) {
+    return;
+  }
+
+  TString fileName = fFileName;
+  gSystem->ExpandPathName(fileName);
+
+  // a binary map is recognised by its header
+  Bool_t binary = kFALSE;
+  ifstream in(fileName.Data(), ios::binary);
+  char magic[8];
+  if (in.read(magic, sizeof(magic)) && memcmp(magic, kMagic, sizeof(magic)) == 0) {
+    binary = kTRUE;
+  }
+  in.close();
+
+  Bool_t ok = binary ? ReadBinary(fileName) : ReadAscii(fileName);
+  if (!ok) {
+    LOG(FATAL) << "FairFieldMap: could not read field map " << fileName << FairLogger::endl;
+  }
+}
+// -------------------------------------------------------------------------
+
+
+
+// -----   Public method SetGrid   -----------------------------------------
+void FairFieldMap::SetGrid(EGridType type, const Int_t n[3], const Double_t min[3], const Double_t max[3])
+{
+  ResetData();
+  fGridType = type;
+  for (Int_t a = 0; a < 3; ++a) {
+    fN[a] = n[a];
+    fMin[a] = min[a];
+    fMax[a] = max[a];
+  }
+  SetStep();
+  fOwnData.assign(4 * static_cast<size_t>(n[0]) * n[1] * n[2], 0.f);
+  fData = &fOwnData[0];
+}
+// -------------------------------------------------------------------------
+
+
+
+// -----   Public method SetValue   ----------------------------------------
+void FairFieldMap::SetValue(Int_t i, Int_t j, Int_t k, Double_t b0, Double_t b1, Double_t b2)
+{
+  if (fOwnData.empty()) {
+    LOG(ERROR) << "FairFieldMap::SetValue: map is not writable, call SetGrid first" << FairLogger::endl;
+    return;
+  }
+  Float_t* node = &fOwnData[4 * ((static_cast<size_t>(i) * fN[1] + j) * fN[2] + k)];
+  node[0] = b0;
+  node[1] = b1;
+  node[2] = b2;
+  node[3] = 0.f;
+}
+// -------------------------------------------------------------------------
+
+
+
+// -----   Public method SetSymmetry   -------------------------------------
+void FairFieldMap::SetSymmetry(Int_t axis, Int_t s0, Int_t s1, Int_t s2)
+{
+  fSymmetry[axis] = 1;
+  fSign[axis][0] = s0;
+  fSign[axis][1] = s1;
+  fSign[axis][2] = s2;
+}
+// -------------------------------------------------------------------------
+
+
+
+// -----   Public method SetPosition   -------------------------------------
+void FairFieldMap::SetPosition(Double_t x, Double_t y, Double_t z)
+{
+  fPosition[0] = x;
+  fPosition[1] = y;
+  fPosition[2] = z;
+}
+// -------------------------------------------------------------------------
+
+
+
+// -----   Public method ReadAscii   ---------------------------------------
+Bool_t FairFieldMap::ReadAscii(const char* fileName)
+{
+  ifstream in(fileName);
+  if (!in) {
+    LOG(ERROR) << "FairFieldMap: cannot open " << fileName << FairLogger::endl;
+    return kFALSE;
+  }
+
+  TString type;
+  in >> type;
+  EGridType gridType;
+  if (type.CompareTo("Cartesian", TString::kIgnoreCase) == 0) {
+    gridType = kCartesian;
+  } else if (type.CompareTo("Cylindrical", TString::kIgnoreCase) == 0) {
+    gridType = kCylindrical;
+  } else {
+    LOG(ERROR) << "FairFieldMap: unknown grid type " << type << " in " << fileName << FairLogger::endl;
+    return kFALSE;
+  }
+
+  Int_t n[3];
+  Double_t min[3], max[3];
+  for (Int_t a = 0; a < 3; ++a) {
+    in >> n[a] >> min[a] >> max[a];
+  }
+  if (!in || n[0] < 1 || n[1] < 1 || n[2] < 1) {
+    LOG(ERROR) << "FairFieldMap: wrong grid definition in " << fileName << FairLogger::endl;
+    return kFALSE;
+  }
+
+  SetGrid(gridType, n, min, max);
+  size_t nNodes = static_cast<size_t>(n[0]) * n[1] * n[2];
+  for (size_t node = 0; node < nNodes; ++node) {
+    Double_t b0, b1, b2;
+    in >> b0 >> b1 >> b2;
+    fOwnData[4 * node] = b0;
+    fOwnData[4 * node + 1] = b1;
+    fOwnData[4 * node + 2] = b2;
+  }
+  if (!in) {
+    LOG(ERROR) << "FairFieldMap: " << fileName << " has less than " << nNodes
+               << " field values" << FairLogger::endl;
+    ResetData();
+    return kFALSE;
+  }
+
+  LOG(INFO) << "FairFieldMap: read " << nNodes << " nodes from " << fileName << FairLogger::endl;
+  return kTRUE;
+}
+// -------------------------------------------------------------------------
+
+
+
+// -----   Public method ReadBinary   --------------------------------------
+Bool_t FairFieldMap::ReadBinary(const char* fileName)
+{
+  Int_t fd = open(fileName, O_RDONLY);
+  if (fd < 0) {
+    LOG(ERROR) << "FairFieldMap: cannot open " << fileName << FairLogger::endl;
+    return kFALSE;
+  }
+  struct stat st;
+  if (fstat(fd, &st) != 0 || st.st_size < static_cast<off_t>(sizeof(BinaryHeader))) {
+    LOG(ERROR) << "FairFieldMap: " << fileName << " is not a field map" << FairLogger::endl;
+    close(fd);
+    return kFALSE;
+  }
+  void* mapped = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (mapped == MAP_FAILED) {
+    LOG(ERROR) << "FairFieldMap: cannot map " << fileName << FairLogger::endl;
+    return kFALSE;
+  }
+
+  const BinaryHeader* header = static_cast<const BinaryHeader*>(mapped);
+  Long64_t nNodes = static_cast<Long64_t>(header->fN[0]) * header->fN[1] * header->fN[2];
+  if (memcmp(header->fMagic, kMagic, sizeof(kMagic)) != 0 || header->fVersion != kVersion
+      || (header->fGridType != kCartesian && header->fGridType != kCylindrical)
+      || header->fN[0] < 1 || header->fN[1] < 1 || header->fN[2] < 1
+      || st.st_size != static_cast<off_t>(sizeof(BinaryHeader) + 4 * sizeof(Float_t) * nNodes)) {
+    LOG(ERROR) << "FairFieldMap: " << fileName << " is not a field map of version "
+               << kVersion << FairLogger::endl;
+    munmap(mapped, st.st_size);
+    return kFALSE;
+  }
+
+  ResetData();
+  fGridType = header->fGridType;
+  for (Int_t a = 0; a < 3; ++a) {
+    fN[a] = header->fN[a];
+    fMin[a] = header->fMin[a];
+    fMax[a] = header->fMax[a];
+    fSymmetry[a] = header->fSymmetry[a];
+    for (Int_t c = 0; c < 3; ++c) {
+      fSign[a][c] = header->fSign[3 * a + c];
+    }
+  }
+  SetStep();
+  fMapped = mapped;
+  fMappedSize = st.st_size;
+  fData = reinterpret_cast<const Float_t*>(static_cast<const char*>(mapped) + sizeof(BinaryHeader));
+
+  LOG(INFO) << "FairFieldMap: mapped " << nNodes << " nodes from " << fileName << FairLogger::endl;
+  return kTRUE;
+}
+// -------------------------------------------------------------------------
+
+
+
+// -----   Public method WriteBinary   -------------------------------------
+Bool_t FairFieldMap::WriteBinary(const char* fileName) const
+{
+  if (!fData) {
+    LOG(ERROR) << "FairFieldMap::WriteBinary: map is empty" << FairLogger::endl;
+    return kFALSE;
+  }
+
+  BinaryHeader header;
+  memset(&header, 0, sizeof(header));
+  memcpy(header.fMagic, kMagic, sizeof(kMagic));
+  header.fVersion = kVersion;
+  header.fGridType = fGridType;
+  for (Int_t a = 0; a < 3; ++a) {
+    header.fN[a] = fN[a];
+    header.fMin[a] = fMin[a];
+    header.fMax[a] = fMax[a];
+    header.fSymmetry[a] = fSymmetry[a];
+    for (Int_t c = 0; c < 3; ++c) {
+      header.fSign[3 * a + c] = fSign[a][c];
+    }
+  }
+
+  ofstream out(fileName, ios::binary);
+  out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  out.write(reinterpret_cast<const char*>(fData),
+            4 * sizeof(Float_t) * static_cast<size_t>(fN[0]) * fN[1] * fN[2]);
+  if (!out) {
+    LOG(ERROR) << "FairFieldMap: cannot write " << fileName << FairLogger::endl;
+    return kFALSE;
+  }
+  return kTRUE;
+}
+// -------------------------------------------------------------------------
+
+
+
+// -----   Get the field components   --------------------------------------
+Double_t FairFieldMap::GetBx(Double_t x, Double_t y, Double_t z)
+{
+  Double_t point[3] = { x, y, z };
+  Double_t b[3];
+  Evaluate(point, b);
+  return b[0];
+}
+
+Double_t FairFieldMap::GetBy(Double_t x, Double_t y, Double_t z)
+{
+  Double_t point[3] = { x, y, z };
+  Double_t b[3];
+  Evaluate(point, b);
+  return b[1];
+}
+
+Double_t FairFieldMap::GetBz(Double_t x, Double_t y, Double_t z)
+{
+  Double_t point[3] = { x, y, z };
+  Double_t b[3];
+  Evaluate(point, b);
+  return b[2];
+}
+// -------------------------------------------------------------------------
+
+
+
+// -----   Public method GetFieldValue   -----------------------------------
+void FairFieldMap::GetFieldValue(const Double_t point[3], Double_t* bField)
+{
+  Evaluate(point, bField);
+}
+// -------------------------------------------------------------------------
+
+
+
+// -----   Public method GetFieldValues   ----------------------------------
+void FairFieldMap::GetFieldValues(Int_t n, const Double_t* points, Double_t* bField)
+{
+  for (Int_t i = 0; i < n; ++i) {
+    Evaluate(points + 3 * i, bField + 3 * i);
+  }
+}
+// -------------------------------------------------------------------------
+
+
+
+// -----   Public method Print   -------------------------------------------
+void FairFieldMap::Print(Option_t*) const
+{
+  const char* axes[2][3] = { { "x", "y", "z" }, { "r", "phi", "z" } };
+  LOG(INFO) << "======================================================" << FairLogger::endl;
+  LOG(INFO) << "----  " << GetName() << " : "
+            << (fGridType == kCartesian ? "cartesian" : "cylindrical") << " field map, "
+            << (fInterpolation == kLinear ? "linear" : "cubic") << " interpolation" << FairLogger::endl;
+  if (!fFileName.IsNull()) {
+    LOG(INFO) << "----  File     : " << fFileName << FairLogger::endl;
+  }
+  for (Int_t a = 0; a < 3; ++a) {
+    LOG(INFO) << "----  " << axes[fGridType == kCylindrical ? 1 : 0][a] << " : " << fN[a] << " nodes from "
+              << fMin[a] << " to " << fMax[a]
+              << (fSymmetry[a] ? " (folded)" : "") << FairLogger::endl;
+  }
+  LOG(INFO) << "----  Position : (" << fPosition[0] << ", " << fPosition[1] << ", "
+            << fPosition[2] << ") cm, scale " << fScale << FairLogger::endl;
+  LOG(INFO) << "======================================================" << FairLogger::endl;
+}
+// -------------------------------------------------------------------------
+
+
+
+// -----   Private method Evaluate   ---------------------------------------
+void FairFieldMap::Evaluate(const Double_t point[3], Double_t* bField) const
+{
+  bField[0] = bField[1] = bField[2] = 0.;
+  if (!fData) {
+    return;
+  }
+
+  // grid coordinates
+  Double_t g[3] = { point[0] - fPosition[0], point[1] - fPosition[1], point[2] - fPosition[2] };
+  Double_t x = g[0];
+  Double_t y = g[1];
+  if (fGridType == kCylindrical) {
+    g[0] = TMath::Sqrt(x * x + y * y);
+    g[1] = TMath::ATan2(y, x);
+    // ATan2 returns (-pi,pi], move phi into the period starting at the
+    // lower edge of the grid (a map folded at phi=0 takes the sign instead)
+    if (!fSymmetry[1]) {
+      g[1] -= TMath::TwoPi() * TMath::Floor((g[1] - fMin[1]) / TMath::TwoPi());
+    }
+  }
+
+  // symmetry folding
+  Double_t sign[3] = { 1., 1., 1. };
+  for (Int_t a = 0; a < 3; ++a) {
+    if (fSymmetry[a] && g[a] < 0.) {
+      g[a] = -g[a];
+      for (Int_t c = 0; c < 3; ++c) {
+        sign[c] *= fSign[a][c];
+      }
+    }
+  }
+
+  // axes with one node are not limited, e.g. phi for an axially symmetric map
+  for (Int_t a = 0; a < 3; ++a) {
+    if (fN[a] > 1 && (g[a] < fMin[a] || g[a] > fMax[a])) {
+      return;
+    }
+  }
+
+  Double_t b[4];
+  if (fInterpolation == kCubic) {
+    InterpolateCubic(g, b);
+  } else {
+    InterpolateLinear(g, b);
+  }
+
+  for (Int_t c = 0; c < 3; ++c) {
+    b[c] *= sign[c] * fScale;
+  }
+
+  if (fGridType == kCylindrical) {
+    Double_t r = g[0];
+    Double_t cosPhi = r > 0. ? x / r : 1.;
+    Double_t sinPhi = r > 0. ? y / r : 0.;
+    bField[0] = b[0] * cosPhi - b[1] * sinPhi;
+    bField[1] = b[0] * sinPhi + b[1] * cosPhi;
+    bField[2] = b[2];
+  } else {
+    bField[0] = b[0];
+    bField[1] = b[1];
+    bField[2] = b[2];
+  }
+}
+// -------------------------------------------------------------------------
+
+
+
+// -----   Private method InterpolateLinear   ------------------------------
+void FairFieldMap::InterpolateLinear(const Double_t g[3], Double_t b[4]) const
+{
+  Double_t t[3];
+  Int_t i = Cell(g[0], fMin[0], fInvStep[0], fN[0], t[0]);
+  Int_t j = Cell(g[1], fMin[1], fInvStep[1], fN[1], t[1]);
+  Int_t k = Cell(g[2], fMin[2], fInvStep[2], fN[2], t[2]);
+
+  // node strides in floats, 0 for an axis with one node
+  size_t s2 = fN[2] > 1 ? 4 : 0;
+  size_t s1 = fN[1] > 1 ? 4 * static_cast<size_t>(fN[2]) : 0;
+  size_t s0 = fN[0] > 1 ? 4 * static_cast<size_t>(fN[1]) * fN[2] : 0;
+  const Float_t* base = fData + 4 * ((static_cast<size_t>(i) * fN[1] + j) * fN[2] + k);
+
+  b[0] = b[1] = b[2] = b[3] = 0.;
+  for (Int_t di = 0; di < 2; ++di) {
+    Double_t wi = di ? t[0] : 1. - t[0];
+    for (Int_t dj = 0; dj < 2; ++dj) {
+      Double_t wij = wi * (dj ? t[1] : 1. - t[1]);
+      for (Int_t dk = 0; dk < 2; ++dk) {
+        Double_t w = wij * (dk ? t[2] : 1. - t[2]);
+        const Float_t* node = base + di * s0 + dj * s1 + dk * s2;
+        for (Int_t c = 0; c < 4; ++c) {
+          b[c] += w * node[c];
+        }
+      }
+    }
+  }
+}
+// -------------------------------------------------------------------------
+
+
+
+// -----   Private method InterpolateCubic   -------------------------------
+void FairFieldMap::InterpolateCubic(const Double_t g[3], Double_t b[4]) const
+{
+  Double_t t[3];
+  Int_t cell[3];
+  for (Int_t a = 0; a < 3; ++a) {
+    cell[a] = Cell(g[a], fMin[a], fInvStep[a], fN[a], t[a]);
+  }
+
+  Double_t w[3][4];
+  size_t offset[3][4];
+  size_t stride[3] = { static_cast<size_t>(fN[1]) * fN[2], static_cast<size_t>(fN[2]), 1 };
+  for (Int_t a = 0; a < 3; ++a) {
+    CubicWeights(t[a], w[a]);
+    for (Int_t d = 0; d < 4; ++d) {
+      offset[a][d] = 4 * stride[a] * Clamp(cell[a] - 1 + d, fN[a]);
+    }
+  }
+
+  b[0] = b[1] = b[2] = b[3] = 0.;
+  for (Int_t di = 0; di < 4; ++di) {
+    for (Int_t dj = 0; dj < 4; ++dj) {
+      Double_t wij = w[0][di] * w[1][dj];
+      const Float_t* row = fData + offset[0][di] + offset[1][dj];
+      for (Int_t dk = 0; dk < 4; ++dk) {
+        Double_t wijk = wij * w[2][dk];
+        const Float_t* node = row + offset[2][dk];
+        for (Int_t c = 0; c < 4; ++c) {
+          b[c] += wijk * node[c];
+        }
+      }
+    }
+  }
+}
+// -------------------------------------------------------------------------
+
+
+
+// -----   Private method ResetData   --------------------------------------
+void FairFieldMap::ResetData()
+{
+  if (fMapped) {
+    munmap(fMapped, fMappedSize);
+    fMapped = NULL;
+    fMappedSize = 0;
+  }
+  fOwnData.clear();
+  fData = NULL;
+}
+// -------------------------------------------------------------------------
+
+
+
+// -----   Private method SetStep   ----------------------------------------
+void FairFieldMap::SetStep()
+{
+  for (Int_t a = 0; a < 3; ++a) {
+    fInvStep[a] = (fN[a] > 1 && fMax[a] > fMin[a]) ? (fN[a] - 1) / (fMax[a] - fMin[a]) : 0.;
+  }
+}
+// -------------------------------------------------------------------------
+
+ClassImp(FairFieldMap)
@@ -0,0 +1,144 @@
+/********************************************************************************
+ *    Copyright (C) 2014 GSI Helmholtzzentrum fuer Schwerionenforschung GmbH    *
+ *                                                                              *
+ *              This software is distributed under the terms of the             *
+ *         GNU Lesser General Public Licence version 3 (LGPL) version 3,        *
+ *                  copied verbatim in the file "LICENSE"                       *
+ ********************************************************************************/
+// -------------------------------------------------------------------------
+// -----                    FairFieldMap header file                   -----
+// -------------------------------------------------------------------------
+
+
+/** FairFieldMap.h
+ **
+ ** Magnetic field map on a regular grid, cartesian (x,y,z) or
+ ** cylindrical (r,phi,z), with trilinear or tricubic (Catmull-Rom)
+ ** interpolation. For a cylindrical grid the map contains Br, Bphi, Bz;
+ ** with one phi bin the field is taken as axially symmetric.
+ **
+ ** The map can be folded at the planes of the grid coordinates
+ ** (SetSymmetry): the map then only covers the positive side of this
+ ** coordinate, and the field components get the given signs on the
+ ** negative side. Outside of the map the field is zero.
+ **
+ ** The field values of a grid node are stored as 4 floats (3 components
+ ** and padding), so that the interpolation runs over all components at
+ ** once. The map is read from
+ ** - a binary file written by WriteBinary(), which is mapped into memory
+ **   and used without any conversion, or
+ ** - an ASCII file: first line "Cartesian" or "Cylindrical", then for
+ **   each of the three grid coordinates a line "n min max", then the
+ **   n0*n1*n2 field vectors, the last coordinate running fastest.
+ ** Coordinates are in cm (phi in rad), field values in kG.
+ **/
+
+#ifndef FAIRFIELDMAP_H
+#define FAIRFIELDMAP_H 1
+
+#include "FairField.h"                  // for FairField
+
+#include "Rtypes.h"                     // for Double_t, Int_t, etc
+#include "TString.h"                    // for TString
+
+#include <vector>                       // for vector
+
+class FairFieldMap : public FairField
+{
+
+  public:
+
+    enum EGridType { kCartesian = 0, kCylindrical = 1 };
+    enum EInterpolation { kLinear = 0, kCubic = 1 };
+
+    /** Default constructor **/
+    FairFieldMap();
+
+    /** Standard constructor
+     ** @param fileName  binary or ASCII map, read in Init()
+     **/
+    FairFieldMap(const char* name, const char* fileName);
+
+    /** Destructor **/
+    virtual ~FairFieldMap();
+
+    /** Reads the map given in the constructor, if not yet filled **/
+    virtual void Init();
+
+    /** Creates an empty map, to be filled with SetValue()
+     ** @param n, min, max  number of nodes and range of the grid coordinates
+     **/
+    void SetGrid(EGridType type, const Int_t n[3], const Double_t min[3], const Double_t max[3]);
+
+    /** Sets the field at a grid node [kG] **/
+    void SetValue(Int_t i, Int_t j, Int_t k, Double_t b0, Double_t b1, Double_t b2);
+
+    void SetInterpolation(EInterpolation interpolation) { fInterpolation = interpolation; }
+
+    /** Folds the map at the plane coordinate=0
+     ** @param axis        0, 1 or 2 for the first, second or third grid coordinate
+     ** @param s0, s1, s2  signs of the field components for negative coordinate
+     **/
+    void SetSymmetry(Int_t axis, Int_t s0, Int_t s1, Int_t s2);
+
+    /** Scale factor for the field values **/
+    void SetScale(Double_t scale) { fScale = scale; }
+
+    /** Position of the map origin in the global system [cm] **/
+    void SetPosition(Double_t x, Double_t y, Double_t z);
+
+    Bool_t ReadAscii(const char* fileName);
+    Bool_t ReadBinary(const char* fileName);
+    Bool_t WriteBinary(const char* fileName) const;
+
+    /** Get the field components [kG]. Each call interpolates all
+     ** components, use GetFieldValue() if more than one is needed.
+     **/
+    virtual Double_t GetBx(Double_t x, Double_t y, Double_t z);
+    virtual Double_t GetBy(Double_t x, Double_t y, Double_t z);
+    virtual Double_t GetBz(Double_t x, Double_t y, Double_t z);
+
+    virtual void GetFieldValue(const Double_t point[3], Double_t* bField);
+    virtual void GetBxyz(const Double_t point[3], Double_t* bField) { GetFieldValue(point, bField); }
+
+    virtual void GetFieldValues(Int_t n, const Double_t* points, Double_t* bField);
+
+    virtual void Print(Option_t*) const;
+
+  private:
+    /** Field at a global position, without virtual calls **/
+    void Evaluate(const Double_t point[3], Double_t* bField) const;
+
+    /** Interpolation at grid coordinates inside the map **/
+    void InterpolateLinear(const Double_t g[3], Double_t b[4]) const;
+    void InterpolateCubic(const Double_t g[3], Double_t b[4]) const;
+
+    void ResetData();
+    void SetStep();
+
+    TString  fFileName;
+    Int_t    fGridType;
+    Int_t    fInterpolation;
+    Int_t    fN[3];
+    Double_t fMin[3];
+    Double_t fMax[3];
+    Int_t    fSymmetry[3];
+    Int_t    fSign[3][3];
+    Double_t fScale;
+    Double_t fPosition[3];
+
+    Double_t fInvStep[3];              //!
+
+    /** Field values, 4 floats per node, in fOwnData or in the mapped file **/
+    const Float_t*       fData;        //!
+    std::vector<Float_t> fOwnData;     //!
+    void*                fMapped;      //!
+    Long64_t             fMappedSize;  //!
+
+    FairFieldMap(const FairFieldMap&);
+    FairFieldMap& operator=(const FairFieldMap&);
+
+    ClassDef(FairFieldMap,1)
+};
+
+#endif
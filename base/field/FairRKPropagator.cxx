@@ -13,9 +13,48 @@
 #include "TMathBase.h"                  // for Abs
 
 #include <stdio.h>                      // for printf
+#include <vector>                       // for vector
+
+using std::vector;
 
 ClassImp(FairRKPropagator);
 
+namespace {
+  /** Field at the points of a subset of the tracks of a batch, with one call to the field */
+  class BatchField
+  {
+    public:
+      BatchField(FairField* field) : fField(field), fPoints(), fValues() {}
+
+      void Get(const vector<Int_t>& sel, const Double_t* x, const Double_t* y, const Double_t* z,
+               Double_t* bx, Double_t* by, Double_t* bz)
+      {
+        Int_t m = sel.size();
+        if (m == 0) { return; }
+        fPoints.resize(3*m);
+        fValues.resize(3*m);
+        for (Int_t j=0; j<m; j++) {
+          Int_t k = sel[j];
+          fPoints[3*j]   = x[k];
+          fPoints[3*j+1] = y[k];
+          fPoints[3*j+2] = z[k];
+        }
+        fField->GetFieldValues(m, &fPoints[0], &fValues[0]);
+        for (Int_t j=0; j<m; j++) {
+          Int_t k = sel[j];
+          bx[k] = fValues[3*j];
+          by[k] = fValues[3*j+1];
+          bz[k] = fValues[3*j+2];
+        }
+      }
+
+    private:
+      FairField* fField;
+      vector<Double_t> fPoints;
+      vector<Double_t> fValues;
+  };
+}
+
 //______________________________________________________________________________
 FairRKPropagator::FairRKPropagator(FairField* field)
   : TObject(),
@@ -271,7 +310,7 @@ Double_t FairRKPropagator::OneStepRungeKutta(Double_t charge, Double_t step,
 //   printf(" differance     dxt=%f  dyt=%f  dzt=%f  \n", dxt, dyt, dzt);
     // * second intermediate point
     est = TMath::Abs(dxt) + TMath::Abs(dyt) + TMath::Abs(dzt);
-    if (est > h) {
+    if (est > TMath::Abs(h)) {
       if (ncut++ > maxcut) { break; }
       h *= khalf;
       continue;
@@ -412,3 +451,279 @@ Double_t FairRKPropagator::OneStepRungeKutta(Double_t charge, Double_t step,
   */
 
 }
+
+//______________________________________________________________________________
+void FairRKPropagator::OneStepRungeKutta(Int_t n, const Double_t* charge, const Double_t* step,
+    Double_t* vect[7], Double_t* length)
+{
+  // Same integration as the scalar OneStepRungeKutta, see there. All tracks
+  // which are not done yet go through the stages together; the arithmetic of
+  // a stage runs over contiguous arrays for all of them, the tracks which had
+  // to cut their step or are done are masked out of the following stages.
+
+  const Int_t maxit = 1992;
+  const Int_t maxcut = 11;
+
+  const Double_t hmin   = 1e-4;
+  const Double_t kdlt   = 1e-6;
+  const Double_t kdlt32 = kdlt/32.;
+  const Double_t kthird = 1./3.;
+  const Double_t khalf  = 0.5;
+  const Double_t kec    = 2.99792458e-4;
+  const Double_t kpisqua = 9.86960440109;
+
+  Double_t* x = vect[0];
+  Double_t* y = vect[1];
+  Double_t* z = vect[2];
+  Double_t* a = vect[3];
+  Double_t* b = vect[4];
+  Double_t* c = vect[5];
+
+  // state of the tracks
+  vector<Double_t> h(n), tl(n, 0.), pinv(n);
+  vector<Int_t> ncut(n, 0), iter(n, 0);
+  vector<Int_t> lanes;
+  lanes.reserve(n);
+  for (Int_t i=0; i<n; i++) {
+    h[i] = step[i];
+    pinv[i] = kec * charge[i] / vect[6][i];
+    if (step[i] != 0.) { lanes.push_back(i); }
+  }
+  vector<Bool_t> done(n, kFALSE);
+
+  // working arrays of the current pass, indexed by the position in lanes
+  vector<Double_t> X(n), Y(n), Z(n), A(n), B(n), C(n), H(n), PH2(n);
+  vector<Double_t> XT(n), YT(n), ZT(n), AT(n), BT(n), CT(n), EST(n), ANG2(n);
+  vector<Double_t> BX(n), BY(n), BZ(n);
+  vector<Double_t> SX[4], SY[4], SZ[4];
+  for (Int_t s=0; s<4; s++) {
+    SX[s].resize(n);
+    SY[s].resize(n);
+    SZ[s].resize(n);
+  }
+  vector<Int_t> all, sel1, sel2;
+  BatchField field(fMagField);
+
+  while (!lanes.empty()) {
+    Int_t m = lanes.size();
+    all.resize(m);
+    for (Int_t k=0; k<m; k++) {
+      Int_t i = lanes[k];
+      Double_t rest = step[i] - tl[i];
+      if (TMath::Abs(h[i]) > TMath::Abs(rest)) {
+        h[i] = rest;
+      }
+      X[k] = x[i];
+      Y[k] = y[i];
+      Z[k] = z[i];
+      A[k] = a[i];
+      B[k] = b[i];
+      C[k] = c[i];
+      H[k] = h[i];
+      PH2[k] = khalf * pinv[i] * h[i];
+      all[k] = k;
+    }
+
+    // * first intermediate point
+    field.Get(all, &X[0], &Y[0], &Z[0], &BX[0], &BY[0], &BZ[0]);
+    for (Int_t k=0; k<m; k++) {
+      Double_t h2 = khalf * H[k];
+      Double_t h4 = khalf * h2;
+      SX[0][k] = (B[k] * BZ[k] - C[k] * BY[k]) * PH2[k];
+      SY[0][k] = (C[k] * BX[k] - A[k] * BZ[k]) * PH2[k];
+      SZ[0][k] = (A[k] * BY[k] - B[k] * BX[k]) * PH2[k];
+      ANG2[k] = SX[0][k]*SX[0][k] + SY[0][k]*SY[0][k] + SZ[0][k]*SZ[0][k];
+      Double_t dxt = h2 * A[k] + h4 * SX[0][k];
+      Double_t dyt = h2 * B[k] + h4 * SY[0][k];
+      Double_t dzt = h2 * C[k] + h4 * SZ[0][k];
+      XT[k] = X[k] + dxt;
+      YT[k] = Y[k] + dyt;
+      ZT[k] = Z[k] + dzt;
+      EST[k] = TMath::Abs(dxt) + TMath::Abs(dyt) + TMath::Abs(dzt);
+    }
+    sel1.clear();
+    for (Int_t k=0; k<m; k++) {
+      Int_t i = lanes[k];
+      if (ANG2[k] > kpisqua) {
+        done[i] = kTRUE;
+      } else if (EST[k] > TMath::Abs(H[k])) {
+        if (ncut[i]++ > maxcut) { done[i] = kTRUE; }
+        else { h[i] *= khalf; }
+      } else {
+        sel1.push_back(k);
+      }
+    }
+
+    // * second intermediate point
+    field.Get(sel1, &XT[0], &YT[0], &ZT[0], &BX[0], &BY[0], &BZ[0]);
+    for (Int_t k=0; k<m; k++) {
+      Double_t at = A[k] + SX[0][k];
+      Double_t bt = B[k] + SY[0][k];
+      Double_t ct = C[k] + SZ[0][k];
+      SX[1][k] = (bt * BZ[k] - ct * BY[k]) * PH2[k];
+      SY[1][k] = (ct * BX[k] - at * BZ[k]) * PH2[k];
+      SZ[1][k] = (at * BY[k] - bt * BX[k]) * PH2[k];
+      at = A[k] + SX[1][k];
+      bt = B[k] + SY[1][k];
+      ct = C[k] + SZ[1][k];
+      SX[2][k] = (bt * BZ[k] - ct * BY[k]) * PH2[k];
+      SY[2][k] = (ct * BX[k] - at * BZ[k]) * PH2[k];
+      SZ[2][k] = (at * BY[k] - bt * BX[k]) * PH2[k];
+      Double_t dxt = H[k] * (A[k] + SX[2][k]);
+      Double_t dyt = H[k] * (B[k] + SY[2][k]);
+      Double_t dzt = H[k] * (C[k] + SZ[2][k]);
+      XT[k] = X[k] + dxt;
+      YT[k] = Y[k] + dyt;
+      ZT[k] = Z[k] + dzt;
+      AT[k] = A[k] + 2.*SX[2][k];
+      BT[k] = B[k] + 2.*SY[2][k];
+      CT[k] = C[k] + 2.*SZ[2][k];
+      EST[k] = TMath::Abs(dxt) + TMath::Abs(dyt) + TMath::Abs(dzt);
+    }
+    sel2.clear();
+    for (size_t j=0; j<sel1.size(); j++) {
+      Int_t k = sel1[j];
+      Int_t i = lanes[k];
+      if (EST[k] > 2.*TMath::Abs(H[k])) {
+        if (ncut[i]++ > maxcut) { done[i] = kTRUE; }
+        else { h[i] *= khalf; }
+      } else {
+        sel2.push_back(k);
+      }
+    }
+
+    // * end point
+    field.Get(sel2, &XT[0], &YT[0], &ZT[0], &BX[0], &BY[0], &BZ[0]);
+    for (Int_t k=0; k<m; k++) {
+      X[k] = X[k] + (A[k] + (SX[0][k] + SX[1][k] + SX[2][k]) * kthird) * H[k];
+      Y[k] = Y[k] + (B[k] + (SY[0][k] + SY[1][k] + SY[2][k]) * kthird) * H[k];
+      Z[k] = Z[k] + (C[k] + (SZ[0][k] + SZ[1][k] + SZ[2][k]) * kthird) * H[k];
+      SX[3][k] = (BT[k]*BZ[k] - CT[k]*BY[k]) * PH2[k];
+      SY[3][k] = (CT[k]*BX[k] - AT[k]*BZ[k]) * PH2[k];
+      SZ[3][k] = (AT[k]*BY[k] - BT[k]*BX[k]) * PH2[k];
+      A[k] = A[k] + (SX[0][k] + SX[3][k] + 2. * (SX[1][k] + SX[2][k])) * kthird;
+      B[k] = B[k] + (SY[0][k] + SY[3][k] + 2. * (SY[1][k] + SY[2][k])) * kthird;
+      C[k] = C[k] + (SZ[0][k] + SZ[3][k] + 2. * (SZ[1][k] + SZ[2][k])) * kthird;
+      EST[k] = TMath::Abs(SX[0][k] + SX[3][k] - (SX[1][k] + SX[2][k]))
+               + TMath::Abs(SY[0][k] + SY[3][k] - (SY[1][k] + SY[2][k]))
+               + TMath::Abs(SZ[0][k] + SZ[3][k] - (SZ[1][k] + SZ[2][k]));
+    }
+    for (size_t j=0; j<sel2.size(); j++) {
+      Int_t k = sel2[j];
+      Int_t i = lanes[k];
+      if (EST[k] > kdlt && TMath::Abs(H[k]) > hmin) {
+        if (ncut[i]++ > maxcut) { done[i] = kTRUE; }
+        else { h[i] *= khalf; }
+        continue;
+      }
+      ncut[i] = 0;
+      // * if too many iterations, stop here
+      if (iter[i]++ > maxit) {
+        done[i] = kTRUE;
+        continue;
+      }
+      tl[i] += h[i];
+      if (EST[k] < kdlt32) {
+        h[i] *= 2.;
+      }
+      Double_t cba = 1./ TMath::Sqrt(A[k]*A[k] + B[k]*B[k] + C[k]*C[k]);
+      x[i] = X[k];
+      y[i] = Y[k];
+      z[i] = Z[k];
+      a[i] = cba*A[k];
+      b[i] = cba*B[k];
+      c[i] = cba*C[k];
+
+      Double_t rest = step[i] - tl[i];
+      if (step[i] < 0.) { rest = -rest; }
+      if (rest < 1.e-5*TMath::Abs(step[i])) { done[i] = kTRUE; }
+    }
+
+    // keep the tracks which are not done
+    Int_t nLeft = 0;
+    for (Int_t k=0; k<m; k++) {
+      if (!done[lanes[k]]) { lanes[nLeft++] = lanes[k]; }
+    }
+    lanes.resize(nLeft);
+  }
+
+  if (length) {
+    for (Int_t i=0; i<n; i++) { length[i] = tl[i]; }
+  }
+}
+//______________________________________________________________________________
+Int_t FairRKPropagator::PropagatToPlane(Int_t n, const Double_t* charge, Double_t* vect[7],
+                                        const Double_t* vec1, const Double_t* vec2, const Double_t* vec3,
+                                        Double_t* length, Bool_t* onPlane)
+{
+  // Newton iteration on the distance to the plane: each track is propagated
+  // by its distance to the plane along its direction, until it is closer
+  // than the tolerance. The tracks still away from the plane are propagated
+  // together.
+
+  const Int_t maxIter = 20;
+  const Double_t tolerance = 1e-4;   // cm
+  const Double_t minCos = 1e-6;
+
+  Double_t norm[3];
+  norm[0] = vec1[1]*vec2[2] - vec1[2]*vec2[1];
+  norm[1] = vec1[2]*vec2[0] - vec1[0]*vec2[2];
+  norm[2] = vec1[0]*vec2[1] - vec1[1]*vec2[0];
+  Double_t mag = TMath::Sqrt(norm[0]*norm[0] + norm[1]*norm[1] + norm[2]*norm[2]);
+  for (Int_t k=0; k<3; k++) { norm[k] /= mag; }
+
+  vector<Double_t> tl(n, 0.);
+  vector<Bool_t> reached(n, kFALSE);
+  vector<Int_t> lanes(n);
+  for (Int_t i=0; i<n; i++) { lanes[i] = i; }
+
+  // compacted tracks to be propagated in one batch
+  vector<Double_t> sub[7];
+  vector<Double_t> subCharge, subStep, subLength;
+
+  for (Int_t it=0; it<=maxIter && !lanes.empty(); it++) {
+    Int_t m = lanes.size();
+    Int_t nLeft = 0;
+    subStep.resize(m);
+    for (Int_t k=0; k<m; k++) {
+      Int_t i = lanes[k];
+      Double_t dist = (vect[0][i]-vec3[0])*norm[0] + (vect[1][i]-vec3[1])*norm[1] + (vect[2][i]-vec3[2])*norm[2];
+      Double_t cosn = vect[3][i]*norm[0] + vect[4][i]*norm[1] + vect[5][i]*norm[2];
+      if (TMath::Abs(dist) < tolerance) {
+        reached[i] = kTRUE;
+      } else if (TMath::Abs(cosn) > minCos && it < maxIter) {
+        subStep[nLeft] = -dist/cosn;
+        lanes[nLeft++] = i;
+      }
+    }
+    lanes.resize(nLeft);
+    if (nLeft == 0) { break; }
+
+    subStep.resize(nLeft);
+    subCharge.resize(nLeft);
+    subLength.resize(nLeft);
+    Double_t* subVect[7];
+    for (Int_t c=0; c<7; c++) {
+      sub[c].resize(nLeft);
+      for (Int_t k=0; k<nLeft; k++) { sub[c][k] = vect[c][lanes[k]]; }
+      subVect[c] = &sub[c][0];
+    }
+    for (Int_t k=0; k<nLeft; k++) { subCharge[k] = charge[lanes[k]]; }
+
+    OneStepRungeKutta(nLeft, &subCharge[0], &subStep[0], subVect, &subLength[0]);
+
+    for (Int_t k=0; k<nLeft; k++) {
+      Int_t i = lanes[k];
+      for (Int_t c=0; c<6; c++) { vect[c][i] = sub[c][k]; }
+      tl[i] += subLength[k];
+    }
+  }
+
+  Int_t nReached = 0;
+  for (Int_t i=0; i<n; i++) {
+    if (reached[i]) { nReached++; }
+    if (length) { length[i] = tl[i]; }
+    if (onPlane) { onPlane[i] = reached[i]; }
+  }
+  return nReached;
+}
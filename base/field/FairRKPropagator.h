@@ -52,6 +52,30 @@ class FairRKPropagator : public TObject
 
     void PropagatToPlane(Double_t Charge, Double_t* vecRKIn, Double_t* vec1, Double_t* vec2, Double_t* vec3, Double_t* vecOut);
 
+    /**Propagate n tracks at once, with the same algorithm as the scalar
+    OneStepRungeKutta. The tracks are given as structure of arrays, vect[k][i]
+    is component k (co-ords,direction cosines,momentum) of track i, and are
+    propagated in place. The field is requested for all tracks of a stage in
+    one call to FairField::GetFieldValues.
+    @n         Number of tracks
+    @charge    Particle charge of each track
+    @step      Step size of each track
+    @vect      Co-ords,direction cosines,momentum, 7 arrays of n values
+    @length    (optional) track length done for each track
+    */
+    void OneStepRungeKutta(Int_t n, const Double_t* charge, const Double_t* step, Double_t* vect[7], Double_t* length = 0);
+
+    /**Propagate n tracks to the same plane, see the batched OneStepRungeKutta
+    @vec1      vector on the plane
+    @vec2      vector on the plane
+    @vec3      point on the plane
+    @length    (optional) track length to the plane for each track
+    @onPlane   (optional) kTRUE for the tracks which reached the plane
+    @return    number of tracks which reached the plane
+    */
+    Int_t PropagatToPlane(Int_t n, const Double_t* charge, Double_t* vect[7], const Double_t* vec1, const Double_t* vec2,
+                          const Double_t* vec3, Double_t* length = 0, Bool_t* onPlane = 0);
+
     virtual ~FairRKPropagator();
     ClassDef(FairRKPropagator, 1);
 
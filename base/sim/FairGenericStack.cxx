@@ -12,6 +12,7 @@
 #include "FairGenericStack.h"
 #include "FairLogger.h"                 // for FairLogger
 #include "TRefArray.h"
+#include "TParticle.h"
 
 // -----   Default constructor   -------------------------------------------
 FairGenericStack::FairGenericStack()
@@ -83,5 +84,20 @@ FairGenericStack* FairGenericStack::CloneStack() const
   return 0;
 }
 
+// -------------------------------------------------------------------------
+// -----   Virtual method  ShiftTrackIndex  --------------------------------
+void FairGenericStack::ShiftTrackIndex(TClonesArray* tracks, Int_t offset) const
+{
+  if (offset == 0 || !tracks->GetClass()->InheritsFrom(TParticle::Class())) { return; }
+
+  for (Int_t i=0; i<tracks->GetEntriesFast(); i++) {
+    TParticle* part = static_cast<TParticle*>(tracks->At(i));
+    for (Int_t j=0; j<2; j++) {
+      if (part->GetMother(j) >= 0) { part->SetMother(j, part->GetMother(j) + offset); }
+      if (part->GetDaughter(j) >= 0) { part->SetDaughter(j, part->GetDaughter(j) + offset); }
+    }
+  }
+}
+
 // -------------------------------------------------------------------------
 ClassImp(FairGenericStack)
@@ -95,6 +95,16 @@ class FairGenericStack : public TVirtualMCStack
 
     virtual TClonesArray* GetListOfParticles() { return 0; }
 
+    /** The output array of the stored tracks, used to merge sub-events
+     ** (see FairPrimaryGenerator::SetSubEvents) **/
+    virtual TClonesArray* GetTrackArray() { return 0; }
+
+    /** Add offset to the track indices (mother, daughters) of the tracks
+     ** in an output array of this stack, used to merge sub-events.
+     ** The default handles arrays of TParticles.
+     **/
+    virtual void ShiftTrackIndex(TClonesArray* tracks, Int_t offset) const;
+
     /** Clone this object (used in MT mode only) */
     virtual FairGenericStack* CloneStack() const;
 
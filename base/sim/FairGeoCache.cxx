@@ -0,0 +1,144 @@
+/********************************************************************************
+ *    Copyright (C) 2014 GSI Helmholtzzentrum fuer Schwerionenforschung GmbH    *
+ *                                                                              *
+ *              This software is distributed under the terms of the             *
+ *         GNU Lesser General Public Licence version 3 (LGPL) version 3,        *
+ *                  copied verbatim in the file "LICENSE"                       *
+ ********************************************************************************/
+// -------------------------------------------------------------------------
+// -----                   FairGeoCache source file                    -----
+// -------------------------------------------------------------------------
+#include "FairGeoCache.h"
+
+#include "FairGeoInterface.h"           // for FairGeoInterface
+#include "FairGeoLoader.h"              // for FairGeoLoader
+#include "FairGeoMedia.h"               // for FairGeoMedia
+#include "FairGeoSet.h"                 // for FairGeoSet
+#include "FairLogger.h"                 // for FairLogger, LOG
+
+#include "RVersion.h"                   // for ROOT_VERSION_CODE
+#include "TDirectory.h"                 // for TDirectory, gDirectory
+#include "TFile.h"                      // for TFile, gFile
+#include "TMD5.h"                       // for TMD5
+#include "TObjArray.h"                  // for TObjArray
+#include "TStopwatch.h"                 // for TStopwatch
+#include "TSystem.h"                    // for TSystem, gSystem
+
+#include <fstream>                      // for ifstream
+
+using namespace std;
+
+namespace {
+  // version of the cache file layout, part of the key
+  const Int_t kCacheVersion = 1;
+
+  void AddString(TMD5& md5, const TString& s)
+  {
+    // with the terminating 0, so that consecutive strings stay separated
+    md5.Update(reinterpret_cast<const UChar_t*>(s.Data()), s.Length() + 1);
+  }
+
+  Bool_t AddFile(TMD5& md5, const char* fileName)
+  {
+    ifstream in(fileName, ios::binary);
+    if (!in) {
+      return kFALSE;
+    }
+    char buffer[65536];
+    while (in) {
+      in.read(buffer, sizeof(buffer));
+      md5.Update(reinterpret_cast<const UChar_t*>(buffer), in.gcount());
+    }
+    return kTRUE;
+  }
+}
+
+TString FairGeoCache::fgDirectory = "";
+
+FairGeoCache::FairGeoCache(const char* moduleName, FairGeoSet* set, Bool_t active)
+  : fFileName()
+{
+  if (fgDirectory.Length() == 0) {
+    return;
+  }
+
+  FairGeoMedia* media = FairGeoLoader::Instance()->getGeoInterface()->getMedia();
+  TMD5 md5;
+  AddString(md5, TString::Format("%d %d %d", kCacheVersion, ROOT_VERSION_CODE, active ? 1 : 0));
+  AddString(md5, set->ClassName());
+  AddString(md5, moduleName);
+  if (!AddFile(md5, set->getGeomFile()) || !AddFile(md5, media->getInputFile())) {
+    LOG(WARNING) << "FairGeoCache: cannot read the input files of " << moduleName
+                 << ", geometry not cached" << FairLogger::endl;
+    return;
+  }
+  md5.Final();
+
+  fFileName = TString::Format("%s/%s_%s.root", fgDirectory.Data(), moduleName, md5.AsString());
+}
+
+FairGeoCache::~FairGeoCache()
+{
+}
+
+TObjArray* FairGeoCache::Read() const
+{
+  if (!IsEnabled() || gSystem->AccessPathName(fFileName)) {
+    return NULL;
+  }
+
+  TStopwatch timer;
+  TFile* oldFile = gFile;
+  TDirectory* oldDir = gDirectory;
+  TObjArray* objects = NULL;
+  TFile* file = TFile::Open(fFileName, "READ");
+  if (file && !file->IsZombie()) {
+    objects = dynamic_cast<TObjArray*>(file->Get("FairGeoCache"));
+  }
+  delete file;
+  gFile = oldFile;
+  oldDir->cd();
+
+  if (!objects) {
+    LOG(WARNING) << "FairGeoCache: cannot read " << fFileName << FairLogger::endl;
+    return NULL;
+  }
+  LOG(INFO) << "FairGeoCache: read " << fFileName << " in "
+            << timer.RealTime() << " s" << FairLogger::endl;
+  return objects;
+}
+
+Bool_t FairGeoCache::Write(TObjArray* objects) const
+{
+  if (!IsEnabled()) {
+    return kFALSE;
+  }
+
+  TStopwatch timer;
+  gSystem->mkdir(fgDirectory, kTRUE);
+  TString tmpName = TString::Format("%s.%d.tmp", fFileName.Data(), gSystem->GetPid());
+  TFile* oldFile = gFile;
+  TDirectory* oldDir = gDirectory;
+  Bool_t ok = kFALSE;
+  TFile* file = TFile::Open(tmpName, "RECREATE");
+  if (file && !file->IsZombie()) {
+    // one key: the references between the objects are kept
+    ok = objects->Write("FairGeoCache", TObject::kSingleKey) > 0;
+    file->Close();
+  }
+  delete file;
+  gFile = oldFile;
+  oldDir->cd();
+
+  if (ok) {
+    ok = gSystem->Rename(tmpName, fFileName) == 0;
+  }
+  if (!ok) {
+    gSystem->Unlink(tmpName);
+    LOG(WARNING) << "FairGeoCache: cannot write " << fFileName << FairLogger::endl;
+    return kFALSE;
+  }
+  LOG(INFO) << "FairGeoCache: wrote " << fFileName << " in "
+            << timer.RealTime() << " s" << FairLogger::endl;
+  return kTRUE;
+}
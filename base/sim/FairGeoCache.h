@@ -0,0 +1,70 @@
+/********************************************************************************
+ *    Copyright (C) 2014 GSI Helmholtzzentrum fuer Schwerionenforschung GmbH    *
+ *                                                                              *
+ *              This software is distributed under the terms of the             *
+ *         GNU Lesser General Public Licence version 3 (LGPL) version 3,        *
+ *                  copied verbatim in the file "LICENSE"                       *
+ ********************************************************************************/
+// -------------------------------------------------------------------------
+// -----                   FairGeoCache header file                    -----
+// -------------------------------------------------------------------------
+#ifndef FAIRGEOCACHE_H
+#define FAIRGEOCACHE_H 1
+
+#include "Rtypes.h"                     // for Bool_t, etc
+#include "TString.h"                    // for TString
+
+class FairGeoSet;
+class TObjArray;
+
+/**
+ * @class FairGeoCache
+ * File cache of the geometries built from ASCII (.geo) files by
+ * FairModule::ConstructASCIIGeometry.
+ *
+ * The key of a geometry set is the MD5 sum of the contents of its .geo file
+ * and of the media file, the class of the set, the name and the active flag
+ * of the module and the ROOT version, so a changed input is never taken from
+ * the cache. The cache file <directory>/<module>_<key>.root holds the
+ * FairGeoNodes of the set together with the TGeoVolumes created for them.
+ *
+ * The cache is off as long as no directory is set (FairRunSim::SetGeometryCache).
+ */
+class FairGeoCache
+{
+
+  public:
+    /**
+     * Computes the key of the set, which has to know its geometry file.
+     * @param moduleName name of the module constructing the set
+     * @param active the sensitive volumes are only registered for active modules
+     */
+    FairGeoCache(const char* moduleName, FairGeoSet* set, Bool_t active);
+    virtual ~FairGeoCache();
+
+    /** Directory of the cache files, created if needed, "" to switch the cache off */
+    static void SetDirectory(const char* dir) { fgDirectory = dir; }
+    static const TString& GetDirectory() { return fgDirectory; }
+
+    Bool_t IsEnabled() const { return fFileName.Length() > 0; }
+    const TString& GetFileName() const { return fFileName; }
+
+    /** @return the stored objects (owned by the caller), NULL if not cached */
+    TObjArray* Read() const;
+
+    /**
+     * Stores the objects with their references to each other in one key.
+     * The file is written under a temporary name and renamed at the end,
+     * so concurrent jobs never read an incomplete cache.
+     */
+    Bool_t Write(TObjArray* objects) const;
+
+  private:
+    static TString fgDirectory;
+    TString fFileName;
+
+    FairGeoCache(const FairGeoCache&);
+    FairGeoCache& operator=(const FairGeoCache&);
+};
+
+#endif
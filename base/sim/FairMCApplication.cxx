@@ -39,6 +39,7 @@
 #include "FairVolume.h"                 // for FairVolume
 
 #include <iosfwd>                       // for ostream
+#include "TClonesArray.h"               // for TClonesArray
 #include "TDatabasePDG.h"               // for TDatabasePDG
 #include "TDirectory.h"                 // for TDirectory, gDirectory
 #include "TGeoManager.h"                // for gGeoManager, TGeoManager
@@ -56,6 +57,7 @@
 #include "TParticlePDG.h"               // for TParticlePDG
 #include "TROOT.h"                      // for TROOT, gROOT
 #include "TRefArray.h"                  // for TRefArray
+#include "TStopwatch.h"                 // for TStopwatch
 #include "TSystem.h"                    // for TSystem, gSystem
 #include "TTree.h"                      // for TTree
 #include "TVirtualMC.h"                 // for TVirtualMC
@@ -67,6 +69,7 @@ class TParticle;
 #include <stdlib.h>                     // for NULL, getenv, exit
 #include <iostream>                     // for operator<<, basic_ostream, etc
 #include <utility>                      // for pair
+#include <vector>                       // for vector
 
 using std::pair;
 
@@ -453,6 +456,15 @@ void FairMCApplication::RunMC(Int_t nofEvents)
   /** Set the list of active detectors to the stack*/
   fStack->SetDetArrayList(fActiveDetectors);
 
+  // In sub-event mode each event is transported as several MC events
+  if (fEvGen && fEvGen->GetNSubEvents() > 1) {
+    if (!fStack->GetTrackArray()) {
+      LOG(FATAL) << "Sub-event mode needs a stack with a track array (GetTrackArray)"
+		 << FairLogger::endl;
+    }
+    nofEvents *= fEvGen->GetNSubEvents();
+  }
+
   // MC run.
   fMC->ProcessRun(nofEvents);
   // finish run
@@ -524,6 +536,14 @@ void FairMCApplication::FinishRun()
         
   }
 
+  // aggregated material budget and dose scores
+  if (fRadLenMan) {
+    fRadLenMan->Finish();
+  }
+  if (fRadMapMan) {
+    fRadMapMan->Finish();
+  }
+
   // Save histograms with memory and runtime information in the output file
   if (FairRunSim::Instance()->IsRunInfoGenerated()) {
     fRunInfo.WriteInfo();
@@ -594,10 +614,10 @@ void FairMCApplication::PreTrack()
     if(fTrajAccepted) {
       // Add trajectory to geo manager
       //    Int_t trackId = fStack->GetCurrentTrackNumber();
-      TGeoTrack* fTrack=fTrajFilter->AddTrack(particle);
+      fTrajFilter->AddTrack(particle);
       // TLorentzVector pos;
       fMC->TrackPosition(fTrkPos);
-      fTrack->AddPoint(fTrkPos.X(), fTrkPos.Y(), fTrkPos.Z(), fTrkPos.T());
+      fTrajFilter->AddPoint(fTrkPos.X(), fTrkPos.Y(), fTrkPos.Z(), fTrkPos.T());
     }
   }
 }
@@ -612,6 +632,7 @@ TVirtualMCApplication* FairMCApplication::CloneForWorker() const
   FairRunSim* workerRun = new FairRunSim(kFALSE);
   workerRun->SetName(fRun->GetName()); // Transport engine
   workerRun->SetOutputFileName(fRun->GetOutputFileName());
+  workerRun->SetMergedOutput(fRun->IsMergedOutput());
 
   // Create new  FairMCApplication object on worker
   FairMCApplication* workerApplication = new FairMCApplication(*this);
@@ -624,7 +645,8 @@ TVirtualMCApplication* FairMCApplication::CloneForWorker() const
 void FairMCApplication::InitOnWorker()
 {
   // Create Root manager
-  fRootManager = new FairRootManagerSimMT();
+  FairRootManagerSimMT* rootManagerMT = new FairRootManagerSimMT();
+  fRootManager = rootManagerMT;
   fRootManager->SetDebug(true);
 
   LOG(INFO) << "FairMCApplication::InitForWorker " 
@@ -633,14 +655,21 @@ void FairMCApplication::InitOnWorker()
   // Set FairRunSim worker(just for consistency, not needed on worker)
   fRun = FairRunSim::Instance();
 
-  // Generate per-thread file name
   TString newFileName = FairRunSim::Instance()->GetOutputFileName();
-  TString tid = "_t";
-  tid += fRootManager->GetId();
-  newFileName.Insert(newFileName.Index(".root"), tid);
+  if ( FairRunSim::Instance()->IsMergedOutput() ) {
+    // One file for all threads, the master keeps its own output file
+    newFileName.Insert(newFileName.Index(".root"), "_mt");
+    FairRunSim::Instance()->SetOutputFile(rootManagerMT->OpenMergedOutFile(newFileName));
+  }
+  else {
+    // Generate per-thread file name
+    TString tid = "_t";
+    tid += fRootManager->GetId();
+    newFileName.Insert(newFileName.Index(".root"), tid);
 
-  // Open per-thread file
-  FairRunSim::Instance()->SetOutputFile(newFileName.Data());
+    // Open per-thread file
+    FairRunSim::Instance()->SetOutputFile(newFileName.Data());
+  }
 
   // Cache thread-local gMC
   fMC = gMC;
@@ -736,7 +765,7 @@ void FairMCApplication::Stepping()
   if(fTrajAccepted) {
     if(fMC->TrackStep() > fTrajFilter->GetStepSizeCut()) {
       fMC->TrackPosition(fTrkPos);
-      fTrajFilter->GetCurrentTrk()->AddPoint(fTrkPos.X(), fTrkPos.Y(), fTrkPos.Z(), fTrkPos.T());
+      fTrajFilter->AddPoint(fTrkPos.X(), fTrkPos.Y(), fTrkPos.Z(), fTrkPos.T());
     }
   }
   if(fRadLenMan) {
@@ -767,7 +796,9 @@ void FairMCApplication::PostTrack()
         (*listIter)->PostTrack();
   }
 
-
+  if(fTrajAccepted) {
+    fTrajFilter->FinishTrack();
+  }
 
 }
 
@@ -828,7 +859,26 @@ void FairMCApplication::FinishEvent()
   }
     
     
-  if (fRootManager) fRootManager->Fill();
+  // In sub-event mode the output of the sub-events is collected, the
+  // event is written by the worker which finishes its last sub-event
+  Bool_t fillEvent = kTRUE;
+  if (fEvGen && fEvGen->GetNSubEvents() > 1) {
+    std::vector<TClonesArray*> arrays;
+    arrays.push_back(fStack->GetTrackArray());
+    for( std::list<FairDetector *>::iterator  listIter = listActiveDetectors.begin();
+         listIter != listActiveDetectors.end();
+         listIter++)
+    {
+      Int_t iColl = 0;
+      TClonesArray* hitArray;
+      while ( (hitArray = (*listIter)->GetCollection(iColl++)) ) {
+        arrays.push_back(hitArray);
+      }
+    }
+    fillEvent = fEvGen->FinishSubEvent(arrays);
+  }
+
+  if (fRootManager && fillEvent) fRootManager->Fill();
   
   for( std::list<FairDetector *>::iterator  listIter = listActiveDetectors.begin();
         listIter != listActiveDetectors.end();
@@ -850,6 +900,9 @@ void FairMCApplication::FinishEvent()
   if(NULL !=fRadMapMan) {
     fRadMapMan->Reset();
   }
+  if(NULL !=fRadGridMan) {
+    fRadGridMan->FinishEvent();
+  }
 
   // Store information about runtime for one event and memory consuption
   // for later usage.
@@ -936,7 +989,9 @@ void FairMCApplication::ConstructGeometry()
 
   TObjArray* tgeovolumelist = gGeoManager->GetListOfVolumes();
 
+  TStopwatch timer;
   while((Mod = dynamic_cast<FairModule*>(fModIter->Next()))) {
+    timer.Start();
     NoOfVolumesBefore=tgeovolumelist->GetEntriesFast();
     Mod->InitParContainers();
     Mod->ConstructGeometry();
@@ -946,6 +1001,9 @@ void FairMCApplication::ConstructGeometry()
       TGeoVolume* v = (TGeoVolume*) tgeovolumelist->At(n);
       fModVolMap.insert(pair<Int_t, Int_t >(v->GetNumber(),ModId));
     }
+    LOG(INFO) << "FairMCApplication: geometry of " << Mod->GetName() << " constructed in "
+              << timer.RealTime() << " s (" << NoOfVolumes-NoOfVolumesBefore << " volumes)"
+              << FairLogger::endl;
   }
   fSenVolumes=FairModule::svList;
   if(fSenVolumes) {
@@ -954,7 +1012,9 @@ void FairMCApplication::ConstructGeometry()
   
   //  LOG(DEBUG) << "FairMCApplication::ConstructGeometry() : Now closing the geometry"<< FairLogger::endl;
   int NoOfVolumesBeforeClose = tgeovolumelist->GetEntries();
+  timer.Start();
   gGeoManager->CloseGeometry();   // close geometry
+  LOG(INFO) << "FairMCApplication: geometry closed in " << timer.RealTime() << " s" << FairLogger::endl;
   int NoOfVolumesAfterClose = tgeovolumelist->GetEntries();
 
   // Check if CloseGeometry has modified the volume list which might happen for
@@ -966,7 +1026,9 @@ void FairMCApplication::ConstructGeometry()
                << "This almost certainly means inconsistent lookup structures used in simulation/stepping.\n";
   }
   
+  timer.Start();
   TVirtualMC::GetMC()->SetRootGeometry();         // notify VMC about Root geometry
+  LOG(INFO) << "FairMCApplication: geometry passed to the MC in " << timer.RealTime() << " s" << FairLogger::endl;
   Int_t Counter=0;
   TDatabasePDG* pdgDatabase = TDatabasePDG::Instance();
   const THashList *list=pdgDatabase->ParticleList();
@@ -1090,6 +1152,10 @@ void FairMCApplication::InitGeometry()
     if (  gMC->IsMT() ) {
       LOG(WARNING) << "Create branch explicitly " << FairLogger::endl;
       TClonesArray* tracks = fStack->GetListOfParticles();
+      // sub-events are merged with the stored tracks the points refer to
+      if ( fEvGen && fEvGen->GetNSubEvents() > 1 ) {
+        tracks = fStack->GetTrackArray();
+      }
       outTree->Bronch("MCTrack", "TClonesArray", &tracks, 3200, 99);
     }
   }
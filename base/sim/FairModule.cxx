@@ -18,6 +18,8 @@
 #include "FairGeoLoader.h"              // for FairGeoLoader
 #include "FairGeoMedia.h"               // for FairGeoMedia
 #include "FairGeoNode.h"                // for FairGeoNode
+#include "FairGeoSet.h"                 // for FairGeoSet
+#include "FairGeoShapes.h"              // for FairGeoShapes
 #include "FairRun.h"                    // for FairRun
 #include "FairRuntimeDb.h"              // for FairRuntimeDb
 #include "FairVolume.h"                 // for FairVolume
@@ -47,6 +49,8 @@
 #include <stdlib.h>                     // for getenv
 #include <string.h>                     // for NULL, strcmp, strlen
 #include <map>
+#include <set>
+#include <vector>
 
 class FairGeoMedium;
 class TGeoMedium;
@@ -517,6 +521,161 @@ void FairModule::ConstructASCIIGeometry()
   LOG(WARNING)<<"The method ConstructASCIIGeometry has to be implemented in the detector class which inherits from FairModule"<<FairLogger::endl;
 }
 
+//__________________________________________________________________________
+Bool_t FairModule::ReadGeometryCache(const FairGeoCache& cache, FairGeoSet* set)
+{
+  /** The cache holds the list of FairGeoNodes of the set, which reference the
+   *  TGeoVolumes built for them, and the matrices of the nodes placed into
+   *  volumes of other sets (NULL for the others), see WriteGeometryCache
+   */
+  TObjArray* objects = cache.Read();
+  if (!objects) { return kFALSE; }
+  TList* nodes = dynamic_cast<TList*>(objects->At(0));
+  TObjArray* placements = dynamic_cast<TObjArray*>(objects->At(1));
+  if (!nodes || !placements) {
+    LOG(WARNING) << "Invalid geometry cache " << cache.GetFileName() << FairLogger::endl;
+    return kFALSE;
+  }
+
+  /** check first that the mothers from the other sets and the shapes exist,
+   *  nothing is changed before */
+  FairGeoShapes* shapes = set->getShapes();
+  TListIter iter(nodes);
+  FairGeoNode* node = NULL;
+  Int_t i = 0;
+  while( (node = static_cast<FairGeoNode*>(iter.Next())) ) {
+    if ( !shapes->selectShape(node->getShape()) ) {
+      LOG(WARNING) << "Shape " << node->getShape() << " of cached geometry "
+                   << cache.GetFileName() << " not found" << FairLogger::endl;
+      return kFALSE;
+    }
+    const TString& motherName = node->getMother();
+    Bool_t placed = i < placements->GetEntriesFast() && placements->At(i);
+    if ( motherName.Length() > 0 && !nodes->FindObject(motherName) ) {
+      FairGeoNode* mother = set->getMasterNode(motherName);
+      if ( !mother || (placed && !mother->getRootVolume()) ) {
+        LOG(WARNING) << "Mother volume " << motherName << " of cached geometry "
+                     << cache.GetFileName() << " not found" << FairLogger::endl;
+        return kFALSE;
+      }
+    }
+    i++;
+  }
+
+  /** the mothers and daughters are linked again as by FairGeoSet::read, and the
+   *  shapes and media of the session are used instead of the stored copies.
+   *  The shapes are not persistent (FairGeoBasicShape has ClassDef version 0),
+   *  their pointers are not written and are selected again by name.
+   */
+  FairGeoMedia* media = FairGeoLoader::Instance()->getGeoInterface()->getMedia();
+  iter.Reset();
+  while( (node = static_cast<FairGeoNode*>(iter.Next())) ) {
+    if ( node->GetListOfDaughters() ) { node->GetListOfDaughters()->Clear(); }
+  }
+  std::set<TGeoVolume*> imported;
+  iter.Reset();
+  i = 0;
+  while( (node = static_cast<FairGeoNode*>(iter.Next())) ) {
+    node->setShapePointer(shapes->selectShape(node->getShape()));
+    if ( node->getMedium() ) {
+      FairGeoMedium* medium = media->getMedium(node->getMedium()->GetName());
+      if (medium) { node->setMedium(medium); }
+    }
+
+    const TString& motherName = node->getMother();
+    FairGeoNode* mother = NULL;
+    if ( motherName.Length() > 0 ) {
+      mother = set->getVolume(motherName);
+      if (!mother) {
+        mother = set->getMasterNode(motherName);
+        if ( node->isModule() && node->isActive() ) { mother->setActive(); }
+      }
+      node->setMother(mother);
+    }
+
+    /** register the volumes in the order in which they were built */
+    TGeoVolume* v = node->getRootVolume();
+    if ( v && imported.insert(v).second ) {
+      AssignMediumAtImport(v);
+      gGeoManager->AddVolume(v);
+    }
+    TGeoMatrix* matrix = NULL;
+    if ( i < placements->GetEntriesFast() ) { matrix = static_cast<TGeoMatrix*>(placements->At(i)); }
+    if ( v && matrix ) {
+      mother->getRootVolume()->AddNode(v, node->getCopyNo(), matrix);
+    }
+
+    set->getListOfVolumes()->Add(node);
+    i++;
+  }
+
+  /** the nodes and matrices are in use now, only the containers are deleted */
+  nodes->SetOwner(kFALSE);
+  placements->SetOwner(kFALSE);
+  objects->SetOwner(kFALSE);
+  delete nodes;
+  delete placements;
+  delete objects;
+  return kTRUE;
+}
+
+//__________________________________________________________________________
+void FairModule::WriteGeometryCache(const FairGeoCache& cache, FairGeoSet* set)
+{
+  if (!cache.IsEnabled()) { return; }
+
+  TList* nodes = set->getListOfVolumes();
+  TObjArray placements(nodes->GetSize());
+  TListIter iter(nodes);
+  FairGeoNode* node = NULL;
+  Int_t i = 0;
+  while( (node = static_cast<FairGeoNode*>(iter.Next())) ) {
+    /** top and reference nodes also change the master nodes, not cached */
+    if ( node->isTopNode() || node->isRefNode() ) {
+      LOG(INFO) << GetName() << ": geometry with top or reference nodes is not cached"
+                << FairLogger::endl;
+      return;
+    }
+    FairGeoNode* mother = node->getMotherNode();
+    TGeoVolume* v = node->getRootVolume();
+    if ( v && mother && set->getVolume(mother->GetName()) != mother ) {
+      /** node placed into the volume of another set, find its matrix */
+      TGeoVolume* mo = mother->getRootVolume();
+      TGeoNode* placed = NULL;
+      for (Int_t k = mo ? mo->GetNdaughters() - 1 : -1; k >= 0 && !placed; k--) {
+        TGeoNode* n = mo->GetNode(k);
+        if ( n->GetVolume() == v && n->GetNumber() == node->getCopyNo() ) { placed = n; }
+      }
+      if (!placed) {
+        LOG(WARNING) << GetName() << ": placement of " << node->GetName()
+                     << " not found, geometry not cached" << FairLogger::endl;
+        return;
+      }
+      placements.AddAtAndExpand(placed->GetMatrix(), i);
+    }
+    i++;
+  }
+
+  /** the shapes are not persistent, their pointers are restored after writing */
+  std::vector<FairGeoBasicShape*> nodeShapes;
+  iter.Reset();
+  while( (node = static_cast<FairGeoNode*>(iter.Next())) ) {
+    nodeShapes.push_back(node->getShapePointer());
+    node->setShapePointer(NULL);
+  }
+
+  TObjArray objects(2);
+  objects.Add(nodes);
+  objects.Add(&placements);
+  cache.Write(&objects);
+
+  iter.Reset();
+  i = 0;
+  while( (node = static_cast<FairGeoNode*>(iter.Next())) ) {
+    node->setShapePointer(nodeShapes[i++]);
+  }
+}
+
 //__________________________________________________________________________
 Bool_t FairModule::CheckIfSensitive(std::string)
 {
@@ -10,6 +10,7 @@
 
 #include "TNamed.h"                     // for TNamed
 
+#include "FairGeoCache.h"               // for FairGeoCache
 #include "FairGeoInterface.h"           // for FairGeoInterface
 #include "FairGeoLoader.h"              // for FairGeoLoader
 #include "FairGeoNode.h"                // for FairGeoNode
@@ -21,11 +22,13 @@
 #include "Rtypes.h"                     // for Bool_t, Int_t, etc
 #include "TList.h"                      // for TList (ptr only), TListIter
 #include "TObjArray.h"                  // for TObjArray
+#include "TStopwatch.h"                 // for TStopwatch
 #include "TString.h"                    // for TString, operator!=
 
 #include <stddef.h>                     // for NULL
 #include <string>                       // for string
 
+class FairGeoSet;
 class FairVolumeList;
 class FairVolume;
 class TArrayI;
@@ -135,6 +138,11 @@ class FairModule:  public TNamed
 
     /**called from ConstructGDMLGeometry. Changes default ID created by TGDMLParse*/
     void ReAssignMediaId();
+    /**called from ConstructASCIIGeometry. Takes the nodes and volumes of the set from the
+     * geometry cache instead of reading and building them, kFALSE if they are not cached*/
+    Bool_t ReadGeometryCache(const FairGeoCache& cache, FairGeoSet* set);
+    /**called from ConstructASCIIGeometry. Stores the nodes and volumes built for the set*/
+    void WriteGeometryCache(const FairGeoCache& cache, FairGeoSet* set);
     void swap(FairModule& other) throw();
 
   protected:
@@ -161,8 +169,17 @@ void FairModule::ConstructASCIIGeometry(T dataType1, TString containerName, U)
   MGeo->print();
   MGeo->setGeomFile(GetGeometryFileName());
   GeoInterface->addGeoModule(MGeo);
-  Bool_t rc = GeoInterface->readSet(MGeo);
-  if ( rc ) { MGeo->create(loader->getGeoBuilder()); }
+  FairGeoCache cache(GetName(), MGeo, fActive);
+  if ( !ReadGeometryCache(cache, MGeo) ) {
+    TStopwatch timer;
+    Bool_t rc = GeoInterface->readSet(MGeo);
+    Double_t readTime = timer.RealTime();
+    timer.Start();
+    if ( rc ) { rc = MGeo->create(loader->getGeoBuilder()); }
+    LOG(INFO) << GetName() << ": geometry read in " << readTime << " s, built in "
+              << timer.RealTime() << " s" << FairLogger::endl;
+    if ( rc ) { WriteGeometryCache(cache, MGeo); }
+  }
 
   TList* volList = MGeo->getListOfVolumes();
   // store geo parameter
@@ -12,6 +12,8 @@
 #include "FairGenericStack.h"  // for FairGenericStack
 #include "FairLogger.h"        // for FairLogger, MESSAGE_ORIGIN
 #include "FairMCEventHeader.h" // for FairMCEventHeader
+#include "FairPrimaryQueue.h"  // for FairPrimaryQueue
+#include "FairSubEventQueue.h" // for FairSubEventQueue
 
 #include "TDatabasePDG.h" // for TDatabasePDG
 #include "TF1.h"          // for TF1
@@ -43,7 +45,9 @@ FairPrimaryGenerator::FairPrimaryGenerator()
       fSmearGausVertexXY(kFALSE), fBeamAngle(kFALSE), fEventPlane(kFALSE),
       fStack(NULL), fGenList(new TObjArray()),
       fListIter(fGenList->MakeIterator()), fEvent(NULL), fdoTracking(kTRUE),
-      fMCIndexOffset(0), fEventNr(0) {
+      fMCIndexOffset(0), fEventNr(0), fSubEventQueue(NULL),
+      fOwnsSubEventQueue(kFALSE), fSubEvent(0), fPrimaryQueue(NULL),
+      fOwnsPrimaryQueue(kFALSE), fRandom(NULL) {
   fTargetZ[0] = 0.;
 }
 // -------------------------------------------------------------------------
@@ -60,7 +64,9 @@ FairPrimaryGenerator::FairPrimaryGenerator(const char *name, const char *title)
       fSmearGausVertexXY(kFALSE), fBeamAngle(kFALSE), fEventPlane(kFALSE),
       fStack(NULL), fGenList(new TObjArray()),
       fListIter(fGenList->MakeIterator()), fEvent(NULL), fdoTracking(kTRUE),
-      fMCIndexOffset(0), fEventNr(0) {
+      fMCIndexOffset(0), fEventNr(0), fSubEventQueue(NULL),
+      fOwnsSubEventQueue(kFALSE), fSubEvent(0), fPrimaryQueue(NULL),
+      fOwnsPrimaryQueue(kFALSE), fRandom(NULL) {
   fTargetZ[0] = 0.;
 }
 
@@ -73,15 +79,19 @@ FairPrimaryGenerator::FairPrimaryGenerator(const FairPrimaryGenerator &rhs)
       fBeamAngleSigmaX(rhs.fBeamAngleSigmaX), fBeamAngleSigmaY(rhs.fBeamAngleSigmaY),
       fBeamDirection(rhs.fBeamDirection),
       fPhiMin(rhs.fPhiMin), fPhiMax(rhs.fPhiMax), fPhi(rhs.fPhi),
-      fTargetZ(new Double_t[1]), fNrTargets(rhs.fNrTargets),
+      fTargetZ(new Double_t[rhs.fNrTargets]), fNrTargets(rhs.fNrTargets),
       fTargetDz(rhs.fTargetDz), fVertex(rhs.fVertex), fNTracks(rhs.fNTracks),
       fSmearVertexZ(rhs.fSmearVertexZ), fSmearGausVertexZ(rhs.fSmearGausVertexZ),
       fSmearVertexXY(rhs.fSmearVertexXY), fSmearGausVertexXY(rhs.fSmearGausVertexXY),
       fBeamAngle(rhs.fBeamAngle), fEventPlane(rhs.fEventPlane),
       fStack(NULL), fGenList(new TObjArray()),
       fListIter(fGenList->MakeIterator()), fEvent(NULL), fdoTracking(rhs.fdoTracking),
-      fMCIndexOffset(rhs.fMCIndexOffset), fEventNr(rhs.fEventNr) {
-  fTargetZ[0] = rhs.fTargetZ[0];
+      fMCIndexOffset(rhs.fMCIndexOffset), fEventNr(rhs.fEventNr),
+      fSubEventQueue(NULL), fOwnsSubEventQueue(kFALSE), fSubEvent(0),
+      fPrimaryQueue(NULL), fOwnsPrimaryQueue(kFALSE), fRandom(NULL) {
+  for (Int_t i = 0; i < fNrTargets; i++) {
+    fTargetZ[i] = rhs.fTargetZ[i];
+  }
 }
 
 // -------------------------------------------------------------------------
@@ -99,10 +109,17 @@ Bool_t FairPrimaryGenerator::Init() {
 // -----   Destructor   ----------------------------------------------------
 FairPrimaryGenerator::~FairPrimaryGenerator() {
 
+  // stop the threads before their generators are deleted
+  if (fOwnsPrimaryQueue) {
+    delete fPrimaryQueue;
+  }
   delete[] fTargetZ;
   fGenList->Delete();
   delete fGenList;
   delete fListIter;
+  if (fOwnsSubEventQueue) {
+    delete fSubEventQueue;
+  }
 
 }
 // -------------------------------------------------------------------------
@@ -131,7 +148,8 @@ FairPrimaryGenerator& FairPrimaryGenerator::operator=(const FairPrimaryGenerator
     fPhiMin = rhs.fPhiMin;
     fPhiMax = rhs.fPhiMax;
     fPhi = rhs.fPhi;
-    fTargetZ = new Double_t[1];
+    delete[] fTargetZ;
+    fTargetZ = new Double_t[rhs.fNrTargets];
     fNrTargets = rhs.fNrTargets;
     fTargetDz = rhs.fTargetDz;
     fVertex = rhs.fVertex;
@@ -149,7 +167,15 @@ FairPrimaryGenerator& FairPrimaryGenerator::operator=(const FairPrimaryGenerator
     fdoTracking = rhs.fdoTracking;
     fMCIndexOffset = rhs.fMCIndexOffset;
     fEventNr = rhs.fEventNr;
-    fTargetZ[0] = rhs.fTargetZ[0];
+    fSubEventQueue = NULL;
+    fOwnsSubEventQueue = kFALSE;
+    fSubEvent = 0;
+    fPrimaryQueue = NULL;
+    fOwnsPrimaryQueue = kFALSE;
+    fRandom = NULL;
+    for (Int_t i = 0; i < fNrTargets; i++) {
+      fTargetZ[i] = rhs.fTargetZ[i];
+    }
   }
   
   return *this;
@@ -158,73 +184,112 @@ FairPrimaryGenerator& FairPrimaryGenerator::operator=(const FairPrimaryGenerator
 
 // -----   Public method GenerateEvent   -----------------------------------
 Bool_t FairPrimaryGenerator::GenerateEvent(FairGenericStack *pStack) {
+  if (!fSubEventQueue) {
+    return GenerateFullEvent(pStack);
+  }
+
+  // Sub-event mode: take the next part of an event generated by the queue
+  if (!fEvent) {
+    LOG(FATAL) << "No MCEventHeader branch!" << FairLogger::endl;
+    return kFALSE;
+  }
+  fEvent->Reset();
+  if (!fSubEventQueue->NextSubEvent(pStack, fEvent, fSubEvent)) {
+    return kFALSE;
+  }
+  fStack = pStack;
+  fNTracks = pStack->GetNprimary();
+  LOG(DEBUG) << "(Event " << fEvent->GetEventID() << ") sub-event " << fSubEvent
+             << " with " << fNTracks << " primary tracks" << FairLogger::endl;
+  return kTRUE;
+}
+// -------------------------------------------------------------------------
+
+// -----   Public method GenerateFullEvent   -------------------------------
+Bool_t FairPrimaryGenerator::GenerateFullEvent(FairGenericStack *pStack) {
   // Check for MCEventHeader
   if (!fEvent) {
     LOG(FATAL) << "No MCEventHeader branch!" << FairLogger::endl;
     return kFALSE;
-  } else {
+  }
 
-    // Initialise
+  if (fPrimaryQueue) {
+    // Take the event generated in advance
     fStack = pStack;
-    fNTracks = 0;
     fEvent->Reset();
-
-    // Create event vertex
-    MakeVertex();
-    fEvent->SetVertex(fVertex);
-
-    // Create beam angle
-    // Here we only randomly generate two angles (anglex, angley)
-    // for the event and later on (in AddTrack())
-    // all our particles will be rotated accordingly.
-    if (fBeamAngle) {
-      MakeBeamAngle();
+    if (!fPrimaryQueue->NextEvent(pStack, fEvent)) {
+      return kFALSE;
     }
+    fNTracks = fEvent->GetNPrim();
+  } else if (!GeneratePrimaries(pStack)) {
+    return kFALSE;
+  }
 
-    // Create event plane
-    // Randomly generate an angle by which each track added (in AddTrack())
-    // to the event is rotated around the z-axis
-    if (fEventPlane) {
-      MakeEventPlane();
-    }
+  fTotPrim += fNTracks;
+  return kTRUE;
+}
+// -------------------------------------------------------------------------
 
-    // Call the ReadEvent methods from all registered generators
-    fListIter->Reset();
-    TObject *obj = 0;
-    FairGenerator *gen = 0;
-    while ((obj = fListIter->Next())) {
-      gen = dynamic_cast<FairGenerator *>(obj);
-      if (!gen) {
-        return kFALSE;
-      }
-      const char *genName = gen->GetName();
-      fMCIndexOffset = fNTracks; // number tracks before generator is called
-      Bool_t test = gen->ReadEvent(this);
-      if (!test) {
-        LOG(ERROR) << "ReadEvent failed for generator " << genName
-                   << FairLogger::endl;
-        return kFALSE;
-      }
-    }
+// -----   Private method GeneratePrimaries   ------------------------------
+Bool_t FairPrimaryGenerator::GeneratePrimaries(FairGenericStack *pStack) {
+  // Initialise
+  fStack = pStack;
+  fNTracks = 0;
+  fEvent->Reset();
+
+  // Create event vertex
+  MakeVertex();
+  fEvent->SetVertex(fVertex);
+
+  // Create beam angle
+  // Here we only randomly generate two angles (anglex, angley)
+  // for the event and later on (in AddTrack())
+  // all our particles will be rotated accordingly.
+  if (fBeamAngle) {
+    MakeBeamAngle();
+  }
 
-  
-    fTotPrim += fNTracks;
-    // Screen output
+  // Create event plane
+  // Randomly generate an angle by which each track added (in AddTrack())
+  // to the event is rotated around the z-axis
+  if (fEventPlane) {
+    MakeEventPlane();
+  }
 
-    // Set the event number if not set already by one of the dedicated generators
-    if (-1 == fEvent->GetEventID()) {
-      fEventNr++;
-      fEvent->SetEventID(fEventNr);
+  // Call the ReadEvent methods from all registered generators
+  fListIter->Reset();
+  TObject *obj = 0;
+  FairGenerator *gen = 0;
+  while ((obj = fListIter->Next())) {
+    gen = dynamic_cast<FairGenerator *>(obj);
+    if (!gen) {
+      return kFALSE;
+    }
+    const char *genName = gen->GetName();
+    fMCIndexOffset = fNTracks; // number tracks before generator is called
+    Bool_t test = gen->ReadEvent(this);
+    if (!test) {
+      LOG(ERROR) << "ReadEvent failed for generator " << genName
+                 << FairLogger::endl;
+      return kFALSE;
     }
-    LOG(DEBUG) << "(Event " << fEvent->GetEventID() << ") " << fNTracks
-               << " primary tracks from vertex (" << fVertex.X() << ", "
-               << fVertex.Y() << ", " << fVertex.Z() << ") with beam angle ("
-               << fBeamAngleX << ", " << fBeamAngleY << ") " << FairLogger::endl;
+  }
 
-    fEvent->SetNPrim(fNTracks);
+  // Screen output
 
-    return kTRUE;
+  // Set the event number if not set already by one of the dedicated generators
+  if (-1 == fEvent->GetEventID()) {
+    fEventNr++;
+    fEvent->SetEventID(fEventNr);
   }
+  LOG(DEBUG) << "(Event " << fEvent->GetEventID() << ") " << fNTracks
+             << " primary tracks from vertex (" << fVertex.X() << ", "
+             << fVertex.Y() << ", " << fVertex.Z() << ") with beam angle ("
+             << fBeamAngleX << ", " << fBeamAngleY << ") " << FairLogger::endl;
+
+  fEvent->SetNPrim(fNTracks);
+
+  return kTRUE;
 }
 // -------------------------------------------------------------------------
 
@@ -261,7 +326,7 @@ void FairPrimaryGenerator::AddTrack(Int_t pdgid, Double_t px_raw,
 
   // ---> Convert K0 and AntiK0 into K0s and K0L
   if (pdgid == 311 || pdgid == -311) {
-    Double_t test = gRandom->Uniform(0., 1.);
+    Double_t test = GetRandom()->Uniform(0., 1.);
     if (test >= 0.5) {
       pdgid = 310;
     } // K0S
@@ -326,6 +391,11 @@ FairPrimaryGenerator* FairPrimaryGenerator::ClonePrimaryGenerator() const
 {
   FairPrimaryGenerator* newPrimaryGenerator = new FairPrimaryGenerator(*this);
 
+  /** The sub-events of all workers come from the queue of the master*/
+  newPrimaryGenerator->fSubEventQueue = fSubEventQueue;
+  /** And so do the events generated in advance*/
+  newPrimaryGenerator->fPrimaryQueue = fPrimaryQueue;
+
   /** Clone generators in the list*/
   for (Int_t i = 0; i < fGenList->GetEntries(); i++) {
     FairGenerator *gen = static_cast<FairGenerator*>(fGenList->At(i));
@@ -337,6 +407,64 @@ FairPrimaryGenerator* FairPrimaryGenerator::ClonePrimaryGenerator() const
   return newPrimaryGenerator;
 }
 
+// -----   Public method SetSubEvents   ------------------------------------
+void FairPrimaryGenerator::SetSubEvents(Int_t nSubEvents) {
+  if (fOwnsSubEventQueue) {
+    delete fSubEventQueue;
+  }
+  fSubEventQueue = NULL;
+  fOwnsSubEventQueue = kFALSE;
+  if (nSubEvents > 1) {
+    fSubEventQueue = new FairSubEventQueue(this, nSubEvents);
+    fOwnsSubEventQueue = kTRUE;
+  }
+}
+// -------------------------------------------------------------------------
+
+// -----   Public method GetNSubEvents   -----------------------------------
+Int_t FairPrimaryGenerator::GetNSubEvents() const {
+  return fSubEventQueue ? fSubEventQueue->GetNSubEvents() : 1;
+}
+// -------------------------------------------------------------------------
+
+// -----   Public method FinishSubEvent   ----------------------------------
+Bool_t FairPrimaryGenerator::FinishSubEvent(std::vector<TClonesArray*> &arrays) {
+  if (!fSubEventQueue) {
+    return kTRUE;
+  }
+  return fSubEventQueue->AddOutput(fEvent->GetEventID(), fSubEvent, fStack, arrays);
+}
+// -------------------------------------------------------------------------
+
+// -----   Public method SetAsyncGeneration   ------------------------------
+void FairPrimaryGenerator::SetAsyncGeneration(Int_t nThreads, Int_t depth, UInt_t seed) {
+  if (fOwnsPrimaryQueue) {
+    delete fPrimaryQueue;
+  }
+  fPrimaryQueue = NULL;
+  fOwnsPrimaryQueue = kFALSE;
+  if (nThreads > 0) {
+    if (depth < 1) {
+      depth = 4 * nThreads;
+    }
+    fPrimaryQueue = new FairPrimaryQueue(this, nThreads, depth, seed);
+    fOwnsPrimaryQueue = kTRUE;
+  }
+}
+// -------------------------------------------------------------------------
+
+// -----   Public method GetNAsyncThreads   --------------------------------
+Int_t FairPrimaryGenerator::GetNAsyncThreads() const {
+  return fPrimaryQueue ? fPrimaryQueue->GetNThreads() : 0;
+}
+// -------------------------------------------------------------------------
+
+// -----   Public method GetRandom   ---------------------------------------
+TRandom* FairPrimaryGenerator::GetRandom() const {
+  return fRandom ? fRandom : gRandom;
+}
+// -------------------------------------------------------------------------
+
 // -----   Public method SetBeam   -----------------------------------------
 void FairPrimaryGenerator::SetBeam(Double_t x0, Double_t y0, Double_t sigmaX,
                                    Double_t sigmaY) {
@@ -400,32 +528,32 @@ void FairPrimaryGenerator::MakeVertex() {
   if (1 == fNrTargets) {
     vz = fTargetZ[0];
   } else {
-    Int_t Target = static_cast<Int_t>(gRandom->Uniform(fNrTargets));
+    Int_t Target = static_cast<Int_t>(GetRandom()->Uniform(fNrTargets));
     vz = fTargetZ[Target];
   }
 
   if (fSmearVertexZ)
-    vz = gRandom->Uniform(vz - fTargetDz / 2., vz + fTargetDz / 2.);
+    vz = GetRandom()->Uniform(vz - fTargetDz / 2., vz + fTargetDz / 2.);
 
   if (fSmearGausVertexZ) {
-    vz = gRandom->Gaus(vz, fTargetDz);
+    vz = GetRandom()->Gaus(vz, fTargetDz);
   }
 
   if (fSmearGausVertexXY) {
     if (fBeamSigmaX != 0.) {
-      vx = gRandom->Gaus(fBeamX0, fBeamSigmaX);
+      vx = GetRandom()->Gaus(fBeamX0, fBeamSigmaX);
     }
     if (fBeamSigmaY != 0.) {
-      vy = gRandom->Gaus(fBeamY0, fBeamSigmaY);
+      vy = GetRandom()->Gaus(fBeamY0, fBeamSigmaY);
     }
   }
 
   if (fSmearVertexXY) {
     if (fBeamSigmaX != 0.) {
-      vx = gRandom->Uniform(vx - fBeamSigmaX / 2., vx + fBeamSigmaX / 2.);
+      vx = GetRandom()->Uniform(vx - fBeamSigmaX / 2., vx + fBeamSigmaX / 2.);
     }
     if (fBeamSigmaY != 0.) {
-      vy = gRandom->Uniform(vy - fBeamSigmaY / 2., vy + fBeamSigmaY / 2.);
+      vy = GetRandom()->Uniform(vy - fBeamSigmaY / 2., vy + fBeamSigmaY / 2.);
     }
   }
 
@@ -435,8 +563,8 @@ void FairPrimaryGenerator::MakeVertex() {
 
 // -----   Private method MakeBeamAngle   -------------------------------
 void FairPrimaryGenerator::MakeBeamAngle() {
-  fBeamAngleX = gRandom->Gaus(fBeamAngleX0, fBeamAngleSigmaX);
-  fBeamAngleY = gRandom->Gaus(fBeamAngleY0, fBeamAngleSigmaY);
+  fBeamAngleX = GetRandom()->Gaus(fBeamAngleX0, fBeamAngleSigmaX);
+  fBeamAngleY = GetRandom()->Gaus(fBeamAngleY0, fBeamAngleSigmaY);
   fBeamDirection.SetXYZ(TMath::Tan(fBeamAngleX), TMath::Tan(fBeamAngleY), 1.);
   fEvent->SetRotX(fBeamAngleX);
   fEvent->SetRotY(fBeamAngleY);
@@ -445,7 +573,7 @@ void FairPrimaryGenerator::MakeBeamAngle() {
 
 // -----   Private method MakeEventPlane   -------------------------------
 void FairPrimaryGenerator::MakeEventPlane() {
-  fPhi = gRandom->Uniform(fPhiMin, fPhiMax);
+  fPhi = GetRandom()->Uniform(fPhiMin, fPhiMax);
   fEvent->SetRotZ(fPhi);
 }
 // -------------------------------------------------------------------------
@@ -34,11 +34,16 @@ the tracking from the macro (M. Al-Turany)
 #include "TMCProcess.h"
 
 #include <iostream> // for operator<<, basic_ostream, etc
+#include <vector>   // for vector
 
 class FairGenericStack;
 class FairMCEventHeader;
+class FairPrimaryQueue;
+class FairSubEventQueue;
+class TClonesArray;
 class TF1;
 class TIterator;
+class TRandom;
 
 class FairPrimaryGenerator : public TNamed {
 
@@ -73,6 +78,54 @@ public:
       **/
   virtual Bool_t GenerateEvent(FairGenericStack *pStack);
 
+  /** Generates a full event from the registered generators, also in
+      sub-event mode (called by the FairSubEventQueue).
+      *@param pStack The particle stack
+      *@return kTRUE if successful, kFALSE if not
+      **/
+  Bool_t GenerateFullEvent(FairGenericStack *pStack);
+
+  /** Switch on the sub-event mode: the primaries of each event are split
+      into nSubEvents parts, which are transported as separate MC events
+      (in MT mode by different workers), and the output is merged back
+      into one event. To be called before the run is initialised.
+      *@param nSubEvents number of sub-events per event, 1 for off
+      **/
+  void SetSubEvents(Int_t nSubEvents);
+
+  /** Number of sub-events per event, 1 if the sub-event mode is off **/
+  Int_t GetNSubEvents() const;
+
+  /** Hands over the output of the current sub-event, the objects are moved
+      out of the arrays (see FairSubEventQueue::AddOutput).
+      *@param arrays track array of the stack followed by the point collections
+      *@return kTRUE if the arrays contain the merged event and have to be written
+      **/
+  Bool_t FinishSubEvent(std::vector<TClonesArray*> &arrays);
+
+  /** Generate the primaries of the following events in background threads
+      (see FairPrimaryQueue), while the current event is transported. With
+      more than one thread the registered generators are cloned and have to
+      produce independent events. To be called before the run is initialised.
+      *@param nThreads number of generating threads, 0 for off
+      *@param depth maximum number of events generated in advance, default 4*nThreads
+      *@param seed base seed of the random generators of the events, 0: from gRandom
+      **/
+  void SetAsyncGeneration(Int_t nThreads, Int_t depth = 0, UInt_t seed = 0);
+
+  /** Number of threads generating events in advance, 0 if off **/
+  Int_t GetNAsyncThreads() const;
+
+  /** Random generator for the current event. It is gRandom, unless the
+      events are generated in advance: then each event has its own random
+      generator, and generators have to use this one instead of gRandom to
+      get reproducible events.
+      **/
+  TRandom* GetRandom() const;
+
+  /** Use the random generator for the following events, NULL for gRandom **/
+  void SetRandom(TRandom* random) { fRandom = random; }
+
   /** Public method AddTrack
       Adding a track to the MC stack. To be called within the ReadEvent
       methods of the registered generators.
@@ -153,6 +206,11 @@ public:
 
   Int_t GetTotPrimary() { return fTotPrim; }
 
+  /** Number of the last event which got its number from the primary
+      generator (see GenerateFullEvent) **/
+  Int_t GetEventNr() const { return fEventNr; }
+  void SetEventNr(Int_t eventNr) { fEventNr = eventNr; }
+
 protected:
   /**  Copy constructor */
   FairPrimaryGenerator(const FairPrimaryGenerator&);
@@ -235,6 +293,18 @@ protected:
       the specific generators
    **/
   Int_t fEventNr;
+  /** Sub-event mode: queue shared by the master and all worker clones */
+  FairSubEventQueue *fSubEventQueue; //!
+  /** The queue is deleted with the generator which created it */
+  Bool_t fOwnsSubEventQueue; //!
+  /** Index of the current sub-event within its event */
+  Int_t fSubEvent; //!
+  /** Events generated in advance: queue shared by the master and all worker clones */
+  FairPrimaryQueue *fPrimaryQueue; //!
+  /** The queue is deleted with the generator which created it */
+  Bool_t fOwnsPrimaryQueue; //!
+  /** Random generator of the current event, NULL for gRandom */
+  TRandom *fRandom; //!
 
   /** Private method MakeVertex. If vertex smearing in xy is switched on,
       the event vertex is smeared Gaussianlike in x and y direction
@@ -265,7 +335,16 @@ protected:
   **/
   void MakeEventPlane();
 
-  ClassDef(FairPrimaryGenerator, 5);
+  /** Private method GeneratePrimaries. Calls the registered generators
+      for the next event, without the bookkeeping of the total number of
+      primaries. Called by GenerateFullEvent and by the FairPrimaryQueue
+      threads.
+  **/
+  Bool_t GeneratePrimaries(FairGenericStack *pStack);
+
+  friend class FairPrimaryQueueWorkers;
+
+  ClassDef(FairPrimaryGenerator, 6);
 };
 
 #endif
@@ -0,0 +1,274 @@
+/********************************************************************************
+ *    Copyright (C) 2014 GSI Helmholtzzentrum fuer Schwerionenforschung GmbH    *
+ *                                                                              *
+ *              This software is distributed under the terms of the             *
+ *         GNU Lesser General Public Licence version 3 (LGPL) version 3,        *
+ *                  copied verbatim in the file "LICENSE"                       *
+ ********************************************************************************/
+// -------------------------------------------------------------------------
+// -----                  FairPrimaryQueue source file                 -----
+// -------------------------------------------------------------------------
+#include "FairPrimaryQueue.h"
+
+#include "FairGenerator.h"              // for FairGenerator
+#include "FairLogger.h"                 // for FairLogger, LOG
+#include "FairMCEventHeader.h"          // for FairMCEventHeader
+#include "FairPrimaryGenerator.h"       // for FairPrimaryGenerator
+#include "FairPrimaryRecorder.h"        // for FairPrimaryRecorder
+
+#include "RVersion.h"                   // for ROOT_VERSION_CODE, etc
+#include "TDatabasePDG.h"               // for TDatabasePDG
+#include "TMath.h"                      // for Min
+#include "TObjArray.h"                  // for TObjArray
+#include "TROOT.h"                      // for EnableThreadSafety
+#include "TRandom.h"                    // for gRandom
+#include "TRandom3.h"                   // for TRandom3
+
+#include <condition_variable>           // for condition_variable
+#include <limits>                       // for numeric_limits
+#include <mutex>                        // for mutex, unique_lock
+#include <thread>                       // for thread
+#include <vector>                       // for vector
+
+using namespace std;
+
+namespace {
+  // protects the creation of the threads by the first NextEvent call
+  mutex gStartMutex;
+}
+
+/** Threads and event slots of a FairPrimaryQueue */
+class FairPrimaryQueueWorkers
+{
+  public:
+    FairPrimaryQueueWorkers(FairPrimaryGenerator* generator, const FairMCEventHeader* header,
+                            Int_t nThreads, Int_t depth, UInt_t seed);
+    ~FairPrimaryQueueWorkers();
+
+    Bool_t Next(FairGenericStack* stack, FairMCEventHeader* header);
+
+  private:
+    enum { kEmpty, kReady, kFailed };
+
+    struct Slot {
+      Int_t fState;
+      ULong64_t fIndex;
+      FairMCEventHeader* fHeader;
+      vector<FairPrimaryRecorder::Primary> fPrimaries;
+    };
+
+    void Run(Int_t thread);
+
+    vector<FairPrimaryGenerator*> fGenerators;
+    vector<FairMCEventHeader*> fHeaders;
+    Bool_t fSharedGenerators;
+    Int_t fFirstEventNr;
+    UInt_t fSeed;
+
+    mutex fMutex;
+    condition_variable fSlotFree;
+    condition_variable fSlotReady;
+    vector<Slot> fSlots;
+    ULong64_t fNextGenerated;   // index of the next event to be generated
+    ULong64_t fNextConsumed;    // index of the next event to be handed out
+    ULong64_t fEnd;             // index of the first failed event
+    Bool_t fStop;
+    vector<thread> fThreads;
+
+    FairPrimaryQueueWorkers(const FairPrimaryQueueWorkers&);
+    FairPrimaryQueueWorkers& operator=(const FairPrimaryQueueWorkers&);
+};
+
+FairPrimaryQueueWorkers::FairPrimaryQueueWorkers(FairPrimaryGenerator* generator,
+                                                 const FairMCEventHeader* header, Int_t nThreads,
+                                                 Int_t depth, UInt_t seed)
+  : fGenerators(),
+    fHeaders(),
+    fSharedGenerators(nThreads == 1),
+    fFirstEventNr(generator->GetEventNr()),
+    fSeed(seed),
+    fMutex(),
+    fSlotFree(),
+    fSlotReady(),
+    fSlots(depth),
+    fNextGenerated(0),
+    fNextConsumed(0),
+    fEnd(numeric_limits<ULong64_t>::max()),
+    fStop(kFALSE),
+    fThreads()
+{
+#if ( ROOT_VERSION_CODE >= ROOT_VERSION(6,6,0) )
+  ROOT::EnableThreadSafety();
+#endif
+
+  // copies of the primary generator without the queue, which generate
+  // synchronously with the registered generators or their clones
+  TObjArray* list = generator->GetListOfGenerators();
+  for (Int_t k = 0; k < nThreads; ++k) {
+    FairPrimaryGenerator* copy = new FairPrimaryGenerator(*generator);
+    for (Int_t i = 0; i < list->GetEntriesFast(); ++i) {
+      FairGenerator* gen = static_cast<FairGenerator*>(list->At(i));
+      if (gen) {
+        copy->AddGenerator(fSharedGenerators ? gen : gen->CloneGenerator());
+      }
+    }
+    if (!fSharedGenerators) {
+      copy->Init();
+    }
+    fGenerators.push_back(copy);
+    // headers of the class used by the run, derived headers keep their members
+    fHeaders.push_back(FairPrimaryRecorder::NewHeader(header));
+  }
+
+  // fill the PDG table before the threads look up their particles
+  TDatabasePDG::Instance()->GetParticle(211);
+
+  for (size_t i = 0; i < fSlots.size(); ++i) {
+    fSlots[i].fState = kEmpty;
+    fSlots[i].fIndex = 0;
+    fSlots[i].fHeader = FairPrimaryRecorder::NewHeader(header);
+  }
+
+  for (Int_t k = 0; k < nThreads; ++k) {
+    fThreads.push_back(thread(&FairPrimaryQueueWorkers::Run, this, k));
+  }
+}
+
+FairPrimaryQueueWorkers::~FairPrimaryQueueWorkers()
+{
+  {
+    lock_guard<mutex> lock(fMutex);
+    fStop = kTRUE;
+  }
+  fSlotFree.notify_all();
+  for (size_t k = 0; k < fThreads.size(); ++k) {
+    fThreads[k].join();
+  }
+
+  for (size_t k = 0; k < fGenerators.size(); ++k) {
+    if (fSharedGenerators) {
+      // the generators belong to the original primary generator
+      fGenerators[k]->GetListOfGenerators()->Clear();
+    }
+    delete fGenerators[k];
+    delete fHeaders[k];
+  }
+  for (size_t i = 0; i < fSlots.size(); ++i) {
+    delete fSlots[i].fHeader;
+  }
+}
+
+void FairPrimaryQueueWorkers::Run(Int_t thread)
+{
+  FairPrimaryGenerator* generator = fGenerators[thread];
+  FairMCEventHeader* header = fHeaders[thread];
+  vector<FairPrimaryRecorder::Primary> primaries;
+  FairPrimaryRecorder recorder(primaries);
+  TRandom3 random;
+  generator->SetEvent(header);
+  generator->SetRandom(&random);
+
+  for (;;) {
+    ULong64_t index = 0;
+    {
+      unique_lock<mutex> lock(fMutex);
+      while (!fStop && !(fNextGenerated < fEnd && fNextGenerated < fNextConsumed + fSlots.size())) {
+        fSlotFree.wait(lock);
+      }
+      if (fStop) {
+        return;
+      }
+      index = fNextGenerated++;
+    }
+
+    // the event number is used if the generators do not set one
+    random.SetSeed(FairPrimaryQueue::EventSeed(fSeed, index));
+    generator->SetEventNr(fFirstEventNr + index);
+    primaries.clear();
+    Bool_t ok = generator->GeneratePrimaries(&recorder);
+
+    {
+      lock_guard<mutex> lock(fMutex);
+      Slot& slot = fSlots[index % fSlots.size()];
+      slot.fIndex = index;
+      if (ok) {
+        slot.fState = kReady;
+        slot.fPrimaries.swap(primaries);
+        FairPrimaryRecorder::CopyHeader(header, slot.fHeader);
+      } else {
+        slot.fState = kFailed;
+        fEnd = TMath::Min(fEnd, index);
+      }
+    }
+    fSlotReady.notify_all();
+  }
+}
+
+Bool_t FairPrimaryQueueWorkers::Next(FairGenericStack* stack, FairMCEventHeader* header)
+{
+  vector<FairPrimaryRecorder::Primary> primaries;
+  {
+    unique_lock<mutex> lock(fMutex);
+    for (;;) {
+      if (fNextConsumed >= fEnd) {
+        return kFALSE;
+      }
+      Slot& slot = fSlots[fNextConsumed % fSlots.size()];
+      if (slot.fState == kReady && slot.fIndex == fNextConsumed) {
+        break;
+      }
+      fSlotReady.wait(lock);
+    }
+    Slot& slot = fSlots[fNextConsumed % fSlots.size()];
+    primaries.swap(slot.fPrimaries);
+    FairPrimaryRecorder::CopyHeader(slot.fHeader, header);
+    slot.fState = kEmpty;
+    ++fNextConsumed;
+  }
+  fSlotFree.notify_all();
+
+  FairPrimaryRecorder::Push(stack, primaries);
+  return kTRUE;
+}
+
+FairPrimaryQueue::FairPrimaryQueue(FairPrimaryGenerator* generator, Int_t nThreads, Int_t depth, UInt_t seed)
+  : fGenerator(generator),
+    fNThreads(nThreads),
+    fDepth(depth),
+    fSeed(seed),
+    fWorkers(0)
+{
+}
+
+FairPrimaryQueue::~FairPrimaryQueue()
+{
+  delete fWorkers;
+}
+
+Bool_t FairPrimaryQueue::NextEvent(FairGenericStack* stack, FairMCEventHeader* header)
+{
+  {
+    lock_guard<mutex> lock(gStartMutex);
+    if (!fWorkers) {
+      if (fSeed == 0) {
+        fSeed = gRandom->GetSeed();
+      }
+      LOG(INFO) << "FairPrimaryQueue: generating up to " << fDepth << " events in advance with "
+                << fNThreads << " threads, seed " << fSeed << FairLogger::endl;
+      fWorkers = new FairPrimaryQueueWorkers(fGenerator, header, fNThreads, fDepth, fSeed);
+    }
+  }
+  return fWorkers->Next(stack, header);
+}
+
+UInt_t FairPrimaryQueue::EventSeed(UInt_t seed, ULong64_t index)
+{
+  // splitmix64 of seed and index, neighbouring events get unrelated seeds
+  ULong64_t z = (static_cast<ULong64_t>(seed) << 32) + index + 0x9e3779b97f4a7c15ULL;
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+  z = z ^ (z >> 31);
+  UInt_t result = static_cast<UInt_t>(z >> 32);
+  // TRandom3::SetSeed(0) would take the seed from the clock
+  return result ? result : 1;
+}
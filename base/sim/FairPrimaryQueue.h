@@ -0,0 +1,80 @@
+/********************************************************************************
+ *    Copyright (C) 2014 GSI Helmholtzzentrum fuer Schwerionenforschung GmbH    *
+ *                                                                              *
+ *              This software is distributed under the terms of the             *
+ *         GNU Lesser General Public Licence version 3 (LGPL) version 3,        *
+ *                  copied verbatim in the file "LICENSE"                       *
+ ********************************************************************************/
+// -------------------------------------------------------------------------
+// -----                  FairPrimaryQueue header file                 -----
+// -------------------------------------------------------------------------
+#ifndef FAIRPRIMARYQUEUE_H
+#define FAIRPRIMARYQUEUE_H 1
+
+#include "Rtypes.h"                     // for Int_t, UInt_t, etc
+
+class FairGenericStack;
+class FairMCEventHeader;
+class FairPrimaryGenerator;
+class FairPrimaryQueueWorkers;
+
+/**
+ * @class FairPrimaryQueue
+ * Generates the primaries of the following events in background threads,
+ * while the current event is transported.
+ *
+ * Each thread runs a copy of the primary generator (vertex, beam angle and
+ * event plane settings) and records the primaries of complete events into a
+ * ring of depth slots. With one thread, the copy calls the registered
+ * generators of the original primary generator, which are then no longer
+ * called from the transport thread. With more threads, each copy gets clones
+ * of the generators (FairGenerator::CloneGenerator), so the generators must
+ * produce independent events; generators reading an input file can only be
+ * used with one thread.
+ *
+ * Event i is generated with its own TRandom3, seeded from the base seed and
+ * i, which the generators get from FairPrimaryGenerator::GetRandom(). The
+ * events are handed out in their order, so the result does not depend on
+ * the number of threads, as long as the generators do not use gRandom.
+ *
+ * NextEvent can be called from several threads (MT workers).
+ */
+class FairPrimaryQueue
+{
+
+  public:
+    /**
+     * @param generator its settings and generators are used by the threads
+     * @param nThreads number of generating threads
+     * @param depth maximum number of events generated in advance
+     * @param seed base seed of the event random generators, 0: from gRandom
+     */
+    FairPrimaryQueue(FairPrimaryGenerator* generator, Int_t nThreads, Int_t depth, UInt_t seed);
+    virtual ~FairPrimaryQueue();
+
+    Int_t GetNThreads() const { return fNThreads; }
+    Int_t GetDepth() const { return fDepth; }
+
+    /**
+     * Pushes the primaries of the next event to the stack and copies the event
+     * information into the header. The threads are started by the first call,
+     * when the generators are initialised.
+     * @return kFALSE if the event generation failed (e.g. end of input file)
+     */
+    Bool_t NextEvent(FairGenericStack* stack, FairMCEventHeader* header);
+
+    /** Seed of the random generator of event index, never 0 */
+    static UInt_t EventSeed(UInt_t seed, ULong64_t index);
+
+  private:
+    FairPrimaryGenerator* fGenerator;
+    Int_t fNThreads;
+    Int_t fDepth;
+    UInt_t fSeed;
+    FairPrimaryQueueWorkers* fWorkers;
+
+    FairPrimaryQueue(const FairPrimaryQueue&);
+    FairPrimaryQueue& operator=(const FairPrimaryQueue&);
+};
+
+#endif
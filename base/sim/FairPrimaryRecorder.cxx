@@ -0,0 +1,97 @@
+/********************************************************************************
+ *    Copyright (C) 2014 GSI Helmholtzzentrum fuer Schwerionenforschung GmbH    *
+ *                                                                              *
+ *              This software is distributed under the terms of the             *
+ *         GNU Lesser General Public Licence version 3 (LGPL) version 3,        *
+ *                  copied verbatim in the file "LICENSE"                       *
+ ********************************************************************************/
+// -------------------------------------------------------------------------
+// -----                FairPrimaryRecorder source file                -----
+// -------------------------------------------------------------------------
+#include "FairPrimaryRecorder.h"
+
+#include "FairMCEventHeader.h"          // for FairMCEventHeader
+
+#include "TBufferFile.h"                // for TBufferFile
+
+using namespace std;
+
+FairPrimaryRecorder::FairPrimaryRecorder(vector<Primary>& primaries)
+  : FairGenericStack(),
+    fPrimaries(primaries)
+{
+}
+
+FairPrimaryRecorder::~FairPrimaryRecorder()
+{
+}
+
+void FairPrimaryRecorder::PushTrack(Int_t toBeDone, Int_t parentID, Int_t pdgCode,
+                                    Double_t px, Double_t py, Double_t pz,
+                                    Double_t e, Double_t vx, Double_t vy,
+                                    Double_t vz, Double_t time, Double_t polx,
+                                    Double_t poly, Double_t polz, TMCProcess proc,
+                                    Int_t& ntr, Double_t weight, Int_t is)
+{
+  PushTrack(toBeDone, parentID, pdgCode, px, py, pz, e, vx, vy, vz, time,
+            polx, poly, polz, proc, ntr, weight, is, -1);
+}
+
+void FairPrimaryRecorder::PushTrack(Int_t toBeDone, Int_t, Int_t pdgCode,
+                                    Double_t px, Double_t py, Double_t pz,
+                                    Double_t e, Double_t vx, Double_t vy,
+                                    Double_t vz, Double_t time, Double_t polx,
+                                    Double_t poly, Double_t polz, TMCProcess proc,
+                                    Int_t& ntr, Double_t weight, Int_t is, Int_t secondparentID)
+{
+  Primary p = { toBeDone, pdgCode, px, py, pz, e, vx, vy, vz, time,
+                polx, poly, polz, proc, weight, is, secondparentID };
+  ntr = fPrimaries.size();
+  fPrimaries.push_back(p);
+}
+
+void FairPrimaryRecorder::Push(FairGenericStack* stack, const vector<Primary>& primaries,
+                               Int_t first)
+{
+  for (size_t i = 0; i < primaries.size(); ++i) {
+    const Primary& p = primaries[i];
+    Int_t ntr = 0;
+    stack->PushTrack(p.fToBeDone, -1, p.fPdgCode, p.fPx, p.fPy, p.fPz, p.fE,
+                     p.fVx, p.fVy, p.fVz, p.fTime, p.fPolx, p.fPoly, p.fPolz,
+                     static_cast<TMCProcess>(p.fProcess), ntr, p.fWeight, p.fStatus,
+                     p.fParent >= 0 ? p.fParent - first : -1);
+  }
+}
+
+void FairPrimaryRecorder::CopyHeader(const FairMCEventHeader* from, FairMCEventHeader* to)
+{
+  if (from->IsA() != FairMCEventHeader::Class() && from->IsA() == to->IsA()) {
+    // the members of derived headers are only known to the streamer
+    UInt_t runId = to->GetRunID();
+    TBufferFile buffer(TBuffer::kWrite);
+    const_cast<FairMCEventHeader*>(from)->Streamer(buffer);
+    buffer.SetReadMode();
+    buffer.SetBufferOffset(0);
+    to->Streamer(buffer);
+    to->SetRunID(runId);
+  }
+
+  // again without the Double32_t truncation of the streamer
+  to->SetEventID(from->GetEventID());
+  to->SetVertex(from->GetX(), from->GetY(), from->GetZ());
+  to->SetTime(from->GetT());
+  to->SetB(from->GetB());
+  to->SetNPrim(from->GetNPrim());
+  to->MarkSet(from->IsSet());
+  to->SetRotX(from->GetRotX());
+  to->SetRotY(from->GetRotY());
+  to->SetRotZ(from->GetRotZ());
+}
+
+FairMCEventHeader* FairPrimaryRecorder::NewHeader(const FairMCEventHeader* header)
+{
+  if (!header) {
+    return new FairMCEventHeader();
+  }
+  return static_cast<FairMCEventHeader*>(header->Clone());
+}
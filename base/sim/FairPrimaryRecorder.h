@@ -0,0 +1,99 @@
+/********************************************************************************
+ *    Copyright (C) 2014 GSI Helmholtzzentrum fuer Schwerionenforschung GmbH    *
+ *                                                                              *
+ *              This software is distributed under the terms of the             *
+ *         GNU Lesser General Public Licence version 3 (LGPL) version 3,        *
+ *                  copied verbatim in the file "LICENSE"                       *
+ ********************************************************************************/
+// -------------------------------------------------------------------------
+// -----                FairPrimaryRecorder header file                -----
+// -------------------------------------------------------------------------
+#ifndef FAIRPRIMARYRECORDER_H
+#define FAIRPRIMARYRECORDER_H 1
+
+#include "FairGenericStack.h"           // for FairGenericStack
+
+#include "Rtypes.h"                     // for Int_t, Double_t, etc
+#include "TMCProcess.h"                 // for TMCProcess
+
+#include <vector>                       // for vector
+
+class FairMCEventHeader;
+class TParticle;
+
+/**
+ * @class FairPrimaryRecorder
+ * Stack which only records the primaries pushed by the FairPrimaryGenerator,
+ * used to generate an event in advance (FairPrimaryQueue) or to split it
+ * (FairSubEventQueue). Push() gives the recorded primaries to the real stack.
+ */
+class FairPrimaryRecorder : public FairGenericStack
+{
+
+  public:
+    /** Primary as given to FairGenericStack::PushTrack */
+    struct Primary {
+      Int_t fToBeDone;
+      Int_t fPdgCode;
+      Double_t fPx, fPy, fPz, fE;
+      Double_t fVx, fVy, fVz, fTime;
+      Double_t fPolx, fPoly, fPolz;
+      Int_t fProcess;
+      Double_t fWeight;
+      Int_t fStatus;
+      Int_t fParent;   // generator index of the mother primary, -1 if none
+    };
+
+    /** @param primaries the primaries are appended to this vector */
+    FairPrimaryRecorder(std::vector<Primary>& primaries);
+    virtual ~FairPrimaryRecorder();
+
+    virtual void PushTrack(Int_t toBeDone, Int_t parentID, Int_t pdgCode,
+                           Double_t px, Double_t py, Double_t pz,
+                           Double_t e, Double_t vx, Double_t vy,
+                           Double_t vz, Double_t time, Double_t polx,
+                           Double_t poly, Double_t polz, TMCProcess proc,
+                           Int_t& ntr, Double_t weight, Int_t is);
+
+    virtual void PushTrack(Int_t toBeDone, Int_t parentID, Int_t pdgCode,
+                           Double_t px, Double_t py, Double_t pz,
+                           Double_t e, Double_t vx, Double_t vy,
+                           Double_t vz, Double_t time, Double_t polx,
+                           Double_t poly, Double_t polz, TMCProcess proc,
+                           Int_t& ntr, Double_t weight, Int_t is, Int_t secondparentID);
+
+    virtual TParticle* PopNextTrack(Int_t&) { return 0; }
+    virtual TParticle* PopPrimaryForTracking(Int_t) { return 0; }
+    virtual void SetCurrentTrack(Int_t) {}
+    virtual Int_t GetNtrack() const { return fPrimaries.size(); }
+    virtual Int_t GetNprimary() const { return fPrimaries.size(); }
+    virtual TParticle* GetCurrentTrack() const { return 0; }
+    virtual Int_t GetCurrentTrackNumber() const { return -1; }
+    virtual Int_t GetCurrentParentTrackNumber() const { return -1; }
+
+    /**
+     * Pushes the primaries to the stack.
+     * @param first generator index of the first primary, subtracted from the
+     *        mother indices (the mothers have to be in the same vector)
+     */
+    static void Push(FairGenericStack* stack, const std::vector<Primary>& primaries,
+                     Int_t first = 0);
+
+    /**
+     * Copies the event information filled by the primary generator. The
+     * members of headers derived from FairMCEventHeader are copied as well
+     * if both headers are of the same class. The run id is kept.
+     */
+    static void CopyHeader(const FairMCEventHeader* from, FairMCEventHeader* to);
+
+    /** New header of the same class as header, for the generation of events in advance */
+    static FairMCEventHeader* NewHeader(const FairMCEventHeader* header);
+
+  private:
+    std::vector<Primary>& fPrimaries;
+
+    FairPrimaryRecorder(const FairPrimaryRecorder&);
+    FairPrimaryRecorder& operator=(const FairPrimaryRecorder&);
+};
+
+#endif
@@ -26,15 +26,21 @@
 #include "FairRootManager.h"
 #include "FairWriteoutBuffer.h"
 #include "TClonesArray.h"
+#include "TFile.h"
 #if ( ROOT_VERSION_CODE >= ROOT_VERSION(6,9,3) )
 #include "TMCAutoLock.h"
 #endif
+#if ( ROOT_VERSION_CODE >= ROOT_VERSION(6,10,0) )
+#include "ROOT/TBufferMerger.hxx"
+#endif
 #include "TMCtls.h"
 #include "TThread.h"
 #include "TError.h"
 #include "RVersion.h"
 
 #include <cstdio>
+#include <map>
+#include <memory>
 
 #if ( ROOT_VERSION_CODE >= ROOT_VERSION(6,9,3) )
 namespace {
@@ -46,9 +52,20 @@ namespace {
   TMCMutex writeMutex = TMCMUTEX_INITIALIZER;
   TMCMutex closeMutex = TMCMUTEX_INITIALIZER;
   TMCMutex getMutex =  TMCMUTEX_INITIALIZER;
+  TMCMutex mergerMutex = TMCMUTEX_INITIALIZER;
 }  
 #endif
 
+#if ( ROOT_VERSION_CODE >= ROOT_VERSION(6,10,0) )
+namespace {
+  // The merger writing the output file shared by all workers,
+  // created by the first worker and deleted with the last one
+  ROOT::Experimental::TBufferMerger* merger = 0;
+  // The in-memory files of the workers, per worker Id
+  std::map<Int_t, std::shared_ptr<ROOT::Experimental::TBufferMergerFile> > mergerFiles;
+}
+#endif
+
 pthread_mutex_t counter_mutex;
 pthread_mutex_t fill_lock_mutex;
 
@@ -59,6 +76,7 @@ pthread_mutex_t fill_lock_mutex;
 Int_t   FairRootManagerSimMT::fgCounter = 0; 
 Bool_t  FairRootManagerSimMT::fgIsFillLock = true; 
 std::vector<Bool_t>* FairRootManagerSimMT::fgIsFillLocks = 0;
+Int_t   FairRootManagerSimMT::fgMergeFlushEvents = 100;
 
 //
 // ctors, dtor
@@ -68,7 +86,9 @@ std::vector<Bool_t>* FairRootManagerSimMT::fgIsFillLocks = 0;
 FairRootManagerSimMT::FairRootManagerSimMT()
   : FairGenericRootManager(),
     fId(0),
-    fRootManager(0)
+    fRootManager(0),
+    fMergedFile(0),
+    fNFilled(0)
 {
 /// Standard constructor
 
@@ -141,6 +161,20 @@ FairRootManagerSimMT::~FairRootManagerSimMT()
       << fId << " " << this << FairLogger::endl;
   }
 
+#if ( ROOT_VERSION_CODE >= ROOT_VERSION(6,10,0) )
+  // Delete the in-memory file, the output file is written
+  // when the merger of the last worker is deleted
+  if ( fMergedFile ) {
+    TMCAutoLock mlk(&mergerMutex);
+    mergerFiles.erase(fId);
+    if ( mergerFiles.empty() ) {
+      delete merger;
+      merger = 0;
+    }
+    fMergedFile = 0;
+  }
+#endif
+
   // Global cleanup 
   --fgCounter;
   if ( ! fgCounter ) {
@@ -239,6 +273,23 @@ void  FairRootManagerSimMT::FillWithoutLock()
   LogMessage("Done Fill");
 }
 
+//_____________________________________________________________________________
+void  FairRootManagerSimMT::FillMerged()
+{
+/// Fill the Root tree in the in-memory file of this worker and pass
+/// the compressed buffers to the merger every fgMergeFlushEvents events.
+/// Only the merger queue is locked, and only for the hand-over.
+
+  FillWithoutLock();
+
+  if ( ++fNFilled >= fgMergeFlushEvents ) {
+    LogMessage("Flush to merger");
+    fMergedFile->Write();
+    fNFilled = 0;
+    LogMessage("Done Flush to merger");
+  }
+}
+
 //
 // public methods
 //
@@ -344,6 +395,12 @@ void  FairRootManagerSimMT::Fill()
 {
 /// Fill the Root tree.
 
+  // Each worker has its own file, no lock needed
+  if ( fMergedFile ) {
+    FillMerged();
+    return;
+  }
+
   // Fill with lack untill first call on all threads
   if ( fgIsFillLock ) {
     FillWithTmpLock();
@@ -367,7 +424,14 @@ void FairRootManagerSimMT:: Write()
 #endif
 
   LogMessage("Write");
-  fRootManager->Write();
+  if ( fMergedFile ) {
+    // writes the tree and passes the remaining buffers to the merger
+    fMergedFile->Write();
+    fNFilled = 0;
+  }
+  else {
+    fRootManager->Write();
+  }
   LogMessage("Done Write");
 
 #if ( ROOT_VERSION_CODE >= ROOT_VERSION(6,9,3) )
@@ -403,3 +467,39 @@ Int_t FairRootManagerSimMT::GetBranchId(TString const & brName)
 
   return fRootManager->GetBranchId(brName);
 }
+
+//_____________________________________________________________________________
+TFile* FairRootManagerSimMT::OpenMergedOutFile(const TString& fileName)
+{
+/// Return the in-memory file of this worker, merged into fileName.
+/// Falls back to a per-thread file if TBufferMerger is not available.
+
+#if ( ROOT_VERSION_CODE >= ROOT_VERSION(6,10,0) )
+  LogMessage("Going to lock for OpenMergedOutFile");
+  TMCAutoLock lk(&mergerMutex);
+
+  if ( ! merger ) {
+    // ROOT::EnableThreadSafety() has been called by FairRunSim::Init() on the master
+    merger = new ROOT::Experimental::TBufferMerger(fileName.Data(), "RECREATE");
+    LOG(INFO) << "FairRootManagerSimMT: merging the output of all workers into "
+      << fileName << FairLogger::endl;
+  }
+  std::shared_ptr<ROOT::Experimental::TBufferMergerFile> file = merger->GetFile();
+  mergerFiles[fId] = file;
+  fMergedFile = file.get();
+  fNFilled = 0;
+
+  lk.unlock();
+  LogMessage("Released lock for OpenMergedOutFile");
+
+  return fMergedFile;
+#else
+  LOG(WARNING) << "FairRootManagerSimMT: merged output requires ROOT >= 6.10, "
+    << "writing one file per thread" << FairLogger::endl;
+  TString threadFileName = fileName;
+  TString tid = "_t";
+  tid += fId;
+  threadFileName.Insert(threadFileName.Index(".root"), tid);
+  return TFile::Open(threadFileName, "recreate");
+#endif
+}
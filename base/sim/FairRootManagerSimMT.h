@@ -32,11 +32,18 @@
 class FairRootManager;
 class FairWriteoutBuffer;
 class TClonesArray; 
+class TFile;
 
 /// \brief The Root IO manager for VMC examples for multi-threaded applications.
 ///
 /// Implemented according to TMCRootManager from Geant4 VMC.
 /// It implements the FairGenericRootManager interface.
+///
+/// With OpenMergedOutFile() all workers write into one output file:
+/// each worker fills its tree in its own in-memory file, and the
+/// serialized and compressed buffers are appended to the output file
+/// by a separate merger thread (ROOT TBufferMerger), so Fill() does
+/// not need any lock.
 
 class FairRootManagerSimMT : public FairGenericRootManager
 {
@@ -59,6 +66,13 @@ class FairRootManagerSimMT : public FairGenericRootManager
 
     virtual Int_t GetBranchId(TString const &BrName);
 
+    /// Open the in-memory file of this worker, its content is merged
+    /// into the file fileName shared by all workers
+    TFile* OpenMergedOutFile(const TString& fileName);
+
+    /// Number of events after which the workers pass their buffers to the merger
+    static void SetMergeFlushEvents(Int_t nEvents) { fgMergeFlushEvents = nEvents; }
+
     virtual FairRootManager*    GetFairRootManager() const { return fRootManager; }
     virtual Int_t  GetId() const { return fId; }
 
@@ -72,15 +86,19 @@ class FairRootManagerSimMT : public FairGenericRootManager
     void  FillWithLock();
     void  FillWithTmpLock();
     void  FillWithoutLock();
+    void  FillMerged();
 
     // global static data members
     static  Int_t    fgCounter;         // The counter of instances
     static  Bool_t   fgIsFillLock;      // The if the Fill should be locked 
     static  std::vector<Bool_t>* fgIsFillLocks; // The info per thread if the Fill should be locked
+    static  Int_t    fgMergeFlushEvents; // The number of events between two flushes to the merger
 
     // data members 
     Int_t             fId;           // This manager ID 
     FairRootManager*  fRootManager;  // The Root manager
+    TFile*            fMergedFile;   // The in-memory file of this worker in merged mode
+    Int_t             fNFilled;      // The number of events filled since the last flush
 };
 
 #endif //ROOT_FairRootManagerSimMT
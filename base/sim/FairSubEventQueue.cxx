@@ -0,0 +1,185 @@
+/********************************************************************************
+ *    Copyright (C) 2014 GSI Helmholtzzentrum fuer Schwerionenforschung GmbH    *
+ *                                                                              *
+ *              This software is distributed under the terms of the             *
+ *         GNU Lesser General Public Licence version 3 (LGPL) version 3,        *
+ *                  copied verbatim in the file "LICENSE"                       *
+ ********************************************************************************/
+// -------------------------------------------------------------------------
+// -----                 FairSubEventQueue source file                 -----
+// -------------------------------------------------------------------------
+#include "FairSubEventQueue.h"
+
+#include "FairGenericStack.h"           // for FairGenericStack
+#include "FairLink.h"                   // for FairLink
+#include "FairLogger.h"                 // for FairLogger, LOG
+#include "FairMCEventHeader.h"          // for FairMCEventHeader
+#include "FairMCPoint.h"                // for FairMCPoint
+#include "FairPrimaryGenerator.h"       // for FairPrimaryGenerator
+
+#include "TClonesArray.h"               // for TClonesArray
+#include "TMath.h"                      // for Max
+
+#include <limits>                       // for numeric_limits
+#include <mutex>                        // for mutex, lock_guard
+
+using namespace std;
+
+namespace {
+  // protects the current event and the output of the sub-events
+  mutex gQueueMutex;
+}
+
+FairSubEventQueue::FairSubEventQueue(FairPrimaryGenerator* generator, Int_t nSubEvents)
+  : fGenerator(generator),
+    fNSubEvents(nSubEvents),
+    fHeader(NULL),
+    fRecorder(0),
+    fPrimaries(),
+    fFirst(),
+    fNext(nSubEvents),
+    fOutput(),
+    fNFinished()
+{
+  fRecorder = new FairPrimaryRecorder(fPrimaries);
+}
+
+FairSubEventQueue::~FairSubEventQueue()
+{
+  for (map<UInt_t, vector<vector<TClonesArray*> > >::iterator it = fOutput.begin(); it != fOutput.end(); ++it) {
+    for (size_t k = 0; k < it->second.size(); ++k) {
+      for (size_t i = 0; i < it->second[k].size(); ++i) {
+        delete it->second[k][i];
+      }
+    }
+  }
+  delete fRecorder;
+  delete fHeader;
+}
+
+Bool_t FairSubEventQueue::GenerateEvent()
+{
+  fPrimaries.clear();
+
+  // the generator fills our header, not the one of its own thread
+  FairMCEventHeader* event = fGenerator->GetEvent();
+  if (!fHeader) {
+    fHeader = FairPrimaryRecorder::NewHeader(event);
+  }
+  fGenerator->SetEvent(fHeader);
+  Bool_t ok = fGenerator->GenerateFullEvent(fRecorder);
+  fGenerator->SetEvent(event);
+  if (!ok) {
+    return kFALSE;
+  }
+
+  // mother index of the following primaries: minParent[i] is the smallest
+  // mother index of the primaries i..n-1, a sub-event may start at i
+  // only if no following primary has its mother before i
+  Int_t n = fPrimaries.size();
+  vector<Int_t> minParent(n + 1, numeric_limits<Int_t>::max());
+  for (Int_t i = n - 1; i >= 0; --i) {
+    Int_t parent = fPrimaries[i].fParent;
+    minParent[i] = (parent >= 0 && parent < minParent[i + 1]) ? parent : minParent[i + 1];
+  }
+
+  fFirst.assign(fNSubEvents + 1, n);
+  fFirst[0] = 0;
+  for (Int_t k = 1; k < fNSubEvents; ++k) {
+    Int_t first = TMath::Max(static_cast<Int_t>(static_cast<Long64_t>(k) * n / fNSubEvents), fFirst[k - 1]);
+    while (first < n && minParent[first] < first) {
+      ++first;
+    }
+    fFirst[k] = first;
+  }
+
+  LOG(DEBUG) << "FairSubEventQueue: event " << fHeader->GetEventID() << " with " << n
+             << " primaries split into " << fNSubEvents << " sub-events" << FairLogger::endl;
+
+  fNext = 0;
+  return kTRUE;
+}
+
+Bool_t FairSubEventQueue::NextSubEvent(FairGenericStack* stack, FairMCEventHeader* header, Int_t& subEvent)
+{
+  vector<Primary> primaries;
+  Int_t first = 0;
+  {
+    lock_guard<mutex> lock(gQueueMutex);
+    if (fNext >= fNSubEvents && !GenerateEvent()) {
+      return kFALSE;
+    }
+    subEvent = fNext++;
+    first = fFirst[subEvent];
+    primaries.assign(fPrimaries.begin() + first, fPrimaries.begin() + fFirst[subEvent + 1]);
+
+    FairPrimaryRecorder::CopyHeader(fHeader, header);
+    header->SetNPrim(fPrimaries.size());
+  }
+
+  // the mother of a primary is always in the same sub-event
+  FairPrimaryRecorder::Push(stack, primaries, first);
+
+  return kTRUE;
+}
+
+Bool_t FairSubEventQueue::AddOutput(UInt_t eventId, Int_t subEvent, FairGenericStack* stack,
+                                    vector<TClonesArray*>& arrays)
+{
+  // move the objects, the arrays of the caller are reused for the next sub-event
+  vector<TClonesArray*> output(arrays.size());
+  for (size_t i = 0; i < arrays.size(); ++i) {
+    output[i] = new TClonesArray(arrays[i]->GetClass(), arrays[i]->GetEntriesFast());
+    output[i]->AbsorbObjects(arrays[i]);
+  }
+
+  vector<vector<TClonesArray*> > pieces;
+  {
+    lock_guard<mutex> lock(gQueueMutex);
+    vector<vector<TClonesArray*> >& event = fOutput[eventId];
+    event.resize(fNSubEvents);
+    event[subEvent].swap(output);
+    if (++fNFinished[eventId] < fNSubEvents) {
+      return kFALSE;
+    }
+    pieces.swap(event);
+    fOutput.erase(eventId);
+    fNFinished.erase(eventId);
+  }
+
+  // all sub-events are done, merge them in their order
+  Int_t trackOffset = 0;
+  for (Int_t k = 0; k < fNSubEvents; ++k) {
+    vector<TClonesArray*>& piece = pieces[k];
+    Int_t nTracks = piece[0]->GetEntriesFast();
+    stack->ShiftTrackIndex(piece[0], trackOffset);
+    for (size_t i = 1; i < piece.size(); ++i) {
+      ShiftPointTrackIndex(piece[i], trackOffset);
+    }
+    for (size_t i = 0; i < piece.size(); ++i) {
+      arrays[i]->AbsorbObjects(piece[i]);
+      delete piece[i];
+    }
+    trackOffset += nTracks;
+  }
+
+  LOG(DEBUG) << "FairSubEventQueue: event " << eventId << " merged, "
+             << trackOffset << " tracks" << FairLogger::endl;
+
+  return kTRUE;
+}
+
+void FairSubEventQueue::ShiftPointTrackIndex(TClonesArray* points, Int_t offset)
+{
+  if (offset == 0 || !points->GetClass()->InheritsFrom(FairMCPoint::Class())) {
+    return;
+  }
+  for (Int_t i = 0; i < points->GetEntriesFast(); ++i) {
+    FairMCPoint* point = static_cast<FairMCPoint*>(points->At(i));
+    Int_t iTrack = point->GetTrackID();
+    if (iTrack >= 0) {
+      point->SetTrackID(iTrack + offset);
+      point->SetLink(FairLink("MCTrack", iTrack + offset));
+    }
+  }
+}
@@ -0,0 +1,106 @@
+/********************************************************************************
+ *    Copyright (C) 2014 GSI Helmholtzzentrum fuer Schwerionenforschung GmbH    *
+ *                                                                              *
+ *              This software is distributed under the terms of the             *
+ *         GNU Lesser General Public Licence version 3 (LGPL) version 3,        *
+ *                  copied verbatim in the file "LICENSE"                       *
+ ********************************************************************************/
+// -------------------------------------------------------------------------
+// -----                 FairSubEventQueue header file                 -----
+// -------------------------------------------------------------------------
+#ifndef FAIRSUBEVENTQUEUE_H
+#define FAIRSUBEVENTQUEUE_H 1
+
+#include "FairPrimaryRecorder.h"        // for FairPrimaryRecorder
+
+#include "Rtypes.h"                     // for Int_t, Double_t, etc
+
+#include <map>                          // for map
+#include <vector>                       // for vector
+
+class FairGenericStack;
+class FairMCEventHeader;
+class FairPrimaryGenerator;
+class TClonesArray;
+
+/**
+ * @class FairSubEventQueue
+ * Splits the primaries of one event into sub-events, which are transported
+ * independently (e.g. by different worker threads), and merges the output
+ * of the sub-events back into one event.
+ *
+ * The full events are generated by the primary generator the queue was
+ * created with, the primaries are recorded and split into nSubEvents parts
+ * of about equal size. A primary is never separated from its mother.
+ * The primaries of one sub-event keep their order, so the track ids of
+ * the sub-event are the generator indices shifted by a constant offset.
+ *
+ * The output of a sub-event (the stack's track array and the point
+ * collections of the detectors) is moved into the queue. The worker
+ * finishing the last sub-event of an event gets the merged output: the
+ * tracks of the sub-events one after the other, with the track indices
+ * of the tracks and points shifted by the number of tracks before them.
+ *
+ * All methods can be called from several threads.
+ */
+class FairSubEventQueue
+{
+
+  public:
+    typedef FairPrimaryRecorder::Primary Primary;
+
+    /**
+     * @param generator generates the full events
+     * @param nSubEvents number of sub-events per event
+     */
+    FairSubEventQueue(FairPrimaryGenerator* generator, Int_t nSubEvents);
+    virtual ~FairSubEventQueue();
+
+    Int_t GetNSubEvents() const { return fNSubEvents; }
+
+    /**
+     * Pushes the primaries of the next sub-event to the stack and copies the
+     * event information into the header. Generates a new event if needed.
+     * @param subEvent set to the index of the sub-event within its event
+     * @return kFALSE if the event generation failed
+     */
+    Bool_t NextSubEvent(FairGenericStack* stack, FairMCEventHeader* header, Int_t& subEvent);
+
+    /**
+     * Takes the output of a finished sub-event, the objects are moved out of
+     * the arrays. If it was the last missing sub-event of the event, the arrays
+     * are filled with the merged output of all sub-events.
+     * @param stack stack of the caller, knows how to shift its track indices
+     * @param arrays track array of the stack followed by the point collections
+     * @return kTRUE if the arrays contain the merged event
+     */
+    Bool_t AddOutput(UInt_t eventId, Int_t subEvent, FairGenericStack* stack,
+                     std::vector<TClonesArray*>& arrays);
+
+  private:
+    /** Generates the next event and splits it, called with the lock held */
+    Bool_t GenerateEvent();
+
+    /** Adds offset to the track ids of the points in the array */
+    static void ShiftPointTrackIndex(TClonesArray* points, Int_t offset);
+
+    FairPrimaryGenerator* fGenerator;
+    Int_t fNSubEvents;
+
+    /** current event: header, primaries and first primary of each sub-event */
+    FairMCEventHeader* fHeader;
+    FairPrimaryRecorder* fRecorder;
+    std::vector<Primary> fPrimaries;
+    std::vector<Int_t> fFirst;
+    /** next sub-event of the current event to be handed out */
+    Int_t fNext;
+
+    /** output of the finished sub-events per event id, by sub-event index */
+    std::map<UInt_t, std::vector<std::vector<TClonesArray*> > > fOutput;
+    std::map<UInt_t, Int_t> fNFinished;
+
+    FairSubEventQueue(const FairSubEventQueue&);
+    FairSubEventQueue& operator=(const FairSubEventQueue&);
+};
+
+#endif
@@ -10,10 +10,12 @@
 // -----                           FairLmdSource                           -----
 // -----                    Created 12.04.2013 by D.Kresan                 -----
 // -----------------------------------------------------------------------------
+#include <algorithm>
 #include <iostream>
 using namespace std;
 
 #include "TList.h"
+#include "TMath.h"
 #include "TObjString.h"
 #include "TRegexp.h"
 #include "TSystemDirectory.h"
@@ -33,7 +35,16 @@ FairLmdSource::FairLmdSource()
     fxBuffer(NULL),
     fxEventData(NULL),
     fxSubEvent(NULL),
-    fxInfoHeader(NULL)
+    fxInfoHeader(NULL),
+    fxMap(NULL),
+    fMemoryMapped(kFALSE),
+    fFirstEvent(0),
+    fLastEvent(-1),
+    fReadAhead(64*1024*1024),
+    fEventIndex(0),
+    fFileFirstEvent(0),
+    fNextAdvise(0),
+    fAdvisedFrom(0)
 {
 }
 
@@ -49,13 +60,26 @@ FairLmdSource::FairLmdSource(const FairLmdSource& source)
     fxBuffer(NULL),
     fxEventData(NULL),
     fxSubEvent(NULL),
-    fxInfoHeader(NULL)
+    fxInfoHeader(NULL),
+    fxMap(NULL),
+    fMemoryMapped(source.fMemoryMapped),
+    fFirstEvent(source.fFirstEvent),
+    fLastEvent(source.fLastEvent),
+    fReadAhead(source.fReadAhead),
+    fEventIndex(0),
+    fFileFirstEvent(0),
+    fNextAdvise(0),
+    fAdvisedFrom(0)
 {
 }
 
 
 FairLmdSource::~FairLmdSource()
 {
+  if(fxMap) {
+    fLmdMapClose(fxMap);
+    delete fxMap;
+  }
   fFileNames->Delete();
   delete fFileNames;
 }
@@ -116,6 +140,7 @@ Bool_t FairLmdSource::Init()
     return kFALSE;
   }
 
+  fEventIndex=0;
   TString name = (static_cast<TObjString*>(fFileNames->At(fCurrentFile)))->GetString();
   if(! OpenNextFile(name)) {
     return kFALSE;
@@ -132,6 +157,10 @@ Bool_t FairLmdSource::Init()
 
 Bool_t FairLmdSource::OpenNextFile(TString fileName)
 {
+  if(fMemoryMapped && OpenMappedFile(fileName)) {
+    return kTRUE;
+  }
+
   Int_t inputMode = GETEVT__FILE;
   fxInputChannel = new s_evt_channel;
   void* headptr = &fxInfoHeader;
@@ -161,12 +190,110 @@ Bool_t FairLmdSource::OpenNextFile(TString fileName)
 }
 
 
+Bool_t FairLmdSource::OpenMappedFile(TString fileName)
+{
+  sLmdMap* map = new sLmdMap;
+  UInt_t status = fLmdMapOpen(map, const_cast<char*>(fileName.Data()), LMD__INDEX);
+  if(LMD__SUCCESS != status) {
+    delete map;
+    if(GETLMD__NOLMDFILE == status) {
+      LOG(INFO) << "File " << fileName << " is not in the mapped LMD format, reading it sequentially."
+                << FairLogger::endl;
+    }
+    return kFALSE;
+  }
+  fxMap = map;
+  fFileFirstEvent = fEventIndex;
+  fNextAdvise = 0;
+  fAdvisedFrom = 0;
+
+  LOG(INFO) << "File " << fileName << " mapped, " << fLmdMapElements(fxMap) << " events"
+            << (fxMap->iIndexed ? " (indexed)." : ".") << FairLogger::endl;
+
+  fLmdMapAdvise(fxMap, 0, fLmdMapElements(fxMap), LMD__MAP_SEQUENTIAL);
+
+  // files in this format have no s_filhe and s_bufhe, the file and buffer
+  // header unpackers (type -4) are not called for mapped files
+  fxInfoHeader = NULL;
+  fxBuffer = NULL;
+
+  return kTRUE;
+}
+
+
+Int_t FairLmdSource::ReadMappedEvent()
+{
+  Long64_t nElements = fLmdMapElements(fxMap);
+  sMbsHeader* header = NULL;
+
+  while(! header) {
+    // events before the range are skipped without reading them
+    if(fEventIndex < fFirstEvent) {
+      fEventIndex = TMath::Min(fFirstEvent, fFileFirstEvent + nElements);
+    }
+    if(fLastEvent >= 0 && fEventIndex >= fLastEvent) {
+      return 1;
+    }
+
+    UInt_t element = static_cast<UInt_t>(fEventIndex - fFileFirstEvent);
+    if(element >= nElements) {
+      // the last file stays open, it is closed by Close()
+      if(fCurrentFile >= fFileNames->GetSize()) {
+        return 1;
+      }
+      Close();
+      TString name = (static_cast<TObjString*>(fFileNames->At(fCurrentFile)))->GetString();
+      if(! OpenNextFile(name)) {
+        return 1;
+      }
+      fCurrentFile += 1;
+      return ReadEvent();
+    }
+
+    // request the next fReadAhead bytes when half of the last request is used,
+    // and give the pages before the current event back
+    if(element >= fNextAdvise) {
+      lmdoff_t* offset = fxMap->pOffset;
+      UInt_t last = upper_bound(offset + element, offset + nElements, offset[element] + fReadAhead) - offset;
+      if(last <= element) {
+        last = element + 1;
+      }
+      fLmdMapAdvise(fxMap, element, last, LMD__MAP_WILLNEED);
+      fLmdMapAdvise(fxMap, fAdvisedFrom, element, LMD__MAP_DONTNEED);
+      fAdvisedFrom = element;
+      fNextAdvise = element + (last - element + 1)/2;
+    }
+
+    // a corrupted event (size in the header and in the table differ) is
+    // skipped, the offsets of the following events are still valid
+    UInt_t status = fLmdMapGetElement(fxMap, element, &header);
+    fEventIndex++;
+    if(LMD__SUCCESS != status) {
+      LOG(ERROR) << "FairLmdSource: reading event " << element << " of file "
+                 << fxMap->cFile << " failed, skipping it." << FairLogger::endl;
+    }
+  }
+  fxEvent = reinterpret_cast<s_ve10_1*>(header);
+
+  return UnpackEvent();
+}
+
+
 Int_t FairLmdSource::ReadEvent(UInt_t)
 {
+  if(fxMap) {
+    return ReadMappedEvent();
+  }
+
   void* evtptr = &fxEvent;
   void* buffptr = &fxBuffer;
 
   Int_t status = f_evt_get_event(fxInputChannel, static_cast<INTS4**>(evtptr),static_cast<INTS4**>(buffptr));
+  // skip the events before the range
+  while(GETEVT__SUCCESS == status && fEventIndex < fFirstEvent) {
+    fEventIndex++;
+    status = f_evt_get_event(fxInputChannel, static_cast<INTS4**>(evtptr),static_cast<INTS4**>(buffptr));
+  }
   //Int_t fuEventCounter = fxEvent->l_count;
   //Int_t fCurrentMbsEventNo = fuEventCounter;
 
@@ -195,13 +322,27 @@ Int_t FairLmdSource::ReadEvent(UInt_t)
     }
   }
 
+  if(fLastEvent >= 0 && fEventIndex >= fLastEvent) {
+    return 1;
+  }
+  fEventIndex++;
+
+  return UnpackEvent();
+}
+
+
+Int_t FairLmdSource::UnpackEvent()
+{
+  Int_t status;
+
  //Store Start Times
-  if (fCurrentEvent==0 ) 
+  if (fCurrentEvent==0 && fxBuffer)
       Unpack(reinterpret_cast<Int_t*>(fxBuffer), sizeof(s_bufhe), -4, -4, -4, -4, -4);
 
 
   // Decode event header
-  Bool_t result = kFALSE;
+  // number of sub-events unpacked, the event fails if there is none
+  Int_t nUnpacked = 0;
   /*Bool_t result = */Unpack(reinterpret_cast<Int_t*>(fxEvent), sizeof(s_ve10_1), -2, -2, -2, -2, -2);
 
   Int_t nrSubEvts = f_evt_get_subevent(fxEvent, 0, NULL, NULL, NULL);
@@ -225,6 +366,7 @@ Int_t FairLmdSource::ReadEvent(UInt_t)
     Int_t nrlongwords;
     status = f_evt_get_subevent(fxEvent, i, static_cast<Int_t**>(SubEvtptr), static_cast<Int_t**>(EvtDataptr), &nrlongwords);
     if(status) {
+      FinishUnpack();
       return 1;
     }
     sebuflength = nrlongwords;
@@ -239,15 +381,18 @@ Int_t FairLmdSource::ReadEvent(UInt_t)
     if(Unpack(fxEventData, sebuflength,
               setype, sesubtype,
               seprocid, sesubcrate, secontrol)) {
-      result = kTRUE;
+      nUnpacked++;
     }
   }
 
+  // with several threads the collected sub-events are unpacked now
+  nUnpacked -= FinishUnpack();
+
   // Increment evt counters.
   fNEvent++;
   fCurrentEvent++;
  
-  if(! result)
+  if(nUnpacked <= 0)
   {
     return 2;
   }
@@ -258,8 +403,14 @@ Int_t FairLmdSource::ReadEvent(UInt_t)
 
 void FairLmdSource::Close()
 {
-  f_evt_get_close(fxInputChannel);
-  Unpack(reinterpret_cast<Int_t*>(fxBuffer), sizeof(s_bufhe), -4, -4, -4, -4, -4);  
+  if(fxMap) {
+    fLmdMapClose(fxMap);
+    delete fxMap;
+    fxMap = NULL;
+  } else {
+    f_evt_get_close(fxInputChannel);
+    Unpack(reinterpret_cast<Int_t*>(fxBuffer), sizeof(s_bufhe), -4, -4, -4, -4, -4);
+  }
   fCurrentEvent=0;
 }
 
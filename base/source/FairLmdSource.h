@@ -19,6 +19,7 @@ extern "C"
 #include "f_evt.h"
 #include "s_filhe_swap.h"
 #include "s_bufhe_swap.h"
+#include "fLmdMap.h"
 }
 
 #include "TString.h"
@@ -29,6 +30,16 @@ extern "C"
 class TList;
 
 
+/**
+ * Reads LMD files one after the other.
+ *
+ * With SetMemoryMapped() files in the LMD format with file header (as
+ * written by fLmdPutOpen) are mapped into memory, the events are unpacked
+ * directly from the mapping. SetEventRange() selects events by their number
+ * in the list of files; with mapped files the events before the range are
+ * not read at all, so several sources (e.g. in different threads or
+ * processes) can share the events of the same files.
+ */
 class FairLmdSource : public FairMbsSource
 {
   public:
@@ -45,8 +56,20 @@ class FairLmdSource : public FairMbsSource
     virtual Int_t ReadEvent(UInt_t=0);
     virtual void Close();
 
+    /** Maps the files into memory, files in the old format are read as before **/
+    void SetMemoryMapped(Bool_t mapped=kTRUE) { fMemoryMapped = mapped; }
+    Bool_t IsMemoryMapped() const { return fMemoryMapped; }
+    /** Reads only the events first to last-1 of all files, last < 0: to the end **/
+    void SetEventRange(Long64_t first, Long64_t last=-1) { fFirstEvent = first; fLastEvent = last; }
+    /** Bytes of a mapped file requested from the disk ahead of the current event (default 64 MB) **/
+    void SetReadAhead(Long64_t bytes) { fReadAhead = bytes; }
+
   protected:
     Bool_t OpenNextFile(TString fileName);
+    Bool_t OpenMappedFile(TString fileName);
+    Int_t ReadMappedEvent();
+    /** Unpacks fxEvent **/
+    Int_t UnpackEvent();
 
     Int_t fCurrentFile;
 	Int_t fNEvent;
@@ -58,6 +81,17 @@ class FairLmdSource : public FairMbsSource
     Int_t* fxEventData;
     s_ves10_1* fxSubEvent;
 	s_filhe* fxInfoHeader;
+    sLmdMap* fxMap;
+    Bool_t fMemoryMapped;
+    Long64_t fFirstEvent;
+    Long64_t fLastEvent;
+    Long64_t fReadAhead;
+    /** number of the next event in all files, and of the first event of the mapped file **/
+    Long64_t fEventIndex;
+    Long64_t fFileFirstEvent;
+    /** element of the mapped file at which the next read ahead is requested **/
+    UInt_t fNextAdvise;
+    UInt_t fAdvisedFrom;
 
     FairLmdSource& operator=(const FairLmdSource&);
 
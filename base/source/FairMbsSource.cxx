@@ -14,16 +14,223 @@
 // -----------------------------------------------------------------------------
 
 #include <iostream>
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+using namespace std;
+
+#include "RVersion.h"
+#include "TROOT.h"
 
 #include "FairMbsSource.h"
 #include "FairLogger.h"
 
-FairMbsSource::FairMbsSource() : FairOnlineSource() {}
+
+// Unpacks the collected sub-events of one event, grouped by unpacker. The
+// calling thread and nThreads-1 workers take the unpackers one by one.
+// A failed sub-event does not stop the unpacker, its following sub-events
+// are unpacked as in the single-threaded case.
+class FairMbsUnpackPool
+{
+  public:
+    FairMbsUnpackPool(TObjArray* unpackers, Int_t nThreads);
+    ~FairMbsUnpackPool();
+
+    /** Adds the data of the current sub-event for one of its unpackers */
+    void Add(Int_t unpacker, Int_t* data, Int_t size);
+    /** Following calls of Add belong to the next sub-event */
+    void NextSubEvent() { fNSubEvents++; }
+    /** Unpacks the collected sub-events, returns the number of failed ones */
+    Int_t Run();
+
+  private:
+    struct SubEvent {
+      Int_t* fData;
+      Int_t fSize;
+      Int_t fIndex;
+      Bool_t fOk;
+    };
+
+    void Work();
+    void RunJobs();
+
+    TObjArray* fUnpackers;
+    vector<vector<SubEvent> > fQueues;
+    vector<Int_t> fActive;
+    Int_t fNSubEvents;
+    atomic<size_t> fNext;
+    Long64_t fGeneration;
+    Int_t fNBusy;
+    Bool_t fStop;
+    mutex fMutex;
+    condition_variable fStart;
+    condition_variable fDone;
+    vector<thread> fThreads;
+};
+
+
+FairMbsUnpackPool::FairMbsUnpackPool(TObjArray* unpackers, Int_t nThreads)
+  : fUnpackers(unpackers),
+    fQueues(unpackers->GetEntriesFast()),
+    fActive(),
+    fNSubEvents(0),
+    fNext(0),
+    fGeneration(0),
+    fNBusy(0),
+    fStop(kFALSE),
+    fMutex(),
+    fStart(),
+    fDone(),
+    fThreads()
+{
+#if ( ROOT_VERSION_CODE >= ROOT_VERSION(6,6,0) )
+  ROOT::EnableThreadSafety();
+#endif
+  for (Int_t i = 1; i < nThreads; i++) {
+    fThreads.push_back(thread(&FairMbsUnpackPool::Work, this));
+  }
+}
+
+
+FairMbsUnpackPool::~FairMbsUnpackPool()
+{
+  {
+    lock_guard<mutex> lock(fMutex);
+    fStop = kTRUE;
+  }
+  fStart.notify_all();
+  for (size_t i = 0; i < fThreads.size(); i++) {
+    fThreads[i].join();
+  }
+}
+
+
+void FairMbsUnpackPool::Add(Int_t unpacker, Int_t* data, Int_t size)
+{
+  if (fQueues[unpacker].empty()) {
+    fActive.push_back(unpacker);
+  }
+  SubEvent sub = { data, size, fNSubEvents, kTRUE };
+  fQueues[unpacker].push_back(sub);
+}
+
+
+Int_t FairMbsUnpackPool::Run()
+{
+  fNext = 0;
+  if (fActive.size() > 1 && !fThreads.empty()) {
+    {
+      lock_guard<mutex> lock(fMutex);
+      fGeneration++;
+      fNBusy = fThreads.size();
+    }
+    fStart.notify_all();
+    RunJobs();
+    unique_lock<mutex> lock(fMutex);
+    fDone.wait(lock, [this] { return fNBusy == 0; });
+  } else {
+    RunJobs();
+  }
+
+  // a sub-event fails if one of its unpackers failed
+  vector<Bool_t> failed(fNSubEvents, kFALSE);
+  for (size_t i = 0; i < fActive.size(); i++) {
+    vector<SubEvent>& queue = fQueues[fActive[i]];
+    for (size_t j = 0; j < queue.size(); j++) {
+      if (!queue[j].fOk) {
+        failed[queue[j].fIndex] = kTRUE;
+      }
+    }
+    queue.clear();
+  }
+  fActive.clear();
+  fNSubEvents = 0;
+  return count(failed.begin(), failed.end(), kTRUE);
+}
+
+
+void FairMbsUnpackPool::Work()
+{
+  Long64_t generation = 0;
+  while (true) {
+    {
+      unique_lock<mutex> lock(fMutex);
+      fStart.wait(lock, [&] { return fStop || fGeneration != generation; });
+      if (fStop) {
+        return;
+      }
+      generation = fGeneration;
+    }
+    RunJobs();
+    {
+      lock_guard<mutex> lock(fMutex);
+      fNBusy--;
+    }
+    fDone.notify_one();
+  }
+}
+
+
+void FairMbsUnpackPool::RunJobs()
+{
+  size_t k;
+  while ((k = fNext++) < fActive.size()) {
+    FairUnpack* unpack = static_cast<FairUnpack*>(fUnpackers->At(fActive[k]));
+    vector<SubEvent>& queue = fQueues[fActive[k]];
+    for (size_t i = 0; i < queue.size(); i++) {
+      queue[i].fOk = unpack->DoUnpack(queue[i].fData, queue[i].fSize);
+    }
+  }
+}
+
+
+static inline ULong64_t DispatchKey(Short_t type, Short_t subType,
+                                    Short_t procId, Short_t control) {
+  return (static_cast<ULong64_t>(static_cast<UShort_t>(type)) << 48) |
+         (static_cast<ULong64_t>(static_cast<UShort_t>(subType)) << 32) |
+         (static_cast<ULong64_t>(static_cast<UShort_t>(procId)) << 16) |
+         static_cast<ULong64_t>(static_cast<UShort_t>(control));
+}
+
+
+FairMbsSource::FairMbsSource()
+    : FairOnlineSource(), fDispatch(), fNDispatched(-1), fNThreads(1),
+      fPool(NULL) {}
 
 FairMbsSource::FairMbsSource(const FairMbsSource &source)
-    : FairOnlineSource(source) {}
+    : FairOnlineSource(source), fDispatch(), fNDispatched(-1),
+      fNThreads(source.GetNThreads()), fPool(NULL) {}
 
 FairMbsSource::~FairMbsSource() {
+  delete fPool;
+}
+
+Bool_t FairMbsSource::InitUnpackers() {
+  if (!FairOnlineSource::InitUnpackers()) {
+    return kFALSE;
+  }
+  BuildDispatchTable();
+  return kTRUE;
+}
+
+void FairMbsSource::BuildDispatchTable() {
+  fDispatch.clear();
+  fNDispatched = fUnpackers->GetEntriesFast();
+  for (Int_t i = 0; i < fNDispatched; i++) {
+    FairUnpack *unpack = static_cast<FairUnpack*>(fUnpackers->At(i));
+    fDispatch[DispatchKey(unpack->GetType(), unpack->GetSubType(),
+                          unpack->GetProcId(), unpack->GetControl())].push_back(i);
+  }
+
+  delete fPool;
+  fPool = NULL;
+  if (fNThreads > 1) {
+    fPool = new FairMbsUnpackPool(fUnpackers, fNThreads);
+    LOG(INFO) << "FairMbsSource: unpacking sub-events on " << fNThreads
+              << " threads" << FairLogger::endl;
+  }
 }
 
 Bool_t FairMbsSource::Unpack(Int_t *data, Int_t size, Short_t type,
@@ -35,32 +242,49 @@ Bool_t FairMbsSource::Unpack(Int_t *data, Int_t size, Short_t type,
              << " ProcId " << procId << " SubCrate " << subCrate
              << " Control " << control
              << FairLogger::endl;
-  
+
+  if (fNDispatched != fUnpackers->GetEntriesFast()) {
+    BuildDispatchTable();
+  }
+
+  unordered_map<ULong64_t, vector<Int_t> >::const_iterator it =
+      fDispatch.find(DispatchKey(type, subType, procId, control));
+  if (it == fDispatch.end()) {
+    return kFALSE;
+  }
+
+  // Event and buffer headers (negative type) are unpacked at once
+  Bool_t deferred = fPool && type >= 0;
+
   FairUnpack *unpack;
   Bool_t seen = kFALSE;
-  for (Int_t i = 0; i < fUnpackers->GetEntriesFast(); i++) {
-    unpack = static_cast<FairUnpack*>(fUnpackers->At(i));
+  const vector<Int_t>& candidates = it->second;
+  for (size_t i = 0; i < candidates.size(); i++) {
+    unpack = static_cast<FairUnpack*>(fUnpackers->At(candidates[i]));
 
-    if (unpack->GetSubCrate() < 0) { // All sub-crates
-      if (type != unpack->GetType() || subType != unpack->GetSubType() ||
-          procId != unpack->GetProcId() || control != unpack->GetControl()) {
-        continue;
-      }
-    } else { // specified sub-crate
-      if (type != unpack->GetType() || subType != unpack->GetSubType() ||
-          procId != unpack->GetProcId() || subCrate != unpack->GetSubCrate() ||
-          control != unpack->GetControl()) {
-        continue;
-      }
+    if (unpack->GetSubCrate() >= 0 && subCrate != unpack->GetSubCrate()) {
+      continue;
     }
 
-    if (!unpack->DoUnpack(data, size)) {
+    if (deferred) {
+      fPool->Add(candidates[i], data, size);
+    } else if (!unpack->DoUnpack(data, size)) {
       return kFALSE;
     }
 
     seen = kTRUE;
   }
+  if (deferred && seen) {
+    fPool->NextSubEvent();
+  }
   return seen;
 }
 
+Int_t FairMbsSource::FinishUnpack() {
+  if (!fPool) {
+    return 0;
+  }
+  return fPool->Run();
+}
+
 ClassImp(FairMbsSource)
@@ -21,7 +21,34 @@
 
 #include "FairUnpack.h"
 
+#include <unordered_map>
+#include <vector>
 
+class FairMbsUnpackPool;
+
+
+/**
+ * Base of the sources of MBS data. Unpack passes a sub-event to the
+ * unpackers registered for its type, sub-type, processor id, sub-crate and
+ * control. The unpackers are looked up in a table which is built by
+ * InitUnpackers; unpackers with a negative sub-crate get the sub-events of
+ * all sub-crates.
+ *
+ * With SetNThreads(n > 1) the sub-events of an event are unpacked on n
+ * threads. All sub-events of one unpacker are unpacked in order by the same
+ * thread, so every unpacker fills only its own output, different unpackers
+ * run concurrently. Unpack then only collects the sub-events, they are
+ * unpacked by FinishUnpack, which ReadEvent has to call before it returns.
+ * The unpackers must not share any state.
+ *
+ * The result of a sub-event is the same in both modes: it fails if one of
+ * its unpackers fails, the other sub-events are unpacked anyway. With
+ * several threads Unpack returns kTRUE for a collected sub-event, and
+ * FinishUnpack returns the number of collected sub-events which failed, so
+ * ReadEvent can apply the same rule to the event as with one thread. Only
+ * the unpackers after a failed one of the same sub-event are not called
+ * with one thread, but called with several.
+ */
 class FairMbsSource : public FairOnlineSource
 {
   public:
@@ -33,11 +60,34 @@ class FairMbsSource : public FairOnlineSource
     virtual Int_t ReadEvent(UInt_t=0) = 0;
     virtual void Close() = 0;
 
+    virtual Bool_t InitUnpackers();
+
+    /** Number of threads unpacking the sub-events of an event (default 1).
+     ** Has to be set before Init. **/
+    void SetNThreads(Int_t nThreads) { fNThreads = nThreads; }
+    Int_t GetNThreads() const { return fNThreads; }
+
   protected:
     Bool_t Unpack(Int_t* data, Int_t size,
                   Short_t type, Short_t subType,
                   Short_t procId, Short_t subCrate, Short_t control);
 
+    /** Unpacks the sub-events collected by Unpack if several threads are
+     ** used. Returns the number of collected sub-events for which one of
+     ** the unpackers failed, 0 with one thread. **/
+    Int_t FinishUnpack();
+
+  private:
+    void BuildDispatchTable();
+
+    /** Unpacker indices by type, sub-type, processor id and control **/
+    std::unordered_map<ULong64_t, std::vector<Int_t> > fDispatch; //!
+    Int_t fNDispatched; //! number of unpackers in fDispatch
+    Int_t fNThreads;
+    FairMbsUnpackPool* fPool; //!
+
+    FairMbsSource& operator=(const FairMbsSource&);
+
     ClassDef(FairMbsSource, 0)
 };
 
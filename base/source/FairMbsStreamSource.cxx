@@ -137,10 +137,15 @@ Int_t FairMbsStreamSource::ReadEvent(UInt_t)
     if(! Unpack(fxEventData, sebuflength,
                 setype, sesubtype,
                 seprocid, sesubcrate, secontrol)) {
+      FinishUnpack();
       return 2;
     }
   }
 
+  if(FinishUnpack() > 0) {
+    return 2;
+  }
+
   return 0;
 }
 
@@ -29,6 +29,7 @@
 #include "FairRuntimeDb.h"              // for FairRuntimeDb
 #include "TRandom.h"                    // for TRandom, gRandom
 #include "TROOT.h"
+#include "TEnv.h"
 #include <list>                         // for _List_iterator, list, etc
 using std::map;
 using std::set;
@@ -76,7 +77,12 @@ FairMixedSource::FairMixedSource(TFile *f, const char* Title, UInt_t)
    fNoOfSignals(0),
    fSignalChainList(NULL),
    fBackgroundChain(NULL),
-   fSignalTypeList()
+   fSignalTypeList(),
+   fSchedule(),
+   fScheduleIndex(0),
+   fScheduleBlockSize(1000),
+   fChainCacheSize(10000000),
+   fAsyncPrefetching(kFALSE)
 {
    if (fRootFile->IsZombie()) {
      LOG(FATAL) << "Error opening the Input file" << FairLogger::endl;
@@ -128,7 +134,12 @@ FairMixedSource::FairMixedSource(const TString* RootFileName, const char* Title,
     fNoOfSignals(0),
     fSignalChainList(NULL),
     fBackgroundChain(NULL),
-    fSignalTypeList()
+    fSignalTypeList(),
+    fSchedule(),
+    fScheduleIndex(0),
+    fScheduleBlockSize(1000),
+    fChainCacheSize(10000000),
+    fAsyncPrefetching(kFALSE)
 {
   fRootFile = TFile::Open(RootFileName->Data());
   if (fRootFile->IsZombie()) {
@@ -180,7 +191,12 @@ FairMixedSource::FairMixedSource(const TString RootFileName, const Int_t signalI
    fNoOfSignals(0),
    fSignalChainList(NULL),
    fBackgroundChain(NULL),
-  fSignalTypeList()
+  fSignalTypeList(),
+   fSchedule(),
+   fScheduleIndex(0),
+   fScheduleBlockSize(1000),
+   fChainCacheSize(10000000),
+   fAsyncPrefetching(kFALSE)
 {
     fRootFile = TFile::Open(RootFileName.Data());
 
@@ -310,6 +326,17 @@ Bool_t FairMixedSource::Init()
     fNoOfEntries = fBackgroundChain->GetEntries();
     FairRootManager::Instance()->SetInChain(fBackgroundChain,0);
 
+    // Each chain gets its own cache, so switching between background and
+    // signal entries does not discard the baskets read for the other chains.
+    if ( fAsyncPrefetching ) {
+      gEnv->SetValue("TFile.AsyncPrefetching", 1);
+    }
+    InitChainCache(fBackgroundChain);
+    std::map<UInt_t, TChain*>::const_iterator chainIter;
+    for(chainIter = fSignalTypeList.begin(); chainIter != fSignalTypeList.end(); chainIter++) {
+      InitChainCache(chainIter->second);
+    }
+
     for(Int_t i=0; i<fListFolder->GetEntriesFast(); i++) {
       TFolder* fold = static_cast<TFolder*>(fListFolder->At(i));
       fEvtHeader = static_cast<FairEventHeader*>(fold->FindObjectAny("EventHeader."));
@@ -341,46 +368,20 @@ Int_t FairMixedSource::ReadEvent(UInt_t i)
 {
   SetEventTime();
 
-  Double_t SBratio=gRandom->Uniform(0,1);
-  Bool_t GetASignal=kFALSE;
-
   if(fSBRatiobyN || fSBRatiobyT ) {
-    std::map<UInt_t, Double_t>::const_iterator iterN;
-    Double_t ratio=0;
-    if(fCurrentEntryNo==0) {
-      for(iterN = fSignalBGN.begin(); iterN != fSignalBGN.end(); iterN++) {
-        ratio+=iterN->second;
-        fSignalBGN[iterN->first]=ratio;
-        LOG(DEBUG) << "--------------Set signal no. " << iterN->first << " weight " << ratio << "." << FairLogger::endl;
-      }
-    }
-    ratio=0;
-    for(iterN = fSignalBGN.begin(); iterN != fSignalBGN.end(); iterN++) {
-      ratio=iterN->second;
-      LOG(DEBUG) << "---Check signal no. " << iterN->first << " SBratio " << SBratio << " : ratio " << ratio << FairLogger::endl;
-      if(SBratio <=ratio) {
-        TChain* chain = fSignalTypeList[iterN->first];
-        UInt_t entry = fCurrentEntry[iterN->first];
-        chain->GetEntry(entry);
-        fOutHeader->SetMCEntryNumber(entry);
-        fOutHeader->SetInputFileId(iterN->first);
-        fOutHeader->SetEventTime(GetEventTime());
-        GetASignal=kTRUE;
-        fCurrentEntry[iterN->first]=entry+1;
-        LOG(DEBUG) << "---Get entry No. " << entry << " from signal chain number --- " << iterN->first << " --- " << FairLogger::endl;
-        break;
-      }
+    if(fScheduleIndex >= fSchedule.size()) {
+      FillSchedule();
     }
-    if(!GetASignal) {
-      UInt_t entry = fCurrentEntry[0];
-      fBackgroundChain->GetEntry(entry);
-      fOutHeader->SetMCEntryNumber(entry);
-      fOutHeader->SetInputFileId(0); //Background files has always 0 as Id
-      fOutHeader->SetEventTime(GetEventTime());
-      fCurrentEntry[0]=entry+1;
-      LOG(DEBUG) << "---Get entry from background chain  --- " << FairLogger::endl;
-    }
-    
+    UInt_t chainId = fSchedule[fScheduleIndex].first;
+    UInt_t entry = fSchedule[fScheduleIndex].second;
+    fScheduleIndex++;
+
+    TChain* chain = chainId == 0 ? fBackgroundChain : fSignalTypeList[chainId];
+    chain->GetEntry(entry);
+    fOutHeader->SetMCEntryNumber(entry);
+    fOutHeader->SetInputFileId(chainId); //Background files has always 0 as Id
+    fOutHeader->SetEventTime(GetEventTime());
+    LOG(DEBUG) << "---Get entry No. " << entry << " from chain number --- " << chainId << " --- " << FairLogger::endl;
   }
 
   fCurrentEntryNo=i;
@@ -389,6 +390,64 @@ Int_t FairMixedSource::ReadEvent(UInt_t i)
 
   return 0;
 }
+void FairMixedSource::FillSchedule()
+{
+  // cumulative signal weights, the rest is background
+  std::vector<std::pair<UInt_t, Double_t> > weights;
+  Double_t ratio=0;
+  std::map<UInt_t, Double_t>::const_iterator iterN;
+  for(iterN = fSignalBGN.begin(); iterN != fSignalBGN.end(); iterN++) {
+    ratio+=iterN->second;
+    weights.push_back(std::make_pair(iterN->first, ratio));
+    LOG(DEBUG2) << "--------------Signal no. " << iterN->first << " weight " << ratio << "." << FairLogger::endl;
+  }
+
+  UInt_t nEvents = fScheduleBlockSize > 0 ? fScheduleBlockSize : 1;
+  fSchedule.clear();
+  fScheduleIndex = 0;
+  // entry range of each chain in this block
+  std::map<UInt_t, std::pair<UInt_t, UInt_t> > ranges;
+  for(UInt_t n = 0; n < nEvents; n++) {
+    Double_t SBratio=gRandom->Uniform(0,1);
+    UInt_t chainId = 0;
+    for(size_t k = 0; k < weights.size(); k++) {
+      if(SBratio <= weights[k].second) {
+        chainId = weights[k].first;
+        break;
+      }
+    }
+    UInt_t entry = fCurrentEntry[chainId]++;
+    fSchedule.push_back(std::make_pair(chainId, entry));
+    if(ranges.find(chainId) == ranges.end()) {
+      ranges[chainId] = std::make_pair(entry, entry);
+    } else {
+      ranges[chainId].second = entry;
+    }
+  }
+
+  // Let the caches prefetch only the entries needed in this block
+  if(fChainCacheSize > 0 && nEvents > 1) {
+    std::map<UInt_t, std::pair<UInt_t, UInt_t> >::const_iterator iterR;
+    for(iterR = ranges.begin(); iterR != ranges.end(); iterR++) {
+      TChain* chain = iterR->first == 0 ? fBackgroundChain : fSignalTypeList[iterR->first];
+      chain->LoadTree(iterR->second.first);
+      chain->SetCacheEntryRange(iterR->second.first, iterR->second.second + 1);
+    }
+  }
+  LOG(DEBUG) << "FairMixedSource: scheduled " << nEvents << " events from "
+             << ranges.size() << " chains" << FairLogger::endl;
+}
+
+void FairMixedSource::InitChainCache(TChain* chain)
+{
+  if(fChainCacheSize <= 0 || !chain) {
+    return;
+  }
+  chain->SetCacheSize(fChainCacheSize);
+  LOG(DEBUG) << "FairMixedSource: cache of " << fChainCacheSize << " bytes for chain "
+             << chain->GetName() << FairLogger::endl;
+}
+
 void FairMixedSource::Close()
 {
 }
@@ -18,6 +18,7 @@
 
 #include "FairSource.h"
 #include <list>    
+#include <vector>
 #include "TChain.h"
 #include "TFile.h"
 #include "TF1.h"
@@ -126,6 +127,17 @@ public:
     void                SetEvtHeaderNew(Bool_t Status) {fEvtHeaderIsNew = Status;}
     Bool_t              IsEvtHeaderNew() {return fEvtHeaderIsNew;}
 
+    /**Set the number of events for which the signal and background entries are chosen in advance
+     *@param nEvents :  events per block (default 1000), 0 chooses the entry when the event is read
+     */
+    void                SetScheduleBlockSize(UInt_t nEvents) {fScheduleBlockSize = nEvents;}
+    /**Set the size of the TTreeCache of the background and each signal chain, has to be set before Init
+     *@param bytes :  cache size (default 10 MB), 0 disables the caches
+     */
+    void                SetChainCacheSize(Long64_t bytes) {fChainCacheSize = bytes;}
+    /**Fill the chain caches with the asynchronous prefetching thread of ROOT (remote files only), has to be set before Init*/
+    void                SetAsyncPrefetching(Bool_t prefetch=kTRUE) {fAsyncPrefetching = prefetch;}
+
 private:
     /**IO manager */
     FairRootManager*         fRootManager;
@@ -217,6 +229,18 @@ private:
     TChain*                              fBackgroundChain; //!
     std::map<UInt_t, TChain*>            fSignalTypeList;//!
 
+    /** Sequence of (chain identifier, entry) of the next events, background has identifier 0 */
+    std::vector<std::pair<UInt_t, UInt_t> > fSchedule; //!
+    /** Next event in fSchedule */
+    size_t                               fScheduleIndex; //!
+    UInt_t                               fScheduleBlockSize; //!
+    Long64_t                             fChainCacheSize; //!
+    Bool_t                               fAsyncPrefetching; //!
+
+    /** Chooses the chains and entries of the next block of events */
+    void FillSchedule();
+    void InitChainCache(TChain* chain);
+
     FairMixedSource(const FairMixedSource&);
     FairMixedSource& operator=(const FairMixedSource&);
     
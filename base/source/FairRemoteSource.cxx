@@ -10,24 +10,242 @@
 // -----                          FairRemoteSource                         -----
 // -----                    Created 12.04.2013 by D.Kresan                 -----
 // -----------------------------------------------------------------------------
-#include <unistd.h>
+#include <sys/socket.h>
 #include <iostream>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
 using namespace std;
 
 #include "ptrevmbsdef.h"          // MBS data definitions
 
 #include "TSocket.h"
 
+#include "FairLogger.h"
 #include "MRevBuffer.h"
 #include "FairRemoteSource.h"
 
 
+// Gets the events from MRevBuffer, in a thread if a buffer size is given.
+// MRevBuffer returns pointers into its receive buffer, which is overwritten
+// with the next buffer from the server, so the events are copied.
+class FairRemoteSourceReceiver
+{
+  public:
+    struct SubEvent {
+      Int_t fOffset;
+      Int_t fSize;
+      Short_t fType;
+      Short_t fSubType;
+      Short_t fProcId;
+      Short_t fSubCrate;
+      Short_t fControl;
+    };
+
+    struct Event {
+      vector<Int_t> fData;
+      vector<SubEvent> fSubEvents;
+      chrono::steady_clock::time_point fArrival;
+    };
+
+    FairRemoteSourceReceiver(MRevBuffer* buffer, TSocket* socket, Int_t size);
+    ~FairRemoteSourceReceiver();
+
+    /** Next event, NULL at the end of the data. Valid until the next call. **/
+    Event* Next();
+    /** Stops the receiver thread **/
+    void Stop();
+
+    atomic<Long64_t> fNReceived;
+    Long64_t fNRead;
+    Double_t fWaitTime;
+    Double_t fLatency;
+    chrono::steady_clock::time_point fStart;
+    chrono::steady_clock::time_point fLast;
+
+  private:
+    void Run();
+    static void Copy(REvent* revent, Event& event);
+
+    MRevBuffer* fBuffer;
+    TSocket* fSocket;
+    vector<Event> fRing;
+    size_t fHead;
+    size_t fCount;
+    Event fCurrent;
+    Bool_t fStop;
+    Bool_t fEnd;
+    Bool_t fRunning;
+    Bool_t fInRevGet;
+    mutex fMutex;
+    condition_variable fNotEmpty;
+    condition_variable fNotFull;
+    condition_variable fStopped;
+    thread fThread;
+};
+
+
+FairRemoteSourceReceiver::FairRemoteSourceReceiver(MRevBuffer* buffer, TSocket* socket, Int_t size)
+  : fNReceived(0),
+    fNRead(0),
+    fWaitTime(0.),
+    fLatency(0.),
+    fStart(chrono::steady_clock::now()),
+    fLast(fStart),
+    fBuffer(buffer),
+    fSocket(socket),
+    fRing(size > 0 ? size : 0),
+    fHead(0),
+    fCount(0),
+    fCurrent(),
+    fStop(kFALSE),
+    fEnd(kFALSE),
+    fRunning(size > 0),
+    fInRevGet(kFALSE),
+    fMutex(),
+    fNotEmpty(),
+    fNotFull(),
+    fStopped(),
+    fThread()
+{
+  if (fRunning) {
+    fThread = thread(&FairRemoteSourceReceiver::Run, this);
+  }
+}
+
+
+FairRemoteSourceReceiver::~FairRemoteSourceReceiver()
+{
+  Stop();
+}
+
+
+void FairRemoteSourceReceiver::Copy(REvent* revent, Event& event)
+{
+  // the event header counts 16 bit words after the first two words
+  Int_t* data = revent->GetData();
+  Int_t nWords = revent->ReGetSize()/2 + 2;
+  event.fData.assign(data, data + nWords);
+  event.fSubEvents.resize(revent->nSubEvt);
+  for (Int_t i = 0; i < revent->nSubEvt; i++) {
+    SubEvent& sub = event.fSubEvents[i];
+    sub.fOffset = revent->pSubEvt[i] - data;
+    sub.fSize = revent->subEvtSize[i];
+    sub.fType = revent->subEvtType[i];
+    sub.fSubType = revent->subEvtSubType[i];
+    sub.fProcId = revent->subEvtProcId[i];
+    sub.fSubCrate = revent->subEvtSubCrate[i];
+    sub.fControl = revent->subEvtControl[i];
+  }
+  event.fArrival = chrono::steady_clock::now();
+}
+
+
+void FairRemoteSourceReceiver::Run()
+{
+  Event received;
+  while (kTRUE) {
+    {
+      unique_lock<mutex> lock(fMutex);
+      while (fCount == fRing.size() && !fStop) {
+        fNotFull.wait(lock);
+      }
+      if (fStop) {
+        break;
+      }
+      fInRevGet = kTRUE;
+    }
+
+    REvent* revent = fBuffer->RevGet(fSocket, 0, 0);
+    fBuffer->RevStatus(0);
+    if (revent) {
+      Copy(revent, received);
+    }
+
+    unique_lock<mutex> lock(fMutex);
+    fInRevGet = kFALSE;
+    if (!revent) {
+      break;
+    }
+    // the ring keeps the vectors, so their memory is reused
+    swap(fRing[(fHead + fCount) % fRing.size()], received);
+    fCount++;
+    fNReceived++;
+    fNotEmpty.notify_one();
+  }
+
+  lock_guard<mutex> lock(fMutex);
+  fEnd = kTRUE;
+  fRunning = kFALSE;
+  fNotEmpty.notify_all();
+  fStopped.notify_all();
+}
+
+
+FairRemoteSourceReceiver::Event* FairRemoteSourceReceiver::Next()
+{
+  chrono::steady_clock::time_point start = chrono::steady_clock::now();
+
+  if (fRing.empty()) {
+    REvent* revent = fBuffer->RevGet(fSocket, 0, 0);
+    fBuffer->RevStatus(0);
+    if (!revent) {
+      return NULL;
+    }
+    Copy(revent, fCurrent);
+    fNReceived++;
+  } else {
+    unique_lock<mutex> lock(fMutex);
+    while (fCount == 0 && !fEnd) {
+      fNotEmpty.wait(lock);
+    }
+    if (fCount == 0) {
+      return NULL;
+    }
+    swap(fCurrent, fRing[fHead]);
+    fHead = (fHead + 1) % fRing.size();
+    fCount--;
+    fNotFull.notify_one();
+  }
+
+  fLast = chrono::steady_clock::now();
+  fWaitTime += chrono::duration<Double_t>(fLast - start).count();
+  fLatency += chrono::duration<Double_t>(fLast - fCurrent.fArrival).count();
+  fNRead++;
+  return &fCurrent;
+}
+
+
+void FairRemoteSourceReceiver::Stop()
+{
+  if (!fThread.joinable()) {
+    return;
+  }
+  unique_lock<mutex> lock(fMutex);
+  fStop = kTRUE;
+  fNotFull.notify_all();
+  // a receiver waiting for data from the server is woken up by shutting
+  // down the connection if no event arrives within a second
+  if (!fStopped.wait_for(lock, chrono::seconds(1), [this] { return !fRunning; })
+      && fInRevGet) {
+    LOG(WARNING) << "FairRemoteSource: no data from the server, closing the connection" << FairLogger::endl;
+    shutdown(fSocket->GetDescriptor(), SHUT_RDWR);
+  }
+  lock.unlock();
+  fThread.join();
+}
+
+
 FairRemoteSource::FairRemoteSource(char* node)
   : FairMbsSource(),
     fNode(node),
     fSocket(NULL),
     fBuffer(new MRevBuffer(1)),
-    fREvent(NULL)
+    fBufferSize(1000),
+    fReceiver(NULL)
 {
 }
 
@@ -37,13 +255,15 @@ FairRemoteSource::FairRemoteSource(const FairRemoteSource& source)
     fNode(const_cast<char*>(source.GetNode())),
     fSocket(NULL),
     fBuffer(new MRevBuffer(1)),
-    fREvent(NULL)
+    fBufferSize(source.GetBufferSize()),
+    fReceiver(NULL)
 {
 }
 
 
 FairRemoteSource::~FairRemoteSource()
 {
+  delete fReceiver;
   delete fBuffer;
 }
 
@@ -56,32 +276,38 @@ Bool_t FairRemoteSource::Init()
   if(! fSocket) {
     return kFALSE;
   }
+  delete fReceiver;
+  fReceiver = new FairRemoteSourceReceiver(fBuffer, fSocket, fBufferSize);
   return kTRUE;
 }
 
 
 Int_t FairRemoteSource::ReadEvent(UInt_t)
 {
-  usleep(10000);
-  fREvent = fBuffer->RevGet(fSocket, 0, 0);
-  fBuffer->RevStatus(0);
-  if(! fREvent) {
+  FairRemoteSourceReceiver::Event* event = fReceiver ? fReceiver->Next() : NULL;
+  if(! event) {
     return 1;
   }
 
   // Decode event header
-  Bool_t result = Unpack(fREvent->GetData(), sizeof(sMbsEv101), -2, -2, -2, -2, -2);
-
-  for(Int_t i = 0; i < fREvent->nSubEvt; i++) {
-    if(Unpack(fREvent->pSubEvt[i], fREvent->subEvtSize[i],
-              fREvent->subEvtType[i], fREvent->subEvtSubType[i],
-              fREvent->subEvtProcId[i], fREvent->subEvtSubCrate[i],
-              fREvent->subEvtControl[i])) {
-      result = kTRUE;
+  Int_t* data = &(event->fData[0]);
+  // number of sub-events and headers unpacked, the event fails if there is none
+  Int_t nUnpacked = Unpack(data, sizeof(sMbsEv101), -2, -2, -2, -2, -2) ? 1 : 0;
+
+  for(size_t i = 0; i < event->fSubEvents.size(); i++) {
+    const FairRemoteSourceReceiver::SubEvent& sub = event->fSubEvents[i];
+    if(Unpack(data + sub.fOffset, sub.fSize,
+              sub.fType, sub.fSubType,
+              sub.fProcId, sub.fSubCrate,
+              sub.fControl)) {
+      nUnpacked++;
     }
   }
 
-  if(! result) {
+  // with several threads the collected sub-events are unpacked now
+  nUnpacked -= FinishUnpack();
+
+  if(nUnpacked <= 0) {
     return 2;
   }
 
@@ -91,11 +317,52 @@ Int_t FairRemoteSource::ReadEvent(UInt_t)
 
 void FairRemoteSource::Close()
 {
+  if (fReceiver) {
+    fReceiver->Stop();
+    LOG(INFO) << "FairRemoteSource: " << GetNEventsRead() << " events read, "
+              << GetEventRate() << " events/s, mean wait "
+              << 1.e3*GetMeanWaitTime() << " ms, mean latency "
+              << 1.e3*GetMeanLatency() << " ms" << FairLogger::endl;
+  }
   fBuffer->RevClose(fSocket);
   fBuffer->RevStatus(0);
 }
 
 
+Long64_t FairRemoteSource::GetNEventsReceived() const
+{
+  return fReceiver ? fReceiver->fNReceived.load() : 0;
+}
+
+
+Long64_t FairRemoteSource::GetNEventsRead() const
+{
+  return fReceiver ? fReceiver->fNRead : 0;
+}
+
+
+Double_t FairRemoteSource::GetEventRate() const
+{
+  if (!fReceiver || fReceiver->fNRead == 0) {
+    return 0.;
+  }
+  Double_t time = chrono::duration<Double_t>(fReceiver->fLast - fReceiver->fStart).count();
+  return time > 0. ? fReceiver->fNRead / time : 0.;
+}
+
+
+Double_t FairRemoteSource::GetMeanWaitTime() const
+{
+  return (fReceiver && fReceiver->fNRead > 0) ? fReceiver->fWaitTime / fReceiver->fNRead : 0.;
+}
+
+
+Double_t FairRemoteSource::GetMeanLatency() const
+{
+  return (fReceiver && fReceiver->fNRead > 0) ? fReceiver->fLatency / fReceiver->fNRead : 0.;
+}
+
+
 ClassImp(FairRemoteSource)
 
 
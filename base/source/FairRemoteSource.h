@@ -19,9 +19,17 @@
 
 class TSocket;
 class MRevBuffer;
-class REvent;
+class FairRemoteSourceReceiver;
 
 
+/**
+ * Reads events from a remote MBS event server.
+ *
+ * A receiver thread gets the events from the server and copies them into
+ * a ring of SetBufferSize() events, so the network transfer overlaps with
+ * the unpacking. ReadEvent only waits if the ring is empty. With a buffer
+ * size of 0 the events are requested by ReadEvent itself.
+ */
 class FairRemoteSource : public FairMbsSource
 {
   public:
@@ -35,11 +43,27 @@ class FairRemoteSource : public FairMbsSource
 
     inline const char* GetNode() const { return fNode; }
 
+    /** Number of events buffered by the receiver thread (default 1000),
+     ** 0 reads the events synchronously. Has to be set before Init. **/
+    void SetBufferSize(Int_t nEvents) { fBufferSize = nEvents; }
+    Int_t GetBufferSize() const { return fBufferSize; }
+
+    /** Statistics since Init **/
+    Long64_t GetNEventsReceived() const;
+    Long64_t GetNEventsRead() const;
+    /** Events read per second **/
+    Double_t GetEventRate() const;
+    /** Mean time ReadEvent had to wait for an event [s] **/
+    Double_t GetMeanWaitTime() const;
+    /** Mean time between the arrival of an event and its unpacking [s] **/
+    Double_t GetMeanLatency() const;
+
   private:
     char* fNode;
     TSocket* fSocket;
     MRevBuffer* fBuffer;
-    REvent* fREvent;
+    Int_t fBufferSize;
+    FairRemoteSourceReceiver* fReceiver; //!
 
     FairRemoteSource& operator=(const FairRemoteSource&);
     
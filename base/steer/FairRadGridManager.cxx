@@ -15,13 +15,28 @@
 #include <iostream>
 #include "FairRadGridManager.h"
 #include "FairRootManager.h"
+#include "FairLogger.h"
+#include "TH2.h"
 #include "TLorentzVector.h"
+#include "TMath.h"
 #include "TParticle.h"
 #include "TVirtualMC.h"
 #include "FairMesh.h"
 
+#include <algorithm>
+#include <mutex>
+
 using namespace std;
 
+namespace
+{
+  /** upper limit of grid cells per axis */
+  const Int_t kMaxCellsPerAxis = 64;
+
+  /** serializes adding the buffers of several managers to the shared histograms */
+  std::mutex gMergeMutex;
+}
+
 ClassImp(FairRadGridManager)
 
 FairRadGridManager* FairRadGridManager::fgInstance = NULL;
@@ -51,13 +66,23 @@ FairRadGridManager::FairRadGridManager()
     fRadl(0),
     fAbsl(0),
     fEstimator(0),
-    fMeshList(NULL)
+    fMeshList(NULL),
+    fScores(),
+    fTouchedMeshes(),
+    fCellStart(),
+    fCellMeshes()
 {
   /** radiation length default ctor */
   if(NULL == fgInstance) {
     fgInstance = this;
   }
   fLtmp=0;
+  for (Int_t i = 0; i < 3; ++i) {
+    fGridMin[i] = 0.;
+    fGridMax[i] = 0.;
+    fGridScale[i] = 0.;
+    fGridN[i] = 0;
+  }
 }
 
 FairRadGridManager::~FairRadGridManager()
@@ -69,6 +94,7 @@ FairRadGridManager::~FairRadGridManager()
 void FairRadGridManager::Init()
 {
 //  fMeshList = new TObjArray();
+  BuildGrid();
 }
 
 void FairRadGridManager::Reset()
@@ -77,56 +103,242 @@ void FairRadGridManager::Reset()
   //  fMesh->Reset();
 }
 
+void FairRadGridManager::BuildGrid()
+{
+  fScores.clear();
+  fTouchedMeshes.clear();
+  fCellStart.assign(2, 0);
+  fCellMeshes.clear();
+  for (Int_t i = 0; i < 3; ++i) {
+    fGridN[i] = 1;
+    fGridScale[i] = 0.;
+  }
+
+  if (!fMeshList) {
+    return;
+  }
+
+  // scoring buffers and the bounding box of all meshes
+  Bool_t first = kTRUE;
+  for (Int_t i=0; i<fMeshList->GetEntriesFast(); i++ ) {
+    FairMesh* aMesh = dynamic_cast<FairMesh*>(fMeshList->At(i));
+    if (!aMesh || !aMesh->GetMeshTid()) {
+      LOG(WARNING) << "FairRadGridManager: entry " << i << " of the mesh list is not a calculated FairMesh, ignored" << FairLogger::endl;
+      continue;
+    }
+
+    MeshScore score;
+    score.fMesh = aMesh;
+    score.fMin[0] = aMesh->GetXmin();
+    score.fMin[1] = aMesh->GetYmin();
+    score.fMin[2] = aMesh->GetZmin();
+    score.fMax[0] = aMesh->GetXmax();
+    score.fMax[1] = aMesh->GetYmax();
+    score.fMax[2] = aMesh->GetZmax();
+    score.fNX = aMesh->GetNXbin();
+    score.fNY = aMesh->GetNYbin();
+    score.fBinScaleX = score.fNX / (score.fMax[0] - score.fMin[0]);
+    score.fBinScaleY = score.fNY / (score.fMax[1] - score.fMin[1]);
+    score.fBinVolume = aMesh->GetBinVolume();
+    score.fDiag = aMesh->GetDiag();
+    for (Int_t type = 0; type < kNScores; ++type) {
+      score.fSumW[type].assign((score.fNX + 2) * (score.fNY + 2), 0.);
+      score.fSumW2[type].assign((score.fNX + 2) * (score.fNY + 2), 0.);
+      score.fEntries[type] = 0;
+    }
+    score.fTouched = kFALSE;
+    fScores.push_back(score);
+
+    for (Int_t axis = 0; axis < 3; ++axis) {
+      if (first || score.fMin[axis] < fGridMin[axis]) { fGridMin[axis] = score.fMin[axis]; }
+      if (first || score.fMax[axis] > fGridMax[axis]) { fGridMax[axis] = score.fMax[axis]; }
+    }
+    first = kFALSE;
+  }
+
+  if (fScores.empty()) {
+    return;
+  }
+
+  // about two cells per mesh and axis, no subdivision of flat directions
+  Int_t nPerAxis = TMath::Min(kMaxCellsPerAxis, 2 * TMath::CeilNint(TMath::Power(Double_t(fScores.size()), 1./3.)));
+  for (Int_t axis = 0; axis < 3; ++axis) {
+    Double_t extent = fGridMax[axis] - fGridMin[axis];
+    fGridN[axis] = (extent > 0.) ? nPerAxis : 1;
+    fGridScale[axis] = (extent > 0.) ? fGridN[axis] / extent : 0.;
+  }
+
+  // cell ranges covered by each mesh, counted first, then filled (compressed rows)
+  Int_t nCells = fGridN[0] * fGridN[1] * fGridN[2];
+  vector<Int_t> lo(3 * fScores.size());
+  vector<Int_t> hi(3 * fScores.size());
+  fCellStart.assign(nCells + 1, 0);
+  for (size_t m = 0; m < fScores.size(); ++m) {
+    for (Int_t axis = 0; axis < 3; ++axis) {
+      lo[3 * m + axis] = TMath::Min(fGridN[axis] - 1, Int_t((fScores[m].fMin[axis] - fGridMin[axis]) * fGridScale[axis]));
+      hi[3 * m + axis] = TMath::Min(fGridN[axis] - 1, Int_t((fScores[m].fMax[axis] - fGridMin[axis]) * fGridScale[axis]));
+    }
+    for (Int_t iz = lo[3 * m + 2]; iz <= hi[3 * m + 2]; ++iz) {
+      for (Int_t iy = lo[3 * m + 1]; iy <= hi[3 * m + 1]; ++iy) {
+        for (Int_t ix = lo[3 * m]; ix <= hi[3 * m]; ++ix) {
+          ++fCellStart[(iz * fGridN[1] + iy) * fGridN[0] + ix + 1];
+        }
+      }
+    }
+  }
+  for (Int_t c = 0; c < nCells; ++c) {
+    fCellStart[c + 1] += fCellStart[c];
+  }
+  fCellMeshes.resize(fCellStart[nCells]);
+  vector<Int_t> fill(fCellStart.begin(), fCellStart.end() - 1);
+  for (size_t m = 0; m < fScores.size(); ++m) {
+    for (Int_t iz = lo[3 * m + 2]; iz <= hi[3 * m + 2]; ++iz) {
+      for (Int_t iy = lo[3 * m + 1]; iy <= hi[3 * m + 1]; ++iy) {
+        for (Int_t ix = lo[3 * m]; ix <= hi[3 * m]; ++ix) {
+          fCellMeshes[fill[(iz * fGridN[1] + iy) * fGridN[0] + ix]++] = Int_t(m);
+        }
+      }
+    }
+  }
+
+  LOG(INFO) << "FairRadGridManager: " << fScores.size() << " meshes on a grid of "
+            << fGridN[0] << "x" << fGridN[1] << "x" << fGridN[2] << " cells, "
+            << Double_t(fCellMeshes.size()) / nCells << " meshes per cell" << FairLogger::endl;
+}
+
+Int_t FairRadGridManager::FindCell(Double_t x, Double_t y, Double_t z) const
+{
+  if (x < fGridMin[0] || x > fGridMax[0] ||
+      y < fGridMin[1] || y > fGridMax[1] ||
+      z < fGridMin[2] || z > fGridMax[2]) {
+    return -1;
+  }
+  Int_t ix = TMath::Min(fGridN[0] - 1, Int_t((x - fGridMin[0]) * fGridScale[0]));
+  Int_t iy = TMath::Min(fGridN[1] - 1, Int_t((y - fGridMin[1]) * fGridScale[1]));
+  Int_t iz = TMath::Min(fGridN[2] - 1, Int_t((z - fGridMin[2]) * fGridScale[2]));
+  return (iz * fGridN[1] + iy) * fGridN[0] + ix;
+}
+
 void FairRadGridManager::FillMeshList()
 {
 
   /**Add a point to the collection*/
-  TParticle* part = TVirtualMC::GetMC()->GetStack()->GetCurrentTrack();
-  fTrackID = TVirtualMC::GetMC()->GetStack()->GetCurrentTrackNumber();
-  TVirtualMC::GetMC()->TrackPosition(fPosIn);
-  TVirtualMC::GetMC()->TrackMomentum(fMomIn);
-  fELoss = 0.;
+  TVirtualMC* mc = TVirtualMC::GetMC();
+  mc->TrackPosition(fPosIn);
+
+  if (fScores.empty()) {
+    return;
+  }
+  Int_t cell = FindCell(fPosIn.X(), fPosIn.Y(), fPosIn.Z());
+  if (cell < 0) {
+    return;
+  }
+
+  TParticle* part = NULL;
+  Double_t eDep = 0.;
+  Double_t step = 0.;
 //  Int_t MatId=  TVirtualMC::GetMC()->CurrentMaterial(fA, fZmat, fDensity, fRadl, fAbsl);
 
   /** Sum energy loss for all steps in the mesh*/
-  for (Int_t i=0; i<fMeshList->GetEntriesFast(); i++ ) {
-    FairMesh* aMesh = static_cast<FairMesh*>(fMeshList->At(i));
-    Double_t fBinVolume = aMesh->GetBinVolume();
-    Double_t fDiag = aMesh->GetDiag();
+  for (Int_t k = fCellStart[cell]; k < fCellStart[cell + 1]; ++k) {
+    MeshScore& score = fScores[fCellMeshes[k]];
 
     // Geometry bound test
-    if ( IsTrackInside(fPosIn,aMesh) ) {
-      fELoss = TVirtualMC::GetMC()->Edep();
-      //cout << "-I- track (" << fTrackID << ")  is inside " << endl;
-      //cout << " E deposited is " << fELoss << endl;
-      TVirtualMC::GetMC()->TrackPosition(fPosOut);
-      TVirtualMC::GetMC()->TrackMomentum(fMomOut);
-
-      // Now cumulate fEloss (Gev/cm3)
-      // and normalize it to the mesh volume
-
-      // 1 estimator Edep
-      fELoss = fELoss/fBinVolume;
-      // 2 estimator TrackLengh
-      fLength = TVirtualMC::GetMC()->TrackStep();
-      // fill TID
-
-      aMesh->fillTID(fPosOut.X(),fPosOut.Y(),fELoss);
-      // fill total Fluence
-      if ( fLength < 5*fDiag ) {
-
-        fLength = fLength/fBinVolume;
-        aMesh->fillFluence(fPosOut.X(),fPosOut.Y(),fLength);
-
-        // fill SEU
-        if ( part->P() > 0.02 ) {
-          aMesh->fillSEU(fPosOut.X(),fPosOut.Y(),fLength);
-        }
-      }
+    if ( (fPosIn.X() < score.fMin[0]) || (fPosIn.X() > score.fMax[0]) ||
+         (fPosIn.Y() < score.fMin[1]) || (fPosIn.Y() > score.fMax[1]) ||
+         (fPosIn.Z() < score.fMin[2]) || (fPosIn.Z() > score.fMax[2]) ) {
+      continue;
+    }
+
+    if (!part) {
+      // track information only for steps inside of a mesh
+      part = mc->GetStack()->GetCurrentTrack();
+      fTrackID = mc->GetStack()->GetCurrentTrackNumber();
+      mc->TrackMomentum(fMomIn);
+      fPosOut = fPosIn;
+      fMomOut = fMomIn;
+      eDep = mc->Edep();
+      step = mc->TrackStep();
+    }
 
+    if (!score.fTouched) {
+      score.fTouched = kTRUE;
+      fTouchedMeshes.push_back(fCellMeshes[k]);
     }
 
+    // Now cumulate fEloss (Gev/cm3)
+    // and normalize it to the mesh volume
+
+    // 1 estimator Edep
+    fELoss = eDep/score.fBinVolume;
+    // 2 estimator TrackLengh
+    fLength = step;
+    // fill TID
+    Score(score, kTid, fPosOut.X(), fPosOut.Y(), fELoss);
+    // fill total Fluence
+    if ( fLength < 5*score.fDiag ) {
+
+      fLength = fLength/score.fBinVolume;
+      Score(score, kFlu, fPosOut.X(), fPosOut.Y(), fLength);
+
+      // fill SEU
+      if ( part->P() > 0.02 ) {
+        Score(score, kSeu, fPosOut.X(), fPosOut.Y(), fLength);
+      }
+    }
+  }
+}
+
+void FairRadGridManager::Score(MeshScore& score, Int_t type, Double_t x, Double_t y, Double_t w)
+{
+  // same bin numbering as TH2::Fill, including under- and overflow
+  Int_t ix = (x < score.fMin[0]) ? 0 : ((x >= score.fMax[0]) ? score.fNX + 1 : 1 + Int_t((x - score.fMin[0]) * score.fBinScaleX));
+  Int_t iy = (y < score.fMin[1]) ? 0 : ((y >= score.fMax[1]) ? score.fNY + 1 : 1 + Int_t((y - score.fMin[1]) * score.fBinScaleY));
+  Int_t bin = iy * (score.fNX + 2) + ix;
+  score.fSumW[type][bin] += w;
+  score.fSumW2[type][bin] += w * w;
+  ++score.fEntries[type];
+}
+
+void FairRadGridManager::FinishEvent()
+{
+  if (fTouchedMeshes.empty()) {
+    return;
+  }
+
+  std::lock_guard<std::mutex> lock(gMergeMutex);
+  for (size_t i = 0; i < fTouchedMeshes.size(); ++i) {
+    MeshScore& score = fScores[fTouchedMeshes[i]];
+    Merge(score, kTid, score.fMesh->GetMeshTid());
+    Merge(score, kFlu, score.fMesh->GetMeshFlu());
+    Merge(score, kSeu, score.fMesh->GetMeshSEU());
+    score.fTouched = kFALSE;
+  }
+  fTouchedMeshes.clear();
+}
+
+void FairRadGridManager::Merge(MeshScore& score, Int_t type, TH2D* hist)
+{
+  if (score.fEntries[type] == 0) {
+    return;
+  }
+
+  Double_t entries = hist->GetEntries();
+  TArrayD* sumw2 = hist->GetSumw2();
+  vector<Double_t>& sumW = score.fSumW[type];
+  vector<Double_t>& sumW2 = score.fSumW2[type];
+  for (size_t bin = 0; bin < sumW.size(); ++bin) {
+    if (sumW2[bin] != 0.) {
+      hist->AddBinContent(bin, sumW[bin]);
+      sumw2->fArray[bin] += sumW2[bin];
+      sumW[bin] = 0.;
+      sumW2[bin] = 0.;
+    }
   }
+  // statistics are recomputed from the bin contents
+  hist->ResetStats();
+  hist->SetEntries(entries + score.fEntries[type]);
+  score.fEntries[type] = 0;
 }
 
 Bool_t FairRadGridManager::IsTrackEntering(TLorentzVector&,
@@ -20,13 +20,20 @@
 #include "TObjArray.h"                  // for TObjArray
 
 #include <iostream>                     // for basic_ostream::operator<<, etc
+#include <vector>                       // for vector
 
 class FairMesh;
 class TClonesArray;
+class TH2D;
 
 
 /**
  * @class FairRadGridManager
+ * Scoring of dose (TID), fluence and SEU in the meshes of the mesh list.
+ * At Init() a uniform grid is laid over the bounding boxes of all meshes,
+ * each cell knowing the meshes overlapping it, so a step only tests the
+ * meshes of its cell. The scores are accumulated in plain per mesh buffers
+ * and added to the mesh histograms at the end of each event.
  */
 
 
@@ -95,7 +102,52 @@ class FairRadGridManager
     /** the mesh */
     TObjArray* fMeshList;
 
+    enum { kTid, kFlu, kSeu, kNScores };
+
+    /** scoring buffer of a mesh */
+    struct MeshScore {
+      FairMesh* fMesh;
+      Double_t fMin[3];
+      Double_t fMax[3];
+      /** bins per cm in x and y */
+      Double_t fBinScaleX;
+      Double_t fBinScaleY;
+      /** bins in x and y, without under-/overflow */
+      Int_t fNX;
+      Int_t fNY;
+      Double_t fBinVolume;
+      Double_t fDiag;
+      /** sum of weights and of squared weights per histogram bin (TH2 numbering) */
+      std::vector<Double_t> fSumW[kNScores];
+      std::vector<Double_t> fSumW2[kNScores];
+      Long64_t fEntries[kNScores];
+      Bool_t fTouched;
+    };
+
+    /** mesh scoring buffers, in the order of the mesh list */
+    std::vector<MeshScore> fScores;  //!
+    /** meshes touched in the current event */
+    std::vector<Int_t> fTouchedMeshes;  //!
+
+    /** uniform grid over the bounding box of all meshes */
+    Double_t fGridMin[3];  //!
+    Double_t fGridMax[3];  //!
+    Double_t fGridScale[3];  //! cells per cm
+    Int_t fGridN[3];  //!
+    /** first entry of each cell in fCellMeshes, one more entry than cells */
+    std::vector<Int_t> fCellStart;  //!
+    /** indices of the meshes overlapping each cell */
+    std::vector<Int_t> fCellMeshes;  //!
+
     static Double_t fLtmp;
+
+    /** builds the scoring buffers and the grid from the mesh list */
+    void BuildGrid();
+    /** @return index of the grid cell containing the point, -1 if outside of all meshes */
+    Int_t FindCell(Double_t x, Double_t y, Double_t z) const;
+    void Score(MeshScore& score, Int_t type, Double_t x, Double_t y, Double_t w);
+    void Merge(MeshScore& score, Int_t type, TH2D* hist);
+
   public:
 
     TObjArray* GetMeshList() { return fMeshList; }
@@ -107,6 +159,8 @@ class FairRadGridManager
     Bool_t  IsTrackEntering(TLorentzVector& vec1,TLorentzVector& vec2);
     /** fill the 2D mesh */
     void FillMeshList();
+    /** add the scores of the event to the mesh histograms */
+    void FinishEvent();
     /**initialize the manager*/
     void  Init();
     /**reset*/
@@ -13,6 +13,7 @@
 #include "FairRadLenManager.h"
 
 #include "FairRadLenPoint.h"            // for FairRadLenPoint
+#include "FairRadScorer.h"              // for FairRadScorer
 #include "FairRootManager.h"            // for FairRootManager
 
 #include "TClonesArray.h"               // for TClonesArray
@@ -50,7 +51,10 @@ FairRadLenManager::FairRadLenManager()
     fZmat(0),
     fDensity(0),
     fRadl(0),
-    fAbsl(0)
+    fAbsl(0),
+    fPointOutput(kTRUE),
+    fAggregate(kFALSE),
+    fScorer(new FairRadScorer("RadLen"))
 {
   /** radiation length default ctor */
   if(NULL == fgInstance) {
@@ -65,12 +69,22 @@ FairRadLenManager::~FairRadLenManager()
   fgInstance = NULL;
   fPointCollection->Delete();
   delete fPointCollection;
+  delete fScorer;
 }
 
 void FairRadLenManager::Init()
 {
   /**create the branch for output */
-  FairRootManager::Instance()->Register("RadLen","RadLenPoint", fPointCollection, kTRUE);
+  if (fPointOutput) {
+    FairRootManager::Instance()->Register("RadLen","RadLenPoint", fPointCollection, kTRUE);
+  }
+}
+
+void FairRadLenManager::Finish()
+{
+  if (fAggregate) {
+    fScorer->Write();
+  }
 }
 
 void FairRadLenManager::Reset()
@@ -81,28 +95,50 @@ void FairRadLenManager::Reset()
 
 void FairRadLenManager::AddPoint(Int_t& ModuleId)
 {
+  TVirtualMC* mc = TVirtualMC::GetMC();
+  Int_t copyNo;
+
+  if ( fAggregate && mc->IsNewTrack() ) {
+    fVolumeID = mc->CurrentVolID(copyNo);
+    mc->TrackMomentum(fMomIn);
+    fScorer->StartTrack(fMomIn.X(), fMomIn.Y(), fMomIn.Z());
+  }
   /**Add a point to the collection*/
-  if ( TVirtualMC::GetMC()->IsTrackEntering() ) {
+  if ( mc->IsTrackEntering() ) {
     fELoss  = 0.;
-    Int_t copyNo;
-    fVolumeID = TVirtualMC::GetMC()->CurrentVolID(copyNo);
-    fTime   = TVirtualMC::GetMC()->TrackTime() * 1.0e09;
-    fLength = TVirtualMC::GetMC()->TrackLength();
-    TVirtualMC::GetMC()->TrackPosition(fPosIn);
-    TVirtualMC::GetMC()->TrackMomentum(fMomIn);
-    //    Int_t MatId=  TVirtualMC::GetMC()->CurrentMaterial(fA, fZmat, fDensity, fRadl, fAbsl);
-    TVirtualMC::GetMC()->CurrentMaterial(fA, fZmat, fDensity, fRadl, fAbsl);
+    fVolumeID = mc->CurrentVolID(copyNo);
+    if (fAggregate) {
+      fScorer->AddCrossing(fVolumeID);
+    }
+    if (fPointOutput) {
+      fTime   = mc->TrackTime() * 1.0e09;
+      fLength = mc->TrackLength();
+      mc->TrackPosition(fPosIn);
+      mc->TrackMomentum(fMomIn);
+      /** the material is asked from the MC only once per volume */
+      const FairRadScorer::Material& mat = fScorer->GetMaterial(fVolumeID);
+      fA = mat.fA;
+      fZmat = mat.fZmat;
+      fDensity = mat.fDensity;
+      fRadl = mat.fRadl;
+      fAbsl = mat.fAbsl;
+    }
   }
   /** Sum energy loss for all steps in the active volume */
-  fELoss += TVirtualMC::GetMC()->Edep();
+  Double_t eDep = mc->Edep();
+  fELoss += eDep;
+  if (fAggregate) {
+    fScorer->AddStep(fVolumeID, mc->TrackStep(), eDep);
+  }
   /**  Create a point at exit of the volume */
-  if ( TVirtualMC::GetMC()->IsTrackExiting()    ||
-       TVirtualMC::GetMC()->IsTrackStop()       ||
-       TVirtualMC::GetMC()->IsTrackDisappeared()   ) {
+  if ( fPointOutput && (
+       mc->IsTrackExiting()    ||
+       mc->IsTrackStop()       ||
+       mc->IsTrackDisappeared() ) ) {
 //    FairRadLenPoint* p=0;
-    fTrackID  = TVirtualMC::GetMC()->GetStack()->GetCurrentTrackNumber();
-    TVirtualMC::GetMC()->TrackPosition(fPosOut);
-    TVirtualMC::GetMC()->TrackMomentum(fMomOut);
+    fTrackID  = mc->GetStack()->GetCurrentTrackNumber();
+    mc->TrackPosition(fPosOut);
+    mc->TrackMomentum(fMomOut);
     TClonesArray& clref = *fPointCollection;
     Int_t tsize = clref.GetEntriesFast();
 //    p=new(clref[tsize]) FairRadLenPoint(fTrackID, ModuleId,
@@ -116,5 +152,3 @@ void FairRadLenManager::AddPoint(Int_t& ModuleId)
   }
 
 }
-
-
@@ -16,10 +16,16 @@
 #include "Rtypes.h"                     // for Float_t, Double_t, Int_t, etc
 #include "TLorentzVector.h"             // for TLorentzVector
 
+class FairRadScorer;
 class TClonesArray;
 
 /**
  * @class FairRadLenManager
+ * Material budget scoring. By default a FairRadLenPoint is stored for every
+ * volume crossing (branch RadLen). In aggregated mode the path length, energy
+ * loss and x/X0 are summed per volume and x/X0 per (eta,phi) of the track
+ * direction instead, and written as histograms into the directory RadLen of
+ * the output file at the end of the run (see FairRadScorer).
  */
 
 
@@ -84,12 +90,27 @@ class FairRadLenManager
     Float_t        fRadl;
     /**absorption length */
     Float_t        fAbsl;
+    /** store a point for every volume crossing */
+    Bool_t         fPointOutput;       //!
+    /** sum per volume and direction */
+    Bool_t         fAggregate;         //!
+    /** aggregated scores and material cache */
+    FairRadScorer* fScorer;            //!
 
   public:
     /**Add point to collection*/
     void  AddPoint(Int_t& ModuleId);
+    /**
+     * Switches the aggregated scoring on, and the point output off
+     * (can be switched on again as debug output). Has to be called before Init().
+     */
+    void  SetAggregatedScoring(Bool_t aggregate=kTRUE) { fAggregate = aggregate; fPointOutput = !aggregate; }
+    /** Switches the output of FairRadLenPoints on/off. Has to be called before Init(). */
+    void  SetPointOutput(Bool_t output=kTRUE) { fPointOutput = output; }
     /**initialize the manager*/
     void  Init();
+    /**write the aggregated scores, at the end of the run*/
+    void  Finish();
     /**reset*/
     void  Reset();
     /**
@@ -12,6 +12,7 @@
 #include "FairRadMapManager.h"
 
 #include "FairRadMapPoint.h"            // for FairRadMapPoint
+#include "FairRadScorer.h"              // for FairRadScorer
 #include "FairRootManager.h"            // for FairRootManager
 
 #include <iosfwd>                       // for ostream
@@ -66,7 +67,11 @@ FairRadMapManager::FairRadMapManager()
     fAbsl(0),
     fActVol(0),
     fActMass(0),
-    fMassMap(NULL)
+    fMassMap(NULL),
+    fVolumeMass(),
+    fPointOutput(kTRUE),
+    fAggregate(kFALSE),
+    fScorer(new FairRadScorer("RadMap", "dose per volume;;Gy"))
 {
   /** radiation length default ctor */
   if(NULL == fgInstance) {
@@ -84,12 +89,15 @@ FairRadMapManager::~FairRadMapManager()
   fPointCollection->Delete();
   delete fPointCollection;
   delete fMassMap;
+  delete fScorer;
 }
 
 void FairRadMapManager::Init()
 {
   /**create the branch for output */
-  FairRootManager::Instance()->Register("RadMap","RadMapPoint", fPointCollection, kTRUE);
+  if (fPointOutput) {
+    FairRootManager::Instance()->Register("RadMap","RadMapPoint", fPointCollection, kTRUE);
+  }
   cout << "RadMapMan initialized" << endl;
 
   // compute once the masses of the volumes in this simulation and store them in a TMap object
@@ -116,6 +124,10 @@ void FairRadMapManager::Init()
     TVectorD* vomass= new TVectorD(1,1,vmass,"END"); // 1-dim vector
 
     fMassMap->Add(myvolume,vomass);
+    if (myvolume->GetNumber() >= static_cast<Int_t>(fVolumeMass.size())) {
+      fVolumeMass.resize(myvolume->GetNumber() + 1, 0.);
+    }
+    fVolumeMass[myvolume->GetNumber()] = vmass;
 
     cout <<  myvolume->GetName() << " has " << vmass << " kg" << endl;
 
@@ -124,6 +136,13 @@ void FairRadMapManager::Init()
 
 }
 
+void FairRadMapManager::Finish()
+{
+  if (fAggregate) {
+    fScorer->Write();
+  }
+}
+
 void FairRadMapManager::Reset()
 {
   /**We have to free the momeory, Clear() is faster but not enough! */
@@ -133,8 +152,16 @@ void FairRadMapManager::Reset()
 
 void FairRadMapManager::AddPoint(Int_t&)
 {
+  TVirtualMC* mc = TVirtualMC::GetMC();
+  Int_t copyNo;
+
+  if ( fAggregate && mc->IsNewTrack() ) {
+    fVolumeID = mc->CurrentVolID(copyNo);
+    mc->TrackMomentum(fMomIn);
+    fScorer->StartTrack(fMomIn.X(), fMomIn.Y(), fMomIn.Z());
+  }
   /**Add a point to the collection*/
-  if ( TVirtualMC::GetMC()->IsTrackEntering() ) {
+  if ( mc->IsTrackEntering() ) {
     fELoss  = 0.;
     fStep = 0.;
     fDose = 0.;
@@ -142,31 +169,42 @@ void FairRadMapManager::AddPoint(Int_t&)
     fPdg = 0;
     fActVol = 0.;
     fActMass = 0.;
-    Int_t copyNo;
-    fVolumeID = TVirtualMC::GetMC()->CurrentVolID(copyNo);
-    fTime   = TVirtualMC::GetMC()->TrackTime() * 1.0e09;
-    fLength = TVirtualMC::GetMC()->TrackLength();
-    TVirtualMC::GetMC()->TrackPosition(fPosIn);
-    TVirtualMC::GetMC()->TrackMomentum(fMomIn);
-    //    Int_t MatId=  TVirtualMC::GetMC()->CurrentMaterial(fA, fZmat, fDensity, fRadl, fAbsl);
-    TVirtualMC::GetMC()->CurrentMaterial(fA, fZmat, fDensity, fRadl, fAbsl);
+    fVolumeID = mc->CurrentVolID(copyNo);
+    fTime   = mc->TrackTime() * 1.0e09;
+    fLength = mc->TrackLength();
+    mc->TrackPosition(fPosIn);
+    mc->TrackMomentum(fMomIn);
+    /** the material is asked from the MC only once per volume */
+    const FairRadScorer::Material& mat = fScorer->GetMaterial(fVolumeID);
+    fA = mat.fA;
+    fZmat = mat.fZmat;
+    fDensity = mat.fDensity;
+    fRadl = mat.fRadl;
+    fAbsl = mat.fAbsl;
 
     //    if (!gGeoManager) { GetGeoManager(); }
     //    TGeoVolume* actVolume = gGeoManager->GetCurrentVolume();
-    TGeoVolume* actVolume = gGeoManager->GetVolume(fVolumeID);
-
-    TVectorD* ActMass = static_cast<TVectorD*>(fMassMap->GetValue(actVolume));
-
-    fActMass = ActMass->Min(); // read from TVectorD
+    // the volume id of the MC is the volume number of the TGeoManager
+    if (fVolumeID >= 0 && fVolumeID < static_cast<Int_t>(fVolumeMass.size())) {
+      fActMass = fVolumeMass[fVolumeID];
+    }
 
     //    cout << actVolume->GetName() << " has " << fActMass << " kg" << endl;
 
+    if (fAggregate) {
+      fScorer->AddCrossing(fVolumeID);
+    }
   }
   /** Sum energy loss for all steps in the active volume */
-  fELoss += TVirtualMC::GetMC()->Edep();
-  fStep  += TVirtualMC::GetMC()->TrackStep();
+  Double_t eDep = mc->Edep();
+  Double_t step = mc->TrackStep();
+  fELoss += eDep;
+  fStep  += step;
+  if (fAggregate) {
+    fScorer->AddStep(fVolumeID, step, eDep);
+  }
 
-  fPdg = TVirtualMC::GetMC()->TrackPid();
+  fPdg = mc->TrackPid();
 
   // calculate the energy dose
   // exclude fragments with PDG code >= 10000
@@ -184,31 +222,33 @@ void FairRadMapManager::AddPoint(Int_t&)
   }
 
   /**  Create a point at exit of the volume */
-  if ( TVirtualMC::GetMC()->IsTrackExiting()    ||
-       TVirtualMC::GetMC()->IsTrackStop()       ||
-       TVirtualMC::GetMC()->IsTrackDisappeared()   ) {
-
-//    FairRadMapPoint* p=0;
-    fTrackID  = TVirtualMC::GetMC()->GetStack()->GetCurrentTrackNumber();
-    Int_t copyNo;
-    Int_t fVolID = TVirtualMC::GetMC()->CurrentVolID(copyNo); // CAVEAT: fVolID is NOT an unique identifier!!
-    TVirtualMC::GetMC()->TrackPosition(fPosOut);
-    TVirtualMC::GetMC()->TrackMomentum(fMomOut);
-
-    TClonesArray& clref = *fPointCollection;
-    Int_t tsize = clref.GetEntriesFast();
-
-//    p=new(clref[tsize]) FairRadMapPoint(fTrackID, fVolID,
-    new(clref[tsize]) FairRadMapPoint(fTrackID, fVolID,
-                                        TVector3(fPosIn.X(),fPosIn.Y(),fPosIn.Z()),
-                                        TVector3(fMomIn.X(),fMomIn.Y(),fMomIn.Z()),
-                                        fTime, fLength, fELoss,
-                                        TVector3(fPosOut.X(),fPosOut.Y(),fPosOut.Z()),
-                                        TVector3(fMomOut.X(),fMomOut.Y(),fMomOut.Z()),
-                                        fA, fZmat, fDensity, fActMass, fStep, fDose, fDoseSL, fPdg);
-
+  if ( mc->IsTrackExiting()    ||
+       mc->IsTrackStop()       ||
+       mc->IsTrackDisappeared()   ) {
+
+    if (fAggregate && fDose > 0.) {
+      fScorer->AddExtra(fVolumeID, fDose);
+    }
+
+    if (fPointOutput) {
+//      FairRadMapPoint* p=0;
+      fTrackID  = mc->GetStack()->GetCurrentTrackNumber();
+      Int_t fVolID = mc->CurrentVolID(copyNo); // CAVEAT: fVolID is NOT an unique identifier!!
+      mc->TrackPosition(fPosOut);
+      mc->TrackMomentum(fMomOut);
+
+      TClonesArray& clref = *fPointCollection;
+      Int_t tsize = clref.GetEntriesFast();
+
+//      p=new(clref[tsize]) FairRadMapPoint(fTrackID, fVolID,
+      new(clref[tsize]) FairRadMapPoint(fTrackID, fVolID,
+                                          TVector3(fPosIn.X(),fPosIn.Y(),fPosIn.Z()),
+                                          TVector3(fMomIn.X(),fMomIn.Y(),fMomIn.Z()),
+                                          fTime, fLength, fELoss,
+                                          TVector3(fPosOut.X(),fPosOut.Y(),fPosOut.Z()),
+                                          TVector3(fMomOut.X(),fMomOut.Y(),fMomOut.Z()),
+                                          fA, fZmat, fDensity, fActMass, fStep, fDose, fDoseSL, fPdg);
+    }
   }
 
 }
-
-
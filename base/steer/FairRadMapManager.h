@@ -14,11 +14,18 @@
 #include "Rtypes.h"                     // for Double_t, Float_t, Int_t, etc
 #include "TLorentzVector.h"             // for TLorentzVector
 
+#include <vector>                       // for vector
+
+class FairRadScorer;
 class TClonesArray;
 class TMap;
 
 /**
  * @class FairRadMapManager
+ * Dose scoring. By default a FairRadMapPoint is stored for every volume
+ * crossing (branch RadMap). In aggregated mode the path length, energy loss,
+ * x/X0 and dose are summed per volume instead, and written as histograms into
+ * the directory RadMap of the output file at the end of the run (see FairRadScorer).
  */
 
 
@@ -95,13 +102,30 @@ class FairRadMapManager
     Double_t       fActMass;
 
     TMap* fMassMap;
+    /** mass per volume number, filled in Init() */
+    std::vector<Double_t> fVolumeMass; //!
+    /** store a point for every volume crossing */
+    Bool_t         fPointOutput;       //!
+    /** sum per volume */
+    Bool_t         fAggregate;         //!
+    /** aggregated scores and material cache */
+    FairRadScorer* fScorer;            //!
 
 
   public:
     /**Add point to collection*/
     void  AddPoint(Int_t& ModuleId);
+    /**
+     * Switches the aggregated scoring on, and the point output off
+     * (can be switched on again as debug output). Has to be called before Init().
+     */
+    void  SetAggregatedScoring(Bool_t aggregate=kTRUE) { fAggregate = aggregate; fPointOutput = !aggregate; }
+    /** Switches the output of FairRadMapPoints on/off. Has to be called before Init(). */
+    void  SetPointOutput(Bool_t output=kTRUE) { fPointOutput = output; }
     /**initialize the manager*/
     void  Init();
+    /**write the aggregated scores, at the end of the run*/
+    void  Finish();
     /**reset*/
     void  Reset();
     /**
@@ -0,0 +1,158 @@
+/********************************************************************************
+ *    Copyright (C) 2014 GSI Helmholtzzentrum fuer Schwerionenforschung GmbH    *
+ *                                                                              *
+ *              This software is distributed under the terms of the             *
+ *         GNU Lesser General Public Licence version 3 (LGPL) version 3,        *
+ *                  copied verbatim in the file "LICENSE"                       *
+ ********************************************************************************/
+// -------------------------------------------------------------------------
+// -----                    FairRadScorer source file                  -----
+// -------------------------------------------------------------------------
+#include "FairRadScorer.h"
+
+#include "FairRootManager.h"            // for FairRootManager
+#include "FairLogger.h"                 // for FairLogger, LOG
+
+#include "TDirectory.h"                 // for TDirectory, gDirectory
+#include "TFile.h"                      // for TFile
+#include "TH1.h"                        // for TH1D
+#include "TH2.h"                        // for TH2D
+#include "TMath.h"                      // for Sqrt, Log, Tan, ATan2, Pi
+#include "TVirtualMC.h"                 // for TVirtualMC
+
+using namespace std;
+
+FairRadScorer::FairRadScorer(const char* name, const char* extraName)
+  : fName(name),
+    fExtraName(extraName),
+    fMaterials(),
+    fMaterialCached(),
+    fPathLength(),
+    fELoss(),
+    fX0(),
+    fExtra(),
+    fCrossings(),
+    fX0Map(new TH2D(fName + "X0EtaPhiSum", "sum of x/X0;#eta;#phi", 100, -5., 5., 90, -TMath::Pi(), TMath::Pi())),
+    fTrackMap(new TH2D(fName + "TracksEtaPhi", "tracks;#eta;#phi", 100, -5., 5., 90, -TMath::Pi(), TMath::Pi())),
+    fTrackX0(0.),
+    fTrackBin(-1)
+{
+  fX0Map->SetDirectory(0);
+  fTrackMap->SetDirectory(0);
+}
+
+FairRadScorer::~FairRadScorer()
+{
+  delete fX0Map;
+  delete fTrackMap;
+}
+
+const FairRadScorer::Material& FairRadScorer::GetMaterial(Int_t volId)
+{
+  if (volId >= static_cast<Int_t>(fMaterials.size())) {
+    Resize(volId + 1);
+  }
+  if (!fMaterialCached[volId]) {
+    Material& mat = fMaterials[volId];
+    // the current volume is the one asked for, the cache is filled on the first step in it
+    TVirtualMC::GetMC()->CurrentMaterial(mat.fA, mat.fZmat, mat.fDensity, mat.fRadl, mat.fAbsl);
+    fMaterialCached[volId] = kTRUE;
+  }
+  return fMaterials[volId];
+}
+
+void FairRadScorer::StartTrack(Double_t px, Double_t py, Double_t pz)
+{
+  FinishTrack();
+
+  Double_t pt = TMath::Sqrt(px * px + py * py);
+  fTrackBin = -1;
+  if (pt > 0.) {
+    Double_t eta = -TMath::Log(TMath::Tan(0.5 * TMath::ATan2(pt, pz)));
+    Double_t phi = TMath::ATan2(py, px);
+    Int_t bin = fTrackMap->FindFixBin(eta, phi);
+    if (!fTrackMap->IsBinUnderflow(bin) && !fTrackMap->IsBinOverflow(bin)) {
+      fTrackBin = bin;
+      fTrackMap->AddBinContent(bin);
+    }
+  }
+}
+
+void FairRadScorer::FinishTrack()
+{
+  if (fTrackBin >= 0) {
+    fX0Map->AddBinContent(fTrackBin, fTrackX0);
+  }
+  fTrackBin = -1;
+  fTrackX0 = 0.;
+}
+
+void FairRadScorer::Resize(Int_t nVolumes)
+{
+  Material none = { 0., 0., 0., 0., 0. };
+  fMaterials.resize(nVolumes, none);
+  fMaterialCached.resize(nVolumes, kFALSE);
+  fPathLength.resize(nVolumes, 0.);
+  fELoss.resize(nVolumes, 0.);
+  fX0.resize(nVolumes, 0.);
+  fExtra.resize(nVolumes, 0.);
+  fCrossings.resize(nVolumes, 0.);
+}
+
+void FairRadScorer::Write()
+{
+  FinishTrack();
+
+  FairRootManager* rootManager = FairRootManager::Instance();
+  if (!rootManager || !rootManager->GetOutFile()) {
+    LOG(ERROR) << "FairRadScorer::Write(): no output file, " << fName << " histograms are not saved" << FairLogger::endl;
+    return;
+  }
+
+  TDirectory* savedir = gDirectory;
+  rootManager->GetOutFile()->cd();
+  gDirectory->mkdir(fName);
+  gDirectory->cd(fName);
+
+  // per volume sums, one bin per used volume, labelled with the volume name
+  vector<Int_t> used;
+  for (size_t id = 0; id < fPathLength.size(); ++id) {
+    if (fCrossings[id] > 0. || fPathLength[id] > 0.) {
+      used.push_back(id);
+    }
+  }
+  Int_t nBins = TMath::Max(static_cast<Int_t>(used.size()), 1);
+  TH1D pathLength(fName + "PathLength", "path length per volume;;cm", nBins, 0, nBins);
+  TH1D eLoss(fName + "ELoss", "energy loss per volume;;GeV", nBins, 0, nBins);
+  TH1D x0(fName + "X0", "x/X0 per volume", nBins, 0, nBins);
+  TH1D crossings(fName + "Crossings", "volume crossings", nBins, 0, nBins);
+  TH1D extra(fName + "Extra", fExtraName, nBins, 0, nBins);
+  for (size_t i = 0; i < used.size(); ++i) {
+    Int_t id = used[i];
+    const char* volName = TVirtualMC::GetMC() ? TVirtualMC::GetMC()->VolName(id) : "";
+    TH1D* hists[] = { &pathLength, &eLoss, &x0, &crossings, &extra };
+    Double_t values[] = { fPathLength[id], fELoss[id], fX0[id], fCrossings[id], fExtra[id] };
+    for (Int_t h = 0; h < 5; ++h) {
+      hists[h]->SetBinContent(i + 1, values[h]);
+      hists[h]->GetXaxis()->SetBinLabel(i + 1, volName);
+    }
+  }
+  pathLength.Write();
+  eLoss.Write();
+  x0.Write();
+  crossings.Write();
+  if (fExtraName.Length() > 0) {
+    extra.Write();
+  }
+
+  // average x/X0 per direction
+  TH2D* x0Mean = static_cast<TH2D*>(fX0Map->Clone(fName + "X0EtaPhi"));
+  x0Mean->SetTitle("mean x/X0;#eta;#phi");
+  x0Mean->Divide(fTrackMap);
+  x0Mean->Write();
+  fX0Map->Write();
+  fTrackMap->Write();
+  delete x0Mean;
+
+  gDirectory = savedir;
+}
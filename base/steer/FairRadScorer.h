@@ -0,0 +1,120 @@
+/********************************************************************************
+ *    Copyright (C) 2014 GSI Helmholtzzentrum fuer Schwerionenforschung GmbH    *
+ *                                                                              *
+ *              This software is distributed under the terms of the             *
+ *         GNU Lesser General Public Licence version 3 (LGPL) version 3,        *
+ *                  copied verbatim in the file "LICENSE"                       *
+ ********************************************************************************/
+// -------------------------------------------------------------------------
+// -----                    FairRadScorer header file                  -----
+// -------------------------------------------------------------------------
+#ifndef FAIRRADSCORER_H
+#define FAIRRADSCORER_H 1
+
+#include "Rtypes.h"                     // for Double_t, Int_t, etc
+#include "TString.h"                    // for TString
+
+#include <vector>                       // for vector
+
+class TH2D;
+
+/**
+ * @class FairRadScorer
+ * Aggregated scoring for the radiation length and radiation map managers.
+ * Instead of one point per volume crossing, the path length, energy loss,
+ * x/X0 and an additional per-manager quantity (e.g. dose) are summed per
+ * volume id, and x/X0 is summed per (eta,phi) bin of the initial track
+ * direction. The material properties are cached per volume id, so the
+ * MC is asked only once per volume.
+ * The sums are written as histograms into a directory of the output file.
+ */
+class FairRadScorer
+{
+
+  public:
+    struct Material {
+      Float_t fA;
+      Float_t fZmat;
+      Float_t fDensity;
+      Float_t fRadl;
+      Float_t fAbsl;
+    };
+
+    /**
+     * @param name prefix of the histograms and name of the output directory
+     * @param extraName title of the additional per-volume quantity, empty for none
+     */
+    FairRadScorer(const char* name, const char* extraName="");
+    virtual ~FairRadScorer();
+
+    /** material of the volume, from the MC at the first call for this volume */
+    const Material& GetMaterial(Int_t volId);
+
+    /** has to be called at the first step of each track */
+    void StartTrack(Double_t px, Double_t py, Double_t pz);
+
+    /** adds a step in the volume */
+    void AddStep(Int_t volId, Double_t step, Double_t eLoss)
+    {
+      if (volId >= static_cast<Int_t>(fPathLength.size())) {
+        Resize(volId + 1);
+      }
+      fPathLength[volId] += step;
+      fELoss[volId] += eLoss;
+      Float_t radl = GetMaterial(volId).fRadl;
+      if (radl > 0.) {
+        Double_t x0 = step / radl;
+        fX0[volId] += x0;
+        fTrackX0 += x0;
+      }
+    }
+
+    /** adds to the additional per-volume quantity */
+    void AddExtra(Int_t volId, Double_t value)
+    {
+      if (volId >= static_cast<Int_t>(fExtra.size())) {
+        Resize(volId + 1);
+      }
+      fExtra[volId] += value;
+    }
+
+    /** counts a volume crossing */
+    void AddCrossing(Int_t volId)
+    {
+      if (volId >= static_cast<Int_t>(fCrossings.size())) {
+        Resize(volId + 1);
+      }
+      fCrossings[volId] += 1.;
+    }
+
+    /** writes the histograms into the directory fName of the output file */
+    void Write();
+
+  private:
+    void Resize(Int_t nVolumes);
+    void FinishTrack();
+
+    TString fName;
+    TString fExtraName;
+
+    /** per volume id */
+    std::vector<Material> fMaterials;
+    std::vector<Bool_t> fMaterialCached;
+    std::vector<Double_t> fPathLength;
+    std::vector<Double_t> fELoss;
+    std::vector<Double_t> fX0;
+    std::vector<Double_t> fExtra;
+    std::vector<Double_t> fCrossings;
+
+    /** sum of x/X0 and number of tracks per (eta,phi) bin */
+    TH2D* fX0Map;
+    TH2D* fTrackMap;
+    /** x/X0 of the current track and its direction, bin -1 if outside the map */
+    Double_t fTrackX0;
+    Int_t fTrackBin;
+
+    FairRadScorer(const FairRadScorer&);
+    FairRadScorer& operator=(const FairRadScorer&);
+};
+
+#endif
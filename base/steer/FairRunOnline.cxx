@@ -39,20 +39,388 @@
 #include "TF1.h"
 #include "TSystem.h"
 #include "TFolder.h"
+#include "TDirectory.h"
 #include "TH1F.h"
 #include "TH2F.h"
 #include "THttpServer.h"
+#include "TCanvas.h"
+#include "RVersion.h"
 
 #include <signal.h>
 #include <stdlib.h>
 #include <iostream>
 #include <list>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
 
 using std::cout;
 using std::endl;
 using std::list;
 
 
+// Runs the THttpServer in its own thread. The server only sees copies of
+// the added objects: between two events the event loop copies the
+// histograms into a staging copy, the server thread copies the staging
+// copy into the served one when it is not processing requests. The event
+// loop never waits for the server; if the server thread is busy with the
+// copies, the snapshot is skipped. Commands of the clients are queued and
+// executed by the event loop on the original objects.
+class FairRunOnlineMonitor
+{
+  public:
+    FairRunOnlineMonitor(const TString& address, Int_t refreshRate);
+    ~FairRunOnlineMonitor();
+
+    THttpServer* GetServer() { return fServer; }
+    void SetSnapshotFraction(Double_t fraction) { fMaxFraction = fraction; }
+
+    void AddObject(const char* folder, TObject* object);
+    void RegisterCommand(const TString& name, const TString& command);
+    void QueueCommand(const TString& name);
+
+    /** Called after each event **/
+    void ProcessEvent();
+    void PrintStatistics() const;
+
+  private:
+    struct Entry {
+      TObject* fOriginal;
+      TObject* fStaging;
+      TObject* fServed;
+      TString fFolder;
+    };
+
+    void Run(TString address);
+    void Snapshot();
+    void ExecuteCommands();
+    TObject* FindOriginal(const TString& name) const;
+
+    static TObject* CloneObject(TObject* object);
+    static void CopyObject(TObject* from, TObject* to);
+    static void CopyList(TList* from, TList* to);
+    static Double_t Now();
+
+    THttpServer* fServer;
+    std::vector<Entry> fEntries;
+    size_t fNRegistered;
+    std::map<TString, TString> fCommands;
+    std::vector<TString> fNewCommands;
+    std::vector<TString> fQueued;
+    std::atomic<Int_t> fNQueued;
+    Bool_t fFresh;
+    Bool_t fStop;
+    Int_t fRefreshRate;
+    Int_t fInterval;
+    Int_t fNEvents;
+    Double_t fMaxFraction;
+    Double_t fLastSnapshot;
+    Long64_t fNSnapshots;
+    Long64_t fNSkipped;
+    Double_t fSnapshotTime;
+    std::mutex fMutex;
+    std::mutex fCommandMutex;
+    std::condition_variable fStarted;
+    std::thread fThread;
+};
+
+
+FairRunOnlineMonitor::FairRunOnlineMonitor(const TString& address, Int_t refreshRate)
+  : fServer(NULL),
+    fEntries(),
+    fNRegistered(0),
+    fCommands(),
+    fNewCommands(),
+    fQueued(),
+    fNQueued(0),
+    fFresh(kFALSE),
+    fStop(kFALSE),
+    fRefreshRate(refreshRate > 0 ? refreshRate : 1),
+    fInterval(fRefreshRate),
+    fNEvents(0),
+    fMaxFraction(0.01),
+    fLastSnapshot(Now()),
+    fNSnapshots(0),
+    fNSkipped(0),
+    fSnapshotTime(0.),
+    fMutex(),
+    fCommandMutex(),
+    fStarted(),
+    fThread()
+{
+#if ( ROOT_VERSION_CODE >= ROOT_VERSION(6,6,0) )
+  ROOT::EnableThreadSafety();
+#endif
+  // The server is created in its thread, it processes the requests only
+  // in the thread which created it
+  std::unique_lock<std::mutex> lock(fMutex);
+  fThread = std::thread(&FairRunOnlineMonitor::Run, this, address);
+  fStarted.wait(lock, [this] { return fServer != NULL; });
+}
+
+
+FairRunOnlineMonitor::~FairRunOnlineMonitor()
+{
+  {
+    std::lock_guard<std::mutex> lock(fMutex);
+    fStop = kTRUE;
+  }
+  fThread.join();
+  for (size_t i = 0; i < fEntries.size(); i++) {
+    delete fEntries[i].fStaging;
+    delete fEntries[i].fServed;
+  }
+}
+
+
+void FairRunOnlineMonitor::Run(TString address)
+{
+  THttpServer* server = new THttpServer(address);
+  // no timer, the requests are only processed here
+  server->SetTimer(0, kTRUE);
+  {
+    std::lock_guard<std::mutex> lock(fMutex);
+    fServer = server;
+  }
+  fStarted.notify_one();
+
+  while (kTRUE) {
+    {
+      std::lock_guard<std::mutex> lock(fMutex);
+      if (fStop) {
+        break;
+      }
+      for (; fNRegistered < fEntries.size(); fNRegistered++) {
+        fServer->Register(fEntries[fNRegistered].fFolder, fEntries[fNRegistered].fServed);
+      }
+      for (size_t i = 0; i < fNewCommands.size(); i++) {
+        fServer->RegisterCommand(fNewCommands[i],
+                                 TString::Format("FairRunOnline::Instance()->QueueHttpCommand(\"%s\")",
+                                                 fNewCommands[i].Data()));
+      }
+      fNewCommands.clear();
+      if (fFresh) {
+        for (size_t i = 0; i < fEntries.size(); i++) {
+          CopyObject(fEntries[i].fStaging, fEntries[i].fServed);
+        }
+        fFresh = kFALSE;
+      }
+    }
+    fServer->ProcessRequests();
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+
+  delete fServer;
+}
+
+
+void FairRunOnlineMonitor::AddObject(const char* folder, TObject* object)
+{
+  Entry entry;
+  entry.fOriginal = object;
+  entry.fStaging = CloneObject(object);
+  entry.fServed = CloneObject(object);
+  entry.fFolder = folder;
+  std::lock_guard<std::mutex> lock(fMutex);
+  fEntries.push_back(entry);
+}
+
+
+void FairRunOnlineMonitor::RegisterCommand(const TString& name, const TString& command)
+{
+  std::lock_guard<std::mutex> lock(fMutex);
+  fCommands[name] = command;
+  fNewCommands.push_back(name);
+}
+
+
+void FairRunOnlineMonitor::QueueCommand(const TString& name)
+{
+  std::lock_guard<std::mutex> lock(fCommandMutex);
+  fQueued.push_back(name);
+  fNQueued++;
+}
+
+
+void FairRunOnlineMonitor::ProcessEvent()
+{
+  if (fNQueued > 0) {
+    ExecuteCommands();
+    Snapshot();
+    fNEvents = 0;
+    return;
+  }
+  if (++fNEvents < fInterval) {
+    return;
+  }
+  fNEvents = 0;
+  Snapshot();
+}
+
+
+void FairRunOnlineMonitor::Snapshot()
+{
+  std::unique_lock<std::mutex> lock(fMutex, std::try_to_lock);
+  if (!lock.owns_lock()) {
+    fNSkipped++;
+    return;
+  }
+  Double_t start = Now();
+  for (size_t i = 0; i < fEntries.size(); i++) {
+    CopyObject(fEntries[i].fOriginal, fEntries[i].fStaging);
+  }
+  fFresh = kTRUE;
+  lock.unlock();
+  Double_t stop = Now();
+
+  // keep the copies below fMaxFraction of the event loop time
+  Double_t time = stop - start;
+  Double_t elapsed = start - fLastSnapshot;
+  fLastSnapshot = stop;
+  fSnapshotTime += time;
+  fNSnapshots++;
+  if (time > fMaxFraction * elapsed) {
+    fInterval *= 2;
+  } else if (time < 0.25 * fMaxFraction * elapsed && fInterval > fRefreshRate) {
+    fInterval = fInterval / 2 > fRefreshRate ? fInterval / 2 : fRefreshRate;
+  }
+}
+
+
+void FairRunOnlineMonitor::ExecuteCommands()
+{
+  std::vector<TString> queued;
+  {
+    std::lock_guard<std::mutex> lock(fCommandMutex);
+    queued.swap(fQueued);
+    fNQueued = 0;
+  }
+  for (size_t i = 0; i < queued.size(); i++) {
+    TString command;
+    {
+      std::lock_guard<std::mutex> lock(fMutex);
+      std::map<TString, TString>::const_iterator it = fCommands.find(queued[i]);
+      if (it == fCommands.end()) {
+        continue;
+      }
+      command = it->second;
+    }
+    // "/name/->Method()" is executed on the original object
+    Ssiz_t arrow = command.Index("/->");
+    if (arrow > 0) {
+      TString path = command(0, arrow);
+      TString name = path(path.Last('/') + 1, path.Length());
+      TObject* object = FindOriginal(name);
+      if (!object) {
+        LOG(WARNING) << "FairRunOnline: object " << name << " of http command "
+                     << queued[i] << " not found" << FairLogger::endl;
+        continue;
+      }
+      command = TString::Format("((%s*)%p)->", object->ClassName(), static_cast<void*>(object))
+                + command(arrow + 3, command.Length());
+    }
+    LOG(DEBUG) << "FairRunOnline: http command " << queued[i] << ": " << command << FairLogger::endl;
+    gROOT->ProcessLine(command);
+  }
+}
+
+
+TObject* FairRunOnlineMonitor::FindOriginal(const TString& name) const
+{
+  for (size_t i = 0; i < fEntries.size(); i++) {
+    TObject* object = fEntries[i].fOriginal;
+    if (name == object->GetName()) {
+      return object;
+    }
+    TObject* found = NULL;
+    if (object->InheritsFrom(TFolder::Class())) {
+      found = static_cast<TFolder*>(object)->FindObjectAny(name);
+    } else if (object->InheritsFrom(TPad::Class())) {
+      found = static_cast<TPad*>(object)->FindObject(name);
+    }
+    if (found) {
+      return found;
+    }
+  }
+  return NULL;
+}
+
+
+TObject* FairRunOnlineMonitor::CloneObject(TObject* object)
+{
+  if (object->InheritsFrom(TFolder::Class())) {
+    TFolder* folder = static_cast<TFolder*>(object);
+    TFolder* copy = new TFolder(folder->GetName(), folder->GetTitle());
+    copy->SetOwner(kTRUE);
+    TIter next(folder->GetListOfFolders());
+    while (TObject* obj = next()) {
+      copy->Add(CloneObject(obj));
+    }
+    return copy;
+  }
+  TObject* copy = object->Clone();
+  if (copy->InheritsFrom(TH1::Class())) {
+    static_cast<TH1*>(copy)->SetDirectory(0);
+  }
+  return copy;
+}
+
+
+// Only the histograms are copied, also those drawn in pads or stored in
+// folders. The structure of canvases and folders is taken from AddObject.
+void FairRunOnlineMonitor::CopyObject(TObject* from, TObject* to)
+{
+  if (from->InheritsFrom(TH1::Class())) {
+    // TH1::Copy adds the copy to gDirectory, the copies belong to no directory
+    TDirectory::TContext context(NULL);
+    static_cast<TH1*>(from)->Copy(*to);
+    static_cast<TH1*>(to)->SetDirectory(NULL);
+  } else if (from->InheritsFrom(TPad::Class())) {
+    CopyList(static_cast<TPad*>(from)->GetListOfPrimitives(),
+             static_cast<TPad*>(to)->GetListOfPrimitives());
+  } else if (from->InheritsFrom(TFolder::Class())) {
+    CopyList(static_cast<TList*>(static_cast<TFolder*>(from)->GetListOfFolders()),
+             static_cast<TList*>(static_cast<TFolder*>(to)->GetListOfFolders()));
+  }
+}
+
+
+void FairRunOnlineMonitor::CopyList(TList* from, TList* to)
+{
+  if (!from || !to) {
+    return;
+  }
+  TIter nextFrom(from);
+  TIter nextTo(to);
+  TObject* a;
+  TObject* b;
+  while ((a = nextFrom()) && (b = nextTo())) {
+    if (a->IsA() == b->IsA()) {
+      CopyObject(a, b);
+    }
+  }
+}
+
+
+void FairRunOnlineMonitor::PrintStatistics() const
+{
+  LOG(INFO) << "FairRunOnline: " << fNSnapshots << " snapshots for the http server, "
+            << (fNSnapshots > 0 ? 1.e3 * fSnapshotTime / fNSnapshots : 0.) << " ms each, "
+            << fNSkipped << " skipped, last interval " << fInterval << " events"
+            << FairLogger::endl;
+}
+
+
+Double_t FairRunOnlineMonitor::Now()
+{
+  return std::chrono::duration<Double_t>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+
 
 //_____________________________________________________________________________
 FairRunOnline* FairRunOnline::fgRinstance = 0;
@@ -74,7 +442,8 @@ FairRunOnline::FairRunOnline()
    fField(0),
    fNevents(0),
    fServer(NULL),
-   fServerRefreshRate(0)
+   fServerRefreshRate(0),
+   fMonitor(NULL)
 {
   fgRinstance = this;
   fAna = kTRUE;
@@ -89,7 +458,8 @@ FairRunOnline::FairRunOnline(FairSource* source)
    fField(0),
    fNevents(0),
    fServer(NULL),
-   fServerRefreshRate(0)
+   fServerRefreshRate(0),
+   fMonitor(NULL)
 {
   fRootManager->SetSource(source);
   fgRinstance = this;
@@ -110,7 +480,11 @@ FairRunOnline::~FairRunOnline()
     }
     delete gGeoManager;
   }
-  delete fServer;
+  if (fMonitor) {
+    delete fMonitor;
+  } else {
+    delete fServer;
+  }
 }
 //_____________________________________________________________________________
 
@@ -300,7 +674,11 @@ Int_t FairRunOnline::EventLoop()
   fRootManager->DeleteOldWriteoutBufferData();
   fTask->FinishEvent();
   fNevents += 1;
-  if(fServer && 0 == (fNevents%fServerRefreshRate))
+  if(fMonitor)
+  {
+    fMonitor->ProcessEvent();
+  }
+  else if(fServer && 0 == (fNevents%fServerRefreshRate))
   {
     fServer->ProcessRequests();
   }
@@ -399,24 +777,57 @@ void FairRunOnline::Finish()
   fRootManager->GetSource()->Close();
 
   fRootManager->CloseOutFile();
+
+  if (fMonitor) {
+    fMonitor->PrintStatistics();
+  }
 }
 //_____________________________________________________________________________
 
 //_____________________________________________________________________________
-void FairRunOnline::ActivateHttpServer(Int_t refreshRate, Int_t httpServer)
+void FairRunOnline::ActivateHttpServer(Int_t refreshRate, Int_t httpServer, Bool_t ownThread)
 {
   TString serverAddress="http:";
   serverAddress+=httpServer;
-  fServer = new THttpServer(serverAddress);
+  if (ownThread) {
+    fMonitor = new FairRunOnlineMonitor(serverAddress, refreshRate);
+    fServer = fMonitor->GetServer();
+  } else {
+    fServer = new THttpServer(serverAddress);
+  }
   fServerRefreshRate = refreshRate;
 }
 //_____________________________________________________________________________
 
+//_____________________________________________________________________________
+void FairRunOnline::SetHttpSnapshotFraction(Double_t fraction)
+{
+  if (fMonitor) {
+    fMonitor->SetSnapshotFraction(fraction);
+  } else {
+    LOG(WARNING) << "FairRunOnline::SetHttpSnapshotFraction : no http server in its own thread" << FairLogger::endl;
+  }
+}
+//_____________________________________________________________________________
+
+//_____________________________________________________________________________
+void FairRunOnline::QueueHttpCommand(const char* name)
+{
+  if (fMonitor) {
+    fMonitor->QueueCommand(name);
+  }
+}
+//_____________________________________________________________________________
+
 
 //_____________________________________________________________________________
 void FairRunOnline::RegisterHttpCommand(TString name, TString command)
 {
-  if(fServer)
+  if(fMonitor)
+  {
+    fMonitor->RegisterCommand(name, command);
+  }
+  else if(fServer)
   {
     TString path = "/Objects/HISTO";
     fServer->RegisterCommand(name, path + command);
@@ -460,21 +871,31 @@ void FairRunOnline::AddObject(TObject* object)
     }
     if(fServer) {
         TString classname = TString(object->ClassName());
+        TString folder;
         if(classname.EqualTo("TCanvas"))
         {
-            fServer->Register("CANVAS", object);
+            folder = "CANVAS";
         }
         else if(classname.EqualTo("TFolder"))
         {
-            fServer->Register("/", object);
+            folder = "/";
         }
         else if(classname.Contains("TH1") || classname.Contains("TH2"))
         {
-            fServer->Register("HISTO", object);
+            folder = "HISTO";
         }
         else
         {
             LOG(WARNING) << "FairRunOnline::AddObject : unrecognized object type : " << classname << FairLogger::endl;
+            return;
+        }
+        if(fMonitor)
+        {
+            fMonitor->AddObject(folder, object);
+        }
+        else
+        {
+            fServer->Register(folder, object);
         }
     }
 }
@@ -30,6 +30,7 @@ class TTree;
 class FairSource;
 class TFolder;
 class THttpServer;
+class FairRunOnlineMonitor;
 
 class FairRunOnline : public FairRun
 {
@@ -75,10 +76,21 @@ class FairRunOnline : public FairRun
     void AddObject(TObject* object);
 
     /** Activate http server on defined host port. To be called before Init.
+     * By default the requests are processed in the event loop. With
+     * ownThread the server runs in its own thread and serves copies of the
+     * added objects, which are refreshed between two events. Only histograms
+     * are refreshed, also inside canvases and folders.
      * @param refreshRate an interval in number of events for server update.
      * @param httpPort the port which is used by the http server
+     * @param ownThread kTRUE: the server runs in its own thread
      */
-    void ActivateHttpServer(Int_t refreshRate = 10000, Int_t httpPort=8080);
+    void ActivateHttpServer(Int_t refreshRate = 10000, Int_t httpPort=8080, Bool_t ownThread=kFALSE);
+
+    /** Maximum fraction of the event loop time used to copy the objects for
+     * the http server in its own thread (default 0.01). The refresh interval
+     * is increased if the copies take longer.
+     */
+    void SetHttpSnapshotFraction(Double_t fraction);
 
     /** Register a command on the http server.
      * @param name a command name starting with /
@@ -87,9 +99,16 @@ class FairRunOnline : public FairRun
     void RegisterHttpCommand(TString name, TString command);
 
 
-    /** Get direct access to the http server. */
+    /** Get direct access to the http server. If the server runs in its own
+     * thread, it must not be used while the event loop is running.
+     */
     THttpServer* GetHttpServer() { return fServer; }
 
+    /** Execute a registered http command in the event loop. Called by the
+     * http server thread.
+     */
+    void QueueHttpCommand(const char* name);
+
     /** Write last data to file, close input and output **/
     void Finish();
 
@@ -114,6 +133,7 @@ class FairRunOnline : public FairRun
     Int_t       fNevents;      //!
     THttpServer* fServer;             //!
     Int_t        fServerRefreshRate;  //!
+    FairRunOnlineMonitor* fMonitor;   //!
 
     virtual void Fill();
 
@@ -15,6 +15,7 @@
 #include "FairGeoParSet.h"              // for FairGeoParSet
 #include "FairField.h"                  // for FairField
 #include "FairFileHeader.h"             // for FairFileHeader
+#include "FairGeoCache.h"               // for FairGeoCache
 #include "FairGeoInterface.h"           // for FairGeoInterface
 #include "FairGeoLoader.h"              // for FairGeoLoader
 #include "FairLogger.h"                 // for FairLogger, MESSAGE_ORIGIN
@@ -23,6 +24,8 @@
 #include "FairModule.h"                 // for FairModule
 #include "FairParSet.h"                 // for FairParSet
 #include "FairPrimaryGenerator.h"       // for FairPrimaryGenerator
+#include "FairRadLenManager.h"          // for FairRadLenManager
+#include "FairRadMapManager.h"          // for FairRadMapManager
 #include "FairRootManager.h"            // for FairRootManager
 #include "FairRunIdGenerator.h"         // for FairRunIdGenerator
 #include "FairRuntimeDb.h"              // for FairRuntimeDb
@@ -35,7 +38,8 @@
 #include "TList.h"                      // for TList
 #include "TObjString.h"                 // for TObjString
 #include "TObject.h"                    // for TObject
-#include "TROOT.h"                      // for TROOT, gROOT
+#include "RVersion.h"                   // for ROOT_VERSION, ROOT_VERSION_CODE
+#include "TROOT.h"                      // for TROOT, gROOT, EnableThreadSafety
 #include "TSystem.h"                    // for TSystem, gSystem
 #include "TRandom.h"                    // for gRandom
 #include <stdlib.h>                     // for getenv, NULL
@@ -62,12 +66,16 @@ FairRunSim::FairRunSim(Bool_t isMaster)
    ListOfModules(new TObjArray()),
    MatFname(""),
    fStoreTraj( kFALSE),
+   fCompactTraj( kFALSE),
+   fMergedOutput( kFALSE),
    fLoaderName( new TString("TGeo")),
    fPythiaDecayer(kFALSE),
    fPythiaDecayerConfig(""),
    fUserDecay(kFALSE),
    fUserDecayConfig(""),
    fRadLength(kFALSE),
+   fRadLenAggregate(kFALSE),
+   fRadMapAggregate(kFALSE),
    fRadMap(kFALSE),
    fRadGrid(kFALSE),
    fMeshList( new TObjArray() ),
@@ -154,6 +162,14 @@ void FairRunSim::Init()
 //  fOutFile=fRootManager->OpenOutFile(fOutname);
   LOG(INFO) << "==============  FairRunSim: Initialising simulation run ==============" << FairLogger::endl;
 
+  // The worker threads of the merged output share ROOT's global state, enable
+  // its locks here on the master, before any worker thread is started.
+#if ( ROOT_VERSION_CODE >= ROOT_VERSION(6,6,0) )
+  if ( fMergedOutput ) {
+    ROOT::EnableThreadSafety();
+  }
+#endif
+
   FairGeoLoader* loader=new FairGeoLoader(fLoaderName->Data(), "Geo Loader");
   FairGeoInterface* GeoInterFace=loader->getGeoInterface();
   GeoInterFace->SetNoOfSets(ListOfModules->GetEntries());
@@ -205,13 +221,22 @@ void FairRunSim::Init()
   // on/off visualisation
   if( fStoreTraj ) {
     LOG(INFO) << "Create visualisation manager " << FairLogger::endl;
-    new FairTrajFilter();
+    FairTrajFilter* trajFilter = new FairTrajFilter();
+    if (fCompactTraj) {
+      trajFilter->SetCompactStorage();
+    }
   }
   if(fRadLength) {
     fApp->SetRadiationLengthReg(fRadLength);
+    if(fRadLenAggregate) {
+      FairRadLenManager::Instance()->SetAggregatedScoring();
+    }
   }
   if(fRadMap) {
     fApp->SetRadiationMapReg(fRadMap);
+    if(fRadMapAggregate) {
+      FairRadMapManager::Instance()->SetAggregatedScoring();
+    }
   }
   if(fRadGrid) {
     fApp->AddMeshList(fMeshList);
@@ -446,6 +471,12 @@ void FairRunSim::SetMaterials(const char* MatFileName)
   LOG(INFO) << "Media file used: " << MatFname.Data() << FairLogger::endl;
 }
 //_____________________________________________________________________________
+void FairRunSim::SetGeometryCache(const char* dir)
+{
+  FairGeoCache::SetDirectory(dir);
+  LOG(INFO) << "Geometry cache used: " << dir << FairLogger::endl;
+}
+//_____________________________________________________________________________
 void FairRunSim::SetGeoModel( char* name )
 {
   if ( strncmp(fName,"TGeant3",7) == 0 ) {
@@ -87,8 +87,23 @@ class FairRunSim : public FairRun
     /** Set the material file name to be used */
     void    SetMaterials(const char* MatFileName);
 
-    /**switch On/Off the track visualisation */
-    void SetStoreTraj(Bool_t storeTraj=kTRUE) {fStoreTraj = storeTraj;}
+    /** Cache the geometries built from ASCII (.geo) files in dir, so that the
+     *  following runs with the same geometry and media files read them
+     *  instead of building them again (see FairGeoCache)
+     */
+    void    SetGeometryCache(const char* dir);
+
+    /**switch On/Off the track visualisation
+     * @param compact : store the trajectories as FairCompactTrajectories (branch GeoTracksCompact)
+     */
+    void SetStoreTraj(Bool_t storeTraj=kTRUE, Bool_t compact=kFALSE) {fStoreTraj = storeTraj; fCompactTraj = compact;}
+
+    /**switch On/Off merged output in multi-threaded mode: all worker threads
+     * write into one file (<output>_mt.root) instead of one file per thread */
+    void SetMergedOutput(Bool_t merged=kTRUE) {fMergedOutput = merged;}
+
+    /**Flag for merged output in multi-threaded mode*/
+    Bool_t IsMergedOutput() {return fMergedOutput; }
 
     /**switch On/Off the debug mode */
     void SetTrackingDebugMode( Bool_t set ) { if (fApp) { fApp->SetTrackingDebugMode( set ); } }
@@ -129,10 +144,15 @@ class FairRunSim : public FairRun
     /**Flag for User decay*/
     Bool_t  IsUserDecay() {return fUserDecay; }
 
-    /**Switch on/off Radiation length register */
-    void SetRadLenRegister(Bool_t value) {fRadLength= value;}
+    /**Switch on/off Radiation length register
+     * @param aggregate : sum per volume and direction instead of storing points
+     */
+    void SetRadLenRegister(Bool_t value, Bool_t aggregate=kFALSE) {fRadLength= value; fRadLenAggregate= aggregate;}
 
-    void SetRadMapRegister(Bool_t value) { fRadMap=value; }
+    /**Switch on/off Radiation map register
+     * @param aggregate : sum per volume instead of storing points
+     */
+    void SetRadMapRegister(Bool_t value, Bool_t aggregate=kFALSE) { fRadMap=value; fRadMapAggregate= aggregate; }
 
     void SetRadGridRegister(Bool_t value) {fRadGrid= value;}
 
@@ -172,12 +192,16 @@ class FairRunSim : public FairRun
     TObjArray*             ListOfModules;//!                       /** Array of used modules */
     TString                MatFname; //!                           /** Material file name */
     Bool_t                 fStoreTraj;   //!                       /** Trajectory store flags */
+    Bool_t                 fCompactTraj; //!                       /** Store trajectories in compact format */
+    Bool_t                 fMergedOutput; //!                      /** One output file for all worker threads */
     TString*               fLoaderName;  //!                       /** Geometry Model (TGeo or G3)*/
     Bool_t                 fPythiaDecayer;  //!                    /** flag for using Pythia decayer*/
     TString                fPythiaDecayerConfig; //!               /** Macro for Pythia decay configuration*/
     Bool_t                 fUserDecay;                             /** flag for setting user decay */
     TString                fUserDecayConfig; //!                   /** Macro for decay configuration*/
     Bool_t                 fRadLength;   //!                       /** flag for registring radiation length*/
+    Bool_t                 fRadLenAggregate; //!                   /** aggregated radiation length scoring */
+    Bool_t                 fRadMapAggregate; //!                   /** aggregated radiation map scoring */
     Bool_t                 fRadMap; //!                            /** flag for RadiationMapManager
     Bool_t                 fRadGrid;  //!
     TObjArray*             fMeshList; //!                          /** radiation grid scoring
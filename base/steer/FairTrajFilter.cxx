@@ -13,6 +13,7 @@
 #include "FairTrajFilter.h"
 
 #include "FairRootManager.h"            // for FairRootManager
+#include "FairCompactTrajectories.h"    // for FairCompactTrajectories
 
 #include <iosfwd>                       // for ostream
 #include "TClonesArray.h"               // for TClonesArray
@@ -30,6 +31,9 @@
 
 using namespace std;
 
+// upper limit of dropped points checked against a new point
+static const size_t kMaxPendingPoints = 256;
+
 
 ClassImp(FairTrajFilter)
 
@@ -73,8 +77,15 @@ FairTrajFilter::FairTrajFilter()
     fStorePrim ( kTRUE),
     fStoreSec ( kTRUE),
     fStepSizeMin ( 0.1), // 1mm by default
+    fTolerance ( 0.), // store all points by default
+    fCompact ( kFALSE),
     fTrackCollection(new TClonesArray("TGeoTrack")),
-    fCurrentTrk(NULL)
+    fCurrentTrk(NULL),
+    fCompactTracks(NULL),
+    fPendingX(),
+    fPendingY(),
+    fPendingZ(),
+    fPendingT()
 {
   if(NULL != fgInstance) {
     Fatal("FairTrajFilter", "Singleton class already exists.");
@@ -94,13 +105,25 @@ FairTrajFilter::~FairTrajFilter()
 void FairTrajFilter::Init(TString brName, TString folderName)
 {
 
-  FairRootManager::Instance()->Register(brName.Data(), folderName.Data(), fTrackCollection, kTRUE);
+  if(fCompact) {
+    FairRootManager::Instance()->Register((brName + "Compact").Data(), folderName.Data(), fCompactTracks, kTRUE);
+  } else {
+    FairRootManager::Instance()->Register(brName.Data(), folderName.Data(), fTrackCollection, kTRUE);
+  }
 
 }
 
 void FairTrajFilter::Reset()
 {
   fTrackCollection->Delete();
+  if(fCompactTracks) {
+    fCompactTracks->Clear();
+  }
+  fCurrentTrk = NULL;
+  fPendingX.clear();
+  fPendingY.clear();
+  fPendingZ.clear();
+  fPendingT.clear();
 }
 
 Bool_t FairTrajFilter::IsAccepted(const TParticle* p) const
@@ -262,6 +285,32 @@ void FairTrajFilter::SetStepSizeCut(Double_t stepSizeMin)
 
 
 
+void FairTrajFilter::SetCompactStorage(Bool_t compact, Double_t tolerance)
+{
+  fCompact = compact;
+  // only created in compact mode, where it is registered as output by Init()
+  if(fCompact && !fCompactTracks) {
+    fCompactTracks = new FairCompactTrajectories();
+  } else if(!fCompact) {
+    delete fCompactTracks;
+    fCompactTracks = NULL;
+  }
+  SetSpatialTolerance(tolerance);
+}
+
+
+
+void FairTrajFilter::SetSpatialTolerance(Double_t tolerance)
+{
+  if(tolerance < 0.) {
+    cout << "-E- FairTrajFilter::SetSpatialTolerance() : invalid value, ignoring." << endl;
+    return;
+  }
+  fTolerance = tolerance;
+}
+
+
+
 void FairTrajFilter::GetVertexCut(Double_t& vxMin, Double_t& vyMin, Double_t& vzMin,
                                   Double_t& vxMax, Double_t& vyMax, Double_t& vzMax) const
 {
@@ -319,6 +368,7 @@ TGeoTrack* FairTrajFilter::AddTrack(Int_t trackId, Int_t pdgCode)
 {
 
 //  cout << "FairTrajFilter::AddTrack" << endl;
+  FinishTrack();
   TClonesArray& clref = *fTrackCollection;
   Int_t tsize = clref.GetEntriesFast();
   fCurrentTrk =  new(clref[tsize]) TGeoTrack(trackId,pdgCode);
@@ -328,6 +378,13 @@ TGeoTrack* FairTrajFilter::AddTrack(Int_t trackId, Int_t pdgCode)
 TGeoTrack* FairTrajFilter::AddTrack(TParticle* p)
 {
 
+  FinishTrack();
+
+  if(fCompact) {
+    fCompactTracks->AddTrack(p);
+    return NULL;
+  }
+
   Int_t trackId=0;
 //  cout << "FairTrajFilter::AddTrack" << endl;
   if(fCurrentTrk) { trackId=fCurrentTrk->GetId(); }
@@ -347,3 +404,98 @@ TGeoTrack* FairTrajFilter::GetTrack(Int_t trackId)
 }
 
 
+
+void FairTrajFilter::AddPoint(Double_t x, Double_t y, Double_t z, Double_t t)
+{
+  if(fTolerance <= 0.) {
+    StorePoint(x, y, z, t);
+    return;
+  }
+
+  size_t nPending = fPendingX.size();
+  if(0 == nPending) {
+    // first point of the track, always stored
+    StorePoint(x, y, z, t);
+  } else if(nPending >= 2) {
+    if(nPending < kMaxPendingPoints && IsWithinTolerance(x, y, z)) {
+      // the candidate can be dropped, the new point replaces it
+      fPendingX.push_back(x);
+      fPendingY.push_back(y);
+      fPendingZ.push_back(z);
+      fPendingT.push_back(t);
+      return;
+    }
+    // the candidate is needed, it becomes the reference for the following points
+    Double_t cx = fPendingX.back();
+    Double_t cy = fPendingY.back();
+    Double_t cz = fPendingZ.back();
+    Double_t ct = fPendingT.back();
+    StorePoint(cx, cy, cz, ct);
+    fPendingX.assign(1, cx);
+    fPendingY.assign(1, cy);
+    fPendingZ.assign(1, cz);
+    fPendingT.assign(1, ct);
+  }
+
+  fPendingX.push_back(x);
+  fPendingY.push_back(y);
+  fPendingZ.push_back(z);
+  fPendingT.push_back(t);
+}
+
+
+
+void FairTrajFilter::FinishTrack()
+{
+  if(fPendingX.size() >= 2) {
+    StorePoint(fPendingX.back(), fPendingY.back(), fPendingZ.back(), fPendingT.back());
+  }
+  fPendingX.clear();
+  fPendingY.clear();
+  fPendingZ.clear();
+  fPendingT.clear();
+}
+
+
+
+void FairTrajFilter::StorePoint(Double_t x, Double_t y, Double_t z, Double_t t)
+{
+  if(fCompact) {
+    fCompactTracks->AddPoint(x, y, z, t);
+  } else if(fCurrentTrk) {
+    fCurrentTrk->AddPoint(x, y, z, t);
+  }
+}
+
+
+
+Bool_t FairTrajFilter::IsWithinTolerance(Double_t x, Double_t y, Double_t z) const
+{
+  // distance of all pending points to the segment from the last stored point to (x, y, z)
+  Double_t ax = fPendingX[0];
+  Double_t ay = fPendingY[0];
+  Double_t az = fPendingZ[0];
+  Double_t dx = x - ax;
+  Double_t dy = y - ay;
+  Double_t dz = z - az;
+  Double_t len2 = dx*dx + dy*dy + dz*dz;
+  Double_t tol2 = fTolerance*fTolerance;
+
+  for(size_t i = 1; i < fPendingX.size(); ++i) {
+    Double_t qx = fPendingX[i] - ax;
+    Double_t qy = fPendingY[i] - ay;
+    Double_t qz = fPendingZ[i] - az;
+    Double_t s = 0.;
+    if(len2 > 0.) {
+      s = (qx*dx + qy*dy + qz*dz) / len2;
+      s = (s < 0.) ? 0. : ((s > 1.) ? 1. : s);
+    }
+    Double_t ex = qx - s*dx;
+    Double_t ey = qy - s*dy;
+    Double_t ez = qz - s*dz;
+    if(ex*ex + ey*ey + ez*ez > tol2) {
+      return kFALSE;
+    }
+  }
+  return kTRUE;
+}
@@ -18,6 +18,9 @@
 #include "TMath.h"                      // for Pi, TwoPi
 #include "TString.h"                    // for TString
 
+#include <vector>                       // for vector
+
+class FairCompactTrajectories;
 class TClonesArray;
 class TParticle;
 
@@ -34,6 +37,13 @@ class TParticle;
  * Three modes of momentum cut (phase space, polar and decart reference systems),
  * are self-excluded. The last that was set, is applied in the simulation.
  * All other cuts are combined together.
+ * The trajectory points can be thinned out on the fly with a spatial
+ * tolerance: a point is only stored if the trajectory would deviate
+ * by more than the tolerance from the straight line between the
+ * neighbouring stored points without it.
+ * In compact mode (FairRun::SetStoreTraj(kTRUE, kTRUE)) the trajectories
+ * are written as one FairCompactTrajectories object per event
+ * (branch GeoTracksCompact) instead of a TClonesArray of TGeoTracks.
  * @author D. Kresan
  * @version 0.1
  * @since 2004-Sep-15
@@ -105,6 +115,10 @@ class FairTrajFilter
 
     Double_t fStepSizeMin;
 
+    Double_t fTolerance;
+
+    Bool_t fCompact;
+
     /**
      * collection of tracks
      */
@@ -112,11 +126,63 @@ class FairTrajFilter
 
     TGeoTrack* fCurrentTrk;
 
+    /**
+     * tracks of the event in compact mode, NULL otherwise
+     */
+    FairCompactTrajectories* fCompactTracks;
+
+    /**
+     * points of the current track since the last stored point:
+     * the last stored point, the dropped points and the candidate.
+     * Kept as one array per coordinate, the memory is reused for all tracks.
+     */
+    std::vector<Double_t> fPendingX;
+    std::vector<Double_t> fPendingY;
+    std::vector<Double_t> fPendingZ;
+    std::vector<Double_t> fPendingT;
+
+    void StorePoint(Double_t x, Double_t y, Double_t z, Double_t t);
+    Bool_t IsWithinTolerance(Double_t x, Double_t y, Double_t z) const;
+
   public:
     TGeoTrack* AddTrack(Int_t trackId, Int_t pdgCode);
+    /**
+     * Starts a new trajectory.
+     * @return The new TGeoTrack, NULL in compact mode.
+     */
     TGeoTrack* AddTrack(TParticle* p);
     TGeoTrack* GetCurrentTrk() {return fCurrentTrk;}
 
+    /**
+     * Adds a point to the current trajectory, subject to the spatial tolerance.
+     */
+    void AddPoint(Double_t x, Double_t y, Double_t z, Double_t t);
+
+    /**
+     * Stores the last pending point of the current trajectory.
+     * Has to be called at the end of each accepted track.
+     */
+    void FinishTrack();
+
+    /**
+     * This function selects the compact storage of trajectories.
+     * It has to be called before Init(), normally via FairRunSim::SetStoreTraj().
+     * @param compact - kTRUE for FairCompactTrajectories, kFALSE for TGeoTracks.
+     * @param tolerance - spatial tolerance in cm, see SetSpatialTolerance().
+     */
+    void SetCompactStorage(Bool_t compact=kTRUE, Double_t tolerance=0.01);
+
+    /**
+     * This function controls the thinning of the trajectories.
+     * @param tolerance - maximum distance in cm between the stored trajectory
+     * and a dropped point. 0 stores every point passing the step size cut.
+     */
+    void SetSpatialTolerance(Double_t tolerance=0.);
+
+    inline Double_t GetSpatialTolerance() const { return fTolerance; };
+    inline Bool_t IsCompactStorage() const { return fCompact; };
+    FairCompactTrajectories* GetCompactTracks() { return fCompactTracks; }
+
     void Init(TString brName="GeoTracks", TString folderName="MCGeoTrack");
     void Reset();
     /**
@@ -0,0 +1,191 @@
+/********************************************************************************
+ *    Copyright (C) 2014 GSI Helmholtzzentrum fuer Schwerionenforschung GmbH    *
+ *                                                                              *
+ *              This software is distributed under the terms of the             *
+ *         GNU Lesser General Public Licence version 3 (LGPL) version 3,        *
+ *                  copied verbatim in the file "LICENSE"                       *
+ ********************************************************************************/
+// Fits TRK helix tracks of HIT hits with the CPU backend, track by track,
+// as one batch on one thread and as one batch on all threads, and checks
+// that all give the same result. Then runs the Kalman update of the same
+// number of tracks through CpuFilter and CpuFilterAll.
+#include "HitTrk.h"
+
+#include "TMatrixD.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+extern "C" void CpuInfo();
+extern "C" void CpuSetThreads(int nThreads);
+extern "C" void CircleFitC(double X[HIT], double Y[HIT], double Z[HIT], double Zerr[HIT],
+                           double* Mx, double* My, double* M0, double result[8]);
+extern "C" void CircleFitCBatchD(int nTrk, int nHit, const double* X, const double* Y, const double* Z,
+                                 const double* Zerr, const double* Mx, const double* My, const double* M0,
+                                 double* result);
+extern "C" void CircleFitCBatchF(int nTrk, int nHit, const float* X, const float* Y, const float* Z,
+                                 const float* Zerr, const float* Mx, const float* My, const float* M0,
+                                 float* result);
+extern "C" void CpuFilter(TMatrixD* h, TMatrixD* fM, TMatrixD* pull, TMatrixD* fH, TMatrixD* preC,
+                          TMatrixD* prea, TMatrixD* av, TMatrixD* curC, TMatrixD* fV, TMatrixD* fR,
+                          TMatrixD* fResVec, double* fDeltaChi2);
+extern "C" void CpuFilterAll(int nTrk, int n, int m, const double* H, const double* meas, const double* V,
+                             const double* aPred, const double* CPred,
+                             double* a, double* C, double* chi2, int* ok);
+
+static double Now()
+{
+  return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static double Uniform(double a, double b)
+{
+  return a + (b - a) * std::rand() / RAND_MAX;
+}
+
+int main()
+{
+  CpuInfo();
+  std::srand(4357);
+
+  // ---- helix tracks: circle in x-y, z linear in the arc length ----------
+  std::vector<double> X(TRK*HIT), Y(TRK*HIT), Z(TRK*HIT), Zerr(TRK*HIT);
+  std::vector<double> Mx(TRK), My(TRK), M0(TRK);
+  for (int t = 0; t < TRK; t++) {
+    double xc = Uniform(-50., 50.);
+    double yc = Uniform(-50., 50.);
+    double r = Uniform(20., 200.);
+    double phi0 = Uniform(0., 6.28);
+    double slope = Uniform(-1., 1.);
+    double mx = 0., my = 0.;
+    for (int i = 0; i < HIT; i++) {
+      int h = t*HIT + i;
+      double phi = phi0 + 1.5 * i / HIT;
+      X[h] = xc + r * std::cos(phi) + Uniform(-0.01, 0.01);
+      Y[h] = yc + r * std::sin(phi) + Uniform(-0.01, 0.01);
+      mx += X[h];
+      my += Y[h];
+    }
+    Mx[t] = mx / HIT;
+    My[t] = my / HIT;
+    double m0 = 0.;
+    for (int i = 0; i < HIT; i++) {
+      int h = t*HIT + i;
+      double dx = X[h] - Mx[t];
+      double dy = Y[h] - My[t];
+      m0 += dx*dx + dy*dy;
+      Z[h] = slope * std::sqrt(dx*dx + dy*dy) + Uniform(-0.05, 0.05);
+      Zerr[h] = 0.05;
+    }
+    M0[t] = m0 / HIT;
+  }
+  std::vector<float> Xf(X.begin(), X.end()), Yf(Y.begin(), Y.end()), Zf(Z.begin(), Z.end());
+  std::vector<float> Zerrf(Zerr.begin(), Zerr.end());
+  std::vector<float> Mxf(Mx.begin(), Mx.end()), Myf(My.begin(), My.end()), M0f(M0.begin(), M0.end());
+
+  // ---- circle fit --------------------------------------------------------
+  std::vector<double> single(8*TRK), one(8*TRK), all(8*TRK);
+  std::vector<float> allF(8*TRK);
+
+  double t0 = Now();
+  for (int t = 0; t < TRK; t++) {
+    CircleFitC(&X[t*HIT], &Y[t*HIT], &Z[t*HIT], &Zerr[t*HIT], &Mx[t], &My[t], &M0[t], &single[8*t]);
+  }
+  double t1 = Now();
+  CpuSetThreads(1);
+  CircleFitCBatchD(TRK, HIT, &X[0], &Y[0], &Z[0], &Zerr[0], &Mx[0], &My[0], &M0[0], &one[0]);
+  double t2 = Now();
+  CpuSetThreads(0);
+  CircleFitCBatchD(TRK, HIT, &X[0], &Y[0], &Z[0], &Zerr[0], &Mx[0], &My[0], &M0[0], &all[0]);
+  double t3 = Now();
+  CircleFitCBatchF(TRK, HIT, &Xf[0], &Yf[0], &Zf[0], &Zerrf[0], &Mxf[0], &Myf[0], &M0f[0], &allF[0]);
+  double t4 = Now();
+
+  double maxDiff = 0., maxDiffF = 0.;
+  for (int k = 0; k < 8*TRK; k++) {
+    maxDiff = std::fmax(maxDiff, std::fabs(single[k] - one[k]));
+    maxDiff = std::fmax(maxDiff, std::fabs(single[k] - all[k]));
+  }
+  for (int t = 0; t < TRK; t++) {
+    // radius, float against double
+    maxDiffF = std::fmax(maxDiffF, std::fabs(allF[8*t+2] - all[8*t+2]) / all[8*t+2]);
+  }
+
+  printf("\nCircle fit of %d tracks with %d hits\n", TRK, HIT);
+  printf("  track by track:             %10.0f tracks/s\n", TRK / (t1 - t0));
+  printf("  batch, one thread:          %10.0f tracks/s\n", TRK / (t2 - t1));
+  printf("  batch, all threads:         %10.0f tracks/s\n", TRK / (t3 - t2));
+  printf("  batch, all threads, float:  %10.0f tracks/s\n", TRK / (t4 - t3));
+  printf("  max. difference batch - single:           %g\n", maxDiff);
+  printf("  max. relative radius difference float:    %g\n", maxDiffF);
+
+  // ---- Kalman update: 5 parameters, 2 measurements -----------------------
+  const int n = 5;
+  const int m = 2;
+  std::vector<double> H(TRK*m*n, 0.), meas(TRK*m), V(TRK*m*m, 0.), aPred(TRK*n), CPred(TRK*n*n, 0.);
+  for (int t = 0; t < TRK; t++) {
+    H[t*m*n + 0*n + 3] = 1.;
+    H[t*m*n + 1*n + 4] = 1.;
+    V[t*m*m + 0] = V[t*m*m + 3] = 1.e-4;
+    for (int k = 0; k < n; k++) {
+      aPred[t*n + k] = Uniform(-1., 1.);
+      CPred[t*n*n + k*n + k] = 1.e-2;
+    }
+    CPred[t*n*n + 1*n + 3] = CPred[t*n*n + 3*n + 1] = 5.e-3;
+    meas[t*m + 0] = aPred[t*n + 3] + Uniform(-0.1, 0.1);
+    meas[t*m + 1] = aPred[t*n + 4] + Uniform(-0.1, 0.1);
+  }
+  std::vector<double> a(TRK*n), C(TRK*n*n), chi2(TRK);
+  std::vector<int> ok(TRK);
+
+  TMatrixD fH(m, n), fM(m, 1), fV(m, m), preC(n, n), prea(n, 1);
+  TMatrixD h, pull, av, curC, fR, fResVec;
+  double deltaChi2 = 0.;
+  double maxDiffFilter = 0.;
+  double t5 = Now();
+  for (int t = 0; t < TRK; t++) {
+    for (int i = 0; i < m; i++) {
+      fM(i, 0) = meas[t*m + i];
+      for (int k = 0; k < n; k++) { fH(i, k) = H[t*m*n + i*n + k]; }
+      for (int j = 0; j < m; j++) { fV(i, j) = V[t*m*m + i*m + j]; }
+    }
+    for (int k = 0; k < n; k++) {
+      prea(k, 0) = aPred[t*n + k];
+      for (int l = 0; l < n; l++) { preC(k, l) = CPred[t*n*n + k*n + l]; }
+    }
+    CpuFilter(&h, &fM, &pull, &fH, &preC, &prea, &av, &curC, &fV, &fR, &fResVec, &deltaChi2);
+    // kept for the comparison below
+    for (int k = 0; k < n; k++) {
+      a[t*n + k] = av(k, 0);
+      for (int l = 0; l < n; l++) { C[t*n*n + k*n + l] = curC(k, l); }
+    }
+    chi2[t] = deltaChi2;
+  }
+  double t6 = Now();
+  std::vector<double> aAll(TRK*n), CAll(TRK*n*n), chi2All(TRK);
+  CpuFilterAll(TRK, n, m, &H[0], &meas[0], &V[0], &aPred[0], &CPred[0], &aAll[0], &CAll[0], &chi2All[0], &ok[0]);
+  double t7 = Now();
+
+  int nFailed = 0;
+  for (int t = 0; t < TRK; t++) {
+    if (!ok[t]) {
+      nFailed++;
+      continue;
+    }
+    for (int k = 0; k < n; k++) { maxDiffFilter = std::fmax(maxDiffFilter, std::fabs(a[t*n + k] - aAll[t*n + k])); }
+    for (int k = 0; k < n*n; k++) { maxDiffFilter = std::fmax(maxDiffFilter, std::fabs(C[t*n*n + k] - CAll[t*n*n + k])); }
+    maxDiffFilter = std::fmax(maxDiffFilter, std::fabs(chi2[t] - chi2All[t]) / chi2[t]);
+  }
+
+  printf("\nKalman update of %d tracks, %d parameters, %d measurements\n", TRK, n, m);
+  printf("  CpuFilter, TMatrixD:        %10.0f tracks/s\n", TRK / (t6 - t5));
+  printf("  CpuFilterAll:               %10.0f tracks/s\n", TRK / (t7 - t6));
+  printf("  max. difference:                          %g, %d tracks failed\n", maxDiffFilter, nFailed);
+
+  int status = (maxDiff == 0. && maxDiffF < 1.e-3 && nFailed == 0 && maxDiffFilter < 1.e-9) ? 0 : 1;
+  printf("\n%s\n", status == 0 ? "CPU backend is consistent." : "CPU backend is NOT consistent.");
+  return status;
+}
@@ -0,0 +1,437 @@
+/********************************************************************************
+ *    Copyright (C) 2014 GSI Helmholtzzentrum fuer Schwerionenforschung GmbH    *
+ *                                                                              *
+ *              This software is distributed under the terms of the             *
+ *         GNU Lesser General Public Licence version 3 (LGPL) version 3,        *
+ *                  copied verbatim in the file "LICENSE"                       *
+ ********************************************************************************/
+// CPU implementation of the track fit of cuda_imp/trackfit_kernel.cu
+//
+// The circle fit is the one of the Fit/FitF kernels: Newton iteration on
+// the moments of the hits around (Mx, My) normalised to M0, followed by a
+// weighted straight line fit of z against the distance to (Mx, My).
+// Results per track: x and y of the centre, radius, -slope, offset, chi2
+// and the errors of slope and offset.
+//
+// Tracks are fitted in blocks of kLanes: the loops over the hits run over
+// the tracks of a block in the innermost loop, so the compiler vectorizes
+// them. The blocks are distributed over CpuGetThreads() threads.
+//
+#include "../cuda_imp/HitTrk.h"
+
+#include "TMatrixD.h"
+
+#include <cmath>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+namespace
+{
+
+const int kLanes = 8;
+
+int gThreads = 0;
+
+int NThreads()
+{
+  if (gThreads > 0) { return gThreads; }
+  int n = std::thread::hardware_concurrency();
+  return n > 0 ? n : 1;
+}
+
+// Newton iteration for the circle through the moments, see Newton() in
+// trackfit_kernel.cu. Writes centre and radius, returns 0 on failure.
+template<typename T>
+int Newton(T Mxx, T Myy, T Mxy, T Mxz, T Myz, T Mzz, T* result)
+{
+  const T epsilon = 0.000000000001;
+  T Mz = Mxx + Myy;
+  T Cov_xy = Mxx*Myy - Mxy*Mxy;
+  T Mxz2 = Mxz*Mxz;
+  T Myz2 = Myz*Myz;
+
+  T A2 = 4.*Cov_xy - 3.*Mz*Mz - Mzz;
+  T A1 = Mzz*Mz + 4.*Cov_xy*Mz - Mxz2 - Myz2 - Mz*Mz*Mz;
+  T A0 = Mxz2*Myy + Myz2*Mxx - Mzz*Cov_xy - 2.*Mxz*Myz*Mxy + Mz*Mz*Cov_xy;
+  T A22 = A2 + A2;
+
+  T xnew = 0.;
+  T yold = 100000000000.;
+  const int iterMax = 20;
+  int iter;
+  for (iter = 0; iter < iterMax; iter++) {
+    T ynew = A0 + xnew*(A1 + xnew*(A2 + 4.*xnew*xnew));
+    if (std::fabs(ynew) > std::fabs(yold)) {
+      xnew = 0.;
+      break;
+    }
+    T Dy = A1 + xnew*(A22 + 16.*xnew*xnew);
+    T xold = xnew;
+    xnew = xold - ynew/Dy;
+    if (std::fabs(xnew) < epsilon) { break; }
+    if (std::fabs((xnew-xold)/xnew) < epsilon) { break; }
+  }
+  if (iter == iterMax-1) { xnew = 0.; }
+
+  T GAM = - Mz - xnew - xnew;
+  T DET = xnew*xnew - xnew*Mz + Cov_xy;
+  if (DET == 0) { return 0; }
+
+  result[0] = (Mxz*(Myy-xnew) - Myz*Mxy)/DET/2.;
+  result[1] = (Myz*(Mxx-xnew) - Mxz*Mxy)/DET/2.;
+  if ((result[0]*result[0]+result[1]*result[1]-GAM) < 0.) { return 0; }
+  result[2] = std::sqrt(result[0]*result[0]+result[1]*result[1]-GAM);
+  return 1;
+}
+
+// Fits the tracks first ... first+n-1, n <= kLanes, hits of track t at
+// [t*nHit, (t+1)*nHit), results at [8*t, 8*t+8)
+template<typename T>
+void FitBlock(int nHit, int first, int n, const T* X, const T* Y, const T* Z, const T* Zerr,
+              const T* Mx, const T* My, const T* M0, T* result)
+{
+  T Mxx[kLanes], Myy[kLanes], Mxy[kLanes], Mxz[kLanes], Myz[kLanes], Mzz[kLanes];
+  T wsum[kLanes], wx[kLanes], wy[kLanes], wxx[kLanes], wxy[kLanes];
+  T cx[kLanes], cy[kLanes];
+  for (int l = 0; l < kLanes; l++) {
+    Mxx[l] = Myy[l] = Mxy[l] = Mxz[l] = Myz[l] = Mzz[l] = 0.;
+    wsum[l] = wx[l] = wy[l] = wxx[l] = wxy[l] = 0.;
+    int t = first + (l < n ? l : 0);
+    cx[l] = Mx[t];
+    cy[l] = My[t];
+  }
+
+  // moments and line fit sums, hit by hit over the tracks of the block
+  for (int i = 0; i < nHit; i++) {
+    T xs[kLanes], ys[kLanes], zs[kLanes], es[kLanes];
+    for (int l = 0; l < kLanes; l++) {
+      int h = (first + (l < n ? l : 0)) * nHit + i;
+      xs[l] = X[h];
+      ys[l] = Y[h];
+      zs[l] = Z[h];
+      es[l] = Zerr[h];
+    }
+    for (int l = 0; l < kLanes; l++) {
+      T xi = xs[l] - cx[l];
+      T yi = ys[l] - cy[l];
+      T zi = xi*xi + yi*yi;
+      T rho = std::sqrt(zi);
+      T w = es[l] > 0.001 ? 1/(es[l]*es[l]) : 0.;
+      Mxy[l] += xi*yi;
+      Mxx[l] += xi*xi;
+      Myy[l] += yi*yi;
+      Mxz[l] += xi*zi;
+      Myz[l] += yi*zi;
+      Mzz[l] += zi*zi;
+      wsum[l] += w;
+      wx[l]   += w*rho;
+      wy[l]   += w*zs[l];
+      wxx[l]  += w*rho*rho;
+      wxy[l]  += w*rho*zs[l];
+    }
+  }
+
+  for (int l = 0; l < n; l++) {
+    int t = first + l;
+    T* res = result + 8*t;
+    T m0 = M0[t];
+    Newton<T>(Mxx[l]/m0, Myy[l]/m0, Mxy[l]/m0, Mxz[l]/m0, Myz[l]/m0, Mzz[l]/m0, res);
+
+    T mm = 0.;
+    T qq = 0.;
+    T det = wsum[l] * wxx[l] - wx[l] * wx[l];
+    if (det > 0.00001) {
+      mm = (wxy[l] * wsum[l] - wy[l] * wx[l]) / det;
+      qq = (wy[l] * wxx[l] - wxy[l] * wx[l]) / det;
+    } else {
+      mm = 1000.;
+      qq = 1000.;
+    }
+    res[3] = -mm;
+    res[4] = qq;
+
+    T chi2 = 0.;
+    for (int i = 0; i < nHit; i++) {
+      int h = t * nHit + i;
+      T xi = X[h] - cx[l];
+      T yi = Y[h] - cy[l];
+      T rho = std::sqrt(xi*xi + yi*yi);
+      T w = Zerr[h] > 0.001 ? 1/(Zerr[h]*Zerr[h]) : 0.;
+      T r1 = Z[h] + res[3] * rho - res[4];
+      chi2 += w * (r1 * r1);
+    }
+    res[5] = chi2;
+
+    if (det > 0.00001) {
+      T varsq = std::sqrt(chi2/nHit);
+      res[6] = varsq * std::sqrt(wsum[l] / det);
+      res[7] = varsq * std::sqrt(wxx[l] / det);
+    } else {
+      res[6] = 0;
+      res[7] = 0;
+    }
+  }
+}
+
+template<typename T>
+void FitRange(int nHit, int first, int last, const T* X, const T* Y, const T* Z, const T* Zerr,
+              const T* Mx, const T* My, const T* M0, T* result)
+{
+  for (int t = first; t < last; t += kLanes) {
+    int n = last - t < kLanes ? last - t : kLanes;
+    FitBlock<T>(nHit, t, n, X, Y, Z, Zerr, Mx, My, M0, result);
+  }
+}
+
+// Splits nTrk tracks in contiguous ranges of whole blocks, one per thread
+template<typename T>
+void FitAll(int nTrk, int nHit, const T* X, const T* Y, const T* Z, const T* Zerr,
+            const T* Mx, const T* My, const T* M0, T* result)
+{
+  int nBlocks = (nTrk + kLanes - 1) / kLanes;
+  int nThreads = NThreads();
+  if (nThreads > nBlocks) { nThreads = nBlocks; }
+  if (nThreads <= 1) {
+    FitRange<T>(nHit, 0, nTrk, X, Y, Z, Zerr, Mx, My, M0, result);
+    return;
+  }
+  std::vector<std::thread> workers;
+  for (int w = 0; w < nThreads; w++) {
+    int first = (nBlocks * w / nThreads) * kLanes;
+    int last = (nBlocks * (w+1) / nThreads) * kLanes;
+    if (last > nTrk) { last = nTrk; }
+    workers.push_back(std::thread(FitRange<T>, nHit, first, last, X, Y, Z, Zerr, Mx, My, M0, result));
+  }
+  for (size_t w = 0; w < workers.size(); w++) {
+    workers[w].join();
+  }
+}
+
+// Gain formulation of the Kalman update for one track, all matrices row
+// major: H (m x n), V (m x m), a (n), C (n x n). Returns 0 if the
+// covariance of the residual cannot be inverted.
+int Update(int n, int m, const double* H, const double* meas, const double* V,
+           const double* aPred, const double* CPred, double* a, double* C, double* chi2)
+{
+  const int kMaxDim = 16;
+  if (n > kMaxDim || m > kMaxDim) { return 0; }
+  double HC[kMaxDim*kMaxDim], R[kMaxDim*kMaxDim], Rinv[kMaxDim*kMaxDim];
+  double r[kMaxDim], K[kMaxDim*kMaxDim];
+
+  // residual r = meas - H a and its covariance R = V + H C H^T
+  for (int i = 0; i < m; i++) {
+    double s = meas[i];
+    for (int k = 0; k < n; k++) { s -= H[i*n+k]*aPred[k]; }
+    r[i] = s;
+    for (int k = 0; k < n; k++) {
+      double hc = 0.;
+      for (int l = 0; l < n; l++) { hc += H[i*n+l]*CPred[l*n+k]; }
+      HC[i*n+k] = hc;
+    }
+  }
+  for (int i = 0; i < m; i++) {
+    for (int j = 0; j < m; j++) {
+      double s = V[i*m+j];
+      for (int k = 0; k < n; k++) { s += HC[i*n+k]*H[j*n+k]; }
+      R[i*m+j] = s;
+    }
+  }
+
+  // R^-1 by Gauss-Jordan
+  double work[kMaxDim*2*kMaxDim];
+  for (int i = 0; i < m; i++) {
+    for (int j = 0; j < m; j++) {
+      work[i*2*m+j] = R[i*m+j];
+      work[i*2*m+m+j] = i == j ? 1. : 0.;
+    }
+  }
+  for (int c = 0; c < m; c++) {
+    int p = c;
+    for (int i = c+1; i < m; i++) {
+      if (std::fabs(work[i*2*m+c]) > std::fabs(work[p*2*m+c])) { p = i; }
+    }
+    if (work[p*2*m+c] == 0.) { return 0; }
+    if (p != c) {
+      for (int j = 0; j < 2*m; j++) {
+        double t = work[c*2*m+j];
+        work[c*2*m+j] = work[p*2*m+j];
+        work[p*2*m+j] = t;
+      }
+    }
+    double piv = 1./work[c*2*m+c];
+    for (int j = 0; j < 2*m; j++) { work[c*2*m+j] *= piv; }
+    for (int i = 0; i < m; i++) {
+      if (i == c) { continue; }
+      double f = work[i*2*m+c];
+      for (int j = 0; j < 2*m; j++) { work[i*2*m+j] -= f*work[c*2*m+j]; }
+    }
+  }
+  for (int i = 0; i < m; i++) {
+    for (int j = 0; j < m; j++) { Rinv[i*m+j] = work[i*2*m+m+j]; }
+  }
+
+  // gain K = C H^T R^-1 = (H C)^T R^-1
+  for (int k = 0; k < n; k++) {
+    for (int j = 0; j < m; j++) {
+      double s = 0.;
+      for (int i = 0; i < m; i++) { s += HC[i*n+k]*Rinv[i*m+j]; }
+      K[k*m+j] = s;
+    }
+  }
+
+  // a = a + K r, C = C - K H C
+  for (int k = 0; k < n; k++) {
+    double s = aPred[k];
+    for (int j = 0; j < m; j++) { s += K[k*m+j]*r[j]; }
+    a[k] = s;
+    for (int l = 0; l < n; l++) {
+      double c = CPred[k*n+l];
+      for (int j = 0; j < m; j++) { c -= K[k*m+j]*HC[j*n+l]; }
+      C[k*n+l] = c;
+    }
+  }
+
+  double x = 0.;
+  for (int i = 0; i < m; i++) {
+    for (int j = 0; j < m; j++) { x += r[i]*Rinv[i*m+j]*r[j]; }
+  }
+  *chi2 = x;
+  return 1;
+}
+
+void UpdateRange(int first, int last, int n, int m, const double* H, const double* meas,
+                 const double* V, const double* aPred, const double* CPred,
+                 double* a, double* C, double* chi2, int* ok)
+{
+  for (int t = first; t < last; t++) {
+    ok[t] = Update(n, m, H + t*m*n, meas + t*m, V + t*m*m, aPred + t*n, CPred + t*n*n,
+                   a + t*n, C + t*n*n, chi2 + t);
+  }
+}
+
+}
+
+extern "C" void CpuSetThreads(int nThreads)
+{
+  gThreads = nThreads;
+}
+
+extern "C" int CpuGetThreads()
+{
+  return NThreads();
+}
+
+extern "C" void CpuInfo()
+{
+  printf("CPU backend of the track fit\n");
+  printf("  Hardware threads:                              %u\n", std::thread::hardware_concurrency());
+  printf("  Threads used:                                  %d\n", NThreads());
+  printf("  Tracks fitted together per thread:             %d\n", kLanes);
+  printf("  Hits per track (HIT):                          %d\n", HIT);
+  printf("  Tracks per batch (TRK):                        %d\n", TRK);
+}
+
+extern "C" void CircleFitC(double X[HIT], double Y[HIT], double Z[HIT], double Zerr[HIT],
+                           double* Mx, double* My, double* M0, double result[8])
+{
+  FitRange<double>(HIT, 0, 1, X, Y, Z, Zerr, Mx, My, M0, result);
+}
+
+extern "C" void CircleFitCF(float X[HIT], float Y[HIT], float Z[HIT], float Zerr[HIT],
+                            float* Mx, float* My, float* M0, float result[8])
+{
+  FitRange<float>(HIT, 0, 1, X, Y, Z, Zerr, Mx, My, M0, result);
+}
+
+extern "C" void CircleFitCAllD(double X[TRK*HIT], double Y[TRK*HIT], double Z[TRK*HIT], double Zerr[TRK*HIT],
+                               double Mx[TRK], double My[TRK], double M0[TRK], double result[8*TRK])
+{
+  FitAll<double>(TRK, HIT, X, Y, Z, Zerr, Mx, My, M0, result);
+}
+
+extern "C" void CircleFitCAllF(float X[TRK*HIT], float Y[TRK*HIT], float Z[TRK*HIT], float Zerr[TRK*HIT],
+                               float Mx[TRK], float My[TRK], float M0[TRK], float result[8*TRK])
+{
+  FitAll<float>(TRK, HIT, X, Y, Z, Zerr, Mx, My, M0, result);
+}
+
+extern "C" void CircleFitCBatchD(int nTrk, int nHit, const double* X, const double* Y, const double* Z,
+                                 const double* Zerr, const double* Mx, const double* My, const double* M0,
+                                 double* result)
+{
+  FitAll<double>(nTrk, nHit, X, Y, Z, Zerr, Mx, My, M0, result);
+}
+
+extern "C" void CircleFitCBatchF(int nTrk, int nHit, const float* X, const float* Y, const float* Z,
+                                 const float* Zerr, const float* Mx, const float* My, const float* M0,
+                                 float* result)
+{
+  FitAll<float>(nTrk, nHit, X, Y, Z, Zerr, Mx, My, M0, result);
+}
+
+extern "C" void CpuFilter(TMatrixD* h, TMatrixD* fM, TMatrixD* pull, TMatrixD* fH, TMatrixD* preC,
+                          TMatrixD* prea, TMatrixD* av, TMatrixD* curC, TMatrixD* fV, TMatrixD* fR,
+                          TMatrixD* fResVec, double* fDeltaChi2)
+{
+  // h = H a_pred, r = m - h, R = V + H C H^T, K = C H^T R^-1,
+  // a = a_pred + K r, C = (1 - K H) C_pred, chi2 = r^T R^-1 r,
+  // pull_i = r_i / sqrt(R_ii)
+  TMatrixD& H = *fH;
+  Int_t nMeas = H.GetNrows();
+  Int_t nState = H.GetNcols();
+  TMatrixD hC(H, TMatrixD::kMult, *preC);
+
+  h->ResizeTo(nMeas, 1);
+  h->Mult(H, *prea);
+  fResVec->ResizeTo(nMeas, 1);
+  *fResVec = *fM;
+  *fResVec -= *h;
+
+  fR->ResizeTo(nMeas, nMeas);
+  fR->MultT(hC, H);
+  *fR += *fV;
+
+  TMatrixD rInv(*fR);
+  rInv.Invert();
+  TMatrixD gain(hC, TMatrixD::kTransposeMult, rInv);
+
+  av->ResizeTo(nState, 1);
+  av->Mult(gain, *fResVec);
+  *av += *prea;
+
+  curC->ResizeTo(nState, nState);
+  curC->Mult(gain, hC);
+  *curC -= *preC;
+  *curC *= -1.;
+
+  TMatrixD rInvRes(rInv, TMatrixD::kMult, *fResVec);
+  TMatrixD chi2(*fResVec, TMatrixD::kTransposeMult, rInvRes);
+  *fDeltaChi2 = chi2(0, 0);
+
+  pull->ResizeTo(fResVec->GetNrows(), 1);
+  for (int i = 0; i < fResVec->GetNrows(); i++) {
+    (*pull)(i, 0) = (*fResVec)(i, 0) / std::sqrt((*fR)(i, i));
+  }
+}
+
+extern "C" void CpuFilterAll(int nTrk, int n, int m, const double* H, const double* meas, const double* V,
+                             const double* aPred, const double* CPred,
+                             double* a, double* C, double* chi2, int* ok)
+{
+  int nThreads = NThreads();
+  if (nThreads > nTrk) { nThreads = nTrk; }
+  if (nThreads <= 1) {
+    UpdateRange(0, nTrk, n, m, H, meas, V, aPred, CPred, a, C, chi2, ok);
+    return;
+  }
+  std::vector<std::thread> workers;
+  for (int w = 0; w < nThreads; w++) {
+    int first = nTrk * w / nThreads;
+    int last = nTrk * (w+1) / nThreads;
+    workers.push_back(std::thread(UpdateRange, first, last, n, m, H, meas, V, aPred, CPred, a, C, chi2, ok));
+  }
+  for (size_t w = 0; w < workers.size(); w++) {
+    workers[w].join();
+  }
+}
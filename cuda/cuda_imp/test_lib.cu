@@ -4,6 +4,14 @@
 #include <cutil.h>
 
   
+extern "C" int DeviceCount(void)
+{
+    int deviceCount = 0;
+    if (cudaGetDeviceCount(&deviceCount) != cudaSuccess)
+        return 0;
+    return deviceCount;
+}
+
 extern "C" void DeviceInfo(void)  
 {  
    int deviceCount;
@@ -11,17 +11,19 @@
 #include "../cuda_imp/HitTrk.h"
 #include "Rtypes.h"
 #include "TObject.h"
-#include "iostream.h"
 #include "TMatrixD.h"
+
+#ifdef FAIRCUDA_WITH_GPU
 //extern "C" Float_t denlan_(Float_t *x);
 extern "C" void IncrementArray(Int_t device);
 extern "C" void DeviceInfo();
+extern "C" Int_t DeviceCount();
 
 
 //extern "C" void runTest(Int_t argc);
 //extern "C" void CudaFilter(const double *, const double *, const double *, const double * , int , int , const double *, int, int, const double*, int, int, const double *, const double*);
 
-extern "C" void CudaFilter(TMatrixD* h, TMatrixD* fM, TMatrixD* pull, TMatrixD* fH, TMatrixD* preC, TMatrixD* prea, TMatrixD* av, TMatrixD* curC ,TMatrixD* fV, TMatrixD* fR, TMatrixD* fResVec, double* fDeltaChi2 );
+//extern "C" void CudaFilter(TMatrixD* h, TMatrixD* fM, TMatrixD* pull, TMatrixD* fH, TMatrixD* preC, TMatrixD* prea, TMatrixD* av, TMatrixD* curC ,TMatrixD* fV, TMatrixD* fR, TMatrixD* fResVec, double* fDeltaChi2 );
 
 
 extern "C" void CircleFitG(Double_t X[HIT], Double_t Y[HIT], Double_t Z[HIT], Double_t Zerr[HIT], Double_t* Mx,Double_t* My,Double_t* M0,Double_t result[8]);
@@ -32,50 +34,140 @@ extern "C" void CircleFitGAllF(Float_t X[TRK* HIT], Float_t Y[TRK* HIT], Float_t
 
 
 extern "C" void CircleFitGF(Float_t X[HIT], Float_t Y[HIT], Float_t Z[HIT], Float_t Zerr[HIT], Float_t* Mx,Float_t* My,Float_t* M0,Float_t result[8]);
+#endif
+
+// CPU backend, cpu_imp/trackfit_cpu.cxx
+extern "C" void CpuInfo();
+extern "C" void CpuSetThreads(Int_t nThreads);
+extern "C" Int_t CpuGetThreads();
+
+extern "C" void CpuFilter(TMatrixD* h, TMatrixD* fM, TMatrixD* pull, TMatrixD* fH, TMatrixD* preC, TMatrixD* prea, TMatrixD* av, TMatrixD* curC ,TMatrixD* fV, TMatrixD* fR, TMatrixD* fResVec, double* fDeltaChi2 );
+
+extern "C" void CpuFilterAll(Int_t nTrk, Int_t n, Int_t m, const Double_t* H, const Double_t* meas, const Double_t* V, const Double_t* aPred, const Double_t* CPred, Double_t* a, Double_t* C, Double_t* chi2, Int_t* ok);
+
+extern "C" void CircleFitC(Double_t X[HIT], Double_t Y[HIT], Double_t Z[HIT], Double_t Zerr[HIT], Double_t* Mx,Double_t* My,Double_t* M0,Double_t result[8]);
+
+extern "C" void CircleFitCAllD(Double_t X[TRK* HIT], Double_t Y[TRK* HIT], Double_t Z[TRK* HIT], Double_t Zerr[TRK* HIT], Double_t Mx[TRK],Double_t My[TRK],Double_t M0[TRK],Double_t result[8*TRK]);
+
+extern "C" void CircleFitCAllF(Float_t X[TRK* HIT], Float_t Y[TRK* HIT], Float_t Z[TRK* HIT], Float_t Zerr[TRK* HIT], Float_t Mx[TRK],Float_t My[TRK],Float_t M0[TRK],Float_t result[8*TRK]);
+
+extern "C" void CircleFitCF(Float_t X[HIT], Float_t Y[HIT], Float_t Z[HIT], Float_t Zerr[HIT], Float_t* Mx,Float_t* My,Float_t* M0,Float_t result[8]);
+
+extern "C" void CircleFitCBatchD(Int_t nTrk, Int_t nHit, const Double_t* X, const Double_t* Y, const Double_t* Z, const Double_t* Zerr, const Double_t* Mx, const Double_t* My, const Double_t* M0, Double_t* result);
+
+extern "C" void CircleFitCBatchF(Int_t nTrk, Int_t nHit, const Float_t* X, const Float_t* Y, const Float_t* Z, const Float_t* Zerr, const Float_t* Mx, const Float_t* My, const Float_t* M0, Float_t* result);
 
 class FairCuda : public TObject
 {
   public:
-    FairCuda() {;}
+    enum Backend { kGPU, kCPU };
+
+    /** Uses the GPU if the library is built with CUDA and a device is
+     ** found, the CPU otherwise. **/
+    FairCuda() : TObject(), fBackend(DefaultBackend()) {;}
     virtual ~FairCuda() {;}
 
+    /** Selects the backend, kGPU is ignored without CUDA support **/
+    void SetBackend(Backend backend) {
+#ifdef FAIRCUDA_WITH_GPU
+      fBackend = backend;
+#else
+      fBackend = kCPU;
+      (void)backend;
+#endif
+    }
+    Backend GetBackend() const { return fBackend; }
+
+    /** Number of threads of the CPU backend, 0 for all hardware threads **/
+    void SetCpuThreads(Int_t nThreads) { CpuSetThreads(nThreads); }
+    Int_t GetCpuThreads() const { return CpuGetThreads(); }
+
+#ifdef FAIRCUDA_WITH_GPU
     void IncrementArray_(Int_t device) {return IncrementArray(device);}
-    void DeviceInfo_() {return DeviceInfo();}
+#endif
+    void DeviceInfo_() {
+#ifdef FAIRCUDA_WITH_GPU
+      if (fBackend == kGPU) { return DeviceInfo(); }
+#endif
+      return CpuInfo();
+    }
 // void runTest_(Int_t argc){return runTest(argc);}
 //  void Filter(){cout << "Cuda Filter "<< endl;}
+    /** Kalman filter update of one track. There is no GPU implementation
+     ** of the filter, it always runs on the CPU. **/
     void Filter(TMatrixD* h, TMatrixD* fM, TMatrixD* pull, TMatrixD* fH, TMatrixD* preC, TMatrixD* prea, TMatrixD* av, TMatrixD* curC, TMatrixD* fV, TMatrixD* fR, TMatrixD* fResVec, double* fDeltaChi2) {
-      return CudaFilter(h,fM, pull, fH, preC, prea,av,curC, fV, fR,fResVec,fDeltaChi2);
+      return CpuFilter(h,fM, pull, fH, preC, prea,av,curC, fV, fR,fResVec,fDeltaChi2);
+    }
+
+    /** Kalman filter update of nTrk tracks with n parameters and m measurements,
+     ** row major arrays per track: H (m x n), meas (m), V (m x m), aPred (n),
+     ** CPred (n x n), output a (n), C (n x n), chi2 and ok (0 if failed).
+     ** Always runs on the CPU. **/
+    void FilterAll(Int_t nTrk, Int_t n, Int_t m, const Double_t* H, const Double_t* meas, const Double_t* V, const Double_t* aPred, const Double_t* CPred, Double_t* a, Double_t* C, Double_t* chi2, Int_t* ok) {
+      return CpuFilterAll(nTrk, n, m, H, meas, V, aPred, CPred, a, C, chi2, ok);
     }
 
 
     void CircleFit(Double_t X[HIT], Double_t Y[HIT],Double_t Z[HIT], Double_t Zerr[HIT], Double_t* Mx,Double_t* My,Double_t* M0, Double_t result[8]) {
       //  printf("\n Cuda  Mx = %f  My = %f\n ", Mx[0], My[0]);
-      return CircleFitG(X,Y,Z,Zerr,Mx,My,M0,result);
+#ifdef FAIRCUDA_WITH_GPU
+      if (fBackend == kGPU) { return CircleFitG(X,Y,Z,Zerr,Mx,My,M0,result); }
+#endif
+      return CircleFitC(X,Y,Z,Zerr,Mx,My,M0,result);
     }
 
 
     void CircleFitAllD(Double_t X[TRK* HIT], Double_t Y[TRK* HIT],Double_t Z[TRK* HIT], Double_t Zerr[TRK* HIT], Double_t Mx[TRK],Double_t My[TRK],Double_t M0[TRK], Double_t result[8*TRK]) {
       //    printf("\n Fair Cuda  : Call GPU function \n ");
-      return CircleFitGAllD(X,Y,Z,Zerr,Mx,My,M0,result);
+#ifdef FAIRCUDA_WITH_GPU
+      if (fBackend == kGPU) { return CircleFitGAllD(X,Y,Z,Zerr,Mx,My,M0,result); }
+#endif
+      return CircleFitCAllD(X,Y,Z,Zerr,Mx,My,M0,result);
 //       printf("\n Fair Cuda  : Back to Application \n ");
 
     }
 
     void CircleFitAllF(Float_t X[TRK* HIT], Float_t Y[TRK* HIT],Float_t Z[TRK* HIT], Float_t Zerr[TRK* HIT], Float_t Mx[TRK],Float_t My[TRK],Float_t M0[TRK], Float_t result[8*TRK]) {
 //       printf("\n Fair Cuda  : Call GPU function \n ");
-      return CircleFitGAllF(X,Y,Z,Zerr,Mx,My,M0,result);
+#ifdef FAIRCUDA_WITH_GPU
+      if (fBackend == kGPU) { return CircleFitGAllF(X,Y,Z,Zerr,Mx,My,M0,result); }
+#endif
+      return CircleFitCAllF(X,Y,Z,Zerr,Mx,My,M0,result);
 //       printf("\n Fair Cuda  : Back to Application \n ");
 
     }
 
+    /** Fit of nTrk tracks with nHit hits each, same layout as CircleFitAllD.
+     ** Always runs on the CPU. **/
+    void CircleFitBatchD(Int_t nTrk, Int_t nHit, const Double_t* X, const Double_t* Y, const Double_t* Z, const Double_t* Zerr, const Double_t* Mx, const Double_t* My, const Double_t* M0, Double_t* result) {
+      return CircleFitCBatchD(nTrk, nHit, X, Y, Z, Zerr, Mx, My, M0, result);
+    }
+
+    void CircleFitBatchF(Int_t nTrk, Int_t nHit, const Float_t* X, const Float_t* Y, const Float_t* Z, const Float_t* Zerr, const Float_t* Mx, const Float_t* My, const Float_t* M0, Float_t* result) {
+      return CircleFitCBatchF(nTrk, nHit, X, Y, Z, Zerr, Mx, My, M0, result);
+    }
+
 
 
     void CircleFitF (Float_t X[HIT], Float_t Y[HIT],Float_t Z[HIT], Float_t Zerr[HIT], Float_t* Mx,Float_t* My,Float_t* M0, Float_t result[8]) {
       //  printf("\n Cuda  Mx = %f  My = %f\n ", Mx[0], My[0]);
-      return CircleFitGF(X,Y,Z,Zerr,Mx,My,M0,result);
+#ifdef FAIRCUDA_WITH_GPU
+      if (fBackend == kGPU) { return CircleFitGF(X,Y,Z,Zerr,Mx,My,M0,result); }
+#endif
+      return CircleFitCF(X,Y,Z,Zerr,Mx,My,M0,result);
     }
 
-    ClassDef(FairCuda, 1)
+  private:
+    static Backend DefaultBackend() {
+#ifdef FAIRCUDA_WITH_GPU
+      if (DeviceCount() > 0) { return kGPU; }
+#endif
+      return kCPU;
+    }
+
+    Backend fBackend;
+
+    ClassDef(FairCuda, 2)
 };
 
 
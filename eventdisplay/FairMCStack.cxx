@@ -13,6 +13,7 @@
 #include "FairMCStack.h"
 #include "FairGeanePro.h"
 #include "FairTrajFilter.h"
+#include "FairCompactTrajectories.h"
 #include "FairRootManager.h"
 #include "FairEventManager.h"
 #include "FairMCTrack.h"
@@ -27,6 +28,7 @@
 #include "TGeant3.h"
 
 #include <iostream>
+#include <vector>
 
 // -----   Default constructor   -------------------------------------------
 FairMCStack::FairMCStack()
@@ -159,12 +161,26 @@ void FairMCStack::Exec(Option_t* /*option*/)
       //  gMC3->Ertrak(x1,p1,x2,p2,GeantCode,"L");
       fPro->PropagateToLength(100.0);
       fPro->Propagate(x1, p1, x2, p2,tr->GetPdgCode());
-      TGeoTrack* tr1= fTrajFilter->GetCurrentTrk();
 
-      Int_t Np=tr1->GetNpoints();
+      // x, y, z, t of the propagated points, the last trajectory of the filter
+      std::vector<Double_t> points;
+      if (fTrajFilter && fTrajFilter->IsCompactStorage()) {
+        FairCompactTrajectories* compact = fTrajFilter->GetCompactTracks();
+        if (compact && compact->GetNTracks() > 0) {
+          compact->GetPoints(compact->GetNTracks()-1, points);
+        }
+      } else if (fTrajFilter && fTrajFilter->GetCurrentTrk()) {
+        TGeoTrack* tr1= fTrajFilter->GetCurrentTrk();
+        for (Int_t n=0; n<tr1->GetNpoints(); n++) {
+          point=tr1->GetPoint(n);
+          points.insert(points.end(), point, point+4);
+        }
+      }
+
+      Int_t Np=points.size()/4;
 
       for (Int_t n=0; n<Np; n++) {
-        point=tr1->GetPoint(n);
+        point=&points[4*n];
         track->SetPoint(n,point[0],point[1],point[2]);
         TEveVector pos= TEveVector(point[0], point[1],point[2]);
         TEvePathMark* path = new TEvePathMark();
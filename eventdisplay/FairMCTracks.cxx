@@ -11,6 +11,7 @@
 // -------------------------------------------------------------------------
 #include "FairMCTracks.h"
 
+#include "FairCompactTrajectories.h"    // for FairCompactTrajectories
 #include "FairEventManager.h"           // for FairEventManager
 #include "FairRootManager.h"            // for FairRootManager
 #include "FairLogger.h"
@@ -29,12 +30,14 @@
 
 #include <string.h>                     // for NULL, strcmp
 #include <iostream>                     // for operator<<, basic_ostream, etc
+#include <vector>                       // for vector
 
 
 // -----   Default constructor   -------------------------------------------
 FairMCTracks::FairMCTracks()
   : FairTask("FairMCTracks", 0),
     fTrackList(NULL),
+    fCompactTrackList(NULL),
     fTrPr(NULL),
     fEventManager(NULL),
     fEveTrList(NULL),
@@ -52,6 +55,7 @@ FairMCTracks::FairMCTracks()
 FairMCTracks::FairMCTracks(const char* name, Int_t iVerbose)
   : FairTask(name, iVerbose),
     fTrackList(NULL),
+    fCompactTrackList(NULL),
     fTrPr(NULL),
     fEventManager(NULL),
     fEveTrList(new TObjArray(16)),
@@ -69,6 +73,10 @@ InitStatus FairMCTracks::Init()
   FairRootManager* fManager = FairRootManager::Instance();
   fTrackList = static_cast<TClonesArray*>(fManager->GetObject("GeoTracks"));
   if(fTrackList==0) {
+    // trajectories stored in compact format
+    fCompactTrackList = static_cast<FairCompactTrajectories*>(fManager->GetObject("GeoTracksCompact"));
+  }
+  if(fTrackList==0 && fCompactTrackList==0) {
     LOG(ERROR) << "FairMCTracks::Init()  branch " << GetName() << " Not found! Task will be deactivated "<< FairLogger::endl;
     SetActive(kFALSE);
   }
@@ -90,50 +98,26 @@ void FairMCTracks::Exec(Option_t* /*option*/)
   if (IsActive()) {
 
     LOG(DEBUG1) << " FairMCTracks::Exec "<< FairLogger::endl; 
-    TGeoTrack* tr;
-    const Double_t* point;
 
     Reset();
 
-    for (Int_t i=0; i<fTrackList->GetEntriesFast(); i++)  {
-      LOG(DEBUG3) << "FairMCTracks::Exec "<< i << FairLogger::endl; 
-      tr=static_cast<TGeoTrack*>(fTrackList->At(i));
-      TParticle* P=static_cast<TParticle*>(tr->GetParticle());
-      PEnergy=P->Energy();
-      MinEnergyLimit=TMath::Min(PEnergy,MinEnergyLimit) ;
-      MaxEnergyLimit=TMath::Max(PEnergy,MaxEnergyLimit) ;
-      LOG(DEBUG3)<< "MinEnergyLimit " << MinEnergyLimit << " MaxEnergyLimit " << MaxEnergyLimit << FairLogger::endl; 
-      if (fEventManager->IsPriOnly() && P->GetMother(0)>-1) { continue; }
-      if(fEventManager->GetCurrentPDG()!=0 && fEventManager->GetCurrentPDG()!= tr->GetPDG()) { continue; }
-      LOG(DEBUG3) << "PEnergy " << PEnergy << " Min "  << fEventManager->GetMinEnergy() << " Max " << fEventManager->GetMaxEnergy() << FairLogger::endl; 
-      if( (PEnergy<fEventManager->GetMinEnergy()) || (PEnergy >fEventManager->GetMaxEnergy())) { continue; }
-
-      Int_t Np=tr->GetNpoints();
-      fTrList= GetTrGroup(P);
-      TEveTrack* track= new TEveTrack(P, tr->GetPDG(), fTrPr);
-      track->SetLineColor(fEventManager->Color(tr->GetPDG()));
-      for (Int_t n=0; n<Np; n++) {
-        point=tr->GetPoint(n);
-        track->SetPoint(n,point[0],point[1],point[2]);
-        TEveVector pos= TEveVector(point[0], point[1],point[2]);
-        TEvePathMark* path = new TEvePathMark();
-        path->fV=pos ;
-        path->fTime= point[3];
-        if(n==0) {
-          TEveVector Mom= TEveVector(P->Px(), P->Py(),P->Pz());
-          path->fP=Mom;
-        }
-        LOG(DEBUG4) << "Path marker added " << path << FairLogger::endl; 
-
-        track->AddPathMark(*path);
-
-        LOG(DEBUG4) << "Path marker added " << path << FairLogger::endl; 
-
-        delete path;
+    if (fTrackList) {
+      TGeoTrack* tr;
+      for (Int_t i=0; i<fTrackList->GetEntriesFast(); i++)  {
+        LOG(DEBUG3) << "FairMCTracks::Exec "<< i << FairLogger::endl; 
+        tr=static_cast<TGeoTrack*>(fTrackList->At(i));
+        Int_t Np=tr->GetNpoints();
+        AddTrack(static_cast<TParticle*>(tr->GetParticle()), tr->GetPDG(), Np, Np > 0 ? tr->GetPoint(0) : NULL);
+      }
+    } else {
+      TParticle P;
+      std::vector<Double_t> points;
+      for (Int_t i=0; i<fCompactTrackList->GetNTracks(); i++)  {
+        LOG(DEBUG3) << "FairMCTracks::Exec "<< i << FairLogger::endl; 
+        fCompactTrackList->GetParticle(i, P);
+        fCompactTrackList->GetPoints(i, points);
+        AddTrack(&P, fCompactTrackList->GetPdgCode(i), fCompactTrackList->GetNPoints(i), points.data());
       }
-      fTrList->AddElement(track);
-      LOG(DEBUG3) << "track added " << track->GetName() << FairLogger::endl; 
-
     }
     for (Int_t i=0; i<fEveTrList->GetEntriesFast(); i++) {
       // TEveTrackList *TrListIn=( TEveTrackList *) fEveTrList->At(i);
@@ -144,6 +128,45 @@ void FairMCTracks::Exec(Option_t* /*option*/)
     gEve->Redraw3D(kFALSE);
   }
 }
+// -------------------------------------------------------------------------
+void FairMCTracks::AddTrack(TParticle* P, Int_t pdg, Int_t Np, const Double_t* points)
+{
+  const Double_t* point;
+
+  PEnergy=P->Energy();
+  MinEnergyLimit=TMath::Min(PEnergy,MinEnergyLimit) ;
+  MaxEnergyLimit=TMath::Max(PEnergy,MaxEnergyLimit) ;
+  LOG(DEBUG3)<< "MinEnergyLimit " << MinEnergyLimit << " MaxEnergyLimit " << MaxEnergyLimit << FairLogger::endl; 
+  if (fEventManager->IsPriOnly() && P->GetMother(0)>-1) { return; }
+  if(fEventManager->GetCurrentPDG()!=0 && fEventManager->GetCurrentPDG()!= pdg) { return; }
+  LOG(DEBUG3) << "PEnergy " << PEnergy << " Min "  << fEventManager->GetMinEnergy() << " Max " << fEventManager->GetMaxEnergy() << FairLogger::endl; 
+  if( (PEnergy<fEventManager->GetMinEnergy()) || (PEnergy >fEventManager->GetMaxEnergy())) { return; }
+
+  fTrList= GetTrGroup(P);
+  TEveTrack* track= new TEveTrack(P, pdg, fTrPr);
+  track->SetLineColor(fEventManager->Color(pdg));
+  for (Int_t n=0; n<Np; n++) {
+    point=points + 4*n;
+    track->SetPoint(n,point[0],point[1],point[2]);
+    TEveVector pos= TEveVector(point[0], point[1],point[2]);
+    TEvePathMark* path = new TEvePathMark();
+    path->fV=pos ;
+    path->fTime= point[3];
+    if(n==0) {
+      TEveVector Mom= TEveVector(P->Px(), P->Py(),P->Pz());
+      path->fP=Mom;
+    }
+    LOG(DEBUG4) << "Path marker added " << path << FairLogger::endl; 
+
+    track->AddPathMark(*path);
+
+    LOG(DEBUG4) << "Path marker added " << path << FairLogger::endl; 
+
+    delete path;
+  }
+  fTrList->AddElement(track);
+  LOG(DEBUG3) << "track added " << track->GetName() << FairLogger::endl; 
+}
 // -----   Destructor   ----------------------------------------------------
 FairMCTracks::~FairMCTracks()
 {
@@ -27,6 +27,7 @@
 #include "TEveTrackPropagator.h"        // IWYU pragma: keep needed by cint
 #include "TString.h"                    // for TString
 
+class FairCompactTrajectories;
 class FairEventManager;
 class TClonesArray;
 class TEveTrackList;
@@ -62,11 +63,16 @@ class FairMCTracks : public FairTask
     virtual void Finish();
     void Reset();
     TEveTrackList* GetTrGroup(TParticle* P);
+    /** Adds the track to the display, if it passes the selection of the event manager
+     *@param points  x, y, z, t of each point
+     **/
+    void AddTrack(TParticle* P, Int_t pdg, Int_t Np, const Double_t* points);
 
   protected:
 
 
     TClonesArray*  fTrackList;  //!
+    FairCompactTrajectories* fCompactTrackList;  //!
     TEveTrackPropagator* fTrPr;
     FairEventManager* fEventManager;  //!
     TObjArray* fEveTrList;
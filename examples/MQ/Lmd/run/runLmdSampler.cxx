@@ -26,7 +26,8 @@ void addCustomOptions(bpo::options_description& options)
         ("lmd-proc-id",     bpo::value<short>(),        "sub-event procId")
         ("lmd-sub-crate",   bpo::value<short>(),        "sub-event subCrate")
         ("lmd-control",     bpo::value<short>(),        "sub-event control")
-        ("lmd-chan-name",   bpo::value<std::string>(),  "MQ-channel name for this sub-event");
+        ("lmd-chan-name",   bpo::value<std::string>(),  "MQ-channel name for this sub-event")
+        ("lmd-batch-size",  bpo::value<int>()->default_value(0), "events per message, 0: one message per sub-event");
 }
 
 FairMQDevicePtr getDevice(const FairMQProgOptions& /*config*/)
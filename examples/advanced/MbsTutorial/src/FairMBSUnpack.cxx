@@ -24,6 +24,8 @@ FairMBSUnpack::FairMBSUnpack(Short_t type, Short_t subType, Short_t procId, Shor
     , fRawData(new TClonesArray("FairMBSRawItem"))
     , fNHits(0)
     , fNHitsTotal(0)
+    , fFailEvery(0)
+    , fNCalls(0)
 {
 }
 
@@ -59,6 +61,13 @@ Bool_t FairMBSUnpack::DoUnpack(Int_t* data, Int_t size)
 {
     LOG(DEBUG) << "FairMBSUnpack : Unpacking... size = " << size << FairLogger::endl;
 
+    fNCalls++;
+    if (fFailEvery > 0 && 0 == fNCalls % fFailEvery)
+    {
+        LOG(DEBUG) << "FairMBSUnpack : Failing call " << fNCalls << FairLogger::endl;
+        return kFALSE;
+    }
+
     Int_t l_i = 0;
 
     Int_t n17 = 0;
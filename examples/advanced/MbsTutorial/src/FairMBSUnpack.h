@@ -44,6 +44,13 @@ class FairMBSUnpack : public FairUnpack
         return fNHitsTotal;
     }
 
+    /** Every n-th call of DoUnpack fails without output, to test the
+     *  error handling of the sources (0: never). */
+    inline void SetFailEvery(Int_t n)
+    {
+        fFailEvery = n;
+    }
+
   protected:
     /** Register the output structures. */
     virtual void Register();
@@ -52,12 +59,14 @@ class FairMBSUnpack : public FairUnpack
     TClonesArray* fRawData; /**< Array of output raw items. */
     Int_t fNHits;           /**< Number of raw items in current event. */
     Int_t fNHitsTotal;      /**< Total number of raw items. */
+    Int_t fFailEvery;       /**< Every n-th call of DoUnpack fails, 0: never. */
+    Int_t fNCalls;          /**< Number of calls of DoUnpack. */
 
     FairMBSUnpack(const FairMBSUnpack&);
     FairMBSUnpack& operator=(const FairMBSUnpack&);
   public:
     // Class definition
-    ClassDef(FairMBSUnpack, 1)
+    ClassDef(FairMBSUnpack, 2)
 };
 
 #endif
@@ -334,6 +334,25 @@ void FairStack::UpdateTrackIndex(TRefArray* detList)
 
 
 
+// -----   Public method ShiftTrackIndex   ---------------------------------
+void FairStack::ShiftTrackIndex(TClonesArray* tracks, Int_t offset) const
+{
+  if ( tracks->GetClass() != FairMCTrack::Class() ) {
+    FairGenericStack::ShiftTrackIndex(tracks, offset);
+    return;
+  }
+
+  for (Int_t i=0; i<tracks->GetEntriesFast(); i++) {
+    FairMCTrack* track = static_cast<FairMCTrack*>(tracks->At(i));
+    if ( track->GetMotherId() >= 0 ) {
+      track->SetMotherId(track->GetMotherId() + offset);
+    }
+  }
+}
+// -------------------------------------------------------------------------
+
+
+
 // -----   Public method Reset   -------------------------------------------
 void FairStack::Reset()
 {
@@ -202,6 +202,12 @@ class FairStack : public FairGenericStack
     TParticle* GetParticle(Int_t trackId) const;
     TClonesArray* GetListOfParticles() { return fParticles; }
 
+    /** Output array of FairMCTracks **/
+    virtual TClonesArray* GetTrackArray() { return fTracks; }
+
+    /** Shift the mother ids of the FairMCTracks in an output array **/
+    virtual void ShiftTrackIndex(TClonesArray* tracks, Int_t offset) const;
+
     /** Clone this object (used in MT mode only) */
     virtual FairGenericStack* CloneStack() const { return new FairStack(); }
 
@@ -0,0 +1,22 @@
+#!/bin/bash
+################################################################################
+#    Copyright (C) 2014 GSI Helmholtzzentrum fuer Schwerionenforschung GmbH    #
+#                                                                              #
+#              This software is distributed under the terms of the             #
+#         GNU Lesser General Public Licence version 3 (LGPL) version 3,        #
+#                  copied verbatim in the file "LICENSE"                       #
+################################################################################
+# Scaling benchmark of the multi-threaded Geant4 simulation of Tutorial1.
+# Runs run_tutorial1_mt.C for 1 to 32 threads, with one output file per
+# thread and with merged output, and prints the event rate for each run.
+# Has to be started from the build directory of the macros, e.g.
+#   cd build/examples/simulation/Tutorial1/macros
+#   ./mt_scaling.sh [nEvents]
+
+nEvents=${1:-1000}
+
+for merged in 0 1; do
+  for nThreads in 1 2 4 8 16 32; do
+    ./run_tutorial1_mt.sh $nEvents $nThreads $merged | grep "events/s"
+  done
+done
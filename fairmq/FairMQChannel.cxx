@@ -36,6 +36,8 @@ FairMQChannel::FairMQChannel()
     , fSndKernelSize(0)
     , fRcvKernelSize(0)
     , fRateLogging(1)
+    , fIoAffinity(0)
+    , fShmSegment()
     , fName("")
     , fIsValid(false)
     , fPoller(nullptr)
@@ -61,6 +63,8 @@ FairMQChannel::FairMQChannel(const string& type, const string& method, const str
     , fSndKernelSize(0)
     , fRcvKernelSize(0)
     , fRateLogging(1)
+    , fIoAffinity(0)
+    , fShmSegment()
     , fName("")
     , fIsValid(false)
     , fPoller(nullptr)
@@ -86,6 +90,8 @@ FairMQChannel::FairMQChannel(const string& name, const string& type, std::shared
     , fSndKernelSize(0)
     , fRcvKernelSize(0)
     , fRateLogging(1)
+    , fIoAffinity(0)
+    , fShmSegment()
     , fName(name)
     , fIsValid(false)
     , fPoller(nullptr)
@@ -111,6 +117,8 @@ FairMQChannel::FairMQChannel(const FairMQChannel& chan)
     , fSndKernelSize(chan.fSndKernelSize)
     , fRcvKernelSize(chan.fRcvKernelSize)
     , fRateLogging(chan.fRateLogging)
+    , fIoAffinity(chan.fIoAffinity)
+    , fShmSegment(chan.fShmSegment)
     , fName(chan.fName)
     , fIsValid(false)
     , fPoller(nullptr)
@@ -135,6 +143,8 @@ FairMQChannel& FairMQChannel::operator=(const FairMQChannel& chan)
     fSndKernelSize = chan.fSndKernelSize;
     fRcvKernelSize = chan.fRcvKernelSize;
     fRateLogging = chan.fRateLogging;
+    fIoAffinity = chan.fIoAffinity;
+    fShmSegment = chan.fShmSegment;
     fSocket = nullptr;
     fName = chan.fName;
     fIsValid = false;
@@ -300,6 +310,34 @@ int FairMQChannel::GetRateLogging() const
     }
 }
 
+int FairMQChannel::GetIoAffinity() const
+{
+    try
+    {
+        unique_lock<mutex> lock(fChannelMutex);
+        return fIoAffinity;
+    }
+    catch (exception& e)
+    {
+        LOG(ERROR) << "Exception caught in FairMQChannel::GetIoAffinity: " << e.what();
+        exit(EXIT_FAILURE);
+    }
+}
+
+string FairMQChannel::GetShmSegment() const
+{
+    try
+    {
+        unique_lock<mutex> lock(fChannelMutex);
+        return fShmSegment;
+    }
+    catch (exception& e)
+    {
+        LOG(ERROR) << "Exception caught in FairMQChannel::GetShmSegment: " << e.what();
+        exit(EXIT_FAILURE);
+    }
+}
+
 void FairMQChannel::UpdateType(const string& type)
 {
     try
@@ -444,6 +482,38 @@ void FairMQChannel::UpdateRateLogging(const int rateLogging)
     }
 }
 
+void FairMQChannel::UpdateIoAffinity(const int ioAffinity)
+{
+    try
+    {
+        unique_lock<mutex> lock(fChannelMutex);
+        fIsValid = false;
+        fIoAffinity = ioAffinity;
+        fModified = true;
+    }
+    catch (exception& e)
+    {
+        LOG(ERROR) << "Exception caught in FairMQChannel::UpdateIoAffinity: " << e.what();
+        exit(EXIT_FAILURE);
+    }
+}
+
+void FairMQChannel::UpdateShmSegment(const string& shmSegment)
+{
+    try
+    {
+        unique_lock<mutex> lock(fChannelMutex);
+        fIsValid = false;
+        fShmSegment = shmSegment;
+        fModified = true;
+    }
+    catch (exception& e)
+    {
+        LOG(ERROR) << "Exception caught in FairMQChannel::UpdateShmSegment: " << e.what();
+        exit(EXIT_FAILURE);
+    }
+}
+
 auto FairMQChannel::SetModified(const bool modified) -> void
 {
     try
@@ -652,6 +722,15 @@ bool FairMQChannel::ValidateChannel()
             exit(EXIT_FAILURE);
         }
 
+        // validate socket I/O thread affinity
+        if (fIoAffinity < 0)
+        {
+            ss << "INVALID";
+            LOG(DEBUG) << ss.str();
+            LOG(ERROR) << "invalid socket I/O thread affinity (cannot be negative): \"" << fIoAffinity << "\"";
+            exit(EXIT_FAILURE);
+        }
+
         fIsValid = true;
         ss << "VALID";
         LOG(DEBUG) << ss.str();
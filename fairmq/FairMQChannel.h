@@ -97,8 +97,8 @@ class FairMQChannel
     /// @return Returns socket address (e.g. "tcp://127.0.0.1:5555" or "ipc://abc")
     std::string GetAddress() const;
 
-    /// Get channel transport ("default", "zeromq", "nanomsg" or "shmem")
-    /// @return Returns channel transport (e.g. "default", "zeromq", "nanomsg" or "shmem")
+    /// Get channel transport ("default", "zeromq", "nanomsg", "shmem" or "inproc")
+    /// @return Returns channel transport (e.g. "default", "zeromq", "nanomsg", "shmem" or "inproc")
     std::string GetTransport() const;
 
     /// Get socket send buffer size (in number of messages)
@@ -121,6 +121,14 @@ class FairMQChannel
     /// @return Returns socket rate logging interval (in seconds)
     int GetRateLogging() const;
 
+    /// Get I/O thread affinity of the socket (bitmask of I/O threads, 0 for any)
+    /// @return Returns I/O thread affinity of the socket (bitmask of I/O threads, 0 for any)
+    int GetIoAffinity() const;
+
+    /// Get name of the shared memory segment used for messages of this channel (shmem transport, empty for the default segment)
+    /// @return Returns name of the shared memory segment used for messages of this channel
+    std::string GetShmSegment() const;
+
     /// Set socket type
     /// @param type Socket type (push/pull/pub/sub/spub/xsub/pair/req/rep/dealer/router/)
     void UpdateType(const std::string& type);
@@ -134,7 +142,7 @@ class FairMQChannel
     void UpdateAddress(const std::string& address);
 
     /// Set channel transport
-    /// @param transport transport string ("default", "zeromq", "nanomsg" or "shmem")
+    /// @param transport transport string ("default", "zeromq", "nanomsg", "shmem" or "inproc")
     void UpdateTransport(const std::string& transport);
 
     /// Set socket send buffer size
@@ -157,6 +165,16 @@ class FairMQChannel
     /// @param rateLogging Socket rate logging interval (in seconds)
     void UpdateRateLogging(const int rateLogging);
 
+    /// Set I/O thread affinity of the socket: bitmask of the I/O threads that handle its connections (0 for any).
+    /// Combined with --io-threads-affinity this keeps the traffic of a channel on a given set of CPUs.
+    /// @param ioAffinity Bitmask of I/O threads (0 for any)
+    void UpdateIoAffinity(const int ioAffinity);
+
+    /// Set the shared memory segment to allocate the messages of this channel in (shmem transport only).
+    /// Independent pipelines on the same node can use separate segments (e.g. on different NUMA nodes, see --shm-segments).
+    /// @param shmSegment Name of the segment, empty for the default segment (--shm-segment-name)
+    void UpdateShmSegment(const std::string& shmSegment);
+
     /// Set channel name
     /// @param name Arbitrary channel name
     void UpdateChannelName(const std::string& name);
@@ -314,6 +332,8 @@ class FairMQChannel
     int fSndKernelSize;
     int fRcvKernelSize;
     int fRateLogging;
+    int fIoAffinity;
+    std::string fShmSegment;
 
     std::string fName;
     std::atomic<bool> fIsValid;
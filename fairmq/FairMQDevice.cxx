@@ -29,6 +29,7 @@
 #include "options/FairMQProgOptions.h"
 #include "zeromq/FairMQTransportFactoryZMQ.h"
 #include "shmem/FairMQTransportFactorySHM.h"
+#include "inproc/FairMQTransportFactoryInproc.h"
 #ifdef NANOMSG_FOUND
 #include "nanomsg/FairMQTransportFactoryNN.h"
 #endif
@@ -42,6 +43,8 @@ FairMQDevice::FairMQDevice()
     , fConfig(nullptr)
     , fId()
     , fNumIoThreads(1)
+    , fAffinity()
+    , fNumaNode(-1)
     , fInitialValidationFinished(false)
     , fInitialValidationCondition()
     , fInitialValidationMutex()
@@ -71,6 +74,8 @@ FairMQDevice::FairMQDevice(const fair::mq::tools::Version version)
     , fConfig(nullptr)
     , fId()
     , fNumIoThreads(1)
+    , fAffinity()
+    , fNumaNode(-1)
     , fInitialValidationFinished(false)
     , fInitialValidationCondition()
     , fInitialValidationMutex()
@@ -117,6 +122,9 @@ void FairMQDevice::InitWrapper()
         msg->SetDeviceId(fId);
     }
 
+    // the state handlers (Init/InitTask/Run/OnData) are executed in this thread, threads spawned from here inherit its placement
+    ApplyPlacement();
+
     // Containers to store the uninitialized channels.
     vector<FairMQChannel*> uninitializedBindingChannels;
     vector<FairMQChannel*> uninitializedConnectingChannels;
@@ -232,6 +240,38 @@ void FairMQDevice::InitWrapper()
     ChangeState(internal_DEVICE_READY);
 }
 
+void FairMQDevice::ApplyPlacement()
+{
+    vector<int> cpus;
+
+    if (fAffinity != "")
+    {
+        cpus = fair::mq::tools::parseCpuList(fAffinity);
+        if (cpus.empty())
+        {
+            LOG(ERROR) << "Invalid device affinity: '" << fAffinity << "'";
+            throw runtime_error(fair::mq::tools::ToString("Invalid device affinity: '", fAffinity, "'"));
+        }
+    }
+    else if (fNumaNode >= 0)
+    {
+        cpus = fair::mq::tools::getNumaNodeCpus(fNumaNode);
+        if (cpus.empty())
+        {
+            LOG(ERROR) << "NUMA node " << fNumaNode << " not found (available: " << fair::mq::tools::getNumNumaNodes() << ")";
+            throw runtime_error(fair::mq::tools::ToString("NUMA node ", fNumaNode, " not found"));
+        }
+    }
+
+    if (!cpus.empty())
+    {
+        fair::mq::tools::setThreadAffinity(cpus);
+    }
+
+    LOG(INFO) << "Device placement: CPUs " << fair::mq::tools::cpuListToString(fair::mq::tools::getThreadAffinity())
+              << (fNumaNode >= 0 ? fair::mq::tools::ToString(" (NUMA node ", fNumaNode, ")") : string(" (no NUMA placement)"));
+}
+
 void FairMQDevice::WaitForInitialValidation()
 {
     unique_lock<mutex> lock(fInitialValidationMutex);
@@ -283,6 +323,19 @@ bool FairMQDevice::AttachChannel(FairMQChannel& ch)
             LOG(DEBUG) << ch.fName << ": channel transport (" << fDefaultTransport << ") overriden to " << ch.fTransport;
             ch.InitTransport(AddTransport(ch.fTransport));
         }
+
+        if (ch.fShmSegment != "")
+        {
+            if (ch.fTransportFactory->GetType() == FairMQ::Transport::SHM)
+            {
+                LOG(DEBUG) << ch.fName << ": using shared memory segment '" << ch.fShmSegment << "'";
+                ch.InitTransport(FairMQTransportFactorySHM::CreateSegmentTransport(ch.fTransportFactory, ch.fShmSegment));
+            }
+            else
+            {
+                LOG(WARN) << ch.fName << ": shmSegment '" << ch.fShmSegment << "' is ignored for non-shmem transports";
+            }
+        }
         ch.fTransportType = ch.fTransportFactory->GetType();
     }
 
@@ -310,6 +363,13 @@ bool FairMQDevice::AttachChannel(FairMQChannel& ch)
             ch.fSocket->SetOption("rcv-size", &(ch.fRcvKernelSize), sizeof(ch.fRcvKernelSize));
         }
 
+        // restrict the socket to a subset of the I/O threads
+        if (ch.fIoAffinity != 0)
+        {
+            uint64_t ioAffinity = ch.fIoAffinity;
+            ch.fSocket->SetOption("affinity", &ioAffinity, sizeof(ioAffinity));
+        }
+
         // attach
         bool bind = (ch.fMethod == "bind");
         bool connectionModifier = false;
@@ -811,6 +871,10 @@ unique_ptr<FairMQTransportFactory> FairMQDevice::MakeTransport(const string& tra
     {
         tr = fair::mq::tools::make_unique<FairMQTransportFactorySHM>();
     }
+    else if (transport == "inproc")
+    {
+        tr = fair::mq::tools::make_unique<FairMQTransportFactoryInproc>();
+    }
 #ifdef NANOMSG_FOUND
     else if (transport == "nanomsg")
     {
@@ -822,6 +886,7 @@ unique_ptr<FairMQTransportFactory> FairMQDevice::MakeTransport(const string& tra
         LOG(ERROR) << "Unavailable transport requested: " << "\"" << transport << "\"" << ". Available are: "
                    << "\"zeromq\""
                    << "\"shmem\""
+                   << ", \"inproc\""
 #ifdef NANOMSG_FOUND
                    << ", \"nanomsg\""
 #endif
@@ -852,6 +917,8 @@ void FairMQDevice::CreateOwnConfig()
     fId = fConfig->GetValue<string>("id");
     fNetworkInterface = fConfig->GetValue<string>("network-interface");
     fNumIoThreads = fConfig->GetValue<int>("io-threads");
+    fAffinity = fConfig->GetValue<string>("affinity");
+    fNumaNode = fConfig->GetValue<int>("numa-node");
     fInitializationTimeoutInS = fConfig->GetValue<int>("initialization-timeout");
 }
 
@@ -892,6 +959,8 @@ void FairMQDevice::SetConfig(FairMQProgOptions& config)
     fId = config.GetValue<string>("id");
     fNetworkInterface = config.GetValue<string>("network-interface");
     fNumIoThreads = config.GetValue<int>("io-threads");
+    fAffinity = config.GetValue<string>("affinity");
+    fNumaNode = config.GetValue<int>("numa-node");
     fInitializationTimeoutInS = config.GetValue<int>("initialization-timeout");
 }
 
@@ -292,14 +292,14 @@ class FairMQDevice : public FairMQStateMachine
     void WaitForInitialValidation();
 
     /// Adds a transport to the device if it doesn't exist
-    /// @param transport  Transport string ("zeromq"/"nanomsg"/"shmem")
+    /// @param transport  Transport string ("zeromq"/"nanomsg"/"shmem"/"inproc")
     std::shared_ptr<FairMQTransportFactory> AddTransport(const std::string& transport);
     /// Sets the default transport for the device
-    /// @param transport  Transport string ("zeromq"/"nanomsg"/"shmem")
+    /// @param transport  Transport string ("zeromq"/"nanomsg"/"shmem"/"inproc")
     void SetTransport(const std::string& transport = "zeromq");
 
     /// Creates stand-alone transport factory
-    /// @param transport  Transport string ("zeromq"/"nanomsg"/"shmem")
+    /// @param transport  Transport string ("zeromq"/"nanomsg"/"shmem"/"inproc")
     static std::unique_ptr<FairMQTransportFactory> MakeTransport(const std::string& transport) __attribute__((deprecated("Use 'static auto FairMQTransportFactory::CreateTransportFactory() -> std::shared_ptr<FairMQTransportFactory>' from <FairMQTransportFactory.h> instead.")));
 
     void SetConfig(FairMQProgOptions& config);
@@ -402,6 +402,12 @@ class FairMQDevice : public FairMQStateMachine
     void SetNumIoThreads(int numIoThreads) { fNumIoThreads = numIoThreads; }
     int GetNumIoThreads() const { return fNumIoThreads; }
 
+    void SetAffinity(const std::string& affinity) { fAffinity = affinity; }
+    std::string GetAffinity() const { return fAffinity; }
+
+    void SetNumaNode(int numaNode) { fNumaNode = numaNode; }
+    int GetNumaNode() const { return fNumaNode; }
+
     void SetPortRangeMin(int portRangeMin) { fPortRangeMin = portRangeMin; }
     int GetPortRangeMin() const { return fPortRangeMin; }
 
@@ -429,6 +435,8 @@ class FairMQDevice : public FairMQStateMachine
     std::string fId; ///< Device ID
 
     int fNumIoThreads; ///< Number of ZeroMQ I/O threads
+    std::string fAffinity; ///< CPU list to pin the device threads to
+    int fNumaNode; ///< NUMA node to place the device on (-1 for none)
 
     /// Additional user initialization (can be overloaded in child classes). Prefer to use InitTask().
     /// Executed in a worker thread
@@ -480,6 +488,9 @@ class FairMQDevice : public FairMQStateMachine
 
     int fInitializationTimeoutInS; ///< Timeout for the initialization (in seconds)
 
+    /// Pins the calling thread according to the configured affinity/NUMA node and reports the placement
+    void ApplyPlacement();
+
     /// Handles the initialization and the Init() method
     void InitWrapper();
     /// Handles the InitTask() method
@@ -9,6 +9,7 @@
 #include <FairMQTransportFactory.h>
 #include <zeromq/FairMQTransportFactoryZMQ.h>
 #include <shmem/FairMQTransportFactorySHM.h>
+#include <inproc/FairMQTransportFactoryInproc.h>
 #ifdef NANOMSG_FOUND
 #include <nanomsg/FairMQTransportFactoryNN.h>
 #endif /* NANOMSG_FOUND */
@@ -47,6 +48,10 @@ auto FairMQTransportFactory::CreateTransportFactory(const std::string& type, con
     {
         return std::make_shared<FairMQTransportFactorySHM>(finalId, config);
     }
+    else if (type == "inproc")
+    {
+        return std::make_shared<FairMQTransportFactoryInproc>(finalId, config);
+    }
 #ifdef NANOMSG_FOUND
     else if (type == "nanomsg")
     {
@@ -58,6 +63,7 @@ auto FairMQTransportFactory::CreateTransportFactory(const std::string& type, con
         LOG(ERROR) << "Unavailable transport requested: " << "\"" << type << "\"" << ". Available are: "
                    << "\"zeromq\""
                    << "\"shmem\""
+                   << ", \"inproc\""
 #ifdef NANOMSG_FOUND
                    << ", \"nanomsg\""
 #endif /* NANOMSG_FOUND */
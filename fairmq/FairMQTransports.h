@@ -20,7 +20,8 @@ enum class Transport
     DEFAULT,
     ZMQ,
     NN,
-    SHM
+    SHM,
+    INPROC
 };
 
 
@@ -28,7 +29,8 @@ static std::unordered_map<std::string, Transport> TransportTypes {
     { "default", Transport::DEFAULT },
     { "zeromq", Transport::ZMQ },
     { "nanomsg", Transport::NN },
-    { "shmem", Transport::SHM }
+    { "shmem", Transport::SHM },
+    { "inproc", Transport::INPROC }
 };
 
 }
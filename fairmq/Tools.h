@@ -10,7 +10,9 @@
 #define FAIR_MQ_TOOLS_H
 
 // IWYU pragma: begin_exports
+#include <fairmq/tools/Affinity.h>
 #include <fairmq/tools/CppSTL.h>
+#include <fairmq/tools/Memory.h>
 #include <fairmq/tools/Network.h>
 #include <fairmq/tools/Strings.h>
 #include <fairmq/tools/Version.h>
@@ -24,6 +24,7 @@ using namespace std;
 
 FairMQBenchmarkSampler::FairMQBenchmarkSampler()
     : fSameMessage(true)
+    , fUseRegion(false)
     , fMsgSize(10000)
     , fMsgCounter(0)
     , fMsgRate(1)
@@ -41,6 +42,7 @@ FairMQBenchmarkSampler::~FairMQBenchmarkSampler()
 void FairMQBenchmarkSampler::InitTask()
 {
     fSameMessage = fConfig->GetValue<bool>("same-msg");
+    fUseRegion = fConfig->GetValue<bool>("use-region");
     fMsgSize = fConfig->GetValue<int>("msg-size");
     fMsgRate = fConfig->GetValue<int>("msg-rate");
     fMaxIterations = fConfig->GetValue<uint64_t>("max-iterations");
@@ -59,12 +61,33 @@ void FairMQBenchmarkSampler::Run()
 
     FairMQMessagePtr baseMsg(dataOutChannel.Transport()->CreateMessage(fMsgSize));
 
+    // with --use-region the messages are cut from an unmanaged region, cycling through a fixed number of slots
+    const size_t numRegionSlots = 64;
+    FairMQUnmanagedRegionPtr region(fUseRegion ? dataOutChannel.Transport()->CreateUnmanagedRegion(numRegionSlots * fMsgSize) : nullptr);
+
     LOG(INFO) << "Starting the benchmark with message size of " << fMsgSize << " and " << fMaxIterations << " iterations.";
     auto tStart = chrono::high_resolution_clock::now();
 
     while (CheckCurrentState(RUNNING))
     {
-        if (fSameMessage)
+        if (fUseRegion)
+        {
+            void* data = static_cast<char*>(region->GetData()) + (fNumIterations % numRegionSlots) * fMsgSize;
+            FairMQMessagePtr msg(dataOutChannel.Transport()->CreateMessage(region, data, fMsgSize));
+
+            if (dataOutChannel.Send(msg) >= 0)
+            {
+                if (fMaxIterations > 0)
+                {
+                    if (fNumIterations >= fMaxIterations)
+                    {
+                        break;
+                    }
+                }
+                ++fNumIterations;
+            }
+        }
+        else if (fSameMessage)
         {
             FairMQMessagePtr msg(dataOutChannel.Transport()->CreateMessage());
             msg->Copy(baseMsg);
@@ -37,6 +37,7 @@ class FairMQBenchmarkSampler : public FairMQDevice
 
   protected:
     bool fSameMessage;
+    bool fUseRegion;
     int fMsgSize;
     int fMsgCounter;
     int fMsgRate;
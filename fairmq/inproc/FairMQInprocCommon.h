@@ -0,0 +1,372 @@
+/********************************************************************************
+ *    Copyright (C) 2017 GSI Helmholtzzentrum fuer Schwerionenforschung GmbH    *
+ *                                                                              *
+ *              This software is distributed under the terms of the             *
+ *              GNU Lesser General Public Licence (LGPL) version 3,             *
+ *                  copied verbatim in the file "LICENSE"                       *
+ ********************************************************************************/
+
+#ifndef FAIR_MQ_INPROC_COMMON_H_
+#define FAIR_MQ_INPROC_COMMON_H_
+
+#include "FairMQMessage.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace fair
+{
+namespace mq
+{
+namespace inproc
+{
+
+// socket flags of the inproc transport
+constexpr int kNoBlock = 1;
+constexpr int kSndMore = 2;
+constexpr int kRcvMore = 4;
+
+// queue capacity used for a high water mark of 0 (unlimited in ZeroMQ)
+constexpr size_t kDefaultCapacity = 65536;
+
+/// Bounded lock-free multi-producer/multi-consumer ring buffer (after D. Vyukov).
+/// Elements are moved in and out, so the queue can carry move-only types like unique_ptr.
+template<typename T>
+class MPMCQueue
+{
+  public:
+    explicit MPMCQueue(const size_t capacity)
+        : fCapacity(RoundUpToPowerOfTwo(capacity < 2 ? 2 : capacity))
+        , fMask(fCapacity - 1)
+        , fCells(new Cell[fCapacity])
+        , fEnqueuePos(0)
+        , fDequeuePos(0)
+    {
+        for (size_t i = 0; i < fCapacity; ++i)
+        {
+            fCells[i].fSequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    MPMCQueue(const MPMCQueue&) = delete;
+    MPMCQueue operator=(const MPMCQueue&) = delete;
+
+    /// moves the item into the queue, the item is untouched if the queue is full
+    /// @return true on success, false if the queue is full
+    bool TryPush(T& item)
+    {
+        Cell* cell;
+        size_t pos = fEnqueuePos.load(std::memory_order_relaxed);
+
+        while (true)
+        {
+            cell = &fCells[pos & fMask];
+            size_t seq = cell->fSequence.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+
+            if (diff == 0)
+            {
+                if (fEnqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                {
+                    break;
+                }
+            }
+            else if (diff < 0)
+            {
+                return false;
+            }
+            else
+            {
+                pos = fEnqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+
+        cell->fData = std::move(item);
+        cell->fSequence.store(pos + 1, std::memory_order_release);
+
+        return true;
+    }
+
+    /// moves the oldest element of the queue into item
+    /// @return true on success, false if the queue is empty
+    bool TryPop(T& item)
+    {
+        Cell* cell;
+        size_t pos = fDequeuePos.load(std::memory_order_relaxed);
+
+        while (true)
+        {
+            cell = &fCells[pos & fMask];
+            size_t seq = cell->fSequence.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1);
+
+            if (diff == 0)
+            {
+                if (fDequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                {
+                    break;
+                }
+            }
+            else if (diff < 0)
+            {
+                return false;
+            }
+            else
+            {
+                pos = fDequeuePos.load(std::memory_order_relaxed);
+            }
+        }
+
+        item = std::move(cell->fData);
+        cell->fData = T();
+        cell->fSequence.store(pos + fMask + 1, std::memory_order_release);
+
+        return true;
+    }
+
+    /// @return true if an element is available for popping (snapshot)
+    bool Readable() const
+    {
+        size_t pos = fDequeuePos.load(std::memory_order_acquire);
+        return fCells[pos & fMask].fSequence.load(std::memory_order_acquire) == pos + 1;
+    }
+
+    /// @return true if there is room for pushing an element (snapshot)
+    bool Writable() const
+    {
+        size_t pos = fEnqueuePos.load(std::memory_order_acquire);
+        return fCells[pos & fMask].fSequence.load(std::memory_order_acquire) == pos;
+    }
+
+    size_t Capacity() const { return fCapacity; }
+
+  private:
+    struct Cell
+    {
+        std::atomic<size_t> fSequence;
+        T fData;
+    };
+
+    static size_t RoundUpToPowerOfTwo(size_t value)
+    {
+        size_t result = 1;
+        while (result < value)
+        {
+            result <<= 1;
+        }
+        return result;
+    }
+
+    const size_t fCapacity;
+    const size_t fMask;
+    std::unique_ptr<Cell[]> fCells;
+    // producers and consumers update different cache lines
+    alignas(64) std::atomic<size_t> fEnqueuePos;
+    alignas(64) std::atomic<size_t> fDequeuePos;
+};
+
+class Queue;
+
+/// Unit of transfer between inproc sockets: a single message or all parts of a multipart message
+struct Frame
+{
+    Frame()
+        : fMsg()
+        , fParts()
+        , fReplyTo()
+    {}
+
+    Frame(Frame&&) = default;
+    Frame& operator=(Frame&&) = default;
+
+    size_t Size() const
+    {
+        if (fMsg)
+        {
+            return fMsg->GetSize();
+        }
+
+        size_t size = 0;
+        for (const auto& part : fParts)
+        {
+            size += part->GetSize();
+        }
+        return size;
+    }
+
+    bool Empty() const { return !fMsg && fParts.empty(); }
+
+    FairMQMessagePtr fMsg; // single part message, avoids allocating fParts
+    std::vector<FairMQMessagePtr> fParts; // multipart message
+    std::shared_ptr<Queue> fReplyTo; // queue of the requester (REQ/REP)
+};
+
+/// Frame queue with blocking support. Transfer is lock-free, the mutex/condition are only
+/// touched when a consumer/producer actually has to wait for the other side.
+class Queue
+{
+  public:
+    explicit Queue(const size_t capacity)
+        : fQueue(capacity)
+        , fWaiters(0)
+        , fMutex()
+        , fCondition()
+    {}
+
+    bool TryPush(Frame& frame)
+    {
+        if (fQueue.TryPush(frame))
+        {
+            Notify();
+            return true;
+        }
+        return false;
+    }
+
+    bool TryPop(Frame& frame)
+    {
+        if (fQueue.TryPop(frame))
+        {
+            Notify();
+            return true;
+        }
+        return false;
+    }
+
+    bool Readable() const { return fQueue.Readable(); }
+    bool Writable() const { return fQueue.Writable(); }
+
+    /// blocks until the queue becomes readable (or writable) or the timeout expires
+    void Wait(const bool forReading, const std::chrono::microseconds timeout)
+    {
+        fWaiters.fetch_add(1, std::memory_order_seq_cst);
+        // pairs with the fence in Notify(): either the waiter sees the new state of the queue in the
+        // predicate below, or the notifier sees the waiter and takes the mutex to wake it up
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        {
+            std::unique_lock<std::mutex> lock(fMutex);
+            fCondition.wait_for(lock, timeout, [&]() { return forReading ? Readable() : Writable(); });
+        }
+        fWaiters.fetch_sub(1, std::memory_order_seq_cst);
+    }
+
+  private:
+    void Notify()
+    {
+        // the push/pop above is only a release store, keep the waiter check from being reordered before it
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (fWaiters.load(std::memory_order_seq_cst) > 0)
+        {
+            std::lock_guard<std::mutex> lock(fMutex);
+            fCondition.notify_all();
+        }
+    }
+
+    MPMCQueue<Frame> fQueue;
+    std::atomic<int> fWaiters;
+    std::mutex fMutex;
+    std::condition_variable fCondition;
+};
+
+/// Rendezvous point of all inproc sockets attached (bound or connected) to the same address
+class Endpoint
+{
+  public:
+    Endpoint()
+        : fMutex()
+        , fQueue()
+        , fSubscribers()
+    {}
+
+    /// queue shared by PUSH/PULL and REQ/REP sockets of this endpoint, created by the first attaching socket
+    std::shared_ptr<Queue> GetQueue(const size_t capacity)
+    {
+        std::lock_guard<std::mutex> lock(fMutex);
+        if (!fQueue)
+        {
+            fQueue = std::make_shared<Queue>(capacity > 0 ? capacity : kDefaultCapacity);
+        }
+        return fQueue;
+    }
+
+    void Subscribe(const std::shared_ptr<Queue>& queue)
+    {
+        std::lock_guard<std::mutex> lock(fMutex);
+        fSubscribers.push_back(queue);
+    }
+
+    void Unsubscribe(const std::shared_ptr<Queue>& queue)
+    {
+        std::lock_guard<std::mutex> lock(fMutex);
+        for (auto it = fSubscribers.begin(); it != fSubscribers.end(); ++it)
+        {
+            if (*it == queue)
+            {
+                fSubscribers.erase(it);
+                break;
+            }
+        }
+    }
+
+    std::vector<std::shared_ptr<Queue>> GetSubscribers()
+    {
+        std::lock_guard<std::mutex> lock(fMutex);
+        return fSubscribers;
+    }
+
+  private:
+    std::mutex fMutex;
+    std::shared_ptr<Queue> fQueue;
+    std::vector<std::shared_ptr<Queue>> fSubscribers;
+};
+
+/// Process wide address -> endpoint map. Endpoints live as long as a socket is attached to them.
+class Registry
+{
+  public:
+    static Registry& Instance()
+    {
+        static Registry registry;
+        return registry;
+    }
+
+    std::shared_ptr<Endpoint> GetEndpoint(const std::string& address)
+    {
+        std::lock_guard<std::mutex> lock(fMutex);
+
+        std::shared_ptr<Endpoint> endpoint = fEndpoints[address].lock();
+        if (!endpoint)
+        {
+            endpoint = std::make_shared<Endpoint>();
+            fEndpoints[address] = endpoint;
+        }
+
+        return endpoint;
+    }
+
+  private:
+    Registry()
+        : fMutex()
+        , fEndpoints()
+    {}
+    Registry(const Registry&) = delete;
+    Registry operator=(const Registry&) = delete;
+
+    std::mutex fMutex;
+    std::unordered_map<std::string, std::weak_ptr<Endpoint>> fEndpoints;
+};
+
+} // namespace inproc
+} // namespace mq
+} // namespace fair
+
+#endif /* FAIR_MQ_INPROC_COMMON_H_ */
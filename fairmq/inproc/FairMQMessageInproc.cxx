@@ -0,0 +1,127 @@
+/********************************************************************************
+ *    Copyright (C) 2017 GSI Helmholtzzentrum fuer Schwerionenforschung GmbH    *
+ *                                                                              *
+ *              This software is distributed under the terms of the             *
+ *              GNU Lesser General Public Licence (LGPL) version 3,             *
+ *                  copied verbatim in the file "LICENSE"                       *
+ ********************************************************************************/
+
+#include <cstdlib>
+#include <cstring>
+#include <new> // bad_alloc
+
+#include "FairMQMessageInproc.h"
+#include "FairMQLogger.h"
+
+using namespace std;
+
+FairMQ::Transport FairMQMessageInproc::fTransportType = FairMQ::Transport::INPROC;
+
+FairMQMessageInproc::FairMQMessageInproc()
+    : fBuffer()
+    , fData(nullptr)
+    , fSize(0)
+{
+}
+
+FairMQMessageInproc::FairMQMessageInproc(const size_t size)
+    : fBuffer()
+    , fData(nullptr)
+    , fSize(0)
+{
+    Rebuild(size);
+}
+
+FairMQMessageInproc::FairMQMessageInproc(void* data, const size_t size, fairmq_free_fn* ffn, void* hint)
+    : fBuffer()
+    , fData(nullptr)
+    , fSize(0)
+{
+    Rebuild(data, size, ffn, hint);
+}
+
+FairMQMessageInproc::FairMQMessageInproc(FairMQUnmanagedRegionPtr& /*region*/, void* data, const size_t size)
+    : fBuffer()
+    , fData(data)
+    , fSize(size)
+{
+    // the region owns the memory, the message only points into it (region has to outlive the message)
+}
+
+void FairMQMessageInproc::Rebuild()
+{
+    fBuffer.reset();
+    fData = nullptr;
+    fSize = 0;
+}
+
+void FairMQMessageInproc::Rebuild(const size_t size)
+{
+    void* data = malloc(size > 0 ? size : 1);
+    if (!data)
+    {
+        LOG(ERROR) << "inproc: failed allocating message of " << size << " bytes";
+        throw bad_alloc();
+    }
+
+    fBuffer = make_shared<Buffer>(data, nullptr, nullptr);
+    fData = data;
+    fSize = size;
+}
+
+void FairMQMessageInproc::Rebuild(void* data, const size_t size, fairmq_free_fn* ffn, void* hint)
+{
+    fBuffer = make_shared<Buffer>(data, ffn, hint);
+    fData = data;
+    fSize = size;
+}
+
+void* FairMQMessageInproc::GetMessage()
+{
+    return this;
+}
+
+void* FairMQMessageInproc::GetData()
+{
+    return fData;
+}
+
+size_t FairMQMessageInproc::GetSize()
+{
+    return fSize;
+}
+
+void FairMQMessageInproc::SetMessage(void*, const size_t)
+{
+    // dummy method to comply with the interface. functionality not allowed in inproc.
+}
+
+void FairMQMessageInproc::SetDeviceId(const string& /*deviceId*/)
+{
+}
+
+FairMQ::Transport FairMQMessageInproc::GetType() const
+{
+    return fTransportType;
+}
+
+void FairMQMessageInproc::Copy(const unique_ptr<FairMQMessage>& msg)
+{
+    if (msg->GetType() == fTransportType)
+    {
+        // Shares the message body between msg and this message.
+        const FairMQMessageInproc* other = static_cast<const FairMQMessageInproc*>(msg.get());
+        fBuffer = other->fBuffer;
+        fData = other->fData;
+        fSize = other->fSize;
+    }
+    else
+    {
+        Rebuild(msg->GetSize());
+        memcpy(fData, msg->GetData(), fSize);
+    }
+}
+
+FairMQMessageInproc::~FairMQMessageInproc()
+{
+}
@@ -0,0 +1,88 @@
+/********************************************************************************
+ *    Copyright (C) 2017 GSI Helmholtzzentrum fuer Schwerionenforschung GmbH    *
+ *                                                                              *
+ *              This software is distributed under the terms of the             *
+ *              GNU Lesser General Public Licence (LGPL) version 3,             *
+ *                  copied verbatim in the file "LICENSE"                       *
+ ********************************************************************************/
+
+#ifndef FAIRMQMESSAGEINPROC_H_
+#define FAIRMQMESSAGEINPROC_H_
+
+#include <cstddef>
+#include <cstdlib> // free
+#include <memory>
+#include <string>
+
+#include "FairMQMessage.h"
+#include "FairMQUnmanagedRegion.h"
+
+/**
+ * Message of the in-process transport. The message object itself is handed over
+ * between the sockets, the body is never copied. Copy() shares the body.
+ */
+
+class FairMQMessageInproc : public FairMQMessage
+{
+  public:
+    FairMQMessageInproc();
+    FairMQMessageInproc(const size_t size);
+    FairMQMessageInproc(void* data, const size_t size, fairmq_free_fn* ffn, void* hint = nullptr);
+    FairMQMessageInproc(FairMQUnmanagedRegionPtr& region, void* data, const size_t size);
+
+    FairMQMessageInproc(const FairMQMessageInproc&) = delete;
+    FairMQMessageInproc operator=(const FairMQMessageInproc&) = delete;
+
+    virtual void Rebuild();
+    virtual void Rebuild(const size_t size);
+    virtual void Rebuild(void* data, const size_t size, fairmq_free_fn* ffn, void* hint = nullptr);
+
+    virtual void* GetMessage();
+    virtual void* GetData();
+    virtual size_t GetSize();
+
+    virtual void SetMessage(void* data, const size_t size);
+
+    virtual void SetDeviceId(const std::string& deviceId);
+
+    virtual FairMQ::Transport GetType() const;
+
+    virtual void Copy(const std::unique_ptr<FairMQMessage>& msg);
+
+    virtual ~FairMQMessageInproc();
+
+  private:
+    /// Owner of the message body, releases it with the free callback or free() when the last message referencing it is gone
+    struct Buffer
+    {
+        Buffer(void* data, fairmq_free_fn* ffn, void* hint)
+            : fData(data)
+            , fFreeFn(ffn)
+            , fHint(hint)
+        {}
+
+        ~Buffer()
+        {
+            if (fFreeFn)
+            {
+                fFreeFn(fData, fHint);
+            }
+            else
+            {
+                free(fData);
+            }
+        }
+
+        void* fData;
+        fairmq_free_fn* fFreeFn;
+        void* fHint;
+    };
+
+    std::shared_ptr<Buffer> fBuffer; // empty for region messages and empty messages
+    void* fData;
+    size_t fSize;
+
+    static FairMQ::Transport fTransportType;
+};
+
+#endif /* FAIRMQMESSAGEINPROC_H_ */
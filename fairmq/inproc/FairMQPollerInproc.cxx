@@ -0,0 +1,163 @@
+/********************************************************************************
+ *    Copyright (C) 2017 GSI Helmholtzzentrum fuer Schwerionenforschung GmbH    *
+ *                                                                              *
+ *              This software is distributed under the terms of the             *
+ *              GNU Lesser General Public Licence (LGPL) version 3,             *
+ *                  copied verbatim in the file "LICENSE"                       *
+ ********************************************************************************/
+
+#include <algorithm>
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+
+#include "FairMQPollerInproc.h"
+#include "FairMQLogger.h"
+
+using namespace std;
+
+FairMQPollerInproc::FairMQPollerInproc(const vector<FairMQChannel>& channels)
+    : fItems()
+    , fOffsetMap()
+{
+    for (const auto& channel : channels)
+    {
+        AddItem(channel.GetSocket());
+    }
+}
+
+FairMQPollerInproc::FairMQPollerInproc(const vector<const FairMQChannel*>& channels)
+    : fItems()
+    , fOffsetMap()
+{
+    for (const auto channel : channels)
+    {
+        AddItem(channel->GetSocket());
+    }
+}
+
+FairMQPollerInproc::FairMQPollerInproc(const unordered_map<string, vector<FairMQChannel>>& channelsMap, const vector<string>& channelList)
+    : fItems()
+    , fOffsetMap()
+{
+    try
+    {
+        for (const string& channel : channelList)
+        {
+            fOffsetMap[channel] = fItems.size();
+            for (const auto& subChannel : channelsMap.at(channel))
+            {
+                AddItem(subChannel.GetSocket());
+            }
+        }
+    }
+    catch (const std::out_of_range& oor)
+    {
+        LOG(ERROR) << "inproc: at least one of the provided channel keys for poller initialization is invalid";
+        LOG(ERROR) << "inproc: out of range error: " << oor.what() << '\n';
+        throw std::out_of_range("invalid channel during poller initialization");
+    }
+}
+
+FairMQPollerInproc::FairMQPollerInproc(const FairMQSocket& cmdSocket, const FairMQSocket& dataSocket)
+    : fItems()
+    , fOffsetMap()
+{
+    AddItem(cmdSocket);
+    AddItem(dataSocket);
+}
+
+void FairMQPollerInproc::AddItem(const FairMQSocket& socket)
+{
+    const FairMQSocketInproc* inprocSocket = dynamic_cast<const FairMQSocketInproc*>(&socket);
+    if (!inprocSocket)
+    {
+        LOG(ERROR) << "inproc: invalid poller configuration, socket does not belong to the inproc transport, exiting.";
+        exit(EXIT_FAILURE);
+    }
+
+    Item item;
+    item.fSocket = inprocSocket;
+    item.fPollIn = inprocSocket->CanReceive();
+    item.fPollOut = inprocSocket->CanSend();
+    item.fReadable = false;
+    item.fWritable = false;
+    fItems.push_back(item);
+}
+
+void FairMQPollerInproc::Poll(const int timeout)
+{
+    // the queues can not be waited on collectively, so the poller checks them with increasing back-off:
+    // yielding at first (fast hand-off), then sleeping up to 1ms between checks
+    auto deadline = chrono::steady_clock::now() + chrono::milliseconds(timeout);
+    chrono::microseconds backoff(1);
+    int spins = 0;
+
+    while (true)
+    {
+        bool ready = false;
+        for (auto& item : fItems)
+        {
+            item.fReadable = item.fPollIn && item.fSocket->Readable();
+            item.fWritable = item.fPollOut && item.fSocket->Writable();
+            ready = ready || item.fReadable || item.fWritable;
+        }
+
+        if (ready || timeout == 0 || (timeout > 0 && chrono::steady_clock::now() >= deadline))
+        {
+            return;
+        }
+
+        if (++spins < 100)
+        {
+            this_thread::yield();
+        }
+        else
+        {
+            this_thread::sleep_for(backoff);
+            backoff = min(backoff * 2, chrono::microseconds(1000));
+        }
+    }
+}
+
+bool FairMQPollerInproc::CheckInput(const int index)
+{
+    return fItems.at(index).fReadable;
+}
+
+bool FairMQPollerInproc::CheckOutput(const int index)
+{
+    return fItems.at(index).fWritable;
+}
+
+bool FairMQPollerInproc::CheckInput(const string channelKey, const int index)
+{
+    try
+    {
+        return fItems.at(fOffsetMap.at(channelKey) + index).fReadable;
+    }
+    catch (const std::out_of_range& oor)
+    {
+        LOG(ERROR) << "inproc: invalid channel key: \"" << channelKey << "\"";
+        LOG(ERROR) << "inproc: out of range error: " << oor.what() << '\n';
+        exit(EXIT_FAILURE);
+    }
+}
+
+bool FairMQPollerInproc::CheckOutput(const string channelKey, const int index)
+{
+    try
+    {
+        return fItems.at(fOffsetMap.at(channelKey) + index).fWritable;
+    }
+    catch (const std::out_of_range& oor)
+    {
+        LOG(ERROR) << "inproc: invalid channel key: \"" << channelKey << "\"";
+        LOG(ERROR) << "inproc: out of range error: " << oor.what() << '\n';
+        exit(EXIT_FAILURE);
+    }
+}
+
+FairMQPollerInproc::~FairMQPollerInproc()
+{
+}
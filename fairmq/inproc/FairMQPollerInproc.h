@@ -0,0 +1,62 @@
+/********************************************************************************
+ *    Copyright (C) 2017 GSI Helmholtzzentrum fuer Schwerionenforschung GmbH    *
+ *                                                                              *
+ *              This software is distributed under the terms of the             *
+ *              GNU Lesser General Public Licence (LGPL) version 3,             *
+ *                  copied verbatim in the file "LICENSE"                       *
+ ********************************************************************************/
+
+#ifndef FAIRMQPOLLERINPROC_H_
+#define FAIRMQPOLLERINPROC_H_
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "FairMQPoller.h"
+#include "FairMQChannel.h"
+#include "FairMQSocketInproc.h"
+
+class FairMQChannel;
+class FairMQTransportFactoryInproc;
+
+class FairMQPollerInproc : public FairMQPoller
+{
+    friend class FairMQChannel;
+    friend class FairMQTransportFactoryInproc;
+
+  public:
+    FairMQPollerInproc(const std::vector<FairMQChannel>& channels);
+    FairMQPollerInproc(const std::vector<const FairMQChannel*>& channels);
+    FairMQPollerInproc(const std::unordered_map<std::string, std::vector<FairMQChannel>>& channelsMap, const std::vector<std::string>& channelList);
+
+    FairMQPollerInproc(const FairMQPollerInproc&) = delete;
+    FairMQPollerInproc operator=(const FairMQPollerInproc&) = delete;
+
+    virtual void Poll(const int timeout);
+    virtual bool CheckInput(const int index);
+    virtual bool CheckOutput(const int index);
+    virtual bool CheckInput(const std::string channelKey, const int index);
+    virtual bool CheckOutput(const std::string channelKey, const int index);
+
+    virtual ~FairMQPollerInproc();
+
+  private:
+    FairMQPollerInproc(const FairMQSocket& cmdSocket, const FairMQSocket& dataSocket);
+
+    void AddItem(const FairMQSocket& socket);
+
+    struct Item
+    {
+        const FairMQSocketInproc* fSocket;
+        bool fPollIn;
+        bool fPollOut;
+        bool fReadable;
+        bool fWritable;
+    };
+
+    std::vector<Item> fItems;
+    std::unordered_map<std::string, int> fOffsetMap;
+};
+
+#endif /* FAIRMQPOLLERINPROC_H_ */
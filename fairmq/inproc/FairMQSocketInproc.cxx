@@ -0,0 +1,717 @@
+/********************************************************************************
+ *    Copyright (C) 2017 GSI Helmholtzzentrum fuer Schwerionenforschung GmbH    *
+ *                                                                              *
+ *              This software is distributed under the terms of the             *
+ *              GNU Lesser General Public Licence (LGPL) version 3,             *
+ *                  copied verbatim in the file "LICENSE"                       *
+ ********************************************************************************/
+
+#include <algorithm> // min
+#include <chrono>
+#include <thread>
+
+#include "FairMQSocketInproc.h"
+#include "FairMQMessageInproc.h"
+#include "FairMQLogger.h"
+
+using namespace std;
+using namespace fair::mq::inproc;
+
+atomic<bool> FairMQSocketInproc::fInterrupted(false);
+
+namespace
+{
+// number of retries (yielding the CPU) before a blocking call waits on the queue,
+// keeps the hand-off between busy pipeline stages free of system calls
+constexpr int kSpinCount = 200;
+// upper bound for the time a blocked call needs to notice an interrupt
+constexpr chrono::milliseconds kWaitSlice(10);
+// with several queues a blocked call cannot wait on all of them, so it checks them more often
+constexpr chrono::milliseconds kMultiQueueWaitSlice(1);
+
+/// @param timeout socket send/receive timeout in ms, -1 for none
+/// @param start time at which the blocking call started
+/// @return time to wait on a queue before checking again, zero if the timeout has expired
+chrono::microseconds NextWait(const size_t numQueues, const int timeout, const chrono::steady_clock::time_point& start)
+{
+    chrono::microseconds slice = (numQueues > 1) ? kMultiQueueWaitSlice : kWaitSlice;
+    if (timeout >= 0)
+    {
+        chrono::microseconds remaining = chrono::duration_cast<chrono::microseconds>(start + chrono::milliseconds(timeout) - chrono::steady_clock::now());
+        if (remaining.count() <= 0)
+        {
+            return chrono::microseconds(0);
+        }
+        slice = min(slice, remaining);
+    }
+    return slice;
+}
+}
+
+FairMQSocketInproc::FairMQSocketInproc(const string& type, const string& name, const string& id /*= ""*/)
+    : FairMQSocket(kSndMore, kRcvMore, kNoBlock)
+    , fType(Type::PUSH)
+    , fId(id + "." + name + "." + type)
+    , fAddressPrefix()
+    , fEndpoints()
+    , fOutQueues()
+    , fInQueues()
+    , fOwnQueue()
+    , fNextOut(0)
+    , fNextIn(0)
+    , fPendingParts()
+    , fOutgoingParts()
+    , fReplyTo()
+    , fAwaitingReply(false)
+    , fSndHwm(1000)
+    , fRcvHwm(1000)
+    , fSndTimeout(-1)
+    , fRcvTimeout(-1)
+    , fBytesTx(0)
+    , fBytesRx(0)
+    , fMessagesTx(0)
+    , fMessagesRx(0)
+{
+    if (type == "push")
+    {
+        fType = Type::PUSH;
+    }
+    else if (type == "pull")
+    {
+        fType = Type::PULL;
+    }
+    else if (type == "pub")
+    {
+        fType = Type::PUB;
+    }
+    else if (type == "sub")
+    {
+        fType = Type::SUB;
+    }
+    else if (type == "req")
+    {
+        fType = Type::REQ;
+    }
+    else if (type == "rep")
+    {
+        fType = Type::REP;
+    }
+    else
+    {
+        LOG(ERROR) << "Failed creating socket " << fId << ", reason: socket type '" << type << "' is not supported by the inproc transport (push/pull/pub/sub/req/rep)";
+        exit(EXIT_FAILURE);
+    }
+
+    // every device has its own command endpoint, even when several devices share the process
+    if (name == "device-commands")
+    {
+        fAddressPrefix = id + "/";
+    }
+}
+
+string FairMQSocketInproc::GetId()
+{
+    return fId;
+}
+
+bool FairMQSocketInproc::Bind(const string& address)
+{
+    return Attach(address);
+}
+
+void FairMQSocketInproc::Connect(const string& address)
+{
+    if (!Attach(address))
+    {
+        // error here means incorrect configuration. exit if it happens.
+        exit(EXIT_FAILURE);
+    }
+}
+
+bool FairMQSocketInproc::Attach(const string& address)
+{
+    if (address.empty())
+    {
+        LOG(ERROR) << "Failed attaching socket " << fId << ", reason: empty address";
+        return false;
+    }
+
+    shared_ptr<Endpoint> endpoint = Registry::Instance().GetEndpoint(fAddressPrefix + address);
+
+    switch (fType)
+    {
+        case Type::PUSH:
+            fOutQueues.push_back(endpoint->GetQueue(fSndHwm));
+            break;
+        case Type::PULL:
+        case Type::REP:
+            fInQueues.push_back(endpoint->GetQueue(fRcvHwm));
+            break;
+        case Type::REQ:
+            fOutQueues.push_back(endpoint->GetQueue(fSndHwm));
+            if (!fOwnQueue)
+            {
+                fOwnQueue = make_shared<Queue>(fRcvHwm > 0 ? fRcvHwm : kDefaultCapacity);
+                fInQueues.push_back(fOwnQueue);
+            }
+            break;
+        case Type::SUB:
+            if (!fOwnQueue)
+            {
+                fOwnQueue = make_shared<Queue>(fRcvHwm > 0 ? fRcvHwm : kDefaultCapacity);
+                fInQueues.push_back(fOwnQueue);
+            }
+            endpoint->Subscribe(fOwnQueue);
+            break;
+        case Type::PUB:
+            break;
+    }
+
+    fEndpoints.push_back(endpoint);
+
+    return true;
+}
+
+int FairMQSocketInproc::Send(FairMQMessagePtr& msg, const int flags)
+{
+    if (!CanSend())
+    {
+        LOG(ERROR) << "Failed sending on socket " << fId << ", reason: socket type does not send";
+        return -1;
+    }
+
+    const int nbytes = msg->GetSize();
+
+    if (flags & kSndMore)
+    {
+        fOutgoingParts.push_back(move(msg));
+        msg = FairMQMessagePtr(new FairMQMessageInproc());
+        return nbytes;
+    }
+
+    Frame frame;
+    if (fOutgoingParts.empty())
+    {
+        frame.fMsg = move(msg);
+    }
+    else
+    {
+        fOutgoingParts.push_back(move(msg));
+        frame.fParts.swap(fOutgoingParts);
+    }
+    const size_t totalSize = frame.Size();
+
+    int rc = SendFrame(frame, flags);
+    if (rc < 0)
+    {
+        // not sent, hand the message back to the caller
+        if (frame.fMsg)
+        {
+            msg = move(frame.fMsg);
+        }
+        else
+        {
+            msg = move(frame.fParts.back());
+            frame.fParts.pop_back();
+            fOutgoingParts.swap(frame.fParts);
+        }
+        return rc;
+    }
+
+    // the message object is now owned by the receiver, leave the caller with an empty one
+    msg = FairMQMessagePtr(new FairMQMessageInproc());
+
+    fBytesTx += totalSize;
+    ++fMessagesTx;
+
+    return nbytes;
+}
+
+int FairMQSocketInproc::Receive(FairMQMessagePtr& msg, const int flags)
+{
+    if (!fPendingParts.empty())
+    {
+        msg = move(fPendingParts.front());
+        fPendingParts.pop_front();
+        return msg->GetSize();
+    }
+
+    Frame frame;
+    int rc = ReceiveFrame(frame, flags);
+    if (rc < 0)
+    {
+        return rc;
+    }
+
+    const size_t totalSize = frame.Size();
+
+    if (frame.fMsg)
+    {
+        msg = move(frame.fMsg);
+    }
+    else
+    {
+        // multipart message received part by part, keep the remaining parts for the following calls
+        auto it = frame.fParts.begin();
+        msg = move(*it);
+        for (++it; it != frame.fParts.end(); ++it)
+        {
+            fPendingParts.push_back(move(*it));
+        }
+    }
+
+    fBytesRx += totalSize;
+    ++fMessagesRx;
+
+    return msg->GetSize();
+}
+
+int64_t FairMQSocketInproc::Send(vector<unique_ptr<FairMQMessage>>& msgVec, const int flags)
+{
+    const unsigned int vecSize = msgVec.size();
+
+    // Sending vector typicaly handles more then one part
+    if (vecSize > 1)
+    {
+        if (!CanSend())
+        {
+            LOG(ERROR) << "Failed sending on socket " << fId << ", reason: socket type does not send";
+            return -1;
+        }
+
+        Frame frame;
+        frame.fParts.swap(msgVec);
+        const int64_t totalSize = frame.Size();
+
+        int rc = SendFrame(frame, flags);
+        if (rc < 0)
+        {
+            msgVec.swap(frame.fParts);
+            return rc;
+        }
+
+        // store statistics on how many messages have been sent (handle all parts as a single message)
+        ++fMessagesTx;
+        fBytesTx += totalSize;
+        return totalSize;
+    } // If there's only one part, send it as a regular message
+    else if (vecSize == 1)
+    {
+        return Send(msgVec.back(), flags);
+    }
+    else // if the vector is empty, something might be wrong
+    {
+        LOG(WARN) << "Will not send empty vector";
+        return -1;
+    }
+}
+
+int64_t FairMQSocketInproc::Receive(vector<unique_ptr<FairMQMessage>>& msgVec, const int flags)
+{
+    int64_t totalSize = 0;
+
+    if (!fPendingParts.empty())
+    {
+        // remainder of a multipart message that was partially received with Receive(msg)
+        for (auto& part : fPendingParts)
+        {
+            totalSize += part->GetSize();
+            msgVec.push_back(move(part));
+        }
+        fPendingParts.clear();
+        return totalSize;
+    }
+
+    Frame frame;
+    int rc = ReceiveFrame(frame, flags);
+    if (rc < 0)
+    {
+        return rc;
+    }
+
+    totalSize = frame.Size();
+
+    if (frame.fMsg)
+    {
+        msgVec.push_back(move(frame.fMsg));
+    }
+    else
+    {
+        for (auto& part : frame.fParts)
+        {
+            msgVec.push_back(move(part));
+        }
+    }
+
+    // store statistics on how many messages have been received (handle all parts as a single message)
+    ++fMessagesRx;
+    fBytesRx += totalSize;
+    return totalSize;
+}
+
+int FairMQSocketInproc::SendFrame(Frame& frame, const int flags)
+{
+    if (fType == Type::PUB)
+    {
+        return Publish(frame);
+    }
+
+    const vector<shared_ptr<Queue>>* queuesPtr = &fOutQueues;
+    vector<shared_ptr<Queue>> replyQueues;
+
+    if (fType == Type::REP)
+    {
+        if (!fReplyTo)
+        {
+            LOG(ERROR) << "Failed sending on socket " << fId << ", reason: no request to reply to";
+            return -1;
+        }
+        replyQueues.push_back(fReplyTo);
+        queuesPtr = &replyQueues;
+    }
+    else if (fType == Type::REQ)
+    {
+        if (fAwaitingReply)
+        {
+            LOG(ERROR) << "Failed sending on socket " << fId << ", reason: previous request has not been answered";
+            return -1;
+        }
+        frame.fReplyTo = fOwnQueue;
+    }
+
+    const vector<shared_ptr<Queue>>& queues = *queuesPtr;
+
+    if (queues.empty())
+    {
+        LOG(ERROR) << "Failed sending on socket " << fId << ", reason: socket is not bound/connected";
+        return -1;
+    }
+
+    const size_t numQueues = queues.size();
+    const auto start = chrono::steady_clock::now();
+    int spins = 0;
+
+    while (true)
+    {
+        // round-robin over the attached endpoints, the first one with free capacity takes the message
+        for (size_t i = 0; i < numQueues; ++i)
+        {
+            size_t index = (fNextOut + i) % numQueues;
+            if (queues[index]->TryPush(frame))
+            {
+                fNextOut = (index + 1) % numQueues;
+
+                if (fType == Type::REP)
+                {
+                    fReplyTo.reset();
+                }
+                else if (fType == Type::REQ)
+                {
+                    fAwaitingReply = true;
+                }
+
+                return 0;
+            }
+        }
+
+        const chrono::microseconds wait = NextWait(numQueues, fSndTimeout, start);
+        if (fInterrupted || (flags & kNoBlock) || wait.count() == 0)
+        {
+            frame.fReplyTo.reset();
+            return -2;
+        }
+
+        if (++spins < kSpinCount)
+        {
+            this_thread::yield();
+        }
+        else
+        {
+            queues[fNextOut % numQueues]->Wait(false, wait);
+        }
+    }
+}
+
+int FairMQSocketInproc::Publish(Frame& frame)
+{
+    vector<shared_ptr<Queue>> subscribers;
+    for (const auto& endpoint : fEndpoints)
+    {
+        auto endpointSubscribers = endpoint->GetSubscribers();
+        subscribers.insert(subscribers.end(), endpointSubscribers.begin(), endpointSubscribers.end());
+    }
+
+    // like with ZeroMQ, messages for absent or slow (full queue) subscribers are dropped
+    for (size_t i = 0; i < subscribers.size(); ++i)
+    {
+        if (i + 1 == subscribers.size())
+        {
+            subscribers[i]->TryPush(frame);
+            break;
+        }
+
+        // every subscriber except the last gets a message sharing the body
+        Frame copy;
+        if (frame.fMsg)
+        {
+            copy.fMsg = FairMQMessagePtr(new FairMQMessageInproc());
+            copy.fMsg->Copy(frame.fMsg);
+        }
+        else
+        {
+            for (const auto& part : frame.fParts)
+            {
+                copy.fParts.push_back(FairMQMessagePtr(new FairMQMessageInproc()));
+                copy.fParts.back()->Copy(part);
+            }
+        }
+        subscribers[i]->TryPush(copy);
+    }
+
+    return 0;
+}
+
+int FairMQSocketInproc::ReceiveFrame(Frame& frame, const int flags)
+{
+    if (!CanReceive())
+    {
+        LOG(ERROR) << "Failed receiving on socket " << fId << ", reason: socket type does not receive";
+        return -1;
+    }
+
+    if (fInQueues.empty())
+    {
+        LOG(ERROR) << "Failed receiving on socket " << fId << ", reason: socket is not bound/connected";
+        return -1;
+    }
+
+    const size_t numQueues = fInQueues.size();
+    const auto start = chrono::steady_clock::now();
+    int spins = 0;
+
+    while (true)
+    {
+        for (size_t i = 0; i < numQueues; ++i)
+        {
+            size_t index = (fNextIn + i) % numQueues;
+            if (fInQueues[index]->TryPop(frame))
+            {
+                fNextIn = (index + 1) % numQueues;
+
+                if (fType == Type::REP)
+                {
+                    fReplyTo = move(frame.fReplyTo);
+                }
+                else if (fType == Type::REQ)
+                {
+                    fAwaitingReply = false;
+                }
+                frame.fReplyTo.reset();
+
+                return 0;
+            }
+        }
+
+        const chrono::microseconds wait = NextWait(numQueues, fRcvTimeout, start);
+        if (fInterrupted || (flags & kNoBlock) || wait.count() == 0)
+        {
+            return -2;
+        }
+
+        if (++spins < kSpinCount)
+        {
+            this_thread::yield();
+        }
+        else
+        {
+            fInQueues[fNextIn]->Wait(true, wait);
+        }
+    }
+}
+
+bool FairMQSocketInproc::Readable() const
+{
+    if (!fPendingParts.empty())
+    {
+        return true;
+    }
+
+    for (const auto& queue : fInQueues)
+    {
+        if (queue->Readable())
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool FairMQSocketInproc::Writable() const
+{
+    switch (fType)
+    {
+        case Type::PUB:
+            return true;
+        case Type::REP:
+            return static_cast<bool>(fReplyTo);
+        case Type::REQ:
+            if (fAwaitingReply)
+            {
+                return false;
+            }
+            // fall through
+        case Type::PUSH:
+            for (const auto& queue : fOutQueues)
+            {
+                if (queue->Writable())
+                {
+                    return true;
+                }
+            }
+            return false;
+        default:
+            return false;
+    }
+}
+
+bool FairMQSocketInproc::CanReceive() const
+{
+    return fType == Type::PULL || fType == Type::SUB || fType == Type::REQ || fType == Type::REP;
+}
+
+bool FairMQSocketInproc::CanSend() const
+{
+    return fType == Type::PUSH || fType == Type::PUB || fType == Type::REQ || fType == Type::REP;
+}
+
+void FairMQSocketInproc::Close()
+{
+    // LOG(DEBUG) << "Closing socket " << fId;
+
+    if (fType == Type::SUB && fOwnQueue)
+    {
+        for (const auto& endpoint : fEndpoints)
+        {
+            endpoint->Unsubscribe(fOwnQueue);
+        }
+    }
+
+    fOutQueues.clear();
+    fInQueues.clear();
+    fOwnQueue.reset();
+    fEndpoints.clear();
+    fPendingParts.clear();
+    fOutgoingParts.clear();
+    fReplyTo.reset();
+    fAwaitingReply = false;
+}
+
+void FairMQSocketInproc::Interrupt()
+{
+    fInterrupted = true;
+}
+
+void FairMQSocketInproc::Resume()
+{
+    fInterrupted = false;
+}
+
+void* FairMQSocketInproc::GetSocket() const
+{
+    return const_cast<FairMQSocketInproc*>(this);
+}
+
+int FairMQSocketInproc::GetSocket(int) const
+{
+    // dummy method to comply with the interface. functionality not possible in inproc.
+    return -1;
+}
+
+void FairMQSocketInproc::SetOption(const string& option, const void* value, size_t valueSize)
+{
+    if (option == "snd-hwm" && valueSize == sizeof(int))
+    {
+        // takes effect for endpoints attached afterwards
+        fSndHwm = *static_cast<const int*>(value);
+    }
+    else if (option == "rcv-hwm" && valueSize == sizeof(int))
+    {
+        fRcvHwm = *static_cast<const int*>(value);
+    }
+    else if (option == "snd-size" || option == "rcv-size" || option == "linger" || option == "affinity")
+    {
+        // kernel buffers, linger period and I/O threads do not exist for this transport
+    }
+    else
+    {
+        LOG(ERROR) << "Failed setting socket option, reason: unknown or invalid option '" << option << "'";
+    }
+}
+
+void FairMQSocketInproc::GetOption(const string& option, void* value, size_t* valueSize)
+{
+    if ((option == "snd-hwm" || option == "rcv-hwm") && *valueSize >= sizeof(int))
+    {
+        *static_cast<int*>(value) = (option == "snd-hwm") ? fSndHwm : fRcvHwm;
+        *valueSize = sizeof(int);
+    }
+    else if (option == "rcv-more" && *valueSize >= sizeof(int64_t))
+    {
+        *static_cast<int64_t*>(value) = fPendingParts.empty() ? 0 : 1;
+        *valueSize = sizeof(int64_t);
+    }
+    else
+    {
+        LOG(ERROR) << "Failed getting socket option, reason: unknown or invalid option '" << option << "'";
+    }
+}
+
+unsigned long FairMQSocketInproc::GetBytesTx() const
+{
+    return fBytesTx;
+}
+
+unsigned long FairMQSocketInproc::GetBytesRx() const
+{
+    return fBytesRx;
+}
+
+unsigned long FairMQSocketInproc::GetMessagesTx() const
+{
+    return fMessagesTx;
+}
+
+unsigned long FairMQSocketInproc::GetMessagesRx() const
+{
+    return fMessagesRx;
+}
+
+bool FairMQSocketInproc::SetSendTimeout(const int timeout, const string& /*address*/, const string& /*method*/)
+{
+    // a blocking send gives up with -2 when no queue had room within the timeout (-1: wait forever)
+    fSndTimeout = timeout;
+    return true;
+}
+
+int FairMQSocketInproc::GetSendTimeout() const
+{
+    return fSndTimeout;
+}
+
+bool FairMQSocketInproc::SetReceiveTimeout(const int timeout, const string& /*address*/, const string& /*method*/)
+{
+    // a blocking receive gives up with -2 when nothing arrived within the timeout (-1: wait forever)
+    fRcvTimeout = timeout;
+    return true;
+}
+
+int FairMQSocketInproc::GetReceiveTimeout() const
+{
+    return fRcvTimeout;
+}
+
+FairMQSocketInproc::~FairMQSocketInproc()
+{
+    Close();
+}
@@ -0,0 +1,123 @@
+/********************************************************************************
+ *    Copyright (C) 2017 GSI Helmholtzzentrum fuer Schwerionenforschung GmbH    *
+ *                                                                              *
+ *              This software is distributed under the terms of the             *
+ *              GNU Lesser General Public Licence (LGPL) version 3,             *
+ *                  copied verbatim in the file "LICENSE"                       *
+ ********************************************************************************/
+
+#ifndef FAIRMQSOCKETINPROC_H_
+#define FAIRMQSOCKETINPROC_H_
+
+#include <atomic>
+#include <deque>
+#include <memory> // unique_ptr
+#include <string>
+#include <vector>
+
+#include "FairMQSocket.h"
+#include "FairMQMessage.h"
+#include "FairMQInprocCommon.h"
+
+/**
+ * Socket of the in-process transport. Messages are handed over as FairMQMessagePtr through
+ * lock-free queues of the endpoint the sockets are attached to, without serialization or copies.
+ * Bind and Connect are equivalent, any address string (inproc://, ipc://, tcp://) identifies the endpoint
+ * within the process. Supported types: push/pull, pub/sub, req/rep.
+ */
+
+class FairMQSocketInproc : public FairMQSocket
+{
+  public:
+    FairMQSocketInproc(const std::string& type, const std::string& name, const std::string& id = "");
+    FairMQSocketInproc(const FairMQSocketInproc&) = delete;
+    FairMQSocketInproc operator=(const FairMQSocketInproc&) = delete;
+
+    virtual std::string GetId();
+
+    virtual bool Bind(const std::string& address);
+    virtual void Connect(const std::string& address);
+
+    virtual int Send(FairMQMessagePtr& msg, const int flags = 0);
+    virtual int Receive(FairMQMessagePtr& msg, const int flags = 0);
+
+    virtual int64_t Send(std::vector<std::unique_ptr<FairMQMessage>>& msgVec, const int flags = 0);
+    virtual int64_t Receive(std::vector<std::unique_ptr<FairMQMessage>>& msgVec, const int flags = 0);
+
+    virtual void* GetSocket() const;
+    virtual int GetSocket(int nothing) const;
+    virtual void Close();
+
+    virtual void Interrupt();
+    virtual void Resume();
+
+    virtual void SetOption(const std::string& option, const void* value, size_t valueSize);
+    virtual void GetOption(const std::string& option, void* value, size_t* valueSize);
+
+    virtual unsigned long GetBytesTx() const;
+    virtual unsigned long GetBytesRx() const;
+    virtual unsigned long GetMessagesTx() const;
+    virtual unsigned long GetMessagesRx() const;
+
+    virtual bool SetSendTimeout(const int timeout, const std::string& address, const std::string& method);
+    virtual int GetSendTimeout() const;
+    virtual bool SetReceiveTimeout(const int timeout, const std::string& address, const std::string& method);
+    virtual int GetReceiveTimeout() const;
+
+    /// @return true if a Receive() would not block (used by the poller)
+    bool Readable() const;
+    /// @return true if a Send() would not block (used by the poller)
+    bool Writable() const;
+    /// @return true for socket types that receive (pull, sub, req, rep)
+    bool CanReceive() const;
+    /// @return true for socket types that send (push, pub, req, rep)
+    bool CanSend() const;
+
+    virtual ~FairMQSocketInproc();
+
+  private:
+    enum class Type
+    {
+        PUSH,
+        PULL,
+        PUB,
+        SUB,
+        REQ,
+        REP
+    };
+
+    bool Attach(const std::string& address);
+    int SendFrame(fair::mq::inproc::Frame& frame, const int flags);
+    int ReceiveFrame(fair::mq::inproc::Frame& frame, const int flags);
+    int Publish(fair::mq::inproc::Frame& frame);
+
+    Type fType;
+    std::string fId;
+    std::string fAddressPrefix; // scopes the device command endpoints to the transport instance
+
+    std::vector<std::shared_ptr<fair::mq::inproc::Endpoint>> fEndpoints;
+    std::vector<std::shared_ptr<fair::mq::inproc::Queue>> fOutQueues; // push, req
+    std::vector<std::shared_ptr<fair::mq::inproc::Queue>> fInQueues; // pull, rep, and the own queue of sub, req
+    std::shared_ptr<fair::mq::inproc::Queue> fOwnQueue; // sub, req (replies)
+    size_t fNextOut;
+    size_t fNextIn;
+
+    std::deque<FairMQMessagePtr> fPendingParts; // remaining parts of a multipart message received part by part
+    std::vector<FairMQMessagePtr> fOutgoingParts; // parts sent with the SNDMORE flag
+    std::shared_ptr<fair::mq::inproc::Queue> fReplyTo; // rep: requester of the last received request
+    bool fAwaitingReply; // req: request sent, reply not yet received
+
+    int fSndHwm;
+    int fRcvHwm;
+    int fSndTimeout;
+    int fRcvTimeout;
+
+    std::atomic<unsigned long> fBytesTx;
+    std::atomic<unsigned long> fBytesRx;
+    std::atomic<unsigned long> fMessagesTx;
+    std::atomic<unsigned long> fMessagesRx;
+
+    static std::atomic<bool> fInterrupted;
+};
+
+#endif /* FAIRMQSOCKETINPROC_H_ */
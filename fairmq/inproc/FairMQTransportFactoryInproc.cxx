@@ -0,0 +1,79 @@
+/********************************************************************************
+ *    Copyright (C) 2017 GSI Helmholtzzentrum fuer Schwerionenforschung GmbH    *
+ *                                                                              *
+ *              This software is distributed under the terms of the             *
+ *              GNU Lesser General Public Licence (LGPL) version 3,             *
+ *                  copied verbatim in the file "LICENSE"                       *
+ ********************************************************************************/
+
+#include "FairMQTransportFactoryInproc.h"
+#include "FairMQLogger.h"
+
+using namespace std;
+
+FairMQ::Transport FairMQTransportFactoryInproc::fTransportType = FairMQ::Transport::INPROC;
+
+FairMQTransportFactoryInproc::FairMQTransportFactoryInproc(const string& id, const FairMQProgOptions* /*config*/)
+    : FairMQTransportFactory(id)
+{
+    LOG(DEBUG) << "Transport: Using in-process (pointer passing) transport";
+}
+
+FairMQMessagePtr FairMQTransportFactoryInproc::CreateMessage() const
+{
+    return unique_ptr<FairMQMessage>(new FairMQMessageInproc());
+}
+
+FairMQMessagePtr FairMQTransportFactoryInproc::CreateMessage(const size_t size) const
+{
+    return unique_ptr<FairMQMessage>(new FairMQMessageInproc(size));
+}
+
+FairMQMessagePtr FairMQTransportFactoryInproc::CreateMessage(void* data, const size_t size, fairmq_free_fn* ffn, void* hint) const
+{
+    return unique_ptr<FairMQMessage>(new FairMQMessageInproc(data, size, ffn, hint));
+}
+
+FairMQMessagePtr FairMQTransportFactoryInproc::CreateMessage(FairMQUnmanagedRegionPtr& region, void* data, const size_t size) const
+{
+    return unique_ptr<FairMQMessage>(new FairMQMessageInproc(region, data, size));
+}
+
+FairMQSocketPtr FairMQTransportFactoryInproc::CreateSocket(const string& type, const string& name) const
+{
+    return unique_ptr<FairMQSocket>(new FairMQSocketInproc(type, name, GetId()));
+}
+
+FairMQPollerPtr FairMQTransportFactoryInproc::CreatePoller(const vector<FairMQChannel>& channels) const
+{
+    return unique_ptr<FairMQPoller>(new FairMQPollerInproc(channels));
+}
+
+FairMQPollerPtr FairMQTransportFactoryInproc::CreatePoller(const std::vector<const FairMQChannel*>& channels) const
+{
+    return unique_ptr<FairMQPoller>(new FairMQPollerInproc(channels));
+}
+
+FairMQPollerPtr FairMQTransportFactoryInproc::CreatePoller(const unordered_map<string, vector<FairMQChannel>>& channelsMap, const vector<string>& channelList) const
+{
+    return unique_ptr<FairMQPoller>(new FairMQPollerInproc(channelsMap, channelList));
+}
+
+FairMQPollerPtr FairMQTransportFactoryInproc::CreatePoller(const FairMQSocket& cmdSocket, const FairMQSocket& dataSocket) const
+{
+    return unique_ptr<FairMQPoller>(new FairMQPollerInproc(cmdSocket, dataSocket));
+}
+
+FairMQUnmanagedRegionPtr FairMQTransportFactoryInproc::CreateUnmanagedRegion(const size_t size) const
+{
+    return unique_ptr<FairMQUnmanagedRegion>(new FairMQUnmanagedRegionInproc(size));
+}
+
+FairMQ::Transport FairMQTransportFactoryInproc::GetType() const
+{
+    return fTransportType;
+}
+
+FairMQTransportFactoryInproc::~FairMQTransportFactoryInproc()
+{
+}
@@ -0,0 +1,56 @@
+/********************************************************************************
+ *    Copyright (C) 2017 GSI Helmholtzzentrum fuer Schwerionenforschung GmbH    *
+ *                                                                              *
+ *              This software is distributed under the terms of the             *
+ *              GNU Lesser General Public Licence (LGPL) version 3,             *
+ *                  copied verbatim in the file "LICENSE"                       *
+ ********************************************************************************/
+
+#ifndef FAIRMQTRANSPORTFACTORYINPROC_H_
+#define FAIRMQTRANSPORTFACTORYINPROC_H_
+
+#include <vector>
+#include <string>
+
+#include "FairMQTransportFactory.h"
+#include "FairMQMessageInproc.h"
+#include "FairMQSocketInproc.h"
+#include "FairMQPollerInproc.h"
+#include "FairMQUnmanagedRegionInproc.h"
+#include <options/FairMQProgOptions.h>
+
+/**
+ * Transport for devices running in the same process (e.g. several devices in one executable, tests).
+ * Messages are passed by pointer between the sockets, see FairMQSocketInproc.
+ */
+
+class FairMQTransportFactoryInproc : public FairMQTransportFactory
+{
+  public:
+    FairMQTransportFactoryInproc(const std::string& id = "", const FairMQProgOptions* config = nullptr);
+    FairMQTransportFactoryInproc(const FairMQTransportFactoryInproc&) = delete;
+    FairMQTransportFactoryInproc operator=(const FairMQTransportFactoryInproc&) = delete;
+
+    ~FairMQTransportFactoryInproc() override;
+
+    FairMQMessagePtr CreateMessage() const override;
+    FairMQMessagePtr CreateMessage(const size_t size) const override;
+    FairMQMessagePtr CreateMessage(void* data, const size_t size, fairmq_free_fn* ffn, void* hint = nullptr) const override;
+    FairMQMessagePtr CreateMessage(FairMQUnmanagedRegionPtr& region, void* data, const size_t size) const override;
+
+    FairMQSocketPtr CreateSocket(const std::string& type, const std::string& name) const override;
+
+    FairMQPollerPtr CreatePoller(const std::vector<FairMQChannel>& channels) const override;
+    FairMQPollerPtr CreatePoller(const std::vector<const FairMQChannel*>& channels) const override;
+    FairMQPollerPtr CreatePoller(const std::unordered_map<std::string, std::vector<FairMQChannel>>& channelsMap, const std::vector<std::string>& channelList) const override;
+    FairMQPollerPtr CreatePoller(const FairMQSocket& cmdSocket, const FairMQSocket& dataSocket) const override;
+
+    FairMQUnmanagedRegionPtr CreateUnmanagedRegion(const size_t size) const override;
+
+    FairMQ::Transport GetType() const override;
+
+  private:
+    static FairMQ::Transport fTransportType;
+};
+
+#endif /* FAIRMQTRANSPORTFACTORYINPROC_H_ */
@@ -0,0 +1,36 @@
+/********************************************************************************
+ *    Copyright (C) 2017 GSI Helmholtzzentrum fuer Schwerionenforschung GmbH    *
+ *                                                                              *
+ *              This software is distributed under the terms of the             *
+ *              GNU Lesser General Public Licence (LGPL) version 3,             *
+ *                  copied verbatim in the file "LICENSE"                       *
+ ********************************************************************************/
+
+#include "FairMQUnmanagedRegionInproc.h"
+#include "FairMQLogger.h"
+
+#include <cstdlib>
+
+using namespace std;
+
+FairMQUnmanagedRegionInproc::FairMQUnmanagedRegionInproc(const size_t size)
+    : fBuffer(malloc(size))
+    , fSize(size)
+{
+}
+
+void* FairMQUnmanagedRegionInproc::GetData() const
+{
+    return fBuffer;
+}
+
+size_t FairMQUnmanagedRegionInproc::GetSize() const
+{
+    return fSize;
+}
+
+FairMQUnmanagedRegionInproc::~FairMQUnmanagedRegionInproc()
+{
+    LOG(DEBUG) << "destroying region";
+    free(fBuffer);
+}
@@ -0,0 +1,33 @@
+/********************************************************************************
+ *    Copyright (C) 2017 GSI Helmholtzzentrum fuer Schwerionenforschung GmbH    *
+ *                                                                              *
+ *              This software is distributed under the terms of the             *
+ *              GNU Lesser General Public Licence (LGPL) version 3,             *
+ *                  copied verbatim in the file "LICENSE"                       *
+ ********************************************************************************/
+
+#ifndef FAIRMQUNMANAGEDREGIONINPROC_H_
+#define FAIRMQUNMANAGEDREGIONINPROC_H_
+
+#include "FairMQUnmanagedRegion.h"
+
+#include <cstddef> // size_t
+
+class FairMQUnmanagedRegionInproc : public FairMQUnmanagedRegion
+{
+  public:
+    FairMQUnmanagedRegionInproc(const size_t size);
+    FairMQUnmanagedRegionInproc(const FairMQUnmanagedRegionInproc&) = delete;
+    FairMQUnmanagedRegionInproc operator=(const FairMQUnmanagedRegionInproc&) = delete;
+
+    virtual void* GetData() const override;
+    virtual size_t GetSize() const override;
+
+    virtual ~FairMQUnmanagedRegionInproc();
+
+  private:
+    void* fBuffer;
+    size_t fSize;
+};
+
+#endif /* FAIRMQUNMANAGEDREGIONINPROC_H_ */
@@ -226,6 +226,8 @@ void ChannelParser(const boost::property_tree::ptree& tree, FairMQMap& channelMa
                 commonChannel.UpdateSndKernelSize(q.second.get<int>("sndKernelSize", commonChannel.GetSndKernelSize()));
                 commonChannel.UpdateRcvKernelSize(q.second.get<int>("rcvKernelSize", commonChannel.GetRcvKernelSize()));
                 commonChannel.UpdateRateLogging(q.second.get<int>("rateLogging", commonChannel.GetRateLogging()));
+                commonChannel.UpdateIoAffinity(q.second.get<int>("ioAffinity", commonChannel.GetIoAffinity()));
+                commonChannel.UpdateShmSegment(q.second.get<string>("shmSegment", commonChannel.GetShmSegment()));
 
                 // temporary FairMQChannel container
                 vector<FairMQChannel> channelList;
@@ -245,6 +247,8 @@ void ChannelParser(const boost::property_tree::ptree& tree, FairMQMap& channelMa
                     LOG(DEBUG) << "\tsndKernelSize = " << commonChannel.GetSndKernelSize();
                     LOG(DEBUG) << "\trcvKernelSize = " << commonChannel.GetRcvKernelSize();
                     LOG(DEBUG) << "\trateLogging   = " << commonChannel.GetRateLogging();
+                    LOG(DEBUG) << "\tioAffinity    = " << commonChannel.GetIoAffinity();
+                    LOG(DEBUG) << "\tshmSegment    = " << commonChannel.GetShmSegment();
 
                     for (int i = 0; i < numSockets; ++i)
                     {
@@ -289,6 +293,8 @@ void ChannelParser(const boost::property_tree::ptree& tree, FairMQMap& channelMa
                 commonChannel.UpdateSndKernelSize(p.second.get<int>("sndKernelSize", commonChannel.GetSndKernelSize()));
                 commonChannel.UpdateRcvKernelSize(p.second.get<int>("rcvKernelSize", commonChannel.GetRcvKernelSize()));
                 commonChannel.UpdateRateLogging(p.second.get<int>("rateLogging", commonChannel.GetRateLogging()));
+                commonChannel.UpdateIoAffinity(p.second.get<int>("ioAffinity", commonChannel.GetIoAffinity()));
+                commonChannel.UpdateShmSegment(p.second.get<string>("shmSegment", commonChannel.GetShmSegment()));
             }
 
             // temporary FairMQChannel container
@@ -309,6 +315,8 @@ void ChannelParser(const boost::property_tree::ptree& tree, FairMQMap& channelMa
                 LOG(DEBUG) << "\tsndKernelSize = " << commonChannel.GetSndKernelSize();
                 LOG(DEBUG) << "\trcvKernelSize = " << commonChannel.GetRcvKernelSize();
                 LOG(DEBUG) << "\trateLogging   = " << commonChannel.GetRateLogging();
+                LOG(DEBUG) << "\tioAffinity    = " << commonChannel.GetIoAffinity();
+                LOG(DEBUG) << "\tshmSegment    = " << commonChannel.GetShmSegment();
 
                 for (int i = 0; i < numSockets; ++i)
                 {
@@ -350,6 +358,8 @@ void SocketParser(const boost::property_tree::ptree& tree, vector<FairMQChannel>
                 channel.UpdateSndKernelSize(q.second.get<int>("sndKernelSize", channel.GetSndKernelSize()));
                 channel.UpdateRcvKernelSize(q.second.get<int>("rcvKernelSize", channel.GetRcvKernelSize()));
                 channel.UpdateRateLogging(q.second.get<int>("rateLogging", channel.GetRateLogging()));
+                channel.UpdateIoAffinity(q.second.get<int>("ioAffinity", channel.GetIoAffinity()));
+                channel.UpdateShmSegment(q.second.get<string>("shmSegment", channel.GetShmSegment()));
 
                 LOG(DEBUG) << "" << channelName << "[" << socketCounter << "]:";
                 LOG(DEBUG) << "\ttype          = " << channel.GetType();
@@ -361,6 +371,8 @@ void SocketParser(const boost::property_tree::ptree& tree, vector<FairMQChannel>
                 LOG(DEBUG) << "\tsndKernelSize = " << channel.GetSndKernelSize();
                 LOG(DEBUG) << "\trcvKernelSize = " << channel.GetRcvKernelSize();
                 LOG(DEBUG) << "\trateLogging   = " << channel.GetRateLogging();
+                LOG(DEBUG) << "\tioAffinity    = " << channel.GetIoAffinity();
+                LOG(DEBUG) << "\tshmSegment    = " << channel.GetShmSegment();
 
                 channelList.push_back(channel);
                 ++socketCounter;
@@ -382,6 +394,8 @@ void SocketParser(const boost::property_tree::ptree& tree, vector<FairMQChannel>
             channel.UpdateSndKernelSize(p.second.get<int>("sndKernelSize", channel.GetSndKernelSize()));
             channel.UpdateRcvKernelSize(p.second.get<int>("rcvKernelSize", channel.GetRcvKernelSize()));
             channel.UpdateRateLogging(p.second.get<int>("rateLogging", channel.GetRateLogging()));
+            channel.UpdateIoAffinity(p.second.get<int>("ioAffinity", channel.GetIoAffinity()));
+            channel.UpdateShmSegment(p.second.get<string>("shmSegment", channel.GetShmSegment()));
 
             LOG(DEBUG) << "" << channelName << "[" << socketCounter << "]:";
             LOG(DEBUG) << "\ttype          = " << channel.GetType();
@@ -393,6 +407,8 @@ void SocketParser(const boost::property_tree::ptree& tree, vector<FairMQChannel>
             LOG(DEBUG) << "\tsndKernelSize = " << channel.GetSndKernelSize();
             LOG(DEBUG) << "\trcvKernelSize = " << channel.GetRcvKernelSize();
             LOG(DEBUG) << "\trateLogging   = " << channel.GetRateLogging();
+            LOG(DEBUG) << "\tioAffinity    = " << channel.GetIoAffinity();
+            LOG(DEBUG) << "\tshmSegment    = " << channel.GetShmSegment();
 
             channelList.push_back(channel);
             ++socketCounter;
@@ -420,6 +436,8 @@ void SocketParser(const boost::property_tree::ptree& tree, vector<FairMQChannel>
         LOG(DEBUG) << "\tsndKernelSize = " << channel.GetSndKernelSize();
         LOG(DEBUG) << "\trcvKernelSize = " << channel.GetRcvKernelSize();
         LOG(DEBUG) << "\trateLogging   = " << channel.GetRateLogging();
+        LOG(DEBUG) << "\tioAffinity    = " << channel.GetIoAffinity();
+        LOG(DEBUG) << "\tshmSegment    = " << channel.GetShmSegment();
 
         channelList.push_back(channel);
     }
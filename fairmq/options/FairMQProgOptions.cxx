@@ -260,6 +260,8 @@ void FairMQProgOptions::UpdateMQValues()
             string sndKernelSizeKey = "chans." + p.first + "." + to_string(index) + ".sndKernelSize";
             string rcvKernelSizeKey = "chans." + p.first + "." + to_string(index) + ".rcvKernelSize";
             string rateLoggingKey = "chans." + p.first + "." + to_string(index) + ".rateLogging";
+            string ioAffinityKey = "chans." + p.first + "." + to_string(index) + ".ioAffinity";
+            string shmSegmentKey = "chans." + p.first + "." + to_string(index) + ".shmSegment";
 
             fMQKeyMap[typeKey] = make_tuple(p.first, index, "type");
             fMQKeyMap[methodKey] = make_tuple(p.first, index, "method");
@@ -270,11 +272,14 @@ void FairMQProgOptions::UpdateMQValues()
             fMQKeyMap[sndKernelSizeKey] = make_tuple(p.first, index, "sndKernelSize");
             fMQKeyMap[rcvKernelSizeKey] = make_tuple(p.first, index, "rcvkernelSize");
             fMQKeyMap[rateLoggingKey] = make_tuple(p.first, index, "rateLogging");
+            fMQKeyMap[ioAffinityKey] = make_tuple(p.first, index, "ioAffinity");
+            fMQKeyMap[shmSegmentKey] = make_tuple(p.first, index, "shmSegment");
 
             UpdateVarMap<string>(typeKey, channel.GetType());
             UpdateVarMap<string>(methodKey, channel.GetMethod());
             UpdateVarMap<string>(addressKey, channel.GetAddress());
             UpdateVarMap<string>(transportKey, channel.GetTransport());
+            UpdateVarMap<string>(shmSegmentKey, channel.GetShmSegment());
 
             //UpdateVarMap<string>(sndBufSizeKey, to_string(channel.GetSndBufSize()));// string API
             UpdateVarMap<int>(sndBufSizeKey, channel.GetSndBufSize());
@@ -291,6 +296,8 @@ void FairMQProgOptions::UpdateMQValues()
             //UpdateVarMap<string>(rateLoggingKey,to_string(channel.GetRateLogging()));// string API
             UpdateVarMap<int>(rateLoggingKey, channel.GetRateLogging());
 
+            UpdateVarMap<int>(ioAffinityKey, channel.GetIoAffinity());
+
             /*
             LOG(DEBUG) << "Update MQ parameters of variable map";
             LOG(DEBUG) << "key = " << typeKey <<"\t value = " << GetValue<string>(typeKey);
@@ -327,7 +334,7 @@ void FairMQProgOptions::InitOptionDescription()
         fMQOptionsInCmd.add_options()
             ("id",                     po::value<string>(),                                     "Device ID (required argument).")
             ("io-threads",             po::value<int   >()->default_value(1),                   "Number of I/O threads.")
-            ("transport",              po::value<string>()->default_value("zeromq"),            "Transport ('zeromq'/'nanomsg').")
+            ("transport",              po::value<string>()->default_value("zeromq"),            "Transport ('zeromq'/'nanomsg'/'shmem'/'inproc').")
             ("config",                 po::value<string>()->default_value("static"),            "Config source ('static'/<config library filename>).")
             ("network-interface",      po::value<string>()->default_value("default"),           "Network interface to bind on (e.g. eth0, ib0..., default will try to detect the interface of the default route).")
             ("config-key",             po::value<string>(),                                     "Use provided value instead of device id for fetching the configuration from the config file.")
@@ -339,12 +346,21 @@ void FairMQProgOptions::InitOptionDescription()
             ("print-channels",         po::value<bool  >()->implicit_value(true),               "Print registered channel endpoints in a machine-readable format (<channel name>:<min num subchannels>:<max num subchannels>)")
             ("shm-segment-size",       po::value<size_t>()->default_value(2000000000),          "shmem transport: size of the shared memory segment (in bytes).")
             ("shm-segment-name",       po::value<string>()->default_value("fairmq_shmem_main"), "shmem transport: name of the shared memory segment.")
+            ("shm-segments",           po::value<string>()->default_value(""),                  "shmem transport: additional segments, selectable per channel via 'shmSegment', as comma separated list of name:size[:numa-node].")
+            ("affinity",               po::value<string>()->default_value(""),                  "CPU list to pin the device threads to (e.g. '0-3,8'). Empty for no pinning.")
+            ("numa-node",              po::value<int   >()->default_value(-1),                  "NUMA node to place the device on (threads are pinned to its CPUs unless --affinity is given). -1 for no placement.")
+            ("io-threads-affinity",    po::value<string>()->default_value(""),                  "CPU list to pin the ZeroMQ I/O threads to (requires ZeroMQ >= 4.3). Defaults to the CPUs of --numa-node, if given.")
+            ("shm-numa-node",          po::value<int   >()->default_value(-1),                  "shmem transport: NUMA node to bind the shared memory segment to. -1 to use --numa-node.")
+            ("shm-hugepages",          po::value<bool  >()->default_value(false),               "shmem transport: advise the kernel to back the shared memory segment with transparent huge pages.")
+            ("shm-hugepages-path",     po::value<string>()->default_value(""),                  "shmem transport: hugetlbfs mount point (e.g. /dev/hugepages) to allocate unmanaged regions from. Empty for regular shared memory.")
+            ("shm-prefault",           po::value<bool  >()->default_value(false),               "shmem transport: fault in all pages of the segment and of unmanaged regions at creation time.")
+            ("shm-mlock",              po::value<bool  >()->default_value(false),               "shmem transport: lock the segment and unmanaged regions in memory (mlock), requires sufficient RLIMIT_MEMLOCK.")
             ;
 
         fMQOptionsInCfg.add_options()
             ("id",                     po::value<string>(),                                     "Device ID (required argument).")
             ("io-threads",             po::value<int   >()->default_value(1),                   "Number of I/O threads.")
-            ("transport",              po::value<string>()->default_value("zeromq"),            "Transport ('zeromq'/'nanomsg').")
+            ("transport",              po::value<string>()->default_value("zeromq"),            "Transport ('zeromq'/'nanomsg'/'shmem'/'inproc').")
             ("config",                 po::value<string>()->default_value("static"),            "Config source ('static'/<config library filename>).")
             ("network-interface",      po::value<string>()->default_value("default"),           "Network interface to bind on (e.g. eth0, ib0..., default will try to detect the interface of the default route).")
             ("config-key",             po::value<string>(),                                     "Use provided value instead of device id for fetching the configuration from the config file.")
@@ -356,6 +372,15 @@ void FairMQProgOptions::InitOptionDescription()
             ("print-channels",         po::value<bool  >()->implicit_value(true),               "Print registered channel endpoints in a machine-readable format (<channel name>:<min num subchannels>:<max num subchannels>)")
             ("shm-segment-size",       po::value<size_t>()->default_value(2000000000),          "shmem transport: size of the shared memory segment (in bytes).")
             ("shm-segment-name",       po::value<string>()->default_value("fairmq_shmem_main"), "shmem transport: name of the shared memory segment.")
+            ("shm-segments",           po::value<string>()->default_value(""),                  "shmem transport: additional segments, selectable per channel via 'shmSegment', as comma separated list of name:size[:numa-node].")
+            ("affinity",               po::value<string>()->default_value(""),                  "CPU list to pin the device threads to (e.g. '0-3,8'). Empty for no pinning.")
+            ("numa-node",              po::value<int   >()->default_value(-1),                  "NUMA node to place the device on (threads are pinned to its CPUs unless --affinity is given). -1 for no placement.")
+            ("io-threads-affinity",    po::value<string>()->default_value(""),                  "CPU list to pin the ZeroMQ I/O threads to (requires ZeroMQ >= 4.3). Defaults to the CPUs of --numa-node, if given.")
+            ("shm-numa-node",          po::value<int   >()->default_value(-1),                  "shmem transport: NUMA node to bind the shared memory segment to. -1 to use --numa-node.")
+            ("shm-hugepages",          po::value<bool  >()->default_value(false),               "shmem transport: advise the kernel to back the shared memory segment with transparent huge pages.")
+            ("shm-hugepages-path",     po::value<string>()->default_value(""),                  "shmem transport: hugetlbfs mount point (e.g. /dev/hugepages) to allocate unmanaged regions from. Empty for regular shared memory.")
+            ("shm-prefault",           po::value<bool  >()->default_value(false),               "shmem transport: fault in all pages of the segment and of unmanaged regions at creation time.")
+            ("shm-mlock",              po::value<bool  >()->default_value(false),               "shmem transport: lock the segment and unmanaged regions in memory (mlock), requires sufficient RLIMIT_MEMLOCK.")
             ;
     }
     else
@@ -363,7 +388,7 @@ void FairMQProgOptions::InitOptionDescription()
         fMQOptionsInCmd.add_options()
             ("id",                     po::value<string>(),                                     "Device ID (required argument).")
             ("io-threads",             po::value<int   >()->default_value(1),                   "Number of I/O threads.")
-            ("transport",              po::value<string>()->default_value("zeromq"),            "Transport ('zeromq'/'nanomsg').")
+            ("transport",              po::value<string>()->default_value("zeromq"),            "Transport ('zeromq'/'nanomsg'/'shmem'/'inproc').")
             ("config",                 po::value<string>()->default_value("static"),            "Config source ('static'/<config library filename>).")
             ("network-interface",      po::value<string>()->default_value("default"),           "Network interface to bind on (e.g. eth0, ib0..., default will try to detect the interface of the default route).")
             ("config-key",             po::value<string>(),                                     "Use provided value instead of device id for fetching the configuration from the config file.")
@@ -375,6 +400,15 @@ void FairMQProgOptions::InitOptionDescription()
             ("print-channels",         po::value<bool  >()->implicit_value(true),               "Print registered channel endpoints in a machine-readable format (<channel name>:<min num subchannels>:<max num subchannels>)")
             ("shm-segment-size",       po::value<size_t>()->default_value(2000000000),          "shmem transport: size of the shared memory segment (in bytes).")
             ("shm-segment-name",       po::value<string>()->default_value("fairmq_shmem_main"), "shmem transport: name of the shared memory segment.")
+            ("shm-segments",           po::value<string>()->default_value(""),                  "shmem transport: additional segments, selectable per channel via 'shmSegment', as comma separated list of name:size[:numa-node].")
+            ("affinity",               po::value<string>()->default_value(""),                  "CPU list to pin the device threads to (e.g. '0-3,8'). Empty for no pinning.")
+            ("numa-node",              po::value<int   >()->default_value(-1),                  "NUMA node to place the device on (threads are pinned to its CPUs unless --affinity is given). -1 for no placement.")
+            ("io-threads-affinity",    po::value<string>()->default_value(""),                  "CPU list to pin the ZeroMQ I/O threads to (requires ZeroMQ >= 4.3). Defaults to the CPUs of --numa-node, if given.")
+            ("shm-numa-node",          po::value<int   >()->default_value(-1),                  "shmem transport: NUMA node to bind the shared memory segment to. -1 to use --numa-node.")
+            ("shm-hugepages",          po::value<bool  >()->default_value(false),               "shmem transport: advise the kernel to back the shared memory segment with transparent huge pages.")
+            ("shm-hugepages-path",     po::value<string>()->default_value(""),                  "shmem transport: hugetlbfs mount point (e.g. /dev/hugepages) to allocate unmanaged regions from. Empty for regular shared memory.")
+            ("shm-prefault",           po::value<bool  >()->default_value(false),               "shmem transport: fault in all pages of the segment and of unmanaged regions at creation time.")
+            ("shm-mlock",              po::value<bool  >()->default_value(false),               "shmem transport: lock the segment and unmanaged regions in memory (mlock), requires sufficient RLIMIT_MEMLOCK.")
             ;
     }
 
@@ -423,6 +457,12 @@ int FairMQProgOptions::UpdateChannelMap(const string& channelName, int index, co
         fFairMQMap.at(channelName).at(index).UpdateTransport(val);
         return 0;
     }
+
+    if (member == "shmSegment")
+    {
+        fFairMQMap.at(channelName).at(index).UpdateShmSegment(val);
+        return 0;
+    }
     else
     {
         //if we get there it means something is wrong
@@ -490,6 +530,12 @@ int FairMQProgOptions::UpdateChannelMap(const string& channelName, int index, co
         fFairMQMap.at(channelName).at(index).UpdateRateLogging(val);
         return 0;
     }
+
+    if (member == "ioAffinity")
+    {
+        fFairMQMap.at(channelName).at(index).UpdateIoAffinity(val);
+        return 0;
+    }
     else
     {
         //if we get there it means something is wrong
@@ -50,6 +50,8 @@ struct SUBOPT {
     SNDKERNELSIZE,
     RCVKERNELSIZE,
     RATELOGGING,    // logging rate
+    IOAFFINITY,     // bitmask of I/O threads handling the socket
+    SHMSEGMENT,     // shared memory segment for the messages (shmem transport)
     lastsocketkey
   };
 
@@ -64,6 +66,8 @@ struct SUBOPT {
     /*[SNDKERNELSIZE] = */ "sndKernelSize",
     /*[RCVKERNELSIZE] = */ "rcvKernelSize",
     /*[RATELOGGING]   = */ "rateLogging",
+    /*[IOAFFINITY]    = */ "ioAffinity",
+    /*[SHMSEGMENT]    = */ "shmSegment",
     nullptr
   };
 
@@ -16,6 +16,7 @@ void addCustomOptions(bpo::options_description& options)
     options.add_options()
         ("out-channel", bpo::value<std::string>()->default_value("data"), "Name of the output channel")
         ("same-msg", bpo::value<bool>()->default_value(true), "Re-send the same message (default), or recreate for each iteration")
+        ("use-region", bpo::value<bool>()->default_value(false), "Send messages from an unmanaged region instead of allocating them")
         ("msg-size", bpo::value<int>()->default_value(1000), "Message size in bytes")
         ("max-iterations", bpo::value<uint64_t>()->default_value(0), "Number of run iterations (0 - infinite)")
         ("msg-rate", bpo::value<int>()->default_value(0), "Msg rate limit in maximum number of messages per second");
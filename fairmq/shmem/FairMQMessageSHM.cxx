@@ -21,11 +21,13 @@ namespace bipc = boost::interprocess;
 atomic<bool> FairMQMessageSHM::fInterrupted(false);
 FairMQ::Transport FairMQMessageSHM::fTransportType = FairMQ::Transport::SHM;
 
-FairMQMessageSHM::FairMQMessageSHM()
+FairMQMessageSHM::FairMQMessageSHM(const uint16_t segmentId)
     : fMessage()
     , fQueued(false)
     , fMetaCreated(false)
     , fRegionId(0)
+    , fSegmentId(segmentId)
+    , fTransportSegmentId(segmentId)
     , fHandle()
     , fSize(0)
     , fLocalPtr(nullptr)
@@ -38,11 +40,13 @@ FairMQMessageSHM::FairMQMessageSHM()
     fMetaCreated = true;
 }
 
-FairMQMessageSHM::FairMQMessageSHM(const size_t size)
+FairMQMessageSHM::FairMQMessageSHM(const size_t size, const uint16_t segmentId)
     : fMessage()
     , fQueued(false)
     , fMetaCreated(false)
     , fRegionId(0)
+    , fSegmentId(segmentId)
+    , fTransportSegmentId(segmentId)
     , fHandle()
     , fSize(0)
     , fLocalPtr(nullptr)
@@ -51,11 +55,13 @@ FairMQMessageSHM::FairMQMessageSHM(const size_t size)
     InitializeChunk(size);
 }
 
-FairMQMessageSHM::FairMQMessageSHM(void* data, const size_t size, fairmq_free_fn* ffn, void* hint)
+FairMQMessageSHM::FairMQMessageSHM(void* data, const size_t size, fairmq_free_fn* ffn, void* hint, const uint16_t segmentId)
     : fMessage()
     , fQueued(false)
     , fMetaCreated(false)
     , fRegionId(0)
+    , fSegmentId(segmentId)
+    , fTransportSegmentId(segmentId)
     , fHandle()
     , fSize(0)
     , fLocalPtr(nullptr)
@@ -80,6 +86,8 @@ FairMQMessageSHM::FairMQMessageSHM(FairMQUnmanagedRegionPtr& region, void* data,
     , fQueued(false)
     , fMetaCreated(false)
     , fRegionId(static_cast<FairMQUnmanagedRegionSHM*>(region.get())->fRegionId)
+    , fSegmentId(0)
+    , fTransportSegmentId(0)
     , fHandle()
     , fSize(size)
     , fLocalPtr(data)
@@ -97,6 +105,7 @@ FairMQMessageSHM::FairMQMessageSHM(FairMQUnmanagedRegionPtr& region, void* data,
         header.fSize = size;
         header.fHandle = fHandle;
         header.fRegionId = fRegionId;
+        header.fSegmentId = fSegmentId;
         memcpy(zmq_msg_data(&fMessage), &header, sizeof(MetaHeader));
 
         fMetaCreated = true;
@@ -109,7 +118,7 @@ bool FairMQMessageSHM::InitializeChunk(const size_t size)
     {
         try
         {
-            fLocalPtr = Manager::Instance().Segment()->allocate(size);
+            fHandle = Manager::Instance().AllocateChunk(fSegmentId, size, fLocalPtr);
         }
         catch (bipc::bad_alloc& ba)
         {
@@ -124,7 +133,6 @@ bool FairMQMessageSHM::InitializeChunk(const size_t size)
                 continue;
             }
         }
-        fHandle = Manager::Instance().Segment()->get_handle_from_address(fLocalPtr);
     }
 
     fSize = size;
@@ -138,6 +146,7 @@ bool FairMQMessageSHM::InitializeChunk(const size_t size)
     header.fSize = size;
     header.fHandle = fHandle;
     header.fRegionId = fRegionId;
+    header.fSegmentId = fSegmentId;
     memcpy(zmq_msg_data(&fMessage), &header, sizeof(MetaHeader));
 
     fMetaCreated = true;
@@ -163,6 +172,8 @@ void FairMQMessageSHM::Rebuild(const size_t size)
     CloseMessage();
 
     fQueued = false;
+    // a received message refers to the segment of the sender, allocate the new chunk in the own one
+    fSegmentId = fTransportSegmentId;
 
     InitializeChunk(size);
 }
@@ -172,6 +183,8 @@ void FairMQMessageSHM::Rebuild(void* data, const size_t size, fairmq_free_fn* ff
     CloseMessage();
 
     fQueued = false;
+    // a received message refers to the segment of the sender, allocate the new chunk in the own one
+    fSegmentId = fTransportSegmentId;
 
     if (InitializeChunk(size))
     {
@@ -202,7 +215,7 @@ void* FairMQMessageSHM::GetData()
     {
         if (fRegionId == 0)
         {
-            return Manager::Instance().Segment()->get_address_from_handle(fHandle);
+            return Manager::Instance().ChunkData(fSegmentId, fHandle);
         }
         else
         {
@@ -243,6 +256,8 @@ void FairMQMessageSHM::Copy(const unique_ptr<FairMQMessage>& msg)
         bipc::managed_shared_memory::handle_t otherHandle = static_cast<FairMQMessageSHM*>(msg.get())->fHandle;
         if (otherHandle)
         {
+            // allocate the copy in the segment of the original
+            fSegmentId = static_cast<FairMQMessageSHM*>(msg.get())->fSegmentId;
             if (InitializeChunk(msg->GetSize()))
             {
                 memcpy(GetData(), msg->GetData(), msg->GetSize());
@@ -259,13 +274,31 @@ void FairMQMessageSHM::Copy(const unique_ptr<FairMQMessage>& msg)
     }
 }
 
+void FairMQMessageSHM::ReleaseChunk()
+{
+    if (fHandle && fRegionId == 0)
+    {
+        Manager::Instance().ReleaseChunk(fSegmentId, fHandle);
+    }
+}
+
+void FairMQMessageSHM::ReacquireChunk()
+{
+    if (fHandle && fRegionId == 0)
+    {
+        Manager::Instance().TakeOwnership(fSegmentId, fHandle);
+    }
+}
+
 void FairMQMessageSHM::CloseMessage()
 {
     if (fHandle && !fQueued && fRegionId == 0)
     {
-        Manager::Instance().Segment()->deallocate(Manager::Instance().Segment()->get_address_from_handle(fHandle));
-        fHandle = 0;
+        Manager::Instance().DeallocateChunk(fSegmentId, fHandle);
     }
+    // a queued chunk belongs to the receiver now, forget it so that Rebuild() allocates a new one
+    fHandle = 0;
+    fLocalPtr = nullptr;
 
     if (fMetaCreated)
     {
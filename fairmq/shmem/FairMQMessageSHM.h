@@ -25,9 +25,9 @@ class FairMQMessageSHM : public FairMQMessage
     friend class FairMQSocketSHM;
 
   public:
-    FairMQMessageSHM();
-    FairMQMessageSHM(const size_t size);
-    FairMQMessageSHM(void* data, const size_t size, fairmq_free_fn* ffn, void* hint = nullptr);
+    explicit FairMQMessageSHM(const uint16_t segmentId = 0);
+    FairMQMessageSHM(const size_t size, const uint16_t segmentId);
+    FairMQMessageSHM(void* data, const size_t size, fairmq_free_fn* ffn, void* hint, const uint16_t segmentId);
     FairMQMessageSHM(FairMQUnmanagedRegionPtr& region, void* data, const size_t size);
 
     FairMQMessageSHM(const FairMQMessageSHM&) = delete;
@@ -56,12 +56,19 @@ class FairMQMessageSHM : public FairMQMessage
     virtual ~FairMQMessageSHM();
 
   private:
+    /// hands the chunk over to the socket before sending, so that it is not reclaimed with this process while queued
+    void ReleaseChunk();
+    /// takes the chunk back if it could not be sent
+    void ReacquireChunk();
+
     zmq_msg_t fMessage;
     bool fQueued;
     bool fMetaCreated;
     static std::atomic<bool> fInterrupted;
     static FairMQ::Transport fTransportType;
     uint64_t fRegionId;
+    uint16_t fSegmentId; // segment of the chunk (if fRegionId == 0)
+    uint16_t fTransportSegmentId; // segment of the transport that created the message, new chunks are allocated there
     bipc::managed_shared_memory::handle_t fHandle;
     size_t fSize;
     void* fLocalPtr;
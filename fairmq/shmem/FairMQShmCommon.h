@@ -9,6 +9,8 @@
 #define FAIR_MQ_SHMEM_COMMON_H_
 
 #include <atomic>
+#include <cstring>
+#include <string>
 
 #include <boost/interprocess/managed_shared_memory.hpp>
 
@@ -37,6 +39,73 @@ struct RegionCounter
     std::atomic<unsigned int> fCount;
 };
 
+/// Number of processes (devices and the monitor) that have the management segment open.
+/// Only the last one removes it, so that no process keeps using a mapping of a removed management segment.
+struct ManagementCounter
+{
+    ManagementCounter(unsigned int c)
+        : fCount(c)
+    {}
+
+    std::atomic<unsigned int> fCount;
+};
+
+/// segment holding the segment registry, the region counter and the monitor status
+constexpr const char* kManagementSegmentName = "fairmq_shmem_management";
+constexpr size_t kManagementSegmentSize = 65536;
+/// guards the management segment (and the device counters of the segments) across processes
+constexpr const char* kManagementMutexName = "fairmq_shmem_mutex";
+
+/// maximum number of segments registered at the same time (segment ids are 0 .. kMaxSegments - 1)
+constexpr uint16_t kMaxSegments = 64;
+
+/// Registry entry of a segment in the management segment, stored under segmentInfoName(id).
+/// The id is what is transported in the MetaHeader, the name is what the segment is opened with.
+struct SegmentInfo
+{
+    SegmentInfo(const std::string& name)
+        : fName()
+    {
+        strncpy(fName, name.c_str(), sizeof(fName) - 1);
+        fName[sizeof(fName) - 1] = '\0';
+    }
+
+    char fName[256];
+};
+
+inline std::string segmentInfoName(const uint16_t id)
+{
+    return "fairmq_shmem_segment_" + std::to_string(id);
+}
+
+/// registers a user of the management segment (call with the management mutex locked)
+inline void attachManagementSegment(boost::interprocess::managed_shared_memory& managementSegment)
+{
+    ManagementCounter* mc = managementSegment.find_or_construct<ManagementCounter>(boost::interprocess::unique_instance)(0);
+    ++(mc->fCount);
+}
+
+/// unregisters a user of the management segment (call with the management mutex locked)
+/// @return true if this was the last user and no segments are registered anymore, i.e. the segment can be removed
+inline bool detachManagementSegment(boost::interprocess::managed_shared_memory& managementSegment)
+{
+    ManagementCounter* mc = managementSegment.find<ManagementCounter>(boost::interprocess::unique_instance).first;
+    if (mc && --(mc->fCount) > 0)
+    {
+        return false;
+    }
+
+    for (uint16_t id = 0; id < kMaxSegments; ++id)
+    {
+        if (managementSegment.find<SegmentInfo>(segmentInfoName(id).c_str()).first)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
 struct MonitorStatus
 {
     MonitorStatus()
@@ -51,6 +120,7 @@ struct alignas(32) MetaHeader
     uint64_t fSize;
     uint64_t fRegionId;
     boost::interprocess::managed_shared_memory::handle_t fHandle;
+    uint16_t fSegmentId;
 };
 
 } // namespace shmem
@@ -15,13 +15,25 @@
 #ifndef FAIRMQSHMMANAGER_H_
 #define FAIRMQSHMMANAGER_H_
 
+#include <array>
+#include <atomic>
 #include <thread>
 #include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
 
 #include <boost/interprocess/managed_shared_memory.hpp>
 #include <boost/interprocess/smart_ptr/shared_ptr.hpp>
+#include <boost/interprocess/sync/named_mutex.hpp>
+#include <boost/interprocess/sync/scoped_lock.hpp>
 
 #include "FairMQLogger.h"
+#include "FairMQShmCommon.h"
+#include "FairMQShmOwnership.h"
+#include <fairmq/Tools.h>
 
 namespace bipc = boost::interprocess;
 
@@ -41,116 +53,478 @@ class Manager
         return man;
     }
 
-    void InitializeSegment(const std::string& op, const std::string& name, const size_t size = 0)
+    /// Creates/opens a segment, registers it in the management segment and increments its user count.
+    /// Every call has to be matched with a DetachSegment() call.
+    /// @param op "open_or_create", "create_only" or "open_only"
+    /// @param name name of the segment
+    /// @param size size of the segment (when creating)
+    /// @return id of the segment, identical in all processes (transported in the MetaHeader)
+    uint16_t InitializeSegment(const std::string& op, const std::string& name, const size_t size = 0)
     {
-        if (!fSegment)
+        std::lock_guard<std::mutex> localLock(fLocalMutex);
+        bipc::scoped_lock<bipc::named_mutex> lock(fMutex);
+        AttachManagementSegment();
+
+        uint16_t id = 0;
+        auto it = fSegmentIds.find(name);
+        if (it == fSegmentIds.end())
+        {
+            bipc::managed_shared_memory* segment = OpenSegment(op, name, size, lock);
+            id = RegisterSegment(name);
+            MapSegment(id, name, segment);
+        }
+        else
+        {
+            id = it->second;
+        }
+        ++fLocalUsers[id];
+        ++fNumLocalUsers;
+
+        return id;
+    }
+
+    /// Decrements the user count of the segment. The segments of the process (including the ones opened for received
+    /// messages) are closed when its last user detaches, removing the ones that are not used by other processes anymore.
+    /// When no registered segments are left, the management segment is removed as well.
+    void DetachSegment(const uint16_t id)
+    {
+        std::lock_guard<std::mutex> localLock(fLocalMutex);
+        bipc::scoped_lock<bipc::named_mutex> lock(fMutex);
+
+        if (id >= kMaxSegments || fLocalUsers[id] == 0)
         {
-            try
+            LOG(DEBUG) << "shmem: segment with id " << id << " not attached, nothing to detach";
+            return;
+        }
+
+        --fLocalUsers[id];
+        if (--fNumLocalUsers > 0)
+        {
+            // keep the segment mapped for messages of the remaining transports, it is closed with them
+            return;
+        }
+
+        for (uint16_t i = 0; i < kMaxSegments; ++i)
+        {
+            if (fSegments[i].load())
             {
-                if (op == "open_or_create")
-                {
-                    fSegment = new bipc::managed_shared_memory(bipc::open_or_create, name.c_str(), size);
-                }
-                else if (op == "create_only")
-                {
-                    fSegment = new bipc::managed_shared_memory(bipc::create_only, name.c_str(), size);
-                }
-                else if (op == "open_only")
-                {
-                    int numTries = 0;
-                    bool success = false;
+                CloseSegment(i);
+            }
+        }
+
+        DetachManagementSegment();
+    }
+
+    /// @return the segment with the given id, segments created by other processes are opened on first use
+    bipc::managed_shared_memory* Segment(const uint16_t id)
+    {
+        if (id < kMaxSegments)
+        {
+            bipc::managed_shared_memory* segment = fSegments[id].load(std::memory_order_acquire);
+            if (segment)
+            {
+                return segment;
+            }
+            return OpenRegisteredSegment(id);
+        }
+
+        LOG(ERROR) << "shmem: invalid segment id " << id;
+        exit(EXIT_FAILURE);
+    }
+
+    /// Allocates a chunk in the given segment, owned by this process until a receiver takes it over.
+    /// @param data pointer to the user data of the chunk (output)
+    /// @return handle of the chunk, throws bipc::bad_alloc if the segment is full
+    bipc::managed_shared_memory::handle_t AllocateChunk(const uint16_t id, const size_t size, void*& data)
+    {
+        bipc::managed_shared_memory* segment = Segment(id);
+        ChunkHeader* chunk = static_cast<ChunkHeader*>(segment->allocate(sizeof(ChunkHeader) + size));
+        fOwnerTables[id]->Link(*segment, chunk, fOwnerSlots[id], fPid);
+        data = chunk + 1;
+        return segment->get_handle_from_address(chunk);
+    }
+
+    /// @return pointer to the user data of the chunk
+    void* ChunkData(const uint16_t id, const bipc::managed_shared_memory::handle_t handle)
+    {
+        return static_cast<ChunkHeader*>(Segment(id)->get_address_from_handle(handle)) + 1;
+    }
+
+    void DeallocateChunk(const uint16_t id, const bipc::managed_shared_memory::handle_t handle)
+    {
+        bipc::managed_shared_memory* segment = Segment(id);
+        ChunkHeader* chunk = static_cast<ChunkHeader*>(segment->get_address_from_handle(handle));
+        fOwnerTables[id]->Unlink(*segment, chunk, fPid);
+        segment->deallocate(chunk);
+    }
+    /// Hands a chunk over to a socket for sending, so that it is not reclaimed with this process while it is queued
+    void ReleaseChunk(const uint16_t id, const bipc::managed_shared_memory::handle_t handle)
+    {
+        bipc::managed_shared_memory* segment = Segment(id);
+        fOwnerTables[id]->Release(*segment, static_cast<ChunkHeader*>(segment->get_address_from_handle(handle)), fPid);
+    }
+
+    /// Moves a received chunk (or one that could not be sent) into the list of this process
+    void TakeOwnership(const uint16_t id, const bipc::managed_shared_memory::handle_t handle)
+    {
+        bipc::managed_shared_memory* segment = Segment(id);
+        fOwnerTables[id]->Acquire(*segment, static_cast<ChunkHeader*>(segment->get_address_from_handle(handle)), fOwnerSlots[id], fPid);
+    }
+
+    /// Signals to the monitor that this process is alive (called periodically by the transport)
+    void UpdateHeartbeats()
+    {
+        const int64_t now = heartbeatNow();
+        for (uint16_t id = 0; id < kMaxSegments; ++id)
+        {
+            if (fSegments[id].load(std::memory_order_acquire) && fOwnerSlots[id] != kNoOwner)
+            {
+                fOwnerTables[id]->fSlots[fOwnerSlots[id]].fHeartbeat = now;
+            }
+        }
+    }
+
+    /// Binds the pages of the segment to the given NUMA node (pages already touched are migrated)
+    bool BindSegmentToNumaNode(const uint16_t id, const int node)
+    {
+        return fair::mq::tools::bindMemoryToNumaNode(Segment(id)->get_address(), Segment(id)->get_size(), node);
+    }
+
+    /// Advises the kernel to back the segment with transparent huge pages
+    bool AdviseSegmentHugePages(const uint16_t id)
+    {
+        return fair::mq::tools::adviseHugePages(Segment(id)->get_address(), Segment(id)->get_size());
+    }
+
+    /// Faults in all pages of the segment, so that no page faults occur on the data path
+    bool PrefaultSegment(const uint16_t id)
+    {
+        return fair::mq::tools::prefaultMemory(Segment(id)->get_address(), Segment(id)->get_size());
+    }
+
+    /// Locks the segment in memory
+    bool LockSegment(const uint16_t id)
+    {
+        return fair::mq::tools::lockMemory(Segment(id)->get_address(), Segment(id)->get_size());
+    }
+
+    /// @return the management segment, opened (again) if this process has detached from it
+    bipc::managed_shared_memory& ManagementSegment()
+    {
+        std::lock_guard<std::mutex> localLock(fLocalMutex);
+        if (!fManagementSegment)
+        {
+            bipc::scoped_lock<bipc::named_mutex> lock(fMutex);
+            AttachManagementSegment();
+        }
+        return *fManagementSegment;
+    }
+
+    ~Manager()
+    {
+        // the segments are closed by the transports, only give up the management segment if one is still open
+        if (fManagementSegment)
+        {
+            bipc::scoped_lock<bipc::named_mutex> lock(fMutex);
+            detachManagementSegment(*fManagementSegment);
+        }
+    }
+
+  private:
+    Manager()
+        : fMutex(bipc::open_or_create, kManagementMutexName)
+        , fManagementSegment()
+        , fLocalMutex()
+        , fSegments()
+        , fSegmentIds()
+        , fRetiredSegments()
+        , fOwnerTables()
+        , fOwnerSlots()
+        , fLocalUsers()
+        , fNumLocalUsers(0)
+        , fPid(getpid())
+    {
+        for (auto& segment : fSegments)
+        {
+            segment.store(nullptr);
+        }
+        fOwnerTables.fill(nullptr);
+        fOwnerSlots.fill(kNoOwner);
+        fLocalUsers.fill(0);
+    }
+    Manager(const Manager&) = delete;
+    Manager operator=(const Manager&) = delete;
+
+    /// opens the management segment and registers this process as its user (called with fMutex locked)
+    void AttachManagementSegment()
+    {
+        if (!fManagementSegment)
+        {
+            fManagementSegment.reset(new bipc::managed_shared_memory(bipc::open_or_create, kManagementSegmentName, kManagementSegmentSize));
+            attachManagementSegment(*fManagementSegment);
+        }
+    }
+
+    /// closes the management segment, removing it if this process was its last user (called with fMutex locked)
+    void DetachManagementSegment()
+    {
+        if (!fManagementSegment)
+        {
+            return;
+        }
+
+        if (detachManagementSegment(*fManagementSegment))
+        {
+            if (bipc::shared_memory_object::remove(kManagementSegmentName))
+            {
+                LOG(DEBUG) << "shmem: successfully removed \"" << kManagementSegmentName << "\" segment after the device has stopped.";
+            }
+            else
+            {
+                LOG(DEBUG) << "shmem: did not remove \"" << kManagementSegmentName << "\" segment after the device stopped. Already removed?";
+            }
+        }
+        fManagementSegment.reset();
+    }
+
+    /// opens the segment (called with fMutex locked, which is released while waiting for a segment to appear)
+    bipc::managed_shared_memory* OpenSegment(const std::string& op, const std::string& name, const size_t size, bipc::scoped_lock<bipc::named_mutex>& lock)
+    {
+        try
+        {
+            if (op == "open_or_create")
+            {
+                return new bipc::managed_shared_memory(bipc::open_or_create, name.c_str(), size);
+            }
+            else if (op == "create_only")
+            {
+                return new bipc::managed_shared_memory(bipc::create_only, name.c_str(), size);
+            }
+            else if (op == "open_only")
+            {
+                int numTries = 0;
 
-                    do
+                while (true)
+                {
+                    try
+                    {
+                        return new bipc::managed_shared_memory(bipc::open_only, name.c_str());
+                    }
+                    catch (bipc::interprocess_exception& ie)
                     {
-                        try
+                        if (++numTries == 5)
                         {
-                            fSegment = new bipc::managed_shared_memory(bipc::open_only, name.c_str());
-                            success = true;
+                            LOG(ERROR) << "Could not open shared memory after " << numTries << " attempts, exiting!";
+                            exit(EXIT_FAILURE);
                         }
-                        catch (bipc::interprocess_exception& ie)
+                        else
                         {
-                            if (++numTries == 5)
-                            {
-                                LOG(ERROR) << "Could not open shared memory after " << numTries << " attempts, exiting!";
-                                exit(EXIT_FAILURE);
-                            }
-                            else
-                            {
-                                LOG(DEBUG) << "Could not open shared memory segment on try " << numTries << ". Retrying in 1 second...";
-                                LOG(DEBUG) << ie.what();
-
-                                std::this_thread::sleep_for(std::chrono::milliseconds(1000));
-                            }
+                            LOG(DEBUG) << "Could not open shared memory segment on try " << numTries << ". Retrying in 1 second...";
+                            LOG(DEBUG) << ie.what();
+
+                            // let the creator register the segment in the meantime
+                            lock.unlock();
+                            std::this_thread::sleep_for(std::chrono::milliseconds(1000));
+                            lock.lock();
                         }
                     }
-                    while (!success);
-                }
-                else
-                {
-                    LOG(ERROR) << "Unknown operation when initializing shared memory segment: " << op;
                 }
             }
-            catch (std::exception& e)
+            else
             {
-                LOG(ERROR) << "Exception during shared memory segment initialization: " << e.what() << ", application will now exit";
+                LOG(ERROR) << "Unknown operation when initializing shared memory segment: " << op;
                 exit(EXIT_FAILURE);
             }
         }
-        else
+        catch (std::exception& e)
         {
-            LOG(INFO) << "Segment already initialized";
+            LOG(ERROR) << "Exception during shared memory segment initialization: " << e.what() << ", application will now exit";
+            exit(EXIT_FAILURE);
         }
     }
 
-    bipc::managed_shared_memory* Segment() const
+    /// Publishes the opened segment in this process and counts the process as its user (called with fMutex locked).
+    /// The device counter counts processes, a segment stays mapped in a process until its last transport is gone.
+    void MapSegment(const uint16_t id, const std::string& name, bipc::managed_shared_memory* segment)
     {
-        if (fSegment)
+        DeviceCounter* dc = segment->find<DeviceCounter>(bipc::unique_instance).first;
+        if (dc)
         {
-            return fSegment;
+            (dc->fCount)++;
+            LOG(DEBUG) << "shmem: incremented device counter of segment '" << name << "' (id " << id << "), now: " << dc->fCount;
         }
         else
         {
-            LOG(ERROR) << "Segment not initialized";
-            exit(EXIT_FAILURE);
+            segment->construct<DeviceCounter>(bipc::unique_instance)(1);
+            LOG(DEBUG) << "shmem: initialized device counter of segment '" << name << "' (id " << id << ") with 1";
         }
+
+        fSegmentIds.emplace(name, id);
+        AttachOwner(id, segment);
+        fSegments[id].store(segment, std::memory_order_release);
     }
 
-    void Remove()
+    /// Unmaps the segment from this process and removes it, if no other process uses it (called with both mutexes locked).
+    /// A segment that still has allocated chunks (messages in flight to a receiver that has not opened the segment yet)
+    /// stays registered while other processes are around, so that its id is not reused for another segment.
+    /// It is removed by the next process closing it or by the monitor.
+    void CloseSegment(const uint16_t id)
     {
-        if (bipc::shared_memory_object::remove("fairmq_shmem_main"))
+        bipc::managed_shared_memory* segment = fSegments[id].load();
+        SegmentInfo* info = fManagementSegment->find<SegmentInfo>(segmentInfoName(id).c_str()).first;
+        std::string name(info ? info->fName : "");
+
+        ReleaseOwner(id);
+
+        // keep the mapping alive for messages that still refer to it, but forget it, so that the id can be reopened
+        fRetiredSegments.emplace_back(segment);
+        fSegments[id].store(nullptr);
+        fOwnerTables[id] = nullptr;
+        for (auto it = fSegmentIds.begin(); it != fSegmentIds.end(); ++it)
+        {
+            if (it->second == id)
+            {
+                fSegmentIds.erase(it);
+                break;
+            }
+        }
+
+        DeviceCounter* dc = segment->find<DeviceCounter>(bipc::unique_instance).first;
+        if (dc && --(dc->fCount) > 0)
         {
-            LOG(DEBUG) << "shmem: successfully removed \"fairmq_shmem_main\" segment after the device has stopped.";
+            LOG(DEBUG) << "shmem: other '" << name << "' users present (" << dc->fCount << "), not removing it.";
+            return;
+        }
+
+        // chunks of messages sent by this process can only be received by processes that use the management segment
+        OwnerTable* table = segment->find<OwnerTable>(bipc::unique_instance).first;
+        ManagementCounter* mc = fManagementSegment->find<ManagementCounter>(bipc::unique_instance).first;
+        uint64_t numAllocated = table ? table->NumAllocated() : 0;
+        if (numAllocated > 0 && mc && mc->fCount > 1)
+        {
+            LOG(DEBUG) << "shmem: " << numAllocated << " chunk(s) still allocated in '" << name << "', not removing it.";
+            return;
+        }
+
+        LOG(DEBUG) << "shmem: last '" << name << "' user, removing segment.";
+        fManagementSegment->destroy<SegmentInfo>(segmentInfoName(id).c_str());
+
+        if (bipc::shared_memory_object::remove(name.c_str()))
+        {
+            LOG(DEBUG) << "shmem: successfully removed \"" << name << "\" segment after the device has stopped.";
         }
         else
         {
-            LOG(DEBUG) << "shmem: did not remove \"fairmq_shmem_main\" segment after the device stopped. Already removed?";
+            LOG(DEBUG) << "shmem: did not remove \"" << name << "\" segment after the device stopped. Already removed?";
+        }
+    }
+
+    /// registers this process as an owner of chunks in the segment (called before the segment is published)
+    void AttachOwner(const uint16_t id, bipc::managed_shared_memory* segment)
+    {
+        fOwnerTables[id] = segment->find_or_construct<OwnerTable>(bipc::unique_instance)();
+        fOwnerSlots[id] = fOwnerTables[id]->Claim(fPid);
+        if (fOwnerSlots[id] == kNoOwner)
+        {
+            LOG(WARN) << "shmem: no free owner slot in segment with id " << id << ", chunks of this process cannot be reclaimed after a crash";
+        }
+    }
+
+    /// gives up the owner slot of this process, if it does not own any chunks anymore
+    void ReleaseOwner(const uint16_t id)
+    {
+        if (fOwnerSlots[id] == kNoOwner)
+        {
+            return;
         }
 
-        if (bipc::shared_memory_object::remove("fairmq_shmem_management"))
+        OwnerSlot& slot = fOwnerTables[id]->fSlots[fOwnerSlots[id]];
+        uint64_t numChunks = slot.NumChunks();
+        if (numChunks == 0)
         {
-            LOG(DEBUG) << "shmem: successfully removed \"fairmq_shmem_management\" segment after the device has stopped.";
+            slot.fPid.store(0);
         }
         else
         {
-            LOG(DEBUG) << "shmem: did not remove \"fairmq_shmem_management\" segment after the device stopped. Already removed?";
+            LOG(DEBUG) << "shmem: " << numChunks << " chunk(s) still owned in segment with id " << id << ", left for the monitor";
         }
+        fOwnerSlots[id] = kNoOwner;
     }
 
-    bipc::managed_shared_memory& ManagementSegment()
+    /// finds the id of the segment in the registry or assigns a free one (called with fMutex locked)
+    uint16_t RegisterSegment(const std::string& name)
     {
-        return fManagementSegment;
+        int freeId = -1;
+
+        for (uint16_t id = 0; id < kMaxSegments; ++id)
+        {
+            SegmentInfo* info = fManagementSegment->find<SegmentInfo>(segmentInfoName(id).c_str()).first;
+            if (info)
+            {
+                if (name == info->fName)
+                {
+                    return id;
+                }
+            }
+            else if (freeId < 0)
+            {
+                freeId = id;
+            }
+        }
+
+        if (freeId < 0)
+        {
+            LOG(ERROR) << "shmem: cannot register segment '" << name << "', maximum number of segments (" << kMaxSegments << ") reached";
+            exit(EXIT_FAILURE);
+        }
+
+        fManagementSegment->construct<SegmentInfo>(segmentInfoName(freeId).c_str())(name);
+        LOG(DEBUG) << "shmem: registered segment '" << name << "' with id " << freeId;
+
+        return freeId;
     }
 
-  private:
-    Manager()
-        : fSegment(nullptr)
-        , fManagementSegment(bipc::open_or_create, "fairmq_shmem_management", 65536)
-    {}
-    Manager(const Manager&) = delete;
-    Manager operator=(const Manager&) = delete;
+    /// opens a segment created by another process, looking up its name in the registry
+    bipc::managed_shared_memory* OpenRegisteredSegment(const uint16_t id)
+    {
+        std::lock_guard<std::mutex> localLock(fLocalMutex);
+
+        bipc::managed_shared_memory* segment = fSegments[id].load();
+        if (segment)
+        {
+            return segment;
+        }
+
+        bipc::scoped_lock<bipc::named_mutex> lock(fMutex);
+        AttachManagementSegment();
+
+        // a registered segment is only removed together with its registry entry, under the same lock
+        SegmentInfo* info = fManagementSegment->find<SegmentInfo>(segmentInfoName(id).c_str()).first;
+        if (!info)
+        {
+            LOG(ERROR) << "shmem: received message from unknown segment with id " << id;
+            exit(EXIT_FAILURE);
+        }
+        std::string name(info->fName);
+
+        segment = OpenSegment("open_only", name, 0, lock);
+        LOG(DEBUG) << "shmem: opened segment '" << name << "' (id " << id << ")";
+        MapSegment(id, name, segment);
+
+        return segment;
+    }
 
-    bipc::managed_shared_memory* fSegment;
-    bipc::managed_shared_memory fManagementSegment;
+    bipc::named_mutex fMutex; // guards the management segment and the device counters across processes
+    std::unique_ptr<bipc::managed_shared_memory> fManagementSegment; // open while the process uses segments
+    std::mutex fLocalMutex; // guards the maps below within the process
+    std::array<std::atomic<bipc::managed_shared_memory*>, kMaxSegments> fSegments; // indexed by segment id
+    std::unordered_map<std::string, uint16_t> fSegmentIds;
+    std::vector<std::unique_ptr<bipc::managed_shared_memory>> fRetiredSegments;
+    std::array<OwnerTable*, kMaxSegments> fOwnerTables; // chunk ownership registry of each segment
+    std::array<uint32_t, kMaxSegments> fOwnerSlots; // slot of this process in each owner table
+    std::array<unsigned int, kMaxSegments> fLocalUsers; // transports of this process using each segment
+    unsigned int fNumLocalUsers; // transports of this process using any segment
+    const int32_t fPid;
 };
 
 // class Chunk
@@ -8,13 +8,16 @@
 
 #include "FairMQShmMonitor.h"
 #include "FairMQShmCommon.h"
+#include "FairMQShmOwnership.h"
 
 #include <boost/interprocess/managed_shared_memory.hpp>
+#include <boost/interprocess/file_mapping.hpp>
 #include <boost/interprocess/containers/vector.hpp>
 #include <boost/interprocess/containers/string.hpp>
 #include <boost/interprocess/allocators/allocator.hpp>
 
 #include <boost/interprocess/sync/named_mutex.hpp>
+#include <boost/interprocess/sync/scoped_lock.hpp>
 #include <boost/interprocess/ipc/message_queue.hpp>
 #include <boost/date_time/posix_time/posix_time.hpp>
 
@@ -37,6 +40,16 @@ using StringVector    = bipc::vector<String, StringAllocator>;
 namespace
 {
     volatile std::sig_atomic_t gSignalStatus;
+
+    /// opens the management segment and registers the monitor as its user, so that the devices do not remove it
+    bipc::managed_shared_memory openManagementSegment()
+    {
+        bipc::named_mutex mtx(bipc::open_or_create, fair::mq::shmem::kManagementMutexName);
+        bipc::scoped_lock<bipc::named_mutex> lock(mtx);
+        bipc::managed_shared_memory managementSegment(bipc::open_or_create, fair::mq::shmem::kManagementSegmentName, fair::mq::shmem::kManagementSegmentSize);
+        fair::mq::shmem::attachManagementSegment(managementSegment);
+        return managementSegment;
+    }
 }
 
 namespace fair
@@ -51,17 +64,21 @@ void signalHandler(int signal)
     gSignalStatus = signal;
 }
 
-Monitor::Monitor(const string& segmentName, bool selfDestruct, bool interactive, unsigned int timeoutInMS)
+Monitor::Monitor(const string& segmentName, bool selfDestruct, bool interactive, unsigned int timeoutInMS, const string& hugePagesPath)
     : fSelfDestruct(selfDestruct)
     , fInteractive(interactive)
     , fSeenOnce(false)
     , fTimeoutInMS(timeoutInMS)
     , fSegmentName(segmentName)
+    , fHugePagesPath(hugePagesPath)
     , fTerminating(false)
     , fHeartbeatTriggered(false)
     , fLastHeartbeat()
+    , fHeartbeatsMutex()
+    , fHeartbeats()
+    , fLastReclaim()
     , fSignalThread()
-    , fManagementSegment(bipc::open_or_create, "fairmq_shmem_management", 65536)
+    , fManagementSegment(openManagementSegment())
 {
     MonitorStatus* monitorStatus = fManagementSegment.find<MonitorStatus>(bipc::unique_instance).first;
     if (monitorStatus != nullptr)
@@ -124,19 +141,21 @@ void Monitor::MonitorHeartbeats()
 {
     try
     {
-        bipc::message_queue mq(bipc::open_or_create, "fairmq_shmem_control_queue", 1000, sizeof(bool));
+        bipc::message_queue mq(bipc::open_or_create, "fairmq_shmem_control_queue", 1000, sizeof(int32_t));
 
         unsigned int priority;
         bipc::message_queue::size_type recvdSize;
 
         while (!fTerminating)
         {
-            bool heartbeat;
+            int32_t pid; // heartbeats carry the pid of the sending process
             bpt::ptime rcvTill = bpt::microsec_clock::universal_time() + bpt::milliseconds(100);
-            if (mq.timed_receive(&heartbeat, sizeof(heartbeat), recvdSize, priority, rcvTill))
+            if (mq.timed_receive(&pid, sizeof(pid), recvdSize, priority, rcvTill))
             {
                 fHeartbeatTriggered = true;
                 fLastHeartbeat = chrono::high_resolution_clock::now();
+                lock_guard<mutex> lock(fHeartbeatsMutex);
+                fHeartbeats[pid] = fLastHeartbeat;
             }
             else
             {
@@ -192,7 +211,7 @@ void Monitor::Interactive()
                     break;
                 case 'x':
                     cout << "[x] --> closing shared memory:" << endl;
-                    Cleanup(fSegmentName);
+                    Cleanup(fSegmentName, fHugePagesPath);
                     break;
                 case 'h':
                     cout << "[h] --> help:" << endl << endl;
@@ -280,10 +299,16 @@ void Monitor::CheckSegment()
         auto now = chrono::high_resolution_clock::now();
         unsigned int duration = chrono::duration_cast<chrono::milliseconds>(now - fLastHeartbeat).count();
 
+        if (chrono::duration_cast<chrono::milliseconds>(now - fLastReclaim).count() > 1000)
+        {
+            ReclaimOrphans(segment);
+            fLastReclaim = now;
+        }
+
         if (fHeartbeatTriggered && duration > fTimeoutInMS)
         {
             cout << "no heartbeats since over " << fTimeoutInMS << " milliseconds, cleaning..." << endl;
-            Cleanup(fSegmentName);
+            Cleanup(fSegmentName, fHugePagesPath);
             fHeartbeatTriggered = false;
             if (fSelfDestruct)
             {
@@ -335,11 +360,69 @@ void Monitor::CheckSegment()
     }
 }
 
-void Monitor::Cleanup(const string& segmentName)
+void Monitor::ReclaimOrphans(bipc::managed_shared_memory& segment)
+{
+    {
+        // forget processes that stopped sending heartbeats, their chunks are reclaimed below
+        lock_guard<mutex> lock(fHeartbeatsMutex);
+        auto now = chrono::high_resolution_clock::now();
+        for (auto it = fHeartbeats.begin(); it != fHeartbeats.end();)
+        {
+            if (chrono::duration_cast<chrono::milliseconds>(now - it->second).count() > fTimeoutInMS && !isProcessAlive(it->first))
+            {
+                if (!fInteractive)
+                {
+                    cout << "process " << it->first << " stopped sending heartbeats" << endl;
+                }
+                it = fHeartbeats.erase(it);
+            }
+            else
+            {
+                ++it;
+            }
+        }
+    }
+
+    ReclaimOrphans(segment, fSegmentName);
+
+    // additional segments registered by the devices
+    for (unsigned int i = 0; i < kMaxSegments; ++i)
+    {
+        SegmentInfo* info = fManagementSegment.find<SegmentInfo>(segmentInfoName(i).c_str()).first;
+        if (info && fSegmentName != info->fName)
+        {
+            try
+            {
+                bipc::managed_shared_memory extraSegment(bipc::open_only, info->fName);
+                ReclaimOrphans(extraSegment, info->fName);
+            }
+            catch (bipc::interprocess_exception& ie)
+            {
+                // segment removed in the meantime
+            }
+        }
+    }
+}
+
+void Monitor::ReclaimOrphans(bipc::managed_shared_memory& segment, const string& segmentName)
+{
+    OwnerTable* table = segment.find<OwnerTable>(bipc::unique_instance).first;
+    if (table)
+    {
+        unsigned int numOwners = 0;
+        uint64_t numChunks = table->ReclaimOrphans(segment, fTimeoutInMS, numOwners);
+        if (numOwners > 0)
+        {
+            cout << (fInteractive ? "\n" : "") << "reclaimed " << numChunks << " chunk(s) of " << numOwners << " dead process(es) in \"" << segmentName << "\"" << endl;
+        }
+    }
+}
+
+void Monitor::Cleanup(const string& segmentName, const string& hugePagesPath)
 {
     try
     {
-        bipc::managed_shared_memory managementSegment(bipc::open_only, "fairmq_shmem_management");
+        bipc::managed_shared_memory managementSegment(bipc::open_only, kManagementSegmentName);
         RegionCounter* rc = managementSegment.find<RegionCounter>(bipc::unique_instance).first;
         if (rc)
         {
@@ -348,6 +431,10 @@ void Monitor::Cleanup(const string& segmentName)
             for (unsigned int i = 1; i <= regionCount; ++i)
             {
                 RemoveObject("fairmq_shmem_region_" + to_string(i));
+                if (!hugePagesPath.empty())
+                {
+                    RemoveFile(hugePagesPath + "/fairmq_shmem_region_" + to_string(i));
+                }
             }
         }
         else
@@ -355,16 +442,26 @@ void Monitor::Cleanup(const string& segmentName)
             cout << "shmem: no region counter found. no regions to cleanup." << endl;
         }
 
-        RemoveObject("fairmq_shmem_management");
+        // additional segments registered by the devices (--shm-segments, channel option shmSegment)
+        for (unsigned int i = 0; i < kMaxSegments; ++i)
+        {
+            SegmentInfo* info = managementSegment.find<SegmentInfo>(segmentInfoName(i).c_str()).first;
+            if (info && segmentName != info->fName)
+            {
+                RemoveObject(info->fName);
+            }
+        }
+
+        RemoveObject(kManagementSegmentName);
     }
     catch (bipc::interprocess_exception& ie)
     {
-        cout << "Did not find \"fairmq_shmem_management\" shared memory segment. No regions to cleanup." << endl;
+        cout << "Did not find \"" << kManagementSegmentName << "\" shared memory segment. No regions to cleanup." << endl;
     }
 
     RemoveObject(segmentName);
 
-    boost::interprocess::named_mutex::remove("fairmq_shmem_mutex");
+    boost::interprocess::named_mutex::remove(kManagementMutexName);
 }
 
 void Monitor::RemoveObject(const std::string& name)
@@ -379,6 +476,18 @@ void Monitor::RemoveObject(const std::string& name)
     }
 }
 
+void Monitor::RemoveFile(const std::string& path)
+{
+    if (bipc::file_mapping::remove(path.c_str()))
+    {
+        cout << "Successfully removed \"" << path << "\" huge page file." << endl;
+    }
+    else
+    {
+        cout << "Did not remove \"" << path << "\" huge page file. Already removed?" << endl;
+    }
+}
+
 void Monitor::CleanupControlQueues()
 {
     if (bipc::message_queue::remove("fairmq_shmem_control_queue"))
@@ -457,7 +566,20 @@ void Monitor::PrintHelp()
 
 Monitor::~Monitor()
 {
-    fManagementSegment.destroy<MonitorStatus>(bipc::unique_instance);
+    try
+    {
+        bipc::named_mutex mtx(bipc::open_only, kManagementMutexName);
+        bipc::scoped_lock<bipc::named_mutex> lock(mtx);
+        fManagementSegment.destroy<MonitorStatus>(bipc::unique_instance);
+        if (detachManagementSegment(fManagementSegment))
+        {
+            RemoveObject(kManagementSegmentName);
+        }
+    }
+    catch (bipc::interprocess_exception& ie)
+    {
+        // removed by Cleanup()
+    }
     if (fSignalThread.joinable())
     {
         fSignalThread.join();
@@ -13,7 +13,10 @@
 #include <thread>
 #include <chrono>
 #include <atomic>
+#include <cstdint>
+#include <mutex>
 #include <string>
+#include <unordered_map>
 
 namespace fair
 {
@@ -25,7 +28,7 @@ namespace shmem
 class Monitor
 {
   public:
-    Monitor(const std::string& segmentName, bool selfDestruct, bool interactive, unsigned int timeoutInMS);
+    Monitor(const std::string& segmentName, bool selfDestruct, bool interactive, unsigned int timeoutInMS, const std::string& hugePagesPath = "");
 
     Monitor(const Monitor&) = delete;
     Monitor operator=(const Monitor&) = delete;
@@ -35,7 +38,7 @@ class Monitor
 
     virtual ~Monitor();
 
-    static void Cleanup(const std::string& segmentName);
+    static void Cleanup(const std::string& segmentName, const std::string& hugePagesPath = "");
     static void CleanupControlQueues();
 
   private:
@@ -44,18 +47,25 @@ class Monitor
     void PrintQueues();
     void MonitorHeartbeats();
     void CheckSegment();
+    void ReclaimOrphans(boost::interprocess::managed_shared_memory& segment);
+    void ReclaimOrphans(boost::interprocess::managed_shared_memory& segment, const std::string& segmentName);
     void Interactive();
     void SignalMonitor();
     static void RemoveObject(const std::string&);
+    static void RemoveFile(const std::string&);
 
     bool fSelfDestruct; // will self-destruct after the memory has been closed
     bool fInteractive; // running in interactive mode
     bool fSeenOnce; // true is segment has been opened successfully at least once
     unsigned int fTimeoutInMS;
     std::string fSegmentName;
+    std::string fHugePagesPath; // hugetlbfs mount point of the unmanaged regions, if any
     std::atomic<bool> fTerminating;
     std::atomic<bool> fHeartbeatTriggered;
     std::chrono::high_resolution_clock::time_point fLastHeartbeat;
+    std::mutex fHeartbeatsMutex;
+    std::unordered_map<int32_t, std::chrono::high_resolution_clock::time_point> fHeartbeats; // last heartbeat per process
+    std::chrono::high_resolution_clock::time_point fLastReclaim;
     std::thread fSignalThread;
     boost::interprocess::managed_shared_memory fManagementSegment;
 };
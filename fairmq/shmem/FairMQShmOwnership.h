@@ -0,0 +1,333 @@
+/********************************************************************************
+ *    Copyright (C) 2017 GSI Helmholtzzentrum fuer Schwerionenforschung GmbH    *
+ *                                                                              *
+ *              This software is distributed under the terms of the             *
+ *              GNU Lesser General Public Licence (LGPL) version 3,             *
+ *                  copied verbatim in the file "LICENSE"                       *
+ ********************************************************************************/
+#ifndef FAIR_MQ_SHMEM_OWNERSHIP_H_
+#define FAIR_MQ_SHMEM_OWNERSHIP_H_
+
+#include <atomic>
+#include <chrono>
+#include <cerrno>
+#include <cstdint>
+#include <thread>
+
+#include <signal.h> // kill
+#include <sys/types.h>
+#include <unistd.h> // getpid
+
+#include <boost/interprocess/managed_shared_memory.hpp>
+
+namespace fair
+{
+namespace mq
+{
+namespace shmem
+{
+
+// Every chunk allocated from a segment is preceded by a ChunkHeader that links it into a chunk list of its owner.
+// Owners are processes, registered in the OwnerTable of the segment. A process owns the chunks it allocated or received.
+// When a message is sent, its chunk leaves the list of the sender and is in flight until the receiver links it into
+// its own list, so a sender that stops (cleanly or not) while its messages are queued does not take them along.
+// When a process dies, the monitor walks the lists of its slot and deallocates the chunks, without touching the rest
+// of the segment. In-flight chunks are only freed with the segment.
+// Each owner has several lists, each with its own lock, used by different threads of the process, so that the
+// threads of a process do not serialize on a single lock.
+
+/// maximum number of processes tracked per segment
+constexpr uint32_t kMaxOwners = 256;
+/// owner of chunks allocated while all owner slots were taken (not tracked)
+constexpr uint32_t kNoOwner = 0xFFFFFFFF;
+/// number of chunk lists per owner
+constexpr uint32_t kNumStripes = 8;
+
+inline bool isProcessAlive(const int32_t pid)
+{
+    return kill(pid, 0) == 0 || errno == EPERM;
+}
+
+inline int64_t heartbeatNow()
+{
+    return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+/// Spin lock in shared memory, holding the pid of the holder. If the holder dies, the lock is taken over.
+class RobustSpinLock
+{
+  public:
+    RobustSpinLock()
+        : fHolder(0)
+    {}
+
+    void Lock(const int32_t pid)
+    {
+        unsigned int spins = 0;
+
+        while (true)
+        {
+            int32_t expected = 0;
+            if (fHolder.compare_exchange_weak(expected, pid, std::memory_order_acquire))
+            {
+                return;
+            }
+
+            if (++spins % 1024 == 0)
+            {
+                if (expected != 0 && !isProcessAlive(expected) && fHolder.compare_exchange_strong(expected, pid, std::memory_order_acquire))
+                {
+                    return;
+                }
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    void Unlock()
+    {
+        fHolder.store(0, std::memory_order_release);
+    }
+
+  private:
+    std::atomic<int32_t> fHolder;
+};
+
+struct alignas(16) ChunkHeader
+{
+    boost::interprocess::managed_shared_memory::handle_t fPrev; // 0 for none (no chunk starts at the segment begin)
+    boost::interprocess::managed_shared_memory::handle_t fNext;
+    uint32_t fOwner; // owner slot (while in flight: slot of the sender)
+    uint16_t fStripe; // list of the owner
+    uint16_t fInFlight; // 1 if sent and not yet received (not in any list)
+};
+
+/// @return the chunk list of the calling thread, threads are spread over the lists in the order of their first use
+inline uint16_t localStripe()
+{
+    static std::atomic<uint32_t> next(0);
+    thread_local uint16_t stripe = next++ % kNumStripes;
+    return stripe;
+}
+
+struct alignas(64) ChunkList
+{
+    ChunkList()
+        : fLock()
+        , fHead(0)
+        , fNumChunks(0)
+        , fNumInFlight(0)
+    {}
+
+    RobustSpinLock fLock; // guards the list
+    boost::interprocess::managed_shared_memory::handle_t fHead;
+    uint64_t fNumChunks;
+    std::atomic<uint64_t> fNumInFlight; // chunks sent from this list and not yet received
+};
+
+struct OwnerSlot
+{
+    OwnerSlot()
+        : fPid(0)
+        , fHeartbeat(0)
+        , fLists()
+    {}
+
+    /// @return number of chunks in the lists of the owner
+    uint64_t NumChunks()
+    {
+        uint64_t numChunks = 0;
+        for (auto& list : fLists)
+        {
+            list.fLock.Lock(getpid());
+            numChunks += list.fNumChunks;
+            list.fLock.Unlock();
+        }
+        return numChunks;
+    }
+
+    std::atomic<int32_t> fPid; // 0 for a free slot
+    std::atomic<int64_t> fHeartbeat; // last sign of life, ms since epoch
+    ChunkList fLists[kNumStripes];
+};
+
+/// Owner registry of a segment, stored in the segment itself (unique instance)
+struct OwnerTable
+{
+    OwnerTable()
+        : fSlots()
+        , fNumUntracked(0)
+    {}
+
+    OwnerSlot fSlots[kMaxOwners];
+    std::atomic<uint64_t> fNumUntracked; // chunks allocated or received without an owner slot
+
+    /// @return claimed slot for the given process, kNoOwner if all slots are taken
+    uint32_t Claim(const int32_t pid)
+    {
+        for (uint32_t i = 0; i < kMaxOwners; ++i)
+        {
+            int32_t expected = 0;
+            if (fSlots[i].fPid.compare_exchange_strong(expected, pid))
+            {
+                fSlots[i].fHeartbeat = heartbeatNow();
+                return i;
+            }
+        }
+        return kNoOwner;
+    }
+
+    /// links the chunk into the list of the calling thread of the owner (chunk must not be in any list)
+    void Link(boost::interprocess::managed_shared_memory& segment, ChunkHeader* chunk, const uint32_t owner, const int32_t pid)
+    {
+        chunk->fOwner = owner;
+        chunk->fStripe = localStripe();
+        chunk->fInFlight = 0;
+        chunk->fPrev = 0;
+        if (owner == kNoOwner)
+        {
+            chunk->fNext = 0;
+            ++fNumUntracked;
+            return;
+        }
+
+        ChunkList& list = fSlots[owner].fLists[chunk->fStripe];
+        list.fLock.Lock(pid);
+        chunk->fNext = list.fHead;
+        auto handle = segment.get_handle_from_address(chunk);
+        if (list.fHead)
+        {
+            static_cast<ChunkHeader*>(segment.get_address_from_handle(list.fHead))->fPrev = handle;
+        }
+        list.fHead = handle;
+        ++list.fNumChunks;
+        list.fLock.Unlock();
+    }
+
+    /// removes the chunk from the list of its current owner (or from the in-flight chunks)
+    void Unlink(boost::interprocess::managed_shared_memory& segment, ChunkHeader* chunk, const int32_t pid)
+    {
+        const uint32_t owner = chunk->fOwner;
+        if (owner == kNoOwner)
+        {
+            --fNumUntracked;
+            return;
+        }
+
+        ChunkList& list = fSlots[owner].fLists[chunk->fStripe];
+        if (chunk->fInFlight)
+        {
+            chunk->fInFlight = 0;
+            --list.fNumInFlight;
+            chunk->fOwner = kNoOwner;
+            return;
+        }
+
+        list.fLock.Lock(pid);
+        if (chunk->fPrev)
+        {
+            static_cast<ChunkHeader*>(segment.get_address_from_handle(chunk->fPrev))->fNext = chunk->fNext;
+        }
+        else
+        {
+            list.fHead = chunk->fNext;
+        }
+        if (chunk->fNext)
+        {
+            static_cast<ChunkHeader*>(segment.get_address_from_handle(chunk->fNext))->fPrev = chunk->fPrev;
+        }
+        --list.fNumChunks;
+        chunk->fOwner = kNoOwner;
+        list.fLock.Unlock();
+    }
+
+    /// Hands the chunk over to the queue of a socket: it leaves the list of its owner and is not reclaimed with it.
+    void Release(boost::interprocess::managed_shared_memory& segment, ChunkHeader* chunk, const int32_t pid)
+    {
+        const uint32_t owner = chunk->fOwner;
+        if (owner == kNoOwner || chunk->fInFlight)
+        {
+            return;
+        }
+
+        Unlink(segment, chunk, pid);
+        chunk->fOwner = owner;
+        chunk->fInFlight = 1;
+        ++fSlots[owner].fLists[chunk->fStripe].fNumInFlight;
+    }
+
+    /// Takes over a received chunk (or a chunk that could not be sent) into the list of the calling thread of the owner
+    void Acquire(boost::interprocess::managed_shared_memory& segment, ChunkHeader* chunk, const uint32_t owner, const int32_t pid)
+    {
+        if (!chunk->fInFlight && chunk->fOwner == owner && owner != kNoOwner)
+        {
+            return;
+        }
+
+        Unlink(segment, chunk, pid);
+        Link(segment, chunk, owner, pid);
+    }
+
+    /// @return number of chunks allocated in the segment (owned, in flight or untracked)
+    uint64_t NumAllocated()
+    {
+        uint64_t numChunks = fNumUntracked;
+        for (auto& slot : fSlots)
+        {
+            numChunks += slot.NumChunks();
+            for (auto& list : slot.fLists)
+            {
+                numChunks += list.fNumInFlight;
+            }
+        }
+        return numChunks;
+    }
+
+    /// Deallocates the chunks of owners that do not exist anymore and have not sent a heartbeat within the grace period.
+    /// Chunks in flight are not touched, they belong to the receiver once it has received them.
+    /// @param numOwners number of reclaimed owners (output)
+    /// @return number of deallocated chunks
+    uint64_t ReclaimOrphans(boost::interprocess::managed_shared_memory& segment, const int64_t gracePeriodInMS, unsigned int& numOwners)
+    {
+        uint64_t numChunks = 0;
+        numOwners = 0;
+        const int32_t self = getpid();
+
+        for (uint32_t i = 0; i < kMaxOwners; ++i)
+        {
+            OwnerSlot& slot = fSlots[i];
+            int32_t pid = slot.fPid.load();
+            if (pid == 0 || isProcessAlive(pid) || heartbeatNow() - slot.fHeartbeat.load() < gracePeriodInMS)
+            {
+                continue;
+            }
+
+            for (auto& list : slot.fLists)
+            {
+                list.fLock.Lock(self);
+                auto handle = list.fHead;
+                while (handle)
+                {
+                    ChunkHeader* chunk = static_cast<ChunkHeader*>(segment.get_address_from_handle(handle));
+                    handle = chunk->fNext;
+                    segment.deallocate(chunk);
+                    ++numChunks;
+                }
+                list.fHead = 0;
+                list.fNumChunks = 0;
+                list.fLock.Unlock();
+            }
+
+            slot.fPid.store(0);
+            ++numOwners;
+        }
+
+        return numChunks;
+    }
+};
+
+} // namespace shmem
+} // namespace mq
+} // namespace fair
+
+#endif /* FAIR_MQ_SHMEM_OWNERSHIP_H_ */
@@ -14,6 +14,7 @@
 #include "FairMQUnmanagedRegionSHM.h"
 #include "FairMQLogger.h"
 #include "FairMQShmCommon.h"
+#include "FairMQShmManager.h"
 
 using namespace std;
 using namespace fair::mq::shmem;
@@ -111,6 +112,9 @@ void FairMQSocketSHM::Connect(const string& address)
 
 int FairMQSocketSHM::Send(FairMQMessagePtr& msg, const int flags)
 {
+    FairMQMessageSHM* shmMsg = static_cast<FairMQMessageSHM*>(msg.get());
+    shmMsg->ReleaseChunk();
+
     int nbytes = -1;
     while (true && !fInterrupted)
     {
@@ -121,7 +125,7 @@ int FairMQSocketSHM::Send(FairMQMessagePtr& msg, const int flags)
         }
         else if (nbytes > 0)
         {
-            static_cast<FairMQMessageSHM*>(msg.get())->fQueued = true;
+            shmMsg->fQueued = true;
 
             size_t size = msg->GetSize();
             fBytesTx += size;
@@ -137,21 +141,25 @@ int FairMQSocketSHM::Send(FairMQMessagePtr& msg, const int flags)
             }
             else
             {
+                shmMsg->ReacquireChunk();
                 return -2;
             }
         }
         else if (zmq_errno() == ETERM)
         {
             LOG(INFO) << "terminating socket " << fId;
+            shmMsg->ReacquireChunk();
             return -1;
         }
         else
         {
             LOG(ERROR) << "Failed sending on socket " << fId << ", reason: " << zmq_strerror(errno);
+            shmMsg->ReacquireChunk();
             return nbytes;
         }
     }
 
+    shmMsg->ReacquireChunk();
     return -1;
 }
 
@@ -175,6 +183,11 @@ int FairMQSocketSHM::Receive(FairMQMessagePtr& msg, const int flags)
             static_cast<FairMQMessageSHM*>(msg.get())->fHandle = hdr->fHandle;
             static_cast<FairMQMessageSHM*>(msg.get())->fSize = hdr->fSize;
             static_cast<FairMQMessageSHM*>(msg.get())->fRegionId = hdr->fRegionId;
+            static_cast<FairMQMessageSHM*>(msg.get())->fSegmentId = hdr->fSegmentId;
+            if (hdr->fRegionId == 0 && hdr->fHandle)
+            {
+                Manager::Instance().TakeOwnership(hdr->fSegmentId, hdr->fHandle);
+            }
             size = msg->GetSize();
 
             fBytesRx += size;
@@ -217,8 +230,26 @@ int64_t FairMQSocketSHM::Send(vector<FairMQMessagePtr>& msgVec, const int flags)
         int nbytes = -1;
         bool repeat = false;
 
+        for (auto& msg : msgVec)
+        {
+            static_cast<FairMQMessageSHM*>(msg.get())->ReleaseChunk();
+        }
+        // parts that have not been queued go back to this process
+        auto reacquire = [&msgVec]()
+        {
+            for (auto& msg : msgVec)
+            {
+                if (!static_cast<FairMQMessageSHM*>(msg.get())->fQueued)
+                {
+                    static_cast<FairMQMessageSHM*>(msg.get())->ReacquireChunk();
+                }
+            }
+        };
+
         while (true && !fInterrupted)
         {
+            repeat = false;
+
             for (unsigned int i = 0; i < vecSize; ++i)
             {
                 nbytes = zmq_msg_send(static_cast<zmq_msg_t*>(msgVec[i]->GetMessage()),
@@ -243,15 +274,18 @@ int64_t FairMQSocketSHM::Send(vector<FairMQMessagePtr>& msgVec, const int flags)
                         }
                         else
                         {
+                            reacquire();
                             return -2;
                         }
                     }
                     if (zmq_errno() == ETERM)
                     {
                         LOG(INFO) << "terminating socket " << fId;
+                        reacquire();
                         return -1;
                     }
                     LOG(ERROR) << "Failed sending on socket " << fId << ", reason: " << zmq_strerror(errno);
+                    reacquire();
                     return nbytes;
                 }
             }
@@ -267,6 +301,7 @@ int64_t FairMQSocketSHM::Send(vector<FairMQMessagePtr>& msgVec, const int flags)
             return totalSize;
         }
 
+        reacquire();
         return -1;
     } // If there's only one part, send it as a regular message
     else if (vecSize == 1)
@@ -316,6 +351,11 @@ int64_t FairMQSocketSHM::Receive(vector<FairMQMessagePtr>& msgVec, const int fla
                 static_cast<FairMQMessageSHM*>(part.get())->fHandle = hdr->fHandle;
                 static_cast<FairMQMessageSHM*>(part.get())->fSize = hdr->fSize;
                 static_cast<FairMQMessageSHM*>(part.get())->fRegionId = hdr->fRegionId;
+                static_cast<FairMQMessageSHM*>(part.get())->fSegmentId = hdr->fSegmentId;
+                if (hdr->fRegionId == 0 && hdr->fHandle)
+                {
+                    Manager::Instance().TakeOwnership(hdr->fSegmentId, hdr->fHandle);
+                }
                 size = part->GetSize();
 
                 msgVec.push_back(move(part));
@@ -596,6 +636,8 @@ int FairMQSocketSHM::GetConstant(const string& constant)
 
     if (constant == "linger")
         return ZMQ_LINGER;
+    if (constant == "affinity")
+        return ZMQ_AFFINITY;
     if (constant == "no-block")
         return ZMQ_DONTWAIT;
     if (constant == "snd-more no-block")
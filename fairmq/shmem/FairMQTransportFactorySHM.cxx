@@ -9,10 +9,12 @@
 #include "FairMQLogger.h"
 #include "FairMQShmManager.h"
 #include "FairMQTransportFactorySHM.h"
+#include <zeromq/FairMQIoThreadsZMQ.h>
 
 #include <zmq.h>
 
 #include <boost/version.hpp>
+#include <boost/algorithm/string.hpp> // split
 #include <boost/filesystem.hpp>
 #include <boost/interprocess/managed_shared_memory.hpp>
 
@@ -39,8 +41,15 @@ FairMQTransportFactorySHM::FairMQTransportFactorySHM(const string& id, const Fai
     , fHeartbeatSocket(nullptr)
     , fHeartbeatThread()
     , fSendHeartbeats(true)
-    , fShMutex(bipc::open_or_create, "fairmq_shmem_mutex")
-    , fDeviceCounter(nullptr)
+    , fParent()
+    , fSegmentId(0)
+    , fSegmentSize(2000000000)
+    , fSegmentNumaNode(-1)
+    , fHugePages(false)
+    , fPrefault(false)
+    , fLock(false)
+    , fSegmentsMutex()
+    , fSegments()
 {
     int major, minor, patch;
     zmq_version(&major, &minor, &patch);
@@ -55,73 +64,161 @@ FairMQTransportFactorySHM::FairMQTransportFactorySHM(const string& id, const Fai
     }
     
     int numIoThreads = 1;
-    size_t segmentSize = 2000000000;
     string segmentName = "fairmq_shmem_main";
+    string segments;
+    string ioAffinity;
+    int numaNode = -1;
+    string hugePagesPath;
     if (config)
     {
         numIoThreads = config->GetValue<int>("io-threads");
-        segmentSize = config->GetValue<size_t>("shm-segment-size");
+        fSegmentSize = config->GetValue<size_t>("shm-segment-size");
         segmentName = config->GetValue<string>("shm-segment-name");
+        segments = config->GetValue<string>("shm-segments");
+        ioAffinity = config->GetValue<string>("io-threads-affinity");
+        numaNode = config->GetValue<int>("numa-node");
+        fSegmentNumaNode = config->GetValue<int>("shm-numa-node");
+        fHugePages = config->GetValue<bool>("shm-hugepages");
+        hugePagesPath = config->GetValue<string>("shm-hugepages-path");
+        fPrefault = config->GetValue<bool>("shm-prefault");
+        fLock = config->GetValue<bool>("shm-mlock");
     }
     else
     {
         LOG(WARN) << "shmem: FairMQProgOptions not available! Using defaults.";
     }
 
+    if (fSegmentNumaNode < 0)
+    {
+        fSegmentNumaNode = numaNode;
+    }
+
     if (zmq_ctx_set(fContext, ZMQ_IO_THREADS, numIoThreads) != 0)
     {
         LOG(ERROR) << "shmem: failed configuring context, reason: " << zmq_strerror(errno);
     }
 
+    // I/O threads are started lazily with the first socket, so the affinity has to be set here
+    fair::mq::zeromq::setIoThreadsAffinity(fContext, numIoThreads, ioAffinity, numaNode, "shmem");
+
     // Set the maximum number of allowed sockets on the context.
     if (zmq_ctx_set(fContext, ZMQ_MAX_SOCKETS, 10000) != 0)
     {
         LOG(ERROR) << "shmem: failed configuring context, reason: " << zmq_strerror(errno);
     }
 
-    Manager::Instance().InitializeSegment("open_or_create", segmentName, segmentSize);
-    LOG(DEBUG) << "shmem: created/opened shared memory segment of " << segmentSize << " bytes. Available are " << Manager::Instance().Segment()->get_free_memory() << " bytes.";
+    fSegmentId = AttachSegment(segmentName, fSegmentSize, fSegmentNumaNode);
 
+    // additional segments, given as name:size[:numa-node], selectable per channel
+    if (segments != "")
     {
-        bipc::scoped_lock<bipc::named_mutex> lock(fShMutex);
-
-        fDeviceCounter = Manager::Instance().Segment()->find<DeviceCounter>(bipc::unique_instance).first;
-        if (fDeviceCounter)
+        vector<string> entries;
+        boost::algorithm::split(entries, segments, boost::algorithm::is_any_of(","));
+        for (const auto& entry : entries)
         {
-            LOG(DEBUG) << "shmem: device counter found, with value of " << fDeviceCounter->fCount << ". incrementing.";
-            (fDeviceCounter->fCount)++;
-            LOG(DEBUG) << "shmem: incremented device counter, now: " << fDeviceCounter->fCount;
+            vector<string> fields;
+            boost::algorithm::split(fields, entry, boost::algorithm::is_any_of(":"));
+            if (fields.size() < 2 || fields.size() > 3 || fields.at(0) == "")
+            {
+                LOG(ERROR) << "shmem: invalid segment specification '" << entry << "', expected name:size[:numa-node]";
+                exit(EXIT_FAILURE);
+            }
+            try
+            {
+                AttachSegment(fields.at(0), stoull(fields.at(1)), fields.size() == 3 ? stoi(fields.at(2)) : fSegmentNumaNode);
+            }
+            catch (logic_error& e)
+            {
+                LOG(ERROR) << "shmem: invalid segment specification '" << entry << "': " << e.what();
+                exit(EXIT_FAILURE);
+            }
         }
-        else
+    }
+
+    FairMQUnmanagedRegionSHM::ConfigureMemory(hugePagesPath, fPrefault, fLock);
+
+    fSendHeartbeats = true;
+    fHeartbeatThread = thread(&FairMQTransportFactorySHM::SendHeartbeats, this);
+}
+
+FairMQTransportFactorySHM::FairMQTransportFactorySHM(shared_ptr<FairMQTransportFactorySHM> parent, const uint16_t segmentId)
+    : FairMQTransportFactory(parent->GetId())
+    , fContext(parent->fContext)
+    , fHeartbeatSocket(nullptr)
+    , fHeartbeatThread()
+    , fSendHeartbeats(false)
+    , fParent(parent)
+    , fSegmentId(segmentId)
+    , fSegmentSize(parent->fSegmentSize)
+    , fSegmentNumaNode(parent->fSegmentNumaNode)
+    , fHugePages(parent->fHugePages)
+    , fPrefault(parent->fPrefault)
+    , fLock(parent->fLock)
+    , fSegmentsMutex()
+    , fSegments()
+{
+}
+
+auto FairMQTransportFactorySHM::CreateSegmentTransport(shared_ptr<FairMQTransportFactory> factory, const string& segmentName) -> shared_ptr<FairMQTransportFactory>
+{
+    auto shmFactory = dynamic_pointer_cast<FairMQTransportFactorySHM>(factory);
+    if (!shmFactory)
+    {
+        LOG(ERROR) << "shmem: segment '" << segmentName << "' requested for a transport that is not shmem";
+        return factory;
+    }
+
+    // always attach via the transport that owns the context
+    if (shmFactory->fParent)
+    {
+        shmFactory = shmFactory->fParent;
+    }
+
+    uint16_t segmentId = shmFactory->AttachSegment(segmentName, shmFactory->fSegmentSize, shmFactory->fSegmentNumaNode);
+
+    return shared_ptr<FairMQTransportFactory>(new FairMQTransportFactorySHM(shmFactory, segmentId));
+}
+
+uint16_t FairMQTransportFactorySHM::AttachSegment(const string& name, const size_t size, const int numaNode)
+{
+    lock_guard<mutex> segmentsLock(fSegmentsMutex);
+
+    auto it = fSegments.find(name);
+    if (it != fSegments.end())
+    {
+        return it->second;
+    }
+
+    uint16_t id = Manager::Instance().InitializeSegment("open_or_create", name, size);
+    fSegments.emplace(name, id);
+    LOG(DEBUG) << "shmem: created/opened shared memory segment '" << name << "' (id " << id << ") of " << size << " bytes. Available are " << Manager::Instance().Segment(id)->get_free_memory() << " bytes.";
+
+    if (numaNode >= 0)
+    {
+        if (Manager::Instance().BindSegmentToNumaNode(id, numaNode))
         {
-            LOG(DEBUG) << "shmem: no device counter found, creating one and initializing with 1";
-            fDeviceCounter = Manager::Instance().Segment()->construct<DeviceCounter>(bipc::unique_instance)(1);
-            LOG(DEBUG) << "shmem: initialized device counter with: " << fDeviceCounter->fCount;
+            LOG(INFO) << "shmem: segment '" << name << "' bound to NUMA node " << numaNode;
         }
+    }
 
-        // start shm monitor
-        // try
-        // {
-        //     MonitorStatus* monitorStatus = fManagementSegment.find<MonitorStatus>(bipc::unique_instance).first;
-        //     if (monitorStatus == nullptr)
-        //     {
-        //         LOG(DEBUG) << "shmem: no shmmonitor found, starting...";
-        //         StartMonitor();
-        //     }
-        //     else
-        //     {
-        //         LOG(DEBUG) << "shmem: found shmmonitor in fairmq_shmem_management.";
-        //     }
-        // }
-        // catch (std::exception& e)
-        // {
-        //     LOG(ERROR) << "shmem: Exception during shmmonitor initialization: " << e.what() << ", application will now exit";
-        //     exit(EXIT_FAILURE);
-        // }
+    // boost::interprocess::managed_shared_memory lives in /dev/shm, so the segment can only use transparent huge pages.
+    // Unmanaged regions can be allocated from a hugetlbfs mount instead (--shm-hugepages-path).
+    if (fHugePages && Manager::Instance().AdviseSegmentHugePages(id))
+    {
+        LOG(INFO) << "shmem: advised transparent huge pages for segment '" << name << "'";
+    }
+    if (fPrefault)
+    {
+        auto tStart = chrono::high_resolution_clock::now();
+        Manager::Instance().PrefaultSegment(id);
+        LOG(INFO) << "shmem: prefaulted segment '" << name << "' in " << chrono::duration<double, milli>(chrono::high_resolution_clock::now() - tStart).count() << "ms";
+    }
+    if (fLock && Manager::Instance().LockSegment(id))
+    {
+        LOG(INFO) << "shmem: locked segment '" << name << "' in memory";
     }
 
-    fSendHeartbeats = true;
-    fHeartbeatThread = thread(&FairMQTransportFactorySHM::SendHeartbeats, this);
+    return id;
 }
 
 void FairMQTransportFactorySHM::StartMonitor()
@@ -165,8 +262,11 @@ void FairMQTransportFactorySHM::SendHeartbeats()
     {
         try
         {
+            // sign of life for the chunk ownership tables of the segments
+            Manager::Instance().UpdateHeartbeats();
+
             bipc::message_queue mq(bipc::open_only, "fairmq_shmem_control_queue");
-            bool heartbeat = true;
+            int32_t heartbeat = getpid();
             bpt::ptime sndTill = bpt::microsec_clock::universal_time() + bpt::milliseconds(100);
             if (mq.timed_send(&heartbeat, sizeof(heartbeat), 0, sndTill))
             {
@@ -187,17 +287,17 @@ void FairMQTransportFactorySHM::SendHeartbeats()
 
 FairMQMessagePtr FairMQTransportFactorySHM::CreateMessage() const
 {
-    return unique_ptr<FairMQMessage>(new FairMQMessageSHM());
+    return unique_ptr<FairMQMessage>(new FairMQMessageSHM(fSegmentId));
 }
 
 FairMQMessagePtr FairMQTransportFactorySHM::CreateMessage(const size_t size) const
 {
-    return unique_ptr<FairMQMessage>(new FairMQMessageSHM(size));
+    return unique_ptr<FairMQMessage>(new FairMQMessageSHM(size, fSegmentId));
 }
 
 FairMQMessagePtr FairMQTransportFactorySHM::CreateMessage(void* data, const size_t size, fairmq_free_fn* ffn, void* hint) const
 {
-    return unique_ptr<FairMQMessage>(new FairMQMessageSHM(data, size, ffn, hint));
+    return unique_ptr<FairMQMessage>(new FairMQMessageSHM(data, size, ffn, hint, fSegmentId));
 }
 
 FairMQMessagePtr FairMQTransportFactorySHM::CreateMessage(FairMQUnmanagedRegionPtr& region, void* data, const size_t size) const
@@ -238,6 +338,12 @@ FairMQUnmanagedRegionPtr FairMQTransportFactorySHM::CreateUnmanagedRegion(const
 
 FairMQTransportFactorySHM::~FairMQTransportFactorySHM()
 {
+    if (fParent)
+    {
+        // segment transport, context and segments belong to the parent
+        return;
+    }
+
     fSendHeartbeats = false;
     fHeartbeatThread.join();
 
@@ -261,21 +367,9 @@ FairMQTransportFactorySHM::~FairMQTransportFactorySHM()
         LOG(ERROR) << "shmem: Terminate(): context not available for shutdown";
     }
 
-    { // mutex scope
-        bipc::scoped_lock<bipc::named_mutex> lock(fShMutex);
-
-        (fDeviceCounter->fCount)--;
-
-        if (fDeviceCounter->fCount == 0)
-        {
-            LOG(DEBUG) << "shmem: last 'fairmq_shmem_main' user, removing segment.";
-
-            Manager::Instance().Remove();
-        }
-        else
-        {
-            LOG(DEBUG) << "shmem: other 'fairmq_shmem_main' users present (" << fDeviceCounter->fCount << "), not removing it.";
-        }
+    for (const auto& segment : fSegments)
+    {
+        Manager::Instance().DetachSegment(segment.second);
     }
 }
 
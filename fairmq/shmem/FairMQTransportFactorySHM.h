@@ -21,8 +21,9 @@
 #include <string>
 #include <thread>
 #include <atomic>
-
-#include <boost/interprocess/sync/named_mutex.hpp>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
 
 class FairMQTransportFactorySHM : public FairMQTransportFactory
 {
@@ -47,19 +48,40 @@ class FairMQTransportFactorySHM : public FairMQTransportFactory
 
     FairMQ::Transport GetType() const override;
 
+    /// @return id of the segment the messages of this transport are allocated in
+    uint16_t GetSegmentId() const { return fSegmentId; }
+
+    /// Returns a transport that shares the sockets context of the given shmem transport,
+    /// but allocates its messages in the named segment (channel option 'shmSegment').
+    /// Segments not declared with --shm-segments are created with the size of the main segment.
+    /// @param factory shmem transport (the device transport)
+    /// @param segmentName name of the segment
+    static auto CreateSegmentTransport(std::shared_ptr<FairMQTransportFactory> factory, const std::string& segmentName) -> std::shared_ptr<FairMQTransportFactory>;
+
     ~FairMQTransportFactorySHM() override;
 
   private:
+    FairMQTransportFactorySHM(std::shared_ptr<FairMQTransportFactorySHM> parent, const uint16_t segmentId);
+
     void SendHeartbeats();
     void StartMonitor();
+    uint16_t AttachSegment(const std::string& name, const size_t size, const int numaNode);
 
     static FairMQ::Transport fTransportType;
     void* fContext;
     void* fHeartbeatSocket;
     std::thread fHeartbeatThread;
     std::atomic<bool> fSendHeartbeats;
-    boost::interprocess::named_mutex fShMutex;
-    fair::mq::shmem::DeviceCounter* fDeviceCounter;
+
+    std::shared_ptr<FairMQTransportFactorySHM> fParent; // set for segment transports, which only borrow the context
+    uint16_t fSegmentId; // segment for the messages created by this transport
+    size_t fSegmentSize;
+    int fSegmentNumaNode;
+    bool fHugePages;
+    bool fPrefault;
+    bool fLock;
+    std::mutex fSegmentsMutex;
+    std::unordered_map<std::string, uint16_t> fSegments; // segments attached by this transport, by name
 };
 
 #endif /* FAIRMQTRANSPORTFACTORYSHM_H_ */
@@ -17,6 +17,16 @@ namespace bipc = boost::interprocess;
 
 atomic<bool> FairMQUnmanagedRegionSHM::fInterrupted(false);
 unordered_map<uint64_t, RemoteRegion> FairMQUnmanagedRegionSHM::fRemoteRegionMap;
+string FairMQUnmanagedRegionSHM::fHugePagesPath;
+bool FairMQUnmanagedRegionSHM::fPrefault = false;
+bool FairMQUnmanagedRegionSHM::fLock = false;
+
+void FairMQUnmanagedRegionSHM::ConfigureMemory(const string& hugePagesPath, const bool prefault, const bool lock)
+{
+    fHugePagesPath = hugePagesPath;
+    fPrefault = prefault;
+    fLock = lock;
+}
 
 FairMQUnmanagedRegionSHM::FairMQUnmanagedRegionSHM(const size_t size)
     : fRegion(nullptr)
@@ -54,10 +64,15 @@ FairMQUnmanagedRegionSHM::FairMQUnmanagedRegionSHM(const size_t size)
 
             LOG(DEBUG) << "creating region with id " << fRegionId;
 
-            auto r = fRemoteRegionMap.emplace(fRegionId, RemoteRegion{regionIdStr, size});
+            auto r = fRemoteRegionMap.emplace(fRegionId, RemoteRegion{regionIdStr, size, fHugePagesPath, fPrefault});
             fRegion = &(r.first->second.fRegion);
 
-            LOG(DEBUG) << "created region with id " << fRegionId;
+            if (fLock)
+            {
+                fair::mq::tools::lockMemory(fRegion->get_address(), fRegion->get_size());
+            }
+
+            LOG(DEBUG) << "created region with id " << fRegionId << (fHugePagesPath.empty() ? "" : " on huge pages in " + fHugePagesPath);
         }
     }
     catch (bipc::interprocess_exception& e)
@@ -66,6 +81,11 @@ FairMQUnmanagedRegionSHM::FairMQUnmanagedRegionSHM(const size_t size)
         LOG(ERROR) << e.what();
         exit(EXIT_FAILURE);
     }
+    catch (runtime_error& e)
+    {
+        LOG(ERROR) << "shmem: cannot create region: " << e.what();
+        exit(EXIT_FAILURE);
+    }
 }
 
 void* FairMQUnmanagedRegionSHM::GetData() const
@@ -89,7 +109,7 @@ bipc::mapped_region* FairMQUnmanagedRegionSHM::GetRemoteRegion(uint64_t regionId
     {
         string regionIdStr = "fairmq_shmem_region_" + to_string(regionId);
 
-        auto r = fRemoteRegionMap.emplace(regionId, RemoteRegion{regionIdStr, 0});
+        auto r = fRemoteRegionMap.emplace(regionId, RemoteRegion{regionIdStr, 0, fHugePagesPath, fPrefault});
         return &(r.first->second.fRegion);
     }
 }
@@ -13,25 +13,80 @@
 #include "FairMQLogger.h"
 
 #include <boost/interprocess/shared_memory_object.hpp>
+#include <boost/interprocess/file_mapping.hpp>
 #include <boost/interprocess/mapped_region.hpp>
 
+#include <cerrno>
 #include <cstddef> // size_t
+#include <cstring>
+#include <stdexcept>
 #include <atomic>
 #include <memory>
 #include <string>
 #include <unordered_map>
 
+#include <fcntl.h> // open
+#include <sys/mman.h> // MAP_POPULATE
+#include <sys/statvfs.h> // fstatvfs
+#include <unistd.h> // ftruncate, close
+
 struct RemoteRegion // todo: better name?
 {
-    RemoteRegion(std::string regionIdStr, uint64_t size)
+    /// @param regionIdStr name of the region
+    /// @param size size of the region, 0 to open an existing region
+    /// @param hugePagesPath hugetlbfs mount point to allocate the region from, empty for regular shared memory
+    /// @param prefault fault in all pages of the region when mapping it
+    RemoteRegion(std::string regionIdStr, uint64_t size, const std::string& hugePagesPath = "", bool prefault = false)
         : fRegionName(regionIdStr)
-        , fShmemObject(boost::interprocess::open_or_create, regionIdStr.c_str(), boost::interprocess::read_write)
+        , fFilePath(hugePagesPath.empty() ? "" : hugePagesPath + "/" + regionIdStr)
+        , fShmemObject()
+        , fFileMapping()
+        , fRegion()
     {
-        if (size > 0)
+#ifdef MAP_POPULATE
+        boost::interprocess::map_options_t mapOptions = prefault ? MAP_POPULATE : boost::interprocess::default_map_options;
+#else
+        boost::interprocess::map_options_t mapOptions = boost::interprocess::default_map_options;
+        (void)prefault;
+#endif
+
+        if (fFilePath.empty())
+        {
+            fShmemObject = boost::interprocess::shared_memory_object(boost::interprocess::open_or_create, regionIdStr.c_str(), boost::interprocess::read_write);
+            if (size > 0)
+            {
+                fShmemObject.truncate(size);
+            }
+            fRegion = boost::interprocess::mapped_region(fShmemObject, boost::interprocess::read_write, 0, 0, nullptr, mapOptions);
+        }
+        else
         {
-            fShmemObject.truncate(size);
+            // files on hugetlbfs are backed by (pre-reserved) huge pages, size has to be a multiple of the huge page size
+            int fd = ::open(fFilePath.c_str(), O_CREAT | O_RDWR, 0666);
+            if (fd < 0)
+            {
+                throw std::runtime_error("cannot open/create huge page file " + fFilePath + ": " + strerror(errno));
+            }
+            if (size > 0)
+            {
+                // hugetlbfs only accepts sizes that are a multiple of the huge page size (reported as the block size)
+                struct statvfs fsInfo;
+                if (::fstatvfs(fd, &fsInfo) == 0 && fsInfo.f_bsize > 0)
+                {
+                    size = ((size + fsInfo.f_bsize - 1) / fsInfo.f_bsize) * fsInfo.f_bsize;
+                }
+            }
+            if (size > 0 && ::ftruncate(fd, size) != 0)
+            {
+                std::string error(strerror(errno));
+                ::close(fd);
+                throw std::runtime_error("cannot resize huge page file " + fFilePath + " to " + std::to_string(size) + " bytes: " + error);
+            }
+            ::close(fd);
+
+            fFileMapping = boost::interprocess::file_mapping(fFilePath.c_str(), boost::interprocess::read_write);
+            fRegion = boost::interprocess::mapped_region(fFileMapping, boost::interprocess::read_write, 0, 0, nullptr, mapOptions);
         }
-        fRegion = boost::interprocess::mapped_region(fShmemObject, boost::interprocess::read_write); // TODO: add HUGEPAGES flag here
     }
 
     RemoteRegion() = delete;
@@ -41,14 +96,26 @@ struct RemoteRegion // todo: better name?
 
     ~RemoteRegion()
     {
-        if (boost::interprocess::shared_memory_object::remove(fRegionName.c_str()))
+        if (fFilePath.empty())
         {
-            LOG(DEBUG) << "destroyed region " << fRegionName;
+            if (boost::interprocess::shared_memory_object::remove(fRegionName.c_str()))
+            {
+                LOG(DEBUG) << "destroyed region " << fRegionName;
+            }
+        }
+        else if (!fRegionName.empty())
+        {
+            if (boost::interprocess::file_mapping::remove(fFilePath.c_str()))
+            {
+                LOG(DEBUG) << "destroyed region " << fRegionName << " (" << fFilePath << ")";
+            }
         }
     }
 
     std::string fRegionName;
+    std::string fFilePath;
     boost::interprocess::shared_memory_object fShmemObject;
+    boost::interprocess::file_mapping fFileMapping;
     boost::interprocess::mapped_region fRegion;
 };
 
@@ -65,6 +132,12 @@ class FairMQUnmanagedRegionSHM : public FairMQUnmanagedRegion
 
     static boost::interprocess::mapped_region* GetRemoteRegion(uint64_t regionId);
 
+    /// Configures the backing of regions created/opened by this process (set by the transport factory)
+    /// @param hugePagesPath hugetlbfs mount point to allocate regions from, empty for regular shared memory
+    /// @param prefault fault in all pages of a region when mapping it
+    /// @param lock lock the pages of created regions in memory
+    static void ConfigureMemory(const std::string& hugePagesPath, const bool prefault, const bool lock);
+
     virtual ~FairMQUnmanagedRegionSHM();
 
   private:
@@ -74,6 +147,9 @@ class FairMQUnmanagedRegionSHM : public FairMQUnmanagedRegion
     std::string fRegionIdStr;
     bool fRemote;
     static std::unordered_map<uint64_t, RemoteRegion> fRemoteRegionMap;
+    static std::string fHugePagesPath;
+    static bool fPrefault;
+    static bool fLock;
 };
 
 #endif /* FAIRMQUNMANAGEDREGIONSHM_H_ */
\ No newline at end of file
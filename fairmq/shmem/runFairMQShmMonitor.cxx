@@ -24,6 +24,7 @@ int main(int argc, char** argv)
         bool selfDestruct = false;
         bool interactive = false;
         unsigned int timeoutInMS;
+        string hugePagesPath;
 
         options_description desc("Options");
         desc.add_options()
@@ -32,6 +33,7 @@ int main(int argc, char** argv)
             ("self-destruct", value<bool>(&selfDestruct)->implicit_value(true), "Quit after first closing of the memory")
             ("interactive", value<bool>(&interactive)->implicit_value(true), "Interactive run")
             ("timeout", value<unsigned int>(&timeoutInMS)->default_value(5000), "Heartbeat timeout in milliseconds")
+            ("hugepages-path", value<string>(&hugePagesPath)->default_value(""), "hugetlbfs mount point of unmanaged regions (as given to the devices via --shm-hugepages-path)")
             ("help", "Print help");
 
         variables_map vm;
@@ -48,14 +50,14 @@ int main(int argc, char** argv)
         if (cleanup)
         {
             cout << "Cleaning up \"" << segmentName << "\"..." << endl;
-            fair::mq::shmem::Monitor::Cleanup(segmentName);
+            fair::mq::shmem::Monitor::Cleanup(segmentName, hugePagesPath);
             fair::mq::shmem::Monitor::CleanupControlQueues();
             return 0;
         }
 
         cout << "Starting monitor for shared memory segment: \"" << segmentName << "\"..." << endl;
 
-        fair::mq::shmem::Monitor monitor{segmentName, selfDestruct, interactive, timeoutInMS};
+        fair::mq::shmem::Monitor monitor{segmentName, selfDestruct, interactive, timeoutInMS, hugePagesPath};
 
         monitor.CatchSignals();
         monitor.Run();
@@ -8,8 +8,15 @@
 
 #include "runner.h"
 #include <gtest/gtest.h>
+#include <FairMQChannel.h>
+#include <FairMQPoller.h>
+#include <FairMQTransportFactory.h>
+#include <chrono>
 #include <sstream> // std::stringstream
+#include <string>
 #include <thread>
+#include <unordered_map>
+#include <vector>
 
 namespace
 {
@@ -46,6 +53,75 @@ auto RunPoller(string transport, int pollType) -> void
     exit(pollout.exit_code + pollin.exit_code);
 }
 
+// the inproc transport only connects sockets of the same process, so its devices are channels in threads here
+auto RunPollerInproc(int pollType) -> void
+{
+    auto factory = FairMQTransportFactory::CreateTransportFactory("inproc");
+    unordered_map<string, vector<FairMQChannel>> channels;
+    channels["data1"].emplace_back("data1", "pull", factory);
+    channels["data2"].emplace_back("data2", "pull", factory);
+    ASSERT_TRUE(channels.at("data1").at(0).Bind("inproc://poll1"));
+    ASSERT_TRUE(channels.at("data2").at(0).Bind("inproc://poll2"));
+    auto push1 = FairMQChannel{"Push1", "push", factory};
+    push1.Connect("inproc://poll1");
+    auto push2 = FairMQChannel{"Push2", "push", factory};
+    push2.Connect("inproc://poll2");
+
+    ASSERT_TRUE(channels.at("data1").at(0).ValidateChannel());
+    ASSERT_TRUE(channels.at("data2").at(0).ValidateChannel());
+    ASSERT_TRUE(push1.ValidateChannel());
+    ASSERT_TRUE(push2.ValidateChannel());
+
+    FairMQPollerPtr poller;
+    if (pollType == 0)
+    {
+        poller = factory->CreatePoller(channels, {"data1", "data2"});
+    }
+    else
+    {
+        poller = factory->CreatePoller(vector<const FairMQChannel*>{&channels.at("data1").at(0), &channels.at("data2").at(0)});
+    }
+    auto checkInput = [&](const string& channel) {
+        return (pollType == 0) ? poller->CheckInput(channel, 0) : poller->CheckInput(channel == "data1" ? 0 : 1);
+    };
+
+    // nothing sent yet, the poll has to time out
+    poller->Poll(10);
+    ASSERT_FALSE(checkInput("data1"));
+    ASSERT_FALSE(checkInput("data2"));
+
+    // a message sent while polling has to wake the poller up, only on its own channel
+    auto sender = thread{[&push2]() {
+        this_thread::sleep_for(chrono::milliseconds(50));
+        auto msg = push2.NewSimpleMessage("2");
+        ASSERT_GE(push2.Send(msg), 0);
+    }};
+    poller->Poll(5000);
+    sender.join();
+    ASSERT_FALSE(checkInput("data1"));
+    ASSERT_TRUE(checkInput("data2"));
+
+    auto msg = FairMQMessagePtr{factory->CreateMessage()};
+    ASSERT_GE(channels.at("data2").at(0).Receive(msg), 0);
+    ASSERT_EQ(string(static_cast<char*>(msg->GetData()), msg->GetSize()), "2");
+
+    auto msg1 = push1.NewSimpleMessage("1");
+    ASSERT_GE(push1.Send(msg1), 0);
+    poller->Poll(100);
+    ASSERT_TRUE(checkInput("data1"));
+    ASSERT_FALSE(checkInput("data2"));
+}
+
+TEST(Poller, Inproc_subchannel)
+{
+    RunPollerInproc(0);
+}
+
+TEST(Poller, Inproc_channel)
+{
+    RunPollerInproc(1);
+}
+
 TEST(Poller, ZeroMQ_subchannel)
 {
     EXPECT_EXIT(RunPoller("zeromq", 0), ::testing::ExitedWithCode(0), "POLL test successfull");
@@ -8,7 +8,10 @@
 
 #include "runner.h"
 #include <gtest/gtest.h>
+#include <FairMQChannel.h>
+#include <FairMQTransportFactory.h>
 #include <sstream> // std::stringstream
+#include <string>
 #include <thread>
 
 namespace
@@ -51,6 +54,49 @@ auto RunPubSub(string transport) -> void
     exit(pub.exit_code + sub1.exit_code + sub2.exit_code);
 }
 
+// the inproc transport only connects sockets of the same process, so its devices are channels in threads here
+auto RunPubSubInproc() -> void
+{
+    auto factory = FairMQTransportFactory::CreateTransportFactory("inproc");
+    auto pub = FairMQChannel{"Pub", "pub", factory};
+    ASSERT_TRUE(pub.Bind("inproc://pubsub"));
+    auto sub1 = FairMQChannel{"Sub1", "sub", factory};
+    sub1.Connect("inproc://pubsub");
+    auto sub2 = FairMQChannel{"Sub2", "sub", factory};
+    sub2.Connect("inproc://pubsub");
+
+    ASSERT_TRUE(pub.ValidateChannel());
+    ASSERT_TRUE(sub1.ValidateChannel());
+    ASSERT_TRUE(sub2.ValidateChannel());
+
+    auto receive = [](FairMQChannel& sub) {
+        for (int i = 0; i < 3; ++i)
+        {
+            auto msg = FairMQMessagePtr{sub.Transport()->CreateMessage()};
+            ASSERT_GE(sub.Receive(msg), 0);
+            ASSERT_EQ(string(static_cast<char*>(msg->GetData()), msg->GetSize()), to_string(i));
+        }
+    };
+
+    // subscribers are registered on connect, so nothing published from now on is lost
+    auto sub1Thread = thread{receive, ref(sub1)};
+    auto sub2Thread = thread{receive, ref(sub2)};
+
+    for (int i = 0; i < 3; ++i)
+    {
+        auto msg = pub.NewSimpleMessage(to_string(i));
+        ASSERT_GE(pub.Send(msg), 0);
+    }
+
+    sub1Thread.join();
+    sub2Thread.join();
+}
+
+TEST(PubSub, Inproc)
+{
+    RunPubSubInproc();
+}
+
 TEST(PubSub, ZeroMQ)
 {
     EXPECT_EXIT(RunPubSub("zeromq"), ::testing::ExitedWithCode(0), "PUB-SUB test successfull");
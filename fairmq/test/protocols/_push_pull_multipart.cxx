@@ -11,7 +11,10 @@
 #include <FairMQParts.h>
 #include <FairMQLogger.h>
 #include <FairMQTransportFactory.h>
+#include <shmem/FairMQTransportFactorySHM.h>
+#include <shmem/FairMQShmManager.h>
 #include <algorithm>
+#include <cstring> // memcpy
 #include <memory>
 #include <sstream>
 #include <string>
@@ -89,6 +92,52 @@ auto RunMultiThreadedMultipart(string transport, string address) -> void
     puller.join();
 }
 
+auto RunSegmentMultipart(string address) -> void
+{
+    auto factory = FairMQTransportFactory::CreateTransportFactory("shmem");
+    // the sender allocates in its own segment, the receiver finds it via the segment id of the messages
+    auto segmentFactory = FairMQTransportFactorySHM::CreateSegmentTransport(factory, "fairmq_test_segment");
+    auto segmentId = static_pointer_cast<FairMQTransportFactorySHM>(segmentFactory)->GetSegmentId();
+    auto mainSegmentId = static_pointer_cast<FairMQTransportFactorySHM>(factory)->GetSegmentId();
+    ASSERT_NE(segmentId, mainSegmentId);
+    auto& manager = fair::mq::shmem::Manager::Instance();
+    auto push = FairMQChannel{"Push", "push", segmentFactory};
+    ASSERT_TRUE(push.Bind(address));
+    auto pull = FairMQChannel{"Pull", "pull", factory};
+    pull.Connect(address);
+
+    ASSERT_TRUE(push.ValidateChannel());
+    ASSERT_TRUE(pull.ValidateChannel());
+
+    {
+        auto sentMsg = FairMQParts{};
+        sentMsg.AddPart(push.NewSimpleMessage("1"));
+        sentMsg.AddPart(factory->NewSimpleMessage("2"));
+        // empty messages get their chunk on Rebuild(), in the segment of the transport that created them
+        auto third = push.NewMessage();
+        third->Rebuild(1);
+        memcpy(third->GetData(), "3", 1);
+        sentMsg.AddPart(move(third));
+
+        ASSERT_TRUE(manager.Segment(segmentId)->belongs_to_segment(sentMsg.At(0)->GetData()));
+        ASSERT_TRUE(manager.Segment(mainSegmentId)->belongs_to_segment(sentMsg.At(1)->GetData()));
+        ASSERT_TRUE(manager.Segment(segmentId)->belongs_to_segment(sentMsg.At(2)->GetData()));
+
+        ASSERT_GE(push.Send(sentMsg), 0);
+    }
+
+    auto receivedMsg = FairMQParts{};
+    ASSERT_GE(pull.Receive(receivedMsg), 0);
+
+    stringstream out;
+    for_each(receivedMsg.cbegin(), receivedMsg.cend(), [&out](const FairMQMessagePtr& part) {
+        out << string{static_cast<char*>(part->GetData()), part->GetSize()};
+    });
+    ASSERT_EQ(out.str(), "123");
+    ASSERT_TRUE(manager.Segment(segmentId)->belongs_to_segment(receivedMsg.At(0)->GetData()));
+    ASSERT_TRUE(manager.Segment(mainSegmentId)->belongs_to_segment(receivedMsg.At(1)->GetData()));
+}
+
 TEST(PushPull, ST_ZeroMQ__inproc_Multipart)
 {
     RunSingleThreadedMultipart("zeromq", "inproc://test");
@@ -99,6 +148,11 @@ TEST(PushPull, ST_Shmem___inproc_Multipart)
     RunSingleThreadedMultipart("shmem", "inproc://test");
 }
 
+TEST(PushPull, ST_Inproc__inproc_Multipart)
+{
+    RunSingleThreadedMultipart("inproc", "inproc://test");
+}
+
 #ifdef NANOMSG_FOUND
 TEST(PushPull, ST_Nanomsg_inproc_Multipart)
 {
@@ -116,6 +170,11 @@ TEST(PushPull, ST_Shmen___ipc____Multipart)
     RunSingleThreadedMultipart("shmem", "ipc://test");
 }
 
+TEST(PushPull, ST_Inproc__ipc____Multipart)
+{
+    RunSingleThreadedMultipart("inproc", "ipc://test");
+}
+
 #ifdef NANOMSG_FOUND
 TEST(PushPull, ST_Nanomsg_ipc____Multipart)
 {
@@ -123,6 +182,11 @@ TEST(PushPull, ST_Nanomsg_ipc____Multipart)
 }
 #endif /* NANOMSG_FOUND */
 
+TEST(PushPull, ST_Shmem___segment_Multipart)
+{
+    RunSegmentMultipart("ipc://test_segment");
+}
+
 TEST(PushPull, MT_ZeroMQ__inproc_Multipart)
 {
     RunMultiThreadedMultipart("zeromq", "inproc://test");
@@ -133,6 +197,11 @@ TEST(PushPull, MT_Shmem___inproc_Multipart)
     RunMultiThreadedMultipart("shmem", "inproc://test");
 }
 
+TEST(PushPull, MT_Inproc__inproc_Multipart)
+{
+    RunMultiThreadedMultipart("inproc", "inproc://test");
+}
+
 #ifdef NANOMSG_FOUND
 TEST(PushPull, MT_Nanomsg_inproc_Multipart)
 {
@@ -150,6 +219,11 @@ TEST(PushPull, MT_Shmem___ipc____Multipart)
     RunMultiThreadedMultipart("shmem", "ipc://test");
 }
 
+TEST(PushPull, MT_Inproc__ipc____Multipart)
+{
+    RunMultiThreadedMultipart("inproc", "ipc://test");
+}
+
 #ifdef NANOMSG_FOUND
 TEST(PushPull, MT_Nanomsg_ipc____Multipart)
 {
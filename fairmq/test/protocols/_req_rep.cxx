@@ -8,7 +8,10 @@
 
 #include "runner.h"
 #include <gtest/gtest.h>
+#include <FairMQChannel.h>
+#include <FairMQTransportFactory.h>
 #include <sstream> // std::stringstream
+#include <string>
 #include <thread>
 
 namespace
@@ -51,6 +54,54 @@ auto RunReqRep(string transport) -> void
     exit(req1.exit_code + req2.exit_code + rep.exit_code);
 }
 
+// the inproc transport only connects sockets of the same process, so its devices are channels in threads here
+auto RunReqRepInproc() -> void
+{
+    auto factory = FairMQTransportFactory::CreateTransportFactory("inproc");
+    auto rep = FairMQChannel{"Rep", "rep", factory};
+    ASSERT_TRUE(rep.Bind("inproc://reqrep"));
+    auto req1 = FairMQChannel{"Req1", "req", factory};
+    req1.Connect("inproc://reqrep");
+    auto req2 = FairMQChannel{"Req2", "req", factory};
+    req2.Connect("inproc://reqrep");
+
+    ASSERT_TRUE(rep.ValidateChannel());
+    ASSERT_TRUE(req1.ValidateChannel());
+    ASSERT_TRUE(req2.ValidateChannel());
+
+    // every requester has to get the answer to its own request
+    auto request = [](FairMQChannel& req, const string& name) {
+        for (int i = 0; i < 10; ++i)
+        {
+            const string text = name + "_" + to_string(i);
+            auto request = req.NewSimpleMessage(text);
+            ASSERT_GE(req.Send(request), 0);
+            auto reply = FairMQMessagePtr{req.Transport()->CreateMessage()};
+            ASSERT_GE(req.Receive(reply), 0);
+            ASSERT_EQ(string(static_cast<char*>(reply->GetData()), reply->GetSize()), "reply to " + text);
+        }
+    };
+
+    auto req1Thread = thread{request, ref(req1), "req1"};
+    auto req2Thread = thread{request, ref(req2), "req2"};
+
+    for (int i = 0; i < 20; ++i)
+    {
+        auto request = FairMQMessagePtr{rep.Transport()->CreateMessage()};
+        ASSERT_GE(rep.Receive(request), 0);
+        auto reply = rep.NewSimpleMessage("reply to " + string(static_cast<char*>(request->GetData()), request->GetSize()));
+        ASSERT_GE(rep.Send(reply), 0);
+    }
+
+    req1Thread.join();
+    req2Thread.join();
+}
+
+TEST(ReqRep, Inproc)
+{
+    RunReqRepInproc();
+}
+
 TEST(ReqRep, ZeroMQ)
 {
     EXPECT_EXIT(RunReqRep("zeromq"), ::testing::ExitedWithCode(0), "REQ-REP test successfull");
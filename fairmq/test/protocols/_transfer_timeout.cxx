@@ -8,6 +8,8 @@
 
 #include "runner.h"
 #include <gtest/gtest.h>
+#include <FairMQSocket.h>
+#include <FairMQTransportFactory.h>
 #include <sstream> // std::stringstream
 
 namespace
@@ -28,6 +30,36 @@ auto RunTransferTimeout(string transport) -> void
     exit(res.exit_code);
 }
 
+// the inproc transport only connects sockets of the same process, so the sockets are created here directly
+auto RunTransferTimeoutInproc() -> void
+{
+    auto factory = FairMQTransportFactory::CreateTransportFactory("inproc");
+
+    // a push with a full queue and no receiver
+    auto push = factory->CreateSocket("push", "data-out");
+    int hwm = 1;
+    push->SetOption("snd-hwm", &hwm, sizeof(hwm));
+    ASSERT_TRUE(push->Bind("inproc://timeout-out"));
+    ASSERT_TRUE(push->SetSendTimeout(100, "inproc://timeout-out", "bind"));
+    auto msg1 = FairMQMessagePtr{factory->CreateMessage()};
+    auto msg2 = FairMQMessagePtr{factory->CreateMessage()};
+    auto msg3 = FairMQMessagePtr{factory->CreateMessage()};
+    ASSERT_GE(push->Send(msg1), 0);
+    ASSERT_GE(push->Send(msg2), 0);
+    ASSERT_EQ(push->Send(msg3), -2);
+
+    auto pull = factory->CreateSocket("pull", "data-in");
+    ASSERT_TRUE(pull->Bind("inproc://timeout-in"));
+    ASSERT_TRUE(pull->SetReceiveTimeout(100, "inproc://timeout-in", "bind"));
+    auto msg4 = FairMQMessagePtr{factory->CreateMessage()};
+    ASSERT_EQ(pull->Receive(msg4), -2);
+}
+
+TEST(TransferTimeout, Inproc)
+{
+    RunTransferTimeoutInproc();
+}
+
 TEST(TransferTimeout, ZeroMQ)
 {
     EXPECT_EXIT(RunTransferTimeout("zeromq"), ::testing::ExitedWithCode(0), "Transfer timeout test successfull");
@@ -0,0 +1,245 @@
+/********************************************************************************
+ *    Copyright (C) 2017 GSI Helmholtzzentrum fuer Schwerionenforschung GmbH    *
+ *                                                                              *
+ *              This software is distributed under the terms of the             *
+ *              GNU Lesser General Public Licence (LGPL) version 3,             *
+ *                  copied verbatim in the file "LICENSE"                       *
+ ********************************************************************************/
+
+#ifndef FAIR_MQ_TOOLS_AFFINITY_H
+#define FAIR_MQ_TOOLS_AFFINITY_H
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE // To get CPU_SET & co. and pthread_setaffinity_np
+#endif
+
+#include "FairMQLogger.h"
+
+#include <boost/algorithm/string.hpp> // split, trim
+
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/mempolicy.h>
+#endif
+
+namespace fair
+{
+namespace mq
+{
+namespace tools
+{
+
+/// @brief parses a CPU list in the kernel cpulist format (e.g. "0-3,8,10-11")
+/// @param list CPU list string
+/// @return sorted list of CPU ids, empty if the list is empty or malformed
+inline std::vector<int> parseCpuList(const std::string& list)
+{
+    std::vector<int> cpus;
+    std::vector<std::string> ranges;
+    std::string trimmed = boost::algorithm::trim_copy(list);
+
+    if (trimmed.empty())
+    {
+        return cpus;
+    }
+
+    boost::algorithm::split(ranges, trimmed, boost::algorithm::is_any_of(","));
+    for (auto& range : ranges)
+    {
+        boost::algorithm::trim(range);
+        if (range.empty())
+        {
+            continue;
+        }
+
+        try
+        {
+            size_t dash = range.find('-');
+            int first = std::stoi(range.substr(0, dash));
+            int last = (dash == std::string::npos) ? first : std::stoi(range.substr(dash + 1));
+            if (first < 0 || last < first)
+            {
+                LOG(ERROR) << "Invalid CPU range '" << range << "' in CPU list '" << list << "'";
+                return std::vector<int>();
+            }
+            for (int cpu = first; cpu <= last; ++cpu)
+            {
+                cpus.push_back(cpu);
+            }
+        }
+        catch (std::exception& e)
+        {
+            LOG(ERROR) << "Invalid CPU list '" << list << "': " << e.what();
+            return std::vector<int>();
+        }
+    }
+
+    std::sort(cpus.begin(), cpus.end());
+    cpus.erase(std::unique(cpus.begin(), cpus.end()), cpus.end());
+
+    return cpus;
+}
+
+/// @brief formats a list of CPU ids in the compact kernel cpulist format
+inline std::string cpuListToString(const std::vector<int>& cpus)
+{
+    std::stringstream ss;
+
+    for (size_t i = 0; i < cpus.size(); ++i)
+    {
+        size_t j = i;
+        while (j + 1 < cpus.size() && cpus.at(j + 1) == cpus.at(j) + 1)
+        {
+            ++j;
+        }
+
+        if (i != 0)
+        {
+            ss << ",";
+        }
+        ss << cpus.at(i);
+        if (j != i)
+        {
+            ss << "-" << cpus.at(j);
+        }
+        i = j;
+    }
+
+    return ss.str();
+}
+
+/// @brief CPUs belonging to the given NUMA node, as reported by sysfs
+/// @return list of CPU ids, empty if the node does not exist
+inline std::vector<int> getNumaNodeCpus(const int node)
+{
+    std::ifstream file("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+    std::string list;
+
+    if (!file || !std::getline(file, list))
+    {
+        return std::vector<int>();
+    }
+
+    return parseCpuList(list);
+}
+
+/// @brief number of NUMA nodes known to the system (1 if NUMA information is not available)
+inline int getNumNumaNodes()
+{
+    int numNodes = 0;
+    while (std::ifstream("/sys/devices/system/node/node" + std::to_string(numNodes) + "/cpulist"))
+    {
+        ++numNodes;
+    }
+
+    return numNodes > 0 ? numNodes : 1;
+}
+
+/// @brief restricts the calling thread to the given CPUs
+/// @return true on success
+inline bool setThreadAffinity(const std::vector<int>& cpus)
+{
+#ifdef __linux__
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (const auto cpu : cpus)
+    {
+        if (cpu >= CPU_SETSIZE)
+        {
+            LOG(ERROR) << "CPU id " << cpu << " exceeds the supported maximum of " << CPU_SETSIZE - 1;
+            return false;
+        }
+        CPU_SET(cpu, &set);
+    }
+
+    int rc = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+    if (rc != 0)
+    {
+        LOG(ERROR) << "Failed setting thread affinity to CPUs " << cpuListToString(cpus) << ", reason: " << strerror(rc);
+        return false;
+    }
+
+    return true;
+#else
+    LOG(WARN) << "Setting thread affinity is not supported on this platform";
+    return false;
+#endif
+}
+
+/// @brief CPUs the calling thread is allowed to run on
+inline std::vector<int> getThreadAffinity()
+{
+    std::vector<int> cpus;
+
+#ifdef __linux__
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (pthread_getaffinity_np(pthread_self(), sizeof(set), &set) == 0)
+    {
+        for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu)
+        {
+            if (CPU_ISSET(cpu, &set))
+            {
+                cpus.push_back(cpu);
+            }
+        }
+    }
+#endif
+
+    return cpus;
+}
+
+/// @brief binds the pages of the given (shared) mapping to a NUMA node (via mbind)
+/// @details Pages that are already resident are migrated, pages touched later are allocated on the node.
+/// For shared memory the policy is stored with the shared object, so it applies to all processes mapping it.
+/// @param address start of the mapping (rounded down to the page boundary)
+/// @param size size of the mapping in bytes
+/// @param node NUMA node id
+/// @return true on success
+inline bool bindMemoryToNumaNode(void* address, const size_t size, const int node)
+{
+#if defined(__linux__) && defined(SYS_mbind)
+    if (node < 0 || node >= static_cast<int>(8 * sizeof(unsigned long)))
+    {
+        LOG(ERROR) << "Invalid NUMA node for memory binding: " << node;
+        return false;
+    }
+
+    const uintptr_t pageSize = sysconf(_SC_PAGESIZE);
+    uintptr_t start = reinterpret_cast<uintptr_t>(address) & ~(pageSize - 1);
+    size_t length = size + (reinterpret_cast<uintptr_t>(address) - start);
+
+    unsigned long nodeMask = 1UL << node;
+    if (syscall(SYS_mbind, start, length, MPOL_BIND, &nodeMask, 8 * sizeof(nodeMask) + 1, MPOL_MF_MOVE) != 0)
+    {
+        LOG(ERROR) << "Failed binding memory to NUMA node " << node << ", reason: " << strerror(errno);
+        return false;
+    }
+
+    return true;
+#else
+    (void)address;
+    (void)size;
+    LOG(WARN) << "Binding memory to NUMA node " << node << " is not supported on this platform";
+    return false;
+#endif
+}
+
+} /* namespace tools */
+} /* namespace mq */
+} /* namespace fair */
+
+#endif /* FAIR_MQ_TOOLS_AFFINITY_H */
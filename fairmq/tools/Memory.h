@@ -0,0 +1,125 @@
+/********************************************************************************
+ *    Copyright (C) 2017 GSI Helmholtzzentrum fuer Schwerionenforschung GmbH    *
+ *                                                                              *
+ *              This software is distributed under the terms of the             *
+ *              GNU Lesser General Public Licence (LGPL) version 3,             *
+ *                  copied verbatim in the file "LICENSE"                       *
+ ********************************************************************************/
+
+#ifndef FAIR_MQ_TOOLS_MEMORY_H
+#define FAIR_MQ_TOOLS_MEMORY_H
+
+#include "FairMQLogger.h"
+
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__linux__) || defined(__APPLE__)
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace fair
+{
+namespace mq
+{
+namespace tools
+{
+
+/// @brief page aligned bounds of the given memory range
+inline void pageAlign(void* address, const size_t size, uintptr_t& start, size_t& length)
+{
+#if defined(__linux__) || defined(__APPLE__)
+    const uintptr_t pageSize = sysconf(_SC_PAGESIZE);
+#else
+    const uintptr_t pageSize = 4096;
+#endif
+    start = reinterpret_cast<uintptr_t>(address) & ~(pageSize - 1);
+    length = size + (reinterpret_cast<uintptr_t>(address) - start);
+}
+
+/// @brief advises the kernel to back the given mapping with transparent huge pages (madvise(MADV_HUGEPAGE))
+/// @details For shared memory this takes effect only if /sys/kernel/mm/transparent_hugepage/shmem_enabled allows it.
+/// @return true on success
+inline bool adviseHugePages(void* address, const size_t size)
+{
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+    uintptr_t start;
+    size_t length;
+    pageAlign(address, size, start, length);
+
+    if (madvise(reinterpret_cast<void*>(start), length, MADV_HUGEPAGE) != 0)
+    {
+        LOG(ERROR) << "Failed advising huge pages for " << size << " bytes, reason: " << strerror(errno);
+        return false;
+    }
+
+    return true;
+#else
+    (void)address;
+    (void)size;
+    LOG(WARN) << "Transparent huge pages are not supported on this platform";
+    return false;
+#endif
+}
+
+/// @brief faults in all pages of the given writable mapping, without modifying its content
+/// @details Uses MADV_POPULATE_WRITE where available (Linux >= 5.14), otherwise reads one byte per page.
+/// @return true on success
+inline bool prefaultMemory(void* address, const size_t size)
+{
+#if defined(__linux__) && defined(MADV_POPULATE_WRITE)
+    uintptr_t start;
+    size_t length;
+    pageAlign(address, size, start, length);
+
+    if (madvise(reinterpret_cast<void*>(start), length, MADV_POPULATE_WRITE) == 0)
+    {
+        return true;
+    }
+    LOG(DEBUG) << "MADV_POPULATE_WRITE failed (" << strerror(errno) << "), falling back to touching every page";
+#endif
+
+#if defined(__linux__) || defined(__APPLE__)
+    const size_t pageSize = sysconf(_SC_PAGESIZE);
+#else
+    const size_t pageSize = 4096;
+#endif
+    const volatile char* ptr = static_cast<const volatile char*>(address);
+    char sink = 0;
+    for (size_t offset = 0; offset < size; offset += pageSize)
+    {
+        sink ^= ptr[offset];
+    }
+    (void)sink;
+
+    return true;
+}
+
+/// @brief locks the pages of the given mapping in memory (mlock)
+/// @return true on success
+inline bool lockMemory(void* address, const size_t size)
+{
+#if defined(__linux__) || defined(__APPLE__)
+    if (mlock(address, size) != 0)
+    {
+        LOG(ERROR) << "Failed locking " << size << " bytes in memory, reason: " << strerror(errno) << ". Check RLIMIT_MEMLOCK (ulimit -l).";
+        return false;
+    }
+
+    return true;
+#else
+    (void)address;
+    (void)size;
+    LOG(WARN) << "Locking memory is not supported on this platform";
+    return false;
+#endif
+}
+
+} /* namespace tools */
+} /* namespace mq */
+} /* namespace fair */
+
+#endif /* FAIR_MQ_TOOLS_MEMORY_H */
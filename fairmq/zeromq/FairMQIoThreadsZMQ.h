@@ -0,0 +1,70 @@
+/********************************************************************************
+ *    Copyright (C) 2017 GSI Helmholtzzentrum fuer Schwerionenforschung GmbH    *
+ *                                                                              *
+ *              This software is distributed under the terms of the             *
+ *              GNU Lesser General Public Licence (LGPL) version 3,             *
+ *                  copied verbatim in the file "LICENSE"                       *
+ ********************************************************************************/
+
+#ifndef FAIR_MQ_ZEROMQ_IOTHREADS_H
+#define FAIR_MQ_ZEROMQ_IOTHREADS_H
+
+#include "FairMQLogger.h"
+#include <fairmq/tools/Affinity.h>
+
+#include <zmq.h>
+
+#include <cerrno>
+#include <string>
+#include <vector>
+
+namespace fair
+{
+namespace mq
+{
+namespace zeromq
+{
+
+/// @brief pins the I/O threads of a ZeroMQ context, shared by the zeromq and shmem transports
+/// @param context ZeroMQ context, before its first socket is created (the I/O threads are started lazily with it)
+/// @param numIoThreads number of I/O threads of the context (for logging)
+/// @param ioAffinity CPU list for the I/O threads, takes precedence over numaNode
+/// @param numaNode NUMA node whose CPUs are used if ioAffinity is empty, -1 for none
+/// @param transport name of the transport, used as log prefix
+inline void setIoThreadsAffinity(void* context, const int numIoThreads, const std::string& ioAffinity, const int numaNode, const std::string& transport)
+{
+    std::vector<int> ioCpus;
+    if (ioAffinity != "")
+    {
+        ioCpus = fair::mq::tools::parseCpuList(ioAffinity);
+    }
+    else if (numaNode >= 0)
+    {
+        ioCpus = fair::mq::tools::getNumaNodeCpus(numaNode);
+    }
+
+    if (ioCpus.empty())
+    {
+        return;
+    }
+
+#ifdef ZMQ_THREAD_AFFINITY_CPU_ADD
+    for (const auto cpu : ioCpus)
+    {
+        if (zmq_ctx_set(context, ZMQ_THREAD_AFFINITY_CPU_ADD, cpu) != 0)
+        {
+            LOG(ERROR) << transport << ": failed configuring I/O thread affinity, reason: " << zmq_strerror(errno);
+        }
+    }
+    LOG(INFO) << transport << ": " << numIoThreads << " I/O thread(s) pinned to CPUs " << fair::mq::tools::cpuListToString(ioCpus);
+#else
+    (void)context;
+    LOG(WARN) << transport << ": pinning I/O threads requires ZeroMQ >= 4.3, ignoring I/O thread affinity " << fair::mq::tools::cpuListToString(ioCpus);
+#endif
+}
+
+} // namespace zeromq
+} // namespace mq
+} // namespace fair
+
+#endif /* FAIR_MQ_ZEROMQ_IOTHREADS_H */
@@ -559,6 +559,8 @@ int FairMQSocketZMQ::GetConstant(const string& constant)
 
     if (constant == "linger")
         return ZMQ_LINGER;
+    if (constant == "affinity")
+        return ZMQ_AFFINITY;
 
     return -1;
 }
@@ -7,6 +7,8 @@
  ********************************************************************************/
 
 #include "FairMQTransportFactoryZMQ.h"
+#include "FairMQIoThreadsZMQ.h"
+
 #include <zmq.h>
 
 using namespace std;
@@ -33,9 +35,13 @@ FairMQTransportFactoryZMQ::FairMQTransportFactoryZMQ(const string& id, const Fai
     }
 
     int numIoThreads = 1;
+    string ioAffinity;
+    int numaNode = -1;
     if (config)
     {
         numIoThreads = config->GetValue<int>("io-threads");
+        ioAffinity = config->GetValue<string>("io-threads-affinity");
+        numaNode = config->GetValue<int>("numa-node");
     }
     else
     {
@@ -47,6 +53,8 @@ FairMQTransportFactoryZMQ::FairMQTransportFactoryZMQ(const string& id, const Fai
         LOG(ERROR) << "failed configuring context, reason: " << zmq_strerror(errno);
     }
 
+    // I/O threads are started lazily with the first socket, so the affinity has to be set here
+    fair::mq::zeromq::setIoThreadsAffinity(fContext, numIoThreads, ioAffinity, numaNode, "zeromq");
 }
 
 FairMQMessagePtr FairMQTransportFactoryZMQ::CreateMessage() const
@@ -0,0 +1,650 @@
+/********************************************************************************
+ *    Copyright (C) 2014 GSI Helmholtzzentrum fuer Schwerionenforschung GmbH    *
+ *                                                                              *
+ *              This software is distributed under the terms of the             *
+ *         GNU Lesser General Public Licence version 3 (LGPL) version 3,        *
+ *                  copied verbatim in the file "LICENSE"                       *
+ ********************************************************************************/
+// Propagation of track parameters and errors without GEANE
+//
+#include "FairRKErrorPropagator.h"
+
+#include "FairField.h"                  // for FairField
+#include "FairGeaneUtil.h"              // for FairGeaneUtil
+#include "FairLogger.h"                 // for FairLogger, LOG
+#include "FairRunAna.h"                 // for FairRunAna
+#include "FairTrackParH.h"              // for FairTrackParH
+#include "FairTrackParP.h"              // for FairTrackParP
+
+#include "TDatabasePDG.h"               // for TDatabasePDG
+#include "TGeoManager.h"                // for TGeoManager, gGeoManager
+#include "TGeoMaterial.h"               // for TGeoMaterial
+#include "TGeoNavigator.h"              // for TGeoNavigator
+#include "TGeoVolume.h"                 // for TGeoVolume
+#include "TMath.h"                      // for Sqrt, Log, ASin, etc
+#include "TParticlePDG.h"               // for TParticlePDG
+
+namespace {
+  const Double_t kEc = 2.99792458e-4;     // GeV/c per kG cm
+  const Double_t kMe = 0.510998928e-3;    // electron mass [GeV]
+  const Double_t kTolerance = 1e-4;       // distance to the target plane [cm]
+  const Double_t kMinStep = 1e-3;         // step to cross a boundary [cm]
+  const Int_t kMaxSteps = 100000;
+
+  inline Double_t Dot(const Double_t a[3], const Double_t b[3])
+  {
+    return a[0]*b[0] + a[1]*b[1] + a[2]*b[2];
+  }
+
+  inline void Cross(const Double_t a[3], const Double_t b[3], Double_t c[3])
+  {
+    c[0] = a[1]*b[2] - a[2]*b[1];
+    c[1] = a[2]*b[0] - a[0]*b[2];
+    c[2] = a[0]*b[1] - a[1]*b[0];
+  }
+
+  /** Unit vectors V, W of the SC system of the direction t **/
+  inline Bool_t SCAxes(const Double_t t[3], Double_t v[3], Double_t w[3])
+  {
+    Double_t cLm = TMath::Sqrt(t[0]*t[0] + t[1]*t[1]);
+    if (cLm < 1e-9) { return kFALSE; }
+    v[0] = -t[1]/cLm;
+    v[1] = t[0]/cLm;
+    v[2] = 0.;
+    w[0] = -t[2]*t[0]/cLm;
+    w[1] = -t[2]*t[1]/cLm;
+    w[2] = cLm;
+    return kTRUE;
+  }
+}
+
+// -----   Default constructor   -------------------------------------------
+FairRKErrorPropagator::FairRKErrorPropagator()
+  : TNamed("RKErrorPropagator", "Propagate Tracks"),
+    fField(FairRunAna::Instance() ? FairRunAna::Instance()->GetField() : NULL),
+    fTarget(-1),
+    fTargetLength(0.),
+    fBackward(kFALSE),
+    fOnlyParameters(kFALSE),
+    fMaxStep(10.),
+    fMaxDeflection(0.05),
+    fMaterialEffects(kTRUE),
+    fMass(0.),
+    fMatA(0.),
+    fMatZ(0.),
+    fMatDensity(0.),
+    fMatRadLen(0.),
+    fLength(0.),
+    fPrintErrors(kTRUE)
+{
+  for (Int_t i=0; i<3; i++) { fPlaneO[i] = fPlaneJ[i] = fPlaneK[i] = 0.; }
+  for (Int_t i=0; i<5; i++) for (Int_t j=0; j<5; j++) { fTrpMat[i][j] = 0.; }
+}
+
+// -----   Constructor with field   ----------------------------------------
+FairRKErrorPropagator::FairRKErrorPropagator(FairField* field)
+  : TNamed("RKErrorPropagator", "Propagate Tracks"),
+    fField(field),
+    fTarget(-1),
+    fTargetLength(0.),
+    fBackward(kFALSE),
+    fOnlyParameters(kFALSE),
+    fMaxStep(10.),
+    fMaxDeflection(0.05),
+    fMaterialEffects(kTRUE),
+    fMass(0.),
+    fMatA(0.),
+    fMatZ(0.),
+    fMatDensity(0.),
+    fMatRadLen(0.),
+    fLength(0.),
+    fPrintErrors(kTRUE)
+{
+  for (Int_t i=0; i<3; i++) { fPlaneO[i] = fPlaneJ[i] = fPlaneK[i] = 0.; }
+  for (Int_t i=0; i<5; i++) for (Int_t j=0; j<5; j++) { fTrpMat[i][j] = 0.; }
+}
+
+// -----   Destructor   ----------------------------------------------------
+FairRKErrorPropagator::~FairRKErrorPropagator() { }
+
+// -----   Targets   -------------------------------------------------------
+Bool_t FairRKErrorPropagator::PropagateToPlane(TVector3& v0, TVector3& v1, TVector3& v2)
+{
+  // plane through v0, spanned by v1 and v2, with DI = DJ x DK
+  TVector3 dj = v1.Unit();
+  TVector3 dk = (dj.Cross(v2)).Cross(dj).Unit();
+  for (Int_t i=0; i<3; i++) {
+    fPlaneO[i] = v0[i];
+    fPlaneJ[i] = dj[i];
+    fPlaneK[i] = dk[i];
+  }
+  fTarget = 1;
+  fBackward = kFALSE;
+  fOnlyParameters = kFALSE;
+  return kTRUE;
+}
+
+Bool_t FairRKErrorPropagator::PropagateToLength(Float_t length)
+{
+  fTargetLength = TMath::Abs(length);
+  fTarget = 0;
+  fBackward = length < 0;
+  fOnlyParameters = kFALSE;
+  return kTRUE;
+}
+
+Bool_t FairRKErrorPropagator::PropagateOnlyParameters()
+{
+  fOnlyParameters = kTRUE;
+  return kTRUE;
+}
+
+void FairRKErrorPropagator::GetTransportMatrix(Double_t trm[5][5])
+{
+  for (Int_t i=0; i<5; i++) for (Int_t j=0; j<5; j++) { trm[i][j] = fTrpMat[i][j]; }
+}
+
+// -----   Public propagation methods   ------------------------------------
+Bool_t FairRKErrorPropagator::Propagate(FairTrackParH* TStart, FairTrackParH* TEnd, Int_t PDG)
+{
+  Local start, end;
+  FromParH(TStart, start);
+  return Propagate(start, end, kFALSE, PDG) && ToParH(end, TEnd);
+}
+
+Bool_t FairRKErrorPropagator::Propagate(FairTrackParP* TStart, FairTrackParH* TEnd, Int_t PDG)
+{
+  Local start, end;
+  FromParP(TStart, start);
+  return Propagate(start, end, kFALSE, PDG) && ToParH(end, TEnd);
+}
+
+Bool_t FairRKErrorPropagator::Propagate(FairTrackParP* TStart, FairTrackParP* TEnd, Int_t PDG)
+{
+  Local start, end;
+  FromParP(TStart, start);
+  return Propagate(start, end, kTRUE, PDG) && ToParP(end, TEnd);
+}
+
+Bool_t FairRKErrorPropagator::Propagate(FairTrackParH* TStart, FairTrackParP* TEnd, Int_t PDG)
+{
+  Local start, end;
+  FromParH(TStart, start);
+  return Propagate(start, end, kTRUE, PDG) && ToParP(end, TEnd);
+}
+
+// -----   Conversion from and to the track parameter classes   ------------
+void FairRKErrorPropagator::FromParH(FairTrackParH* par, Local& local)
+{
+  Double_t mom[3] = { par->GetPx(), par->GetPy(), par->GetPz() };
+  Double_t p = TMath::Sqrt(Dot(mom, mom));
+  local.fSD = kFALSE;
+  local.fPos[0] = par->GetX();
+  local.fPos[1] = par->GetY();
+  local.fPos[2] = par->GetZ();
+  for (Int_t i=0; i<3; i++) { local.fDir[i] = mom[i]/p; }
+  local.fQp = par->GetQp();
+  par->GetCov(local.fCov);
+}
+
+void FairRKErrorPropagator::FromParP(FairTrackParP* par, Local& local)
+{
+  Double_t mom[3] = { par->GetPx(), par->GetPy(), par->GetPz() };
+  Double_t p = TMath::Sqrt(Dot(mom, mom));
+  local.fSD = kTRUE;
+  local.fPos[0] = par->GetX();
+  local.fPos[1] = par->GetY();
+  local.fPos[2] = par->GetZ();
+  for (Int_t i=0; i<3; i++) { local.fDir[i] = mom[i]/p; }
+  local.fQp = par->GetQp();
+  par->GetCov(local.fCov);
+  TVector3 o = par->GetOrigin();
+  TVector3 di = par->GetIVer();
+  TVector3 dj = par->GetJVer();
+  TVector3 dk = par->GetKVer();
+  for (Int_t i=0; i<3; i++) {
+    local.fO[i] = o[i];
+    local.fDI[i] = di[i];
+    local.fDJ[i] = dj[i];
+    local.fDK[i] = dk[i];
+  }
+}
+
+Bool_t FairRKErrorPropagator::ToParH(const Local& local, FairTrackParH* par)
+{
+  Double_t p = 1./TMath::Abs(local.fQp);
+  Int_t q = local.fQp < 0 ? -1 : 1;
+  Double_t cov[15];
+  for (Int_t i=0; i<15; i++) { cov[i] = local.fCov[i]; }
+  par->SetTrackPar(local.fPos[0], local.fPos[1], local.fPos[2],
+                   p*local.fDir[0], p*local.fDir[1], p*local.fDir[2], q, cov);
+  return kTRUE;
+}
+
+Bool_t FairRKErrorPropagator::ToParP(const Local& local, FairTrackParP* par)
+{
+  Double_t p = 1./TMath::Abs(local.fQp);
+  Int_t q = local.fQp < 0 ? -1 : 1;
+  Double_t cov[15];
+  for (Int_t i=0; i<15; i++) { cov[i] = local.fCov[i]; }
+  par->SetTrackPar(local.fPos[0], local.fPos[1], local.fPos[2],
+                   p*local.fDir[0], p*local.fDir[1], p*local.fDir[2], q, cov,
+                   TVector3(local.fO), TVector3(local.fDI), TVector3(local.fDJ), TVector3(local.fDK));
+  return kTRUE;
+}
+
+// -----   Propagation   ---------------------------------------------------
+Bool_t FairRKErrorPropagator::Propagate(const Local& start, Local& end, Bool_t endSD, Int_t PDG)
+{
+  if (fTarget < 0) {
+    if (fPrintErrors) { LOG(ERROR) << "FairRKErrorPropagator: no target defined" << FairLogger::endl; }
+    return kFALSE;
+  }
+  TParticlePDG* particle = TDatabasePDG::Instance()->GetParticle(PDG);
+  if (!particle) {
+    if (fPrintErrors) { LOG(ERROR) << "FairRKErrorPropagator: unknown particle " << PDG << FairLogger::endl; }
+    return kFALSE;
+  }
+  fMass = particle->Mass();
+  Bool_t withErrors = !fOnlyParameters;
+
+  // the navigator of this thread
+  TGeoNavigator* nav = NULL;
+  if (fMaterialEffects && gGeoManager) {
+    nav = gGeoManager->GetCurrentNavigator();
+    if (!nav) { nav = gGeoManager->AddNavigator(); }
+  }
+  fMatA = fMatZ = fMatDensity = fMatRadLen = 0.;
+
+  Double_t state[7];
+  Double_t jacIn[7][5];
+  LocalToFree(start, state, jacIn);
+
+  // covariance and transport matrix in the free system
+  Double_t cov7[7][7], jacAll[7][7];
+  if (withErrors) {
+    FairGeaneUtil util;
+    Double_t cov5[5][5];
+    Double_t cov15[15];
+    for (Int_t i=0; i<15; i++) { cov15[i] = start.fCov[i]; }
+    util.FromVec15ToMat25(cov15, cov5);
+    for (Int_t i=0; i<7; i++) {
+      for (Int_t j=0; j<7; j++) {
+        Double_t s = 0.;
+        for (Int_t k=0; k<5; k++) for (Int_t l=0; l<5; l++) { s += jacIn[i][k]*cov5[k][l]*jacIn[j][l]; }
+        cov7[i][j] = s;
+        jacAll[i][j] = (i == j) ? 1. : 0.;
+      }
+    }
+  }
+
+  Double_t planeI[3];
+  Cross(fPlaneJ, fPlaneK, planeI);
+  Double_t dir = fBackward ? -1. : 1.;
+  Double_t length = 0.;
+  Bool_t reached = kFALSE;
+
+  for (Int_t iStep=0; iStep<kMaxSteps; iStep++) {
+    // signed path length to the target along the momentum
+    Double_t rest;
+    if (fTarget == 0) {
+      rest = dir*(fTargetLength - length);
+      if (TMath::Abs(rest) < kTolerance) { reached = kTRUE; break; }
+    } else {
+      Double_t dist = planeI[0]*(fPlaneO[0]-state[0]) + planeI[1]*(fPlaneO[1]-state[1]) + planeI[2]*(fPlaneO[2]-state[2]);
+      if (TMath::Abs(dist) < kTolerance) { reached = kTRUE; break; }
+      Double_t cosI = Dot(planeI, state+3);
+      if (TMath::Abs(cosI) < 1e-6) { break; }
+      rest = dist/cosI;
+      // the plane has to be in the direction of propagation at the start
+      if (iStep == 0 && rest*dir < 0.) { break; }
+    }
+
+    // step limited by the target, the maximum step, the deflection and the material
+    Double_t step = TMath::Min(TMath::Abs(rest), fMaxStep);
+    Double_t b[3];
+    Field(state, b);
+    Double_t bMag = TMath::Sqrt(Dot(b, b));
+    if (bMag > 0. && state[6] != 0.) {
+      step = TMath::Min(step, fMaxDeflection/(kEc*bMag*TMath::Abs(state[6])));
+    }
+    Double_t h = rest < 0. ? -step : step;
+    if (nav) { FindMaterial(nav, state, h, step); }
+    h = rest < 0. ? -step : step;
+
+    Double_t jacStep[7][7];
+    Double_t qpBefore = state[6];
+    RKStep(state, h, withErrors ? jacStep : NULL);
+    length += dir*h;
+
+    // material effects, the energy is lost along the momentum
+    Double_t noise[7][7];
+    Bool_t withNoise = kFALSE;
+    if (fMaterialEffects && fMatDensity > 0. && fMatA > 0.) {
+      Double_t p = 1./TMath::Abs(qpBefore);
+      Double_t e = TMath::Sqrt(p*p + fMass*fMass);
+      Double_t dedx, sigma2;
+      EnergyLoss(p, dedx, sigma2);
+      Double_t eNew = e - h*dedx;
+      if (eNew <= fMass) {
+        if (fPrintErrors) { LOG(WARNING) << "FairRKErrorPropagator: particle stopped after " << length << " cm" << FairLogger::endl; }
+        return kFALSE;
+      }
+      Double_t pNew = TMath::Sqrt(eNew*eNew - fMass*fMass);
+      state[6] = (qpBefore < 0. ? -1. : 1.)/pNew;
+
+      if (withErrors) {
+        // dq/p after / dq/p before
+        Double_t factor = (p*p*p*eNew)/(pNew*pNew*pNew*e);
+        for (Int_t j=0; j<7; j++) { jacStep[6][j] *= factor; }
+
+        for (Int_t i=0; i<7; i++) for (Int_t j=0; j<7; j++) { noise[i][j] = 0.; }
+        Double_t x = TMath::Abs(h);
+        // multiple scattering, Highland formula, thick scatterer
+        if (fMatRadLen > 0. && fMatRadLen < 1e10) {
+          Double_t beta = pNew/eNew;
+          Double_t xX0 = x/fMatRadLen;
+          Double_t theta0 = 0.0136/(beta*pNew)*TMath::Sqrt(xX0)*(1. + 0.038*TMath::Log(xX0));
+          Double_t theta2 = xX0 > 1e-10 ? theta0*theta0 : 0.;
+          const Double_t* t = state+3;
+          for (Int_t i=0; i<3; i++) {
+            for (Int_t j=0; j<3; j++) {
+              Double_t proj = (i == j ? 1. : 0.) - t[i]*t[j];
+              noise[3+i][3+j] = theta2*proj;
+              noise[i][j] = theta2*h*h/3.*proj;
+              noise[i][3+j] = noise[3+i][j] = theta2*h/2.*proj;
+            }
+          }
+        }
+        // energy loss straggling
+        noise[6][6] = eNew*eNew/(pNew*pNew*pNew*pNew*pNew*pNew)*sigma2*x;
+        withNoise = kTRUE;
+      }
+    }
+
+    if (withErrors) {
+      Double_t tmp[7][7], tmpAll[7][7];
+      for (Int_t i=0; i<7; i++) {
+        for (Int_t j=0; j<7; j++) {
+          Double_t s = 0., sAll = 0.;
+          for (Int_t k=0; k<7; k++) {
+            s += jacStep[i][k]*cov7[k][j];
+            sAll += jacStep[i][k]*jacAll[k][j];
+          }
+          tmp[i][j] = s;
+          tmpAll[i][j] = sAll;
+        }
+      }
+      for (Int_t i=0; i<7; i++) {
+        for (Int_t j=0; j<7; j++) {
+          Double_t s = withNoise ? noise[i][j] : 0.;
+          for (Int_t k=0; k<7; k++) { s += tmp[i][k]*jacStep[j][k]; }
+          cov7[i][j] = s;
+          jacAll[i][j] = tmpAll[i][j];
+        }
+      }
+    }
+  }
+
+  if (!reached) {
+    if (fPrintErrors) { LOG(ERROR) << "FairRKErrorPropagator: target not reached" << FairLogger::endl; }
+    return kFALSE;
+  }
+  fLength = length;
+
+  // end system: the target plane, or the plane perpendicular to the track
+  end.fSD = endSD;
+  if (fTarget == 1) {
+    for (Int_t i=0; i<3; i++) {
+      end.fO[i] = fPlaneO[i];
+      end.fDI[i] = planeI[i];
+      end.fDJ[i] = fPlaneJ[i];
+      end.fDK[i] = fPlaneK[i];
+    }
+  } else {
+    for (Int_t i=0; i<3; i++) {
+      end.fO[i] = state[i];
+      end.fDI[i] = state[3+i];
+    }
+    if (!SCAxes(state+3, end.fDJ, end.fDK)) { return kFALSE; }
+  }
+  Double_t jacOut[5][7];
+  FreeToLocal(state, end, jacOut);
+
+  if (withErrors) {
+    Double_t cov5[5][5];
+    for (Int_t i=0; i<5; i++) {
+      for (Int_t j=0; j<5; j++) {
+        Double_t s = 0., sTrp = 0.;
+        for (Int_t k=0; k<7; k++) {
+          Double_t sJ = 0.;
+          for (Int_t l=0; l<7; l++) {
+            s += jacOut[i][k]*cov7[k][l]*jacOut[j][l];
+            sJ += jacAll[k][l]*jacIn[l][j];
+          }
+          sTrp += jacOut[i][k]*sJ;
+        }
+        cov5[i][j] = s;
+        fTrpMat[i][j] = sTrp;
+      }
+    }
+    FairGeaneUtil util;
+    util.FromMat25ToVec15(cov5, end.fCov);
+  } else {
+    for (Int_t i=0; i<15; i++) { end.fCov[i] = 0.; }
+  }
+  return kTRUE;
+}
+
+// -----   Parameter systems   ---------------------------------------------
+void FairRKErrorPropagator::LocalToFree(const Local& local, Double_t state[7], Double_t jac[7][5])
+{
+  for (Int_t i=0; i<3; i++) {
+    state[i] = local.fPos[i];
+    state[3+i] = local.fDir[i];
+  }
+  state[6] = local.fQp;
+
+  for (Int_t i=0; i<7; i++) for (Int_t j=0; j<5; j++) { jac[i][j] = 0.; }
+  jac[6][0] = 1.;
+  const Double_t* t = local.fDir;
+
+  if (local.fSD) {
+    // t = spu (DI + v' DJ + w' DK) / n
+    Double_t ti = Dot(local.fDI, t);
+    Double_t tv = Dot(local.fDJ, t)/ti;
+    Double_t tw = Dot(local.fDK, t)/ti;
+    Double_t n = TMath::Sqrt(1. + tv*tv + tw*tw);
+    Double_t spu = ti < 0. ? -1. : 1.;
+    for (Int_t i=0; i<3; i++) {
+      jac[3+i][1] = spu*local.fDJ[i]/n - t[i]*tv/(n*n);
+      jac[3+i][2] = spu*local.fDK[i]/n - t[i]*tw/(n*n);
+      jac[i][3] = local.fDJ[i];
+      jac[i][4] = local.fDK[i];
+    }
+  } else {
+    Double_t v[3], w[3];
+    SCAxes(t, v, w);
+    Double_t cLm = w[2];
+    for (Int_t i=0; i<3; i++) {
+      jac[3+i][1] = w[i];
+      jac[3+i][2] = cLm*v[i];
+      jac[i][3] = v[i];
+      jac[i][4] = w[i];
+    }
+  }
+}
+
+void FairRKErrorPropagator::FreeToLocal(const Double_t state[7], Local& local, Double_t jac[5][7])
+{
+  for (Int_t i=0; i<3; i++) {
+    local.fPos[i] = state[i];
+    local.fDir[i] = state[3+i];
+  }
+  local.fQp = state[6];
+
+  // change of the direction along the track
+  const Double_t* t = state+3;
+  Double_t b[3], tb[3], dt[3];
+  Field(state, b);
+  Cross(t, b, tb);
+  for (Int_t i=0; i<3; i++) { dt[i] = kEc*state[6]*tb[i]; }
+
+  // a change of the position along the normal n of the end system is
+  // compensated by a change of the path length: ds = -n.dr / n.t
+  Double_t v[3], w[3];
+  const Double_t* n;
+  Double_t g[3], h[3];         // derivatives of the direction parameters
+  if (local.fSD) {
+    n = local.fDI;
+    for (Int_t i=0; i<3; i++) {
+      v[i] = local.fDJ[i];
+      w[i] = local.fDK[i];
+    }
+    Double_t ti = Dot(n, t);
+    Double_t tv = Dot(v, t)/ti;
+    Double_t tw = Dot(w, t)/ti;
+    for (Int_t i=0; i<3; i++) {
+      g[i] = (v[i] - tv*n[i])/ti;
+      h[i] = (w[i] - tw*n[i])/ti;
+    }
+  } else {
+    n = t;
+    SCAxes(t, v, w);
+    Double_t cLm = w[2];
+    for (Int_t i=0; i<3; i++) {
+      g[i] = w[i];
+      h[i] = v[i]/cLm;
+    }
+  }
+  Double_t nt = Dot(n, t);
+
+  for (Int_t i=0; i<5; i++) for (Int_t j=0; j<7; j++) { jac[i][j] = 0.; }
+  jac[0][6] = 1.;
+  Double_t gdt = Dot(g, dt);
+  Double_t hdt = Dot(h, dt);
+  Double_t vt = Dot(v, t);
+  Double_t wt = Dot(w, t);
+  for (Int_t i=0; i<3; i++) {
+    jac[1][i] = -gdt*n[i]/nt;
+    jac[1][3+i] = g[i];
+    jac[2][i] = -hdt*n[i]/nt;
+    jac[2][3+i] = h[i];
+    jac[3][i] = v[i] - vt*n[i]/nt;
+    jac[4][i] = w[i] - wt*n[i]/nt;
+  }
+}
+
+// -----   Runge-Kutta step with Jacobian   --------------------------------
+void FairRKErrorPropagator::RKStep(Double_t state[7], Double_t h, Double_t (*jac)[7])
+{
+  // dr/ds = t, dt/ds = kEc q/p (t x B), the derivatives of the state with
+  // respect to the state at the start of the step are integrated with the
+  // same stages, neglecting the gradient of the field
+  Double_t y[4][7];      // state at the stages
+  Double_t k[4][7];      // derivatives at the stages
+  Double_t b[4][3];
+  const Double_t c[4] = { 0., 0.5, 0.5, 1. };
+
+  for (Int_t s=0; s<4; s++) {
+    for (Int_t i=0; i<7; i++) { y[s][i] = s == 0 ? state[i] : state[i] + c[s]*h*k[s-1][i]; }
+    Field(y[s], b[s]);
+    Double_t tb[3];
+    Cross(y[s]+3, b[s], tb);
+    for (Int_t i=0; i<3; i++) {
+      k[s][i] = y[s][3+i];
+      k[s][3+i] = kEc*y[s][6]*tb[i];
+    }
+    k[s][6] = 0.;
+  }
+  for (Int_t i=0; i<6; i++) {
+    state[i] += h/6.*(k[0][i] + 2.*k[1][i] + 2.*k[2][i] + k[3][i]);
+  }
+  Double_t norm = 1./TMath::Sqrt(state[3]*state[3] + state[4]*state[4] + state[5]*state[5]);
+  for (Int_t i=3; i<6; i++) { state[i] *= norm; }
+
+  if (!jac) { return; }
+
+  Double_t d[7][7];      // derivatives at the current stage
+  Double_t dk[4][7][7];  // their change along the track
+  for (Int_t s=0; s<4; s++) {
+    for (Int_t i=0; i<7; i++) {
+      for (Int_t j=0; j<7; j++) {
+        Double_t unit = (i == j) ? 1. : 0.;
+        d[i][j] = s == 0 ? unit : unit + c[s]*h*dk[s-1][i][j];
+      }
+    }
+    Double_t tb[3];
+    Cross(y[s]+3, b[s], tb);
+    for (Int_t j=0; j<7; j++) {
+      Double_t dt[3] = { d[3][j], d[4][j], d[5][j] };
+      Double_t dtb[3];
+      Cross(dt, b[s], dtb);
+      for (Int_t i=0; i<3; i++) {
+        dk[s][i][j] = d[3+i][j];
+        dk[s][3+i][j] = kEc*(y[s][6]*dtb[i] + d[6][j]*tb[i]);
+      }
+      dk[s][6][j] = 0.;
+    }
+  }
+  for (Int_t i=0; i<7; i++) {
+    for (Int_t j=0; j<7; j++) {
+      jac[i][j] = (i == j ? 1. : 0.) + h/6.*(dk[0][i][j] + 2.*dk[1][i][j] + 2.*dk[2][i][j] + dk[3][i][j]);
+    }
+  }
+}
+
+// -----   Material   ------------------------------------------------------
+void FairRKErrorPropagator::FindMaterial(TGeoNavigator* nav, const Double_t state[7], Double_t h, Double_t& step)
+{
+  Double_t sign = h < 0. ? -1. : 1.;
+  nav->SetCurrentPoint(state[0], state[1], state[2]);
+  nav->SetCurrentDirection(sign*state[3], sign*state[4], sign*state[5]);
+  nav->FindNode();
+  TGeoVolume* volume = nav->GetCurrentVolume();
+  TGeoMaterial* material = volume ? volume->GetMaterial() : NULL;
+  if (!material) {
+    fMatA = fMatZ = fMatDensity = fMatRadLen = 0.;
+    return;
+  }
+  fMatA = material->GetA();
+  fMatZ = material->GetZ();
+  fMatDensity = material->GetDensity();
+  fMatRadLen = material->GetRadLen();
+
+  // go a bit beyond the boundary, the next step is in the next volume
+  nav->FindNextBoundary(step);
+  Double_t boundary = nav->GetStep();
+  if (boundary < step) {
+    step = TMath::Min(step, boundary + kMinStep);
+  }
+}
+
+void FairRKErrorPropagator::EnergyLoss(Double_t p, Double_t& dedx, Double_t& sigma2)
+{
+  // Bethe-Bloch without density correction, Bohr straggling
+  const Double_t k = 0.307075e-3;   // GeV cm^2/g
+  Double_t e = TMath::Sqrt(p*p + fMass*fMass);
+  Double_t beta2 = p*p/(e*e);
+  Double_t gamma = e/fMass;
+  Double_t bg2 = p*p/(fMass*fMass);
+  Double_t ratio = kMe/fMass;
+  Double_t tMax = 2.*kMe*bg2/(1. + 2.*gamma*ratio + ratio*ratio);
+  Double_t exc = (fMatZ > 1. ? 16.*TMath::Power(fMatZ, 0.9) : 19.2)*1e-9;
+  Double_t za = fMatZ/fMatA*fMatDensity;
+
+  dedx = k*za/beta2*(0.5*TMath::Log(2.*kMe*bg2*tMax/(exc*exc)) - beta2);
+  if (dedx < 0.) { dedx = 0.; }
+  sigma2 = 0.1569e-6*za*gamma*gamma*(1. - 0.5*beta2);
+}
+
+void FairRKErrorPropagator::Field(const Double_t pos[3], Double_t b[3])
+{
+  if (fField) {
+    fField->GetFieldValue(pos, b);
+  } else {
+    b[0] = b[1] = b[2] = 0.;
+  }
+}
+
+ClassImp(FairRKErrorPropagator)
@@ -0,0 +1,158 @@
+/********************************************************************************
+ *    Copyright (C) 2014 GSI Helmholtzzentrum fuer Schwerionenforschung GmbH    *
+ *                                                                              *
+ *              This software is distributed under the terms of the             *
+ *         GNU Lesser General Public Licence version 3 (LGPL) version 3,        *
+ *                  copied verbatim in the file "LICENSE"                       *
+ ********************************************************************************/
+// Propagation of track parameters and errors without GEANE
+//
+// Same interface as FairGeanePro for FairTrackParH (SC system) and
+// FairTrackParP (SD system), but the transport is done in C++:
+// - Runge-Kutta integration through the FairField,
+// - mean energy loss (Bethe-Bloch) and its straggling, and multiple
+//   scattering (Highland) from the TGeoMaterial of the current volume,
+// - transport of the covariance matrix with the Jacobian integrated along
+//   the track (the field gradient is neglected).
+//
+// All state is kept in the object, so several objects can be used in
+// parallel threads. For the geometry each thread uses its own
+// TGeoNavigator (TGeoManager::SetMaxThreads has to be called before).
+//
+#ifndef FAIRRKERRORPROPAGATOR_H
+#define FAIRRKERRORPROPAGATOR_H 1
+
+#include "TNamed.h"                     // for TNamed
+
+#include "Rtypes.h"                     // for Int_t, Bool_t, Double_t, etc
+#include "TVector3.h"                   // for TVector3
+
+class FairField;
+class FairTrackPar;
+class FairTrackParP;
+class FairTrackParH;
+class TGeoNavigator;
+
+class FairRKErrorPropagator : public TNamed
+{
+
+  public:
+    /** Default constructor, uses the field of the current run **/
+    FairRKErrorPropagator();
+
+    /** Constructor with the field to be used, 0 for no field **/
+    FairRKErrorPropagator(FairField* field);
+
+    /** Destructor **/
+    virtual ~FairRKErrorPropagator();
+
+    Bool_t Propagate(FairTrackParH* TStart, FairTrackParH* TEnd, Int_t PDG);
+    Bool_t Propagate(FairTrackParP* TStart, FairTrackParH* TEnd, Int_t PDG);
+    Bool_t Propagate(FairTrackParP* TStart, FairTrackParP* TEnd, Int_t PDG);
+    Bool_t Propagate(FairTrackParH* TStart, FairTrackParP* TEnd, Int_t PDG);
+
+    /** Target: plane through v0 spanned by v1 and v2 **/
+    Bool_t PropagateToPlane(TVector3& v0, TVector3& v1, TVector3& v2);
+    /** Target: given track length **/
+    Bool_t PropagateToLength(Float_t length);
+    /** Propagate against the direction of the momentum **/
+    void setBackProp() { fBackward = kTRUE; }
+    /** Do not propagate the errors **/
+    Bool_t PropagateOnlyParameters();
+
+    /** Transport matrix of the last propagation, from the start to the end parameters **/
+    void GetTransportMatrix(Double_t trm[5][5]);
+    /** Track length of the last propagation **/
+    Float_t GetLengthAtPCA() { return fLength; }
+
+    void SetField(FairField* field) { fField = field; }
+    /** Maximum step length [cm] **/
+    void SetMaxStep(Double_t step) { fMaxStep = step; }
+    /** Maximum deflection in the field per step [rad] **/
+    void SetMaxDeflection(Double_t angle) { fMaxDeflection = angle; }
+    /** Switch energy loss and multiple scattering on or off **/
+    void SetMaterialEffects(Bool_t on) { fMaterialEffects = on; }
+
+    void SetPrintErrors(bool printError = kTRUE) { fPrintErrors = printError; }
+
+  private:
+    /** Track in the lab with the covariance of its SC parameters
+     ** (q/p, lambda, phi, y_sc, z_sc) or SD parameters (q/p, v', w', v, w)
+     **/
+    struct Local {
+      Bool_t   fSD;        // SD or SC parameters
+      Double_t fPos[3];
+      Double_t fDir[3];    // unit vector along the momentum
+      Double_t fQp;
+      Double_t fCov[15];   // covariance in q/p
+      Double_t fO[3];      // SD plane: origin and unit vectors
+      Double_t fDI[3];
+      Double_t fDJ[3];
+      Double_t fDK[3];
+    };
+
+    void FromParH(FairTrackParH* par, Local& local);
+    void FromParP(FairTrackParP* par, Local& local);
+    Bool_t ToParH(const Local& local, FairTrackParH* par);
+    Bool_t ToParP(const Local& local, FairTrackParP* par);
+
+    /** Propagates the local parameters at the start to the target, the end
+     ** parameters are in the SC system or in the SD system of the target plane
+     **/
+    Bool_t Propagate(const Local& start, Local& end, Bool_t endSD, Int_t PDG);
+
+    /** Free state (x,y,z,tx,ty,tz,q/p) of a track and its derivatives
+     ** with respect to the local parameters **/
+    void LocalToFree(const Local& local, Double_t state[7], Double_t jac[7][5]);
+    /** Track of a free state and the derivatives of the local parameters
+     ** with respect to the free state, for the SC system or the SD system
+     ** of the plane in local **/
+    void FreeToLocal(const Double_t state[7], Local& local, Double_t jac[5][7]);
+
+    /** One Runge-Kutta step of length h, and the Jacobian of the step if jac is given **/
+    void RKStep(Double_t state[7], Double_t h, Double_t (*jac)[7]);
+
+    /** Mean energy loss [GeV/cm] and its variance [GeV^2/cm] in the current material **/
+    void EnergyLoss(Double_t p, Double_t& dedx, Double_t& sigma2);
+
+    /** Takes the material at the track position, limits the step to the next boundary **/
+    void FindMaterial(TGeoNavigator* nav, const Double_t state[7], Double_t h, Double_t& step);
+
+    void Field(const Double_t pos[3], Double_t b[3]);
+
+    FairField* fField;
+
+    /** target **/
+    Int_t    fTarget;            // -1 none, 0 length, 1 plane
+    Double_t fTargetLength;
+    Double_t fPlaneO[3];
+    Double_t fPlaneJ[3];
+    Double_t fPlaneK[3];
+    Bool_t   fBackward;
+    Bool_t   fOnlyParameters;
+
+    /** step control **/
+    Double_t fMaxStep;
+    Double_t fMaxDeflection;
+    Bool_t   fMaterialEffects;
+
+    /** particle and material of the current step **/
+    Double_t fMass;              //!
+    Double_t fMatA;              //!
+    Double_t fMatZ;              //!
+    Double_t fMatDensity;        //!
+    Double_t fMatRadLen;         //!
+
+    /** results of the last propagation **/
+    Double_t fTrpMat[5][5];      //!
+    Float_t  fLength;            //!
+
+    Bool_t   fPrintErrors;
+
+    FairRKErrorPropagator(const FairRKErrorPropagator&);
+    FairRKErrorPropagator& operator=(const FairRKErrorPropagator&);
+
+    ClassDef(FairRKErrorPropagator,1);
+};
+
+#endif
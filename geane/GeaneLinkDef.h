@@ -13,6 +13,7 @@
 
 #pragma link C++ class  FairGeane+;
 #pragma link C++ class  FairGeanePro+;
+#pragma link C++ class  FairRKErrorPropagator+;
 
 #endif
 
@@ -11,9 +11,12 @@
 // -------------------------------------------------------------------------
 #include "FairAsciiGenerator.h"
 
+#include "FairGeneratorTextReader.h"   // for FairGeneratorTextReader
 #include "FairPrimaryGenerator.h"       // for FairPrimaryGenerator
 #include "FairLogger.h"
 
+#include "TString.h"                    // for TString, operator+
+
 #include <stddef.h>                     // for NULL
 #include <climits>                      // for INT_MAX
 
@@ -21,7 +24,10 @@
 FairAsciiGenerator::FairAsciiGenerator()
   :FairGenerator(),
    fInputFile(NULL),
-   fFileName("")
+   fFileName(""),
+   fCache(NULL),
+   fEvent(),
+   fTracks()
 {
 }
 // ------------------------------------------------------------------------
@@ -32,13 +38,16 @@ FairAsciiGenerator::FairAsciiGenerator()
 FairAsciiGenerator::FairAsciiGenerator(const char* fileName)
   :FairGenerator(),
    fInputFile(0),
-   fFileName(fileName)
+   fFileName(fileName),
+   fCache(NULL),
+   fEvent(),
+   fTracks()
 {
   //  fFileName  = fileName;
   LOG(INFO) << "FairAsciiGenerator: Opening input file " 
 	    << fileName << FairLogger::endl;
-  fInputFile = new std::ifstream(fFileName);
-  if ( ! fInputFile->is_open() ) {
+  fInputFile = new FairGeneratorTextReader();
+  if ( ! fInputFile->Open(fFileName) ) {
     LOG(FATAL) << "Cannot open input file." << FairLogger::endl;
   }
 
@@ -52,6 +61,7 @@ FairAsciiGenerator::FairAsciiGenerator(const char* fileName)
 FairAsciiGenerator::~FairAsciiGenerator()
 {
   CloseInput();
+  delete fCache;
 }
 // ------------------------------------------------------------------------
 
@@ -61,14 +71,70 @@ FairAsciiGenerator::~FairAsciiGenerator()
 Bool_t FairAsciiGenerator::ReadEvent(FairPrimaryGenerator* primGen)
 {
 
-  // Check for input file
-  if ( ! fInputFile->is_open() ) {
-    LOG(ERROR) << "FairAsciiGenerator: Input file not open!" 
-	       << FairLogger::endl;
-    return kFALSE;
+  if ( fCache && fCache->IsReading() ) {
+    // Read the event from the cache
+    if ( ! fCache->ReadEvent(fEvent, fTracks) ) {
+      LOG(INFO) << "FairAsciiGenerator: End of input file reached "
+		<< FairLogger::endl;
+      fCache->Close();
+      return kFALSE;
+    }
+  } else {
+    // Check for input file
+    if ( ! fInputFile || ! fInputFile->IsOpen() ) {
+      LOG(ERROR) << "FairAsciiGenerator: Input file not open!" 
+		 << FairLogger::endl;
+      return kFALSE;
+    }
+    if ( ! ReadTextEvent() ) {
+      // The input file is closed at its end, then the cache is complete
+      if ( fCache && ! fInputFile ) { fCache->Commit(); }
+      return kFALSE;
+    }
+    if ( fCache && fCache->IsWriting() ) { fCache->WriteEvent(fEvent, fTracks); }
+  }
+
+  LOG(INFO) << "FairAsciiGenerator: Event " << fEvent.fEventId << ",  vertex = ("
+	    << fEvent.fVx << "," << fEvent.fVy << "," << fEvent.fVz << ") cm,  multiplicity "
+	    << fEvent.fNTracks << FairLogger::endl;
+
+  // Give the tracks to PrimaryGenerator
+  for (size_t itrack=0; itrack<fTracks.size(); itrack++) {
+    const FairGeneratorCacheTrack& track = fTracks[itrack];
+    primGen->AddTrack(track.fPdg, track.fPx, track.fPy, track.fPz,
+                      fEvent.fVx, fEvent.fVy, fEvent.fVz);
   }
 
 
+  return kTRUE;
+}
+// ------------------------------------------------------------------------
+
+
+
+// -----   Public method SetCacheFile   -----------------------------------
+void FairAsciiGenerator::SetCacheFile(const char* cacheName)
+{
+  if ( ! fInputFile ) { return; }
+
+  TString name = cacheName ? TString(cacheName) : TString(fFileName) + ".fgc";
+  if ( ! fCache ) { fCache = new FairGeneratorCache(); }
+  if ( fCache->OpenRead(name, fFileName) ) {
+    // The text input is not needed any more
+    CloseInput();
+  } else {
+    fCache->OpenWrite(name, fFileName);
+  }
+}
+// ------------------------------------------------------------------------
+
+
+
+// -----   Private method ReadTextEvent   ---------------------------------
+Bool_t FairAsciiGenerator::ReadTextEvent()
+{
+  FairGeneratorTextReader& in = *fInputFile;
+
   // Define event variable to be read from file
   Int_t ntracks = 0, eventID = 0;
   Double_t vx = 0., vy = 0., vz = 0.;
@@ -78,37 +144,48 @@ Bool_t FairAsciiGenerator::ReadEvent(FairPrimaryGenerator* primGen)
   Double_t px = 0., py = 0., pz = 0.;
 
   // Read event header line from input file
-  *fInputFile >> ntracks;
-  if (fInputFile->fail() || ntracks < 0 || ntracks > (INT_MAX-1)) LOG(FATAL) << "Error reading the number of events from event header." << FairLogger::endl;
-  *fInputFile >> eventID >>  vx >>  vy >>  vz;
-
-  // If end of input file is reached : close it and abort run
-  if ( fInputFile->eof() ) {
-    LOG(INFO) << "FairAsciiGenerator: End of input file reached " 
-	      << FairLogger::endl;
-    CloseInput();
+  if ( ! in.ReadInt(ntracks) ) {
+    // If end of input file is reached : close it and abort run
+    if ( in.AtEnd() ) {
+      LOG(INFO) << "FairAsciiGenerator: End of input file reached " 
+		<< FairLogger::endl;
+      CloseInput();
+      return kFALSE;
+    }
+    LOG(FATAL) << "Error reading the number of events from event header." << FairLogger::endl;
+  }
+  if (ntracks < 0 || ntracks > (INT_MAX-1)) LOG(FATAL) << "Error reading the number of events from event header." << FairLogger::endl;
+  if ( ! ( in.ReadInt(eventID) && in.ReadDouble(vx) && in.ReadDouble(vy) && in.ReadDouble(vz) ) ) {
+    LOG(ERROR) << "FairAsciiGenerator: Error reading event header" << FairLogger::endl;
     return kFALSE;
   }
 
-  LOG(INFO) << "FairAsciiGenerator: Event " << eventID << ",  vertex = ("
-	    << vx << "," << vy << "," << vz << ") cm,  multiplicity "
-	    << ntracks << FairLogger::endl;
+  fEvent.fEventId = eventID;
+  fEvent.fNTracks = ntracks;
+  fEvent.fB = 0.;
+  fEvent.fBeamEnergy = 0.;
+  fEvent.fVx = vx;
+  fEvent.fVy = vy;
+  fEvent.fVz = vz;
+  fTracks.resize(ntracks);
 
   // Loop over tracks in the current event
   for (Int_t itrack=0; itrack<ntracks; itrack++) {
 
     // Read PID and momentum from file
-    *fInputFile >> pdgID >> px >> py >> pz;
+    if ( ! ( in.ReadInt(pdgID) && in.ReadDouble(px) && in.ReadDouble(py) && in.ReadDouble(pz) ) ) {
+      LOG(ERROR) << "FairAsciiGenerator: Error reading track " << itrack
+		 << " of event " << eventID << FairLogger::endl;
+      return kFALSE;
+    }
     // convert Geant3 code to PDG code
 
     // Int_t pdg= fPDG->ConvertGeant3ToPdg(pdgID);
 
-    // Give track to PrimaryGenerator
-    primGen->AddTrack(pdgID, px, py, pz, vx, vy, vz);
-
+    FairGeneratorCacheTrack track = { pdgID, 0, px, py, pz };
+    fTracks[itrack] = track;
   }
 
-
   return kTRUE;
 }
 // ------------------------------------------------------------------------
@@ -119,10 +196,10 @@ Bool_t FairAsciiGenerator::ReadEvent(FairPrimaryGenerator* primGen)
 void FairAsciiGenerator::CloseInput()
 {
   if ( fInputFile ) {
-    if ( fInputFile->is_open() ) {
+    if ( fInputFile->IsOpen() ) {
       LOG(INFO) << "FairAsciiGenerator: Closing input file "
 		<< fFileName << FairLogger::endl;
-      fInputFile->close();
+      fInputFile->Close();
     }
     delete fInputFile;
     fInputFile = NULL;
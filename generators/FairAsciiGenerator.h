@@ -22,6 +22,9 @@
  followed by NTRACKS lines of the format G3PID, PX, PY, PZ, where
  G3PID is the GEANT3 particle code, and PX, PY, PZ the cartesian
  momentum coordinates in GeV.
+ The file can be compressed with gzip (extension .gz). With SetCacheFile
+ the events are converted once into a binary cache (see FairGeneratorCache),
+ which is read instead of the text file in the following runs.
  Derived from FairGenerator.
 **/
 
@@ -30,12 +33,13 @@
 #define FAIR_ASCIIGENERATOR_H
 
 #include "FairGenerator.h"              // for FairGenerator
+#include "FairGeneratorCache.h"         // for FairGeneratorCacheEvent, etc
 
-#include <iosfwd>                       // for ifstream
 #include "Rtypes.h"                     // for FairAsciiGenerator::Class, etc
 
-#include <fstream>                      // for ifstream
+#include <vector>                       // for vector
 
+class FairGeneratorTextReader;
 class FairPrimaryGenerator;
 
 class FairAsciiGenerator : public FairGenerator
@@ -64,17 +68,33 @@ class FairAsciiGenerator : public FairGenerator
     virtual Bool_t ReadEvent(FairPrimaryGenerator* primGen);
 
 
+    /** Read the events from a binary cache of the input file. If the cache
+     ** does not exist or is outdated, it is written while the input file is
+     ** read and becomes available when the end of the input file is reached.
+     ** Has to be called before the first event is read.
+     ** @param cacheName  name of the cache, default is the input name + ".fgc"
+     **/
+    void SetCacheFile(const char* cacheName=0);
+
+
 
   private:
 
-    std::ifstream* fInputFile;               //! Input file stream
+    FairGeneratorTextReader* fInputFile;     //! Input file
     const Char_t* fFileName;            //! Input file Name
 
+    FairGeneratorCache* fCache;              //! Binary copy of the input file
+    FairGeneratorCacheEvent fEvent;          //! Current event
+    std::vector<FairGeneratorCacheTrack> fTracks;  //! Tracks of the current event
+
 
     /** Private method CloseInput. Just for convenience. Closes the
      ** input file properly. Called from destructor and from ReadEvent. **/
     void CloseInput();
 
+    /** Parses the next event of the input file into fEvent and fTracks **/
+    Bool_t ReadTextEvent();
+
     FairAsciiGenerator(const FairAsciiGenerator&);
     FairAsciiGenerator& operator=(const FairAsciiGenerator&);
 
@@ -82,7 +102,7 @@ class FairAsciiGenerator : public FairGenerator
 
 //  TDatabasePDG *fPDG; //!
 
-    ClassDef(FairAsciiGenerator,1);
+    ClassDef(FairAsciiGenerator,2);
 
 };
 
@@ -195,23 +195,23 @@ Bool_t FairBoxGenerator::ReadEvent(FairPrimaryGenerator* primGen)
 
   // Generate particles
   for (Int_t k = 0; k < fMult; k++) {
-    phi = gRandom->Uniform(fPhiMin,fPhiMax) * TMath::DegToRad();
+    phi = primGen->GetRandom()->Uniform(fPhiMin,fPhiMax) * TMath::DegToRad();
 
-    if      (fPRangeIsSet ) { pabs = gRandom->Uniform(fPMin,fPMax); }
-    else if (fPtRangeIsSet) { pt   = gRandom->Uniform(fPtMin,fPtMax); }
+    if      (fPRangeIsSet ) { pabs = primGen->GetRandom()->Uniform(fPMin,fPMax); }
+    else if (fPtRangeIsSet) { pt   = primGen->GetRandom()->Uniform(fPtMin,fPtMax); }
 
     if      (fThetaRangeIsSet) {
       if (fCosThetaIsSet)
-        theta = acos(gRandom->Uniform(cos(fThetaMin* TMath::DegToRad()),
+        theta = acos(primGen->GetRandom()->Uniform(cos(fThetaMin* TMath::DegToRad()),
                                       cos(fThetaMax* TMath::DegToRad())));
       else {
-        theta = gRandom->Uniform(fThetaMin,fThetaMax) * TMath::DegToRad();
+        theta = primGen->GetRandom()->Uniform(fThetaMin,fThetaMax) * TMath::DegToRad();
       }
     } else if (fEtaRangeIsSet) {
-      eta   = gRandom->Uniform(fEtaMin,fEtaMax);
+      eta   = primGen->GetRandom()->Uniform(fEtaMin,fEtaMax);
       theta = 2*TMath::ATan(TMath::Exp(-eta));
     } else if (fYRangeIsSet) {
-      y     = gRandom->Uniform(fYMin,fYMax);
+      y     = primGen->GetRandom()->Uniform(fYMin,fYMax);
       mt = TMath::Sqrt(fPDGMass*fPDGMass + pt*pt);
       pz = mt * TMath::SinH(y);
     }
@@ -229,8 +229,8 @@ Bool_t FairBoxGenerator::ReadEvent(FairPrimaryGenerator* primGen)
     py = pt*TMath::Sin(phi);
 
     if (fBoxVtxIsSet) {
-      fX = gRandom->Uniform(fX1,fX2);
-      fY = gRandom->Uniform(fY1,fY2);
+      fX = primGen->GetRandom()->Uniform(fX1,fX2);
+      fY = primGen->GetRandom()->Uniform(fY1,fY2);
     }
 
     if (fDebug)
@@ -18,9 +18,11 @@
 #include "TF1.h"                        // for TF1
 #include "TRandom.h"                    // for TRandom, gRandom
 
-#include <algorithm>                    // for max
+#include <algorithm>                    // for max, min, upper_bound
 
 using std::max;
+using std::min;
+using std::upper_bound;
 
 // -----   Default constructor   ------------------------------------------
 FairEvtGenGenerator::FairEvtGenGenerator()
@@ -29,7 +31,8 @@ FairEvtGenGenerator::FairEvtGenGenerator()
     fInputFile(NULL),
     fGasmode(0),
     fRsigma (0.),
-    fDensityFunction(NULL)
+    fDensityFunction(NULL),
+    fDensityIntegral()
 {
 }
 // ------------------------------------------------------------------------
@@ -41,7 +44,8 @@ FairEvtGenGenerator::FairEvtGenGenerator(const char* fileName)
    fInputFile(NULL),
    fGasmode(0),
    fRsigma (0.),
-   fDensityFunction(0)
+   fDensityFunction(0),
+   fDensityIntegral()
 {
   LOG(INFO) << "FairEvtGenGenerator: Opening input file " << fileName 
 	    << FairLogger::endl;
@@ -64,7 +68,8 @@ FairEvtGenGenerator::FairEvtGenGenerator(const char* fileName, Double_t Rsigma,
    fInputFile(NULL),
    fGasmode(1),
    fRsigma (Rsigma),
-   fDensityFunction(DensityFunction)
+   fDensityFunction(DensityFunction),
+   fDensityIntegral()
 {
   LOG(INFO) << "FairEvtGenGenerator: Opening input file " << fileName 
 	    << FairLogger::endl;
@@ -137,14 +142,19 @@ Bool_t FairEvtGenGenerator::ReadEvent(FairPrimaryGenerator* primGen)
 
           // Random 2D point in a circle of radius r (simple beamprofile)
           Double_t fX, fY, fZ, radius;
-          radius = gRandom->Gaus(0,fRsigma);
-          gRandom->Circle(fX, fY, radius);
+          radius = primGen->GetRandom()->Gaus(0,fRsigma);
+          primGen->GetRandom()->Circle(fX, fY, radius);
           fVx = fVx + fX;
           fVy = fVy + fY;
 
           // calculate fZ according to some (probability) density function of the
           // gas
-          fZ=fDensityFunction->GetRandom();
+          // events generated in advance have their own random generator
+          if (primGen->GetRandom() != gRandom) {
+            fZ=GetRandomZ(primGen->GetRandom());
+          } else {
+            fZ=fDensityFunction->GetRandom();
+          }
           fVz = fVz + fZ;
 
         }
@@ -200,5 +210,42 @@ void FairEvtGenGenerator::CloseInput()
 // ------------------------------------------------------------------------
 
 
+
+// -----   Private method GetRandomZ   ------------------------------------
+Double_t FairEvtGenGenerator::GetRandomZ(TRandom* random)
+{
+  Int_t nBins = fDensityFunction->GetNpx();
+  Double_t xMin = fDensityFunction->GetXmin();
+  Double_t dx = (fDensityFunction->GetXmax() - xMin) / nBins;
+
+  // integral of the density over the bins, computed at the first call
+  if (fDensityIntegral.empty()) {
+    fDensityIntegral.assign(nBins + 1, 0.);
+    for (Int_t i = 0; i < nBins; i++) {
+      Double_t integral = fDensityFunction->Integral(xMin + i*dx, xMin + (i+1)*dx);
+      fDensityIntegral[i+1] = fDensityIntegral[i] + max(integral, 0.);
+    }
+    Double_t total = fDensityIntegral[nBins];
+    if (total <= 0.) {
+      LOG(FATAL) << "FairEvtGenGenerator: integral of the density function is zero"
+                 << FairLogger::endl;
+    }
+    for (Int_t i = 1; i <= nBins; i++) {
+      fDensityIntegral[i] /= total;
+    }
+  }
+
+  // bin of the random integral, linear within the bin
+  Double_t r = random->Rndm();
+  Int_t bin = upper_bound(fDensityIntegral.begin(), fDensityIntegral.end(), r)
+              - fDensityIntegral.begin() - 1;
+  bin = max(0, min(bin, nBins - 1));
+  Double_t width = fDensityIntegral[bin+1] - fDensityIntegral[bin];
+  Double_t fraction = width > 0. ? (r - fDensityIntegral[bin]) / width : 0.5;
+  return xMin + (bin + fraction) * dx;
+}
+// ------------------------------------------------------------------------
+
+
 ClassImp(FairEvtGenGenerator)
 
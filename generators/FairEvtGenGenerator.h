@@ -88,9 +88,11 @@
 #include "Rtypes.h"                     // for FairEvtGenGenerator::Class, etc
 
 #include <stdio.h>                      // for FILE
+#include <vector>                       // for vector
 
 class FairPrimaryGenerator;
 class TF1;
+class TRandom;
 
 class FairEvtGenGenerator : public FairGenerator
 {
@@ -133,6 +135,11 @@ class FairEvtGenGenerator : public FairGenerator
      ** input file properly. Called from destructor and from ReadEvent. **/
     void CloseInput();
 
+    /** Random z from fDensityFunction, like TF1::GetRandom but with the
+     ** random generator of the event instead of gRandom. Only used when
+     ** the events are generated in advance, linear within the bins. **/
+    Double_t GetRandomZ(TRandom* random);
+
     int    fGasmode;
     double fRsigma;
 
@@ -141,6 +148,7 @@ class FairEvtGenGenerator : public FairGenerator
 
 //  TDatabasePDG *fPDG; //!
     TF1* fDensityFunction;
+    std::vector<Double_t> fDensityIntegral; //! normalised integral of fDensityFunction
 
     FairEvtGenGenerator(const FairEvtGenGenerator&);
     FairEvtGenGenerator& operator=(const FairEvtGenGenerator&);
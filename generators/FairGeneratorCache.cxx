@@ -0,0 +1,239 @@
+/********************************************************************************
+ *    Copyright (C) 2014 GSI Helmholtzzentrum fuer Schwerionenforschung GmbH    *
+ *                                                                              *
+ *              This software is distributed under the terms of the             *
+ *         GNU Lesser General Public Licence version 3 (LGPL) version 3,        *
+ *                  copied verbatim in the file "LICENSE"                       *
+ ********************************************************************************/
+// -------------------------------------------------------------------------
+// -----                FairGeneratorCache source file                 -----
+// -------------------------------------------------------------------------
+#include "FairGeneratorCache.h"
+
+#include "FairLogger.h"                 // for logging
+
+#include <sys/stat.h>                   // for stat
+
+namespace
+{
+struct FairGeneratorCacheHeader
+{
+  UInt_t    fMagic;
+  UInt_t    fVersion;
+  UInt_t    fEventSize;
+  UInt_t    fTrackSize;
+  ULong64_t fInputSize;
+  Long64_t  fInputTime;
+  ULong64_t fNEvents;
+};
+
+const UInt_t kMagic = 0x46474331; // "FGC1"
+const UInt_t kVersion = 1;
+const size_t kIOBufferSize = 1 << 20;
+}
+
+// -----   Default constructor   ------------------------------------------
+FairGeneratorCache::FairGeneratorCache()
+  : fFile(NULL),
+    fWriting(kFALSE),
+    fName(),
+    fNEvents(0),
+    fNEventsTotal(0),
+    fInputSize(0),
+    fInputTime(0)
+{
+}
+// ------------------------------------------------------------------------
+
+
+
+// -----   Destructor   ---------------------------------------------------
+FairGeneratorCache::~FairGeneratorCache()
+{
+  Close();
+}
+// ------------------------------------------------------------------------
+
+
+
+// -----   Private method StatInput   -------------------------------------
+Bool_t FairGeneratorCache::StatInput(const char* inputName)
+{
+  struct stat info;
+  if ( stat(inputName, &info) != 0 ) { return kFALSE; }
+  fInputSize = info.st_size;
+  fInputTime = info.st_mtime;
+  return kTRUE;
+}
+// ------------------------------------------------------------------------
+
+
+
+// -----   Public method OpenRead   ---------------------------------------
+Bool_t FairGeneratorCache::OpenRead(const char* cacheName, const char* inputName)
+{
+  Close();
+  if ( ! StatInput(inputName) ) { return kFALSE; }
+
+  fFile = fopen(cacheName, "rb");
+  if ( ! fFile ) { return kFALSE; }
+
+  FairGeneratorCacheHeader header;
+  if ( fread(&header, sizeof(header), 1, fFile) != 1
+       || header.fMagic != kMagic || header.fVersion != kVersion
+       || header.fEventSize != sizeof(FairGeneratorCacheEvent)
+       || header.fTrackSize != sizeof(FairGeneratorCacheTrack) ) {
+    LOG(WARNING) << "FairGeneratorCache: " << cacheName
+                 << " is no generator cache or was written by another version, ignored"
+                 << FairLogger::endl;
+    Close();
+    return kFALSE;
+  }
+  if ( header.fInputSize != fInputSize || header.fInputTime != fInputTime ) {
+    LOG(WARNING) << "FairGeneratorCache: " << inputName << " was modified after "
+                 << cacheName << " was written, cache ignored" << FairLogger::endl;
+    Close();
+    return kFALSE;
+  }
+
+  setvbuf(fFile, NULL, _IOFBF, kIOBufferSize);
+  fName = cacheName;
+  fWriting = kFALSE;
+  fNEvents = 0;
+  fNEventsTotal = header.fNEvents;
+  LOG(INFO) << "FairGeneratorCache: Reading " << fNEventsTotal
+            << " events from " << cacheName << FairLogger::endl;
+  return kTRUE;
+}
+// ------------------------------------------------------------------------
+
+
+
+// -----   Public method OpenWrite   --------------------------------------
+Bool_t FairGeneratorCache::OpenWrite(const char* cacheName, const char* inputName)
+{
+  Close();
+  if ( ! StatInput(inputName) ) { return kFALSE; }
+
+  std::string tmpName = std::string(cacheName) + ".tmp";
+  fFile = fopen(tmpName.c_str(), "wb");
+  if ( ! fFile ) {
+    LOG(WARNING) << "FairGeneratorCache: Cannot create " << tmpName
+                 << FairLogger::endl;
+    return kFALSE;
+  }
+  setvbuf(fFile, NULL, _IOFBF, kIOBufferSize);
+
+  // The number of events is filled in by Commit
+  FairGeneratorCacheHeader header = { kMagic, kVersion, sizeof(FairGeneratorCacheEvent),
+                                      sizeof(FairGeneratorCacheTrack), fInputSize, fInputTime, 0 };
+  if ( fwrite(&header, sizeof(header), 1, fFile) != 1 ) {
+    fclose(fFile);
+    fFile = NULL;
+    remove(tmpName.c_str());
+    return kFALSE;
+  }
+
+  fName = cacheName;
+  fWriting = kTRUE;
+  fNEvents = fNEventsTotal = 0;
+  LOG(INFO) << "FairGeneratorCache: Writing events of " << inputName
+            << " to " << cacheName << FairLogger::endl;
+  return kTRUE;
+}
+// ------------------------------------------------------------------------
+
+
+
+// -----   Public method Commit   -----------------------------------------
+Bool_t FairGeneratorCache::Commit()
+{
+  if ( ! IsWriting() ) { return kFALSE; }
+
+  std::string tmpName = fName + ".tmp";
+  FairGeneratorCacheHeader header = { kMagic, kVersion, sizeof(FairGeneratorCacheEvent),
+                                      sizeof(FairGeneratorCacheTrack), fInputSize, fInputTime, fNEvents };
+  Bool_t ok = fseek(fFile, 0, SEEK_SET) == 0
+              && fwrite(&header, sizeof(header), 1, fFile) == 1;
+  ok = (fclose(fFile) == 0) && ok;
+  fFile = NULL;
+  fWriting = kFALSE;
+
+  if ( ok && rename(tmpName.c_str(), fName.c_str()) == 0 ) {
+    LOG(INFO) << "FairGeneratorCache: " << fNEvents << " events written to "
+              << fName << FairLogger::endl;
+    return kTRUE;
+  }
+  LOG(WARNING) << "FairGeneratorCache: Could not write " << fName
+               << FairLogger::endl;
+  remove(tmpName.c_str());
+  return kFALSE;
+}
+// ------------------------------------------------------------------------
+
+
+
+// -----   Public method Close   ------------------------------------------
+void FairGeneratorCache::Close()
+{
+  if ( ! fFile ) { return; }
+
+  fclose(fFile);
+  fFile = NULL;
+  if ( fWriting ) {
+    LOG(INFO) << "FairGeneratorCache: Input file was not read to the end, "
+              << fName << " not created" << FairLogger::endl;
+    remove((fName + ".tmp").c_str());
+    fWriting = kFALSE;
+  }
+}
+// ------------------------------------------------------------------------
+
+
+
+// -----   Public method ReadEvent   --------------------------------------
+Bool_t FairGeneratorCache::ReadEvent(FairGeneratorCacheEvent& event,
+                                     std::vector<FairGeneratorCacheTrack>& tracks)
+{
+  if ( ! IsReading() || fNEvents >= fNEventsTotal ) { return kFALSE; }
+
+  if ( fread(&event, sizeof(event), 1, fFile) != 1 || event.fNTracks < 0 ) {
+    LOG(ERROR) << "FairGeneratorCache: " << fName << " is truncated"
+               << FairLogger::endl;
+    return kFALSE;
+  }
+  tracks.resize(event.fNTracks);
+  if ( event.fNTracks > 0
+       && fread(&tracks[0], sizeof(FairGeneratorCacheTrack), event.fNTracks, fFile)
+          != static_cast<size_t>(event.fNTracks) ) {
+    LOG(ERROR) << "FairGeneratorCache: " << fName << " is truncated"
+               << FairLogger::endl;
+    return kFALSE;
+  }
+  ++fNEvents;
+  return kTRUE;
+}
+// ------------------------------------------------------------------------
+
+
+
+// -----   Public method WriteEvent   -------------------------------------
+Bool_t FairGeneratorCache::WriteEvent(const FairGeneratorCacheEvent& event,
+                                      const std::vector<FairGeneratorCacheTrack>& tracks)
+{
+  if ( ! IsWriting() ) { return kFALSE; }
+
+  FairGeneratorCacheEvent record = event;
+  record.fNTracks = tracks.size();
+  if ( fwrite(&record, sizeof(record), 1, fFile) != 1
+       || ( ! tracks.empty()
+            && fwrite(&tracks[0], sizeof(FairGeneratorCacheTrack), tracks.size(), fFile) != tracks.size() ) ) {
+    LOG(WARNING) << "FairGeneratorCache: Error writing " << fName
+                 << ", cache not created" << FairLogger::endl;
+    Close();
+    return kFALSE;
+  }
+  ++fNEvents;
+  return kTRUE;
+}
+// ------------------------------------------------------------------------
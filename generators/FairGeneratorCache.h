@@ -0,0 +1,97 @@
+/********************************************************************************
+ *    Copyright (C) 2014 GSI Helmholtzzentrum fuer Schwerionenforschung GmbH    *
+ *                                                                              *
+ *              This software is distributed under the terms of the             *
+ *         GNU Lesser General Public Licence version 3 (LGPL) version 3,        *
+ *                  copied verbatim in the file "LICENSE"                       *
+ ********************************************************************************/
+// -------------------------------------------------------------------------
+// -----                FairGeneratorCache header file                 -----
+// -------------------------------------------------------------------------
+
+
+/** FairGeneratorCache.h
+ **
+ ** Binary copy of the events read by an Ascii generator. The first run
+ ** which reads the whole text file writes the events as they are given to
+ ** the FairPrimaryGenerator (PDG code, momentum, vertex) into the cache file;
+ ** later runs read the cache instead of parsing the text again.
+ **
+ ** The cache is written to <name>.tmp and renamed when the end of the input
+ ** is reached, so an interrupted conversion never leaves an incomplete cache.
+ ** The size and modification time of the text file are stored in the cache
+ ** and a cache which does not belong to the current input is ignored.
+ ** The numbers are written in the byte order of the machine.
+ **/
+
+
+#ifndef FAIRGENERATORCACHE_H
+#define FAIRGENERATORCACHE_H
+
+#include "Rtypes.h"                     // for Int_t, Bool_t, etc
+
+#include <stdio.h>                      // for FILE
+#include <string>                       // for string
+#include <vector>                       // for vector
+
+struct FairGeneratorCacheEvent
+{
+  Int_t    fEventId;
+  Int_t    fNTracks;
+  Double_t fB;                          // impact parameter [fm]
+  Double_t fBeamEnergy;                 // beam energy [GeV], 0 if not known
+  Double_t fVx, fVy, fVz;               // event vertex [cm]
+};
+
+struct FairGeneratorCacheTrack
+{
+  Int_t    fPdg;
+  Int_t    fReserved;
+  Double_t fPx, fPy, fPz;               // momentum [GeV]
+};
+
+class FairGeneratorCache
+{
+  public:
+
+    FairGeneratorCache();
+    ~FairGeneratorCache();
+
+    /** Opens the cache for reading, kFALSE if it does not exist or does
+     ** not belong to the input file **/
+    Bool_t OpenRead(const char* cacheName, const char* inputName);
+
+    /** Starts the conversion of the input file into the cache **/
+    Bool_t OpenWrite(const char* cacheName, const char* inputName);
+
+    /** Finishes the conversion, called when the input file ends **/
+    Bool_t Commit();
+
+    /** Closes the cache, a conversion which is not committed is discarded **/
+    void Close();
+
+    Bool_t IsReading() const { return fFile && ! fWriting; }
+    Bool_t IsWriting() const { return fFile && fWriting; }
+
+    /** Next event from the cache, kFALSE at the end **/
+    Bool_t ReadEvent(FairGeneratorCacheEvent& event, std::vector<FairGeneratorCacheTrack>& tracks);
+
+    Bool_t WriteEvent(const FairGeneratorCacheEvent& event, const std::vector<FairGeneratorCacheTrack>& tracks);
+
+  private:
+
+    FILE* fFile;
+    Bool_t fWriting;
+    std::string fName;                  // name of the cache file
+    ULong64_t fNEvents;                 // events read or written
+    ULong64_t fNEventsTotal;            // events in the cache
+    ULong64_t fInputSize;
+    Long64_t  fInputTime;
+
+    Bool_t StatInput(const char* inputName);
+
+    FairGeneratorCache(const FairGeneratorCache&);
+    FairGeneratorCache& operator=(const FairGeneratorCache&);
+};
+
+#endif
@@ -0,0 +1,318 @@
+/********************************************************************************
+ *    Copyright (C) 2014 GSI Helmholtzzentrum fuer Schwerionenforschung GmbH    *
+ *                                                                              *
+ *              This software is distributed under the terms of the             *
+ *         GNU Lesser General Public Licence version 3 (LGPL) version 3,        *
+ *                  copied verbatim in the file "LICENSE"                       *
+ ********************************************************************************/
+// -------------------------------------------------------------------------
+// -----             FairGeneratorTextReader source file               -----
+// -------------------------------------------------------------------------
+#include "FairGeneratorTextReader.h"
+
+#include "FairLogger.h"                 // for logging
+
+#include <climits>                      // for INT_MAX, INT_MIN
+#include <stdlib.h>                     // for strtod
+#include <string.h>                     // for memchr, memmove, strlen
+#include <string>                       // for string
+#include <unistd.h>                     // for access
+
+namespace
+{
+// Data read from the file at once
+const size_t kBlockSize = 4 << 20;
+// Longest number which is guaranteed to be in the buffer when it is parsed
+const size_t kMaxToken = 256;
+
+const Double_t kPow10[] = {
+  1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+  1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+inline Bool_t IsDigit(char c) { return c >= '0' && c <= '9'; }
+inline Bool_t IsBlank(char c) { return c == ' ' || c == '\n' || c == '\t' || c == '\r' || c == '\f' || c == '\v'; }
+
+// Converts the number at p, which has to be terminated by a character which
+// is no part of a number. Numbers with up to 15 significant digits and a
+// decimal exponent of at most 22 are exact in double precision, so the result
+// of a multiplication or division is correctly rounded; everything else is
+// left to strtod.
+const char* ParseDouble(const char* p, Double_t& value)
+{
+  const char* start = p;
+  Bool_t negative = kFALSE;
+  if ( *p == '-' || *p == '+' ) { negative = (*p++ == '-'); }
+
+  ULong64_t mantissa = 0;
+  Int_t nSignificant = 0, nDigits = 0, exponent = 0;
+  for ( ; IsDigit(*p); ++p, ++nDigits) {
+    if ( nSignificant < 19 ) {
+      mantissa = 10 * mantissa + (*p - '0');
+      if ( mantissa ) { ++nSignificant; }
+    } else {
+      ++exponent;
+    }
+  }
+  if ( *p == '.' ) {
+    for (++p; IsDigit(*p); ++p, ++nDigits) {
+      if ( nSignificant < 19 ) {
+        mantissa = 10 * mantissa + (*p - '0');
+        if ( mantissa ) { ++nSignificant; }
+        --exponent;
+      }
+    }
+  }
+  if ( nDigits == 0 ) { return start; }
+
+  if ( *p == 'e' || *p == 'E' ) {
+    const char* e = p + 1;
+    Bool_t negativeExp = kFALSE;
+    if ( *e == '-' || *e == '+' ) { negativeExp = (*e++ == '-'); }
+    if ( IsDigit(*e) ) {
+      Int_t exp = 0;
+      for ( ; IsDigit(*e); ++e) {
+        if ( exp < 10000 ) { exp = 10 * exp + (*e - '0'); }
+      }
+      exponent += negativeExp ? -exp : exp;
+      p = e;
+    }
+  }
+
+  if ( nSignificant <= 15 && exponent >= -22 && exponent <= 22 ) {
+    value = static_cast<Double_t>(mantissa);
+    value = exponent < 0 ? value / kPow10[-exponent] : value * kPow10[exponent];
+    if ( negative ) { value = -value; }
+    return p;
+  }
+
+  char* end = 0;
+  value = strtod(start, &end);
+  return end;
+}
+}
+
+// -----   Default constructor   ------------------------------------------
+FairGeneratorTextReader::FairGeneratorTextReader()
+  : fFile(NULL),
+    fPipe(kFALSE),
+    fEof(kTRUE),
+    fBuffer(),
+    fPos(0),
+    fEnd(0)
+{
+}
+// ------------------------------------------------------------------------
+
+
+
+// -----   Destructor   ---------------------------------------------------
+FairGeneratorTextReader::~FairGeneratorTextReader()
+{
+  Close();
+}
+// ------------------------------------------------------------------------
+
+
+
+// -----   Public method Open   -------------------------------------------
+Bool_t FairGeneratorTextReader::Open(const char* fileName)
+{
+  Close();
+
+  size_t length = strlen(fileName);
+  if ( length > 3 && strcmp(fileName + length - 3, ".gz") == 0 ) {
+    // popen succeeds also if the file is missing, so check it here
+    if ( access(fileName, R_OK) != 0 ) { return kFALSE; }
+    std::string command = "gzip -dc '";
+    for (const char* c = fileName; *c; ++c) {
+      if ( *c == '\'' ) { command += "'\\''"; }
+      else { command += *c; }
+    }
+    command += "'";
+    fFile = popen(command.c_str(), "r");
+    fPipe = kTRUE;
+  } else {
+    fFile = fopen(fileName, "r");
+    fPipe = kFALSE;
+  }
+  if ( ! fFile ) { return kFALSE; }
+
+  // One spare byte for the terminating zero behind the data
+  fBuffer.resize(kBlockSize + 1);
+  fBuffer[0] = '\0';
+  fPos = fEnd = 0;
+  fEof = kFALSE;
+  return kTRUE;
+}
+// ------------------------------------------------------------------------
+
+
+
+// -----   Public method Close   ------------------------------------------
+void FairGeneratorTextReader::Close()
+{
+  if ( fFile ) {
+    if ( fPipe ) {
+      if ( pclose(fFile) != 0 && ! fEof ) {
+        // gzip is stopped by the closed pipe if the file was not read to the end
+        LOG(DEBUG) << "FairGeneratorTextReader: gzip terminated before the end of the file"
+                   << FairLogger::endl;
+      }
+    } else {
+      fclose(fFile);
+    }
+    fFile = NULL;
+  }
+  std::vector<char>().swap(fBuffer);
+  fPos = fEnd = 0;
+  fEof = kTRUE;
+}
+// ------------------------------------------------------------------------
+
+
+
+// -----   Private method Fill   ------------------------------------------
+void FairGeneratorTextReader::Fill(size_t nChars)
+{
+  if ( fEnd - fPos >= nChars || fEof ) { return; }
+
+  memmove(&fBuffer[0], &fBuffer[fPos], fEnd - fPos);
+  fEnd -= fPos;
+  fPos = 0;
+
+  size_t nRead = fread(&fBuffer[fEnd], 1, kBlockSize - fEnd, fFile);
+  if ( nRead < kBlockSize - fEnd ) {
+    if ( ferror(fFile) ) {
+      LOG(ERROR) << "FairGeneratorTextReader: Error reading input file"
+                 << FairLogger::endl;
+    }
+    fEof = kTRUE;
+  }
+  fEnd += nRead;
+  fBuffer[fEnd] = '\0';
+}
+// ------------------------------------------------------------------------
+
+
+
+// -----   Private method SkipBlanks   ------------------------------------
+Bool_t FairGeneratorTextReader::SkipBlanks()
+{
+  for (;;) {
+    while ( fPos < fEnd && IsBlank(fBuffer[fPos]) ) { ++fPos; }
+    if ( fPos < fEnd ) { break; }
+    if ( fEof ) { return kFALSE; }
+    Fill(1);
+  }
+  Fill(kMaxToken);
+  return kTRUE;
+}
+// ------------------------------------------------------------------------
+
+
+
+// -----   Public method AtEnd   ------------------------------------------
+Bool_t FairGeneratorTextReader::AtEnd()
+{
+  Fill(1);
+  return fPos == fEnd;
+}
+// ------------------------------------------------------------------------
+
+
+
+// -----   Public method Peek   -------------------------------------------
+Int_t FairGeneratorTextReader::Peek()
+{
+  Fill(1);
+  return fPos < fEnd ? static_cast<unsigned char>(fBuffer[fPos]) : -1;
+}
+// ------------------------------------------------------------------------
+
+
+
+// -----   Public method ReadInt   ----------------------------------------
+Bool_t FairGeneratorTextReader::ReadInt(Int_t& value)
+{
+  if ( ! SkipBlanks() ) { return kFALSE; }
+
+  const char* p = &fBuffer[fPos];
+  Bool_t negative = kFALSE;
+  if ( *p == '-' || *p == '+' ) { negative = (*p++ == '-'); }
+  if ( ! IsDigit(*p) ) { return kFALSE; }
+
+  Long64_t result = 0;
+  for ( ; IsDigit(*p); ++p) {
+    result = 10 * result + (*p - '0');
+    if ( result > Long64_t(INT_MAX) + 1 ) { return kFALSE; }
+  }
+  if ( negative ) { result = -result; }
+  if ( result > INT_MAX || result < INT_MIN ) { return kFALSE; }
+
+  value = static_cast<Int_t>(result);
+  fPos = p - &fBuffer[0];
+  return kTRUE;
+}
+// ------------------------------------------------------------------------
+
+
+
+// -----   Public method ReadDouble   -------------------------------------
+Bool_t FairGeneratorTextReader::ReadDouble(Double_t& value)
+{
+  if ( ! SkipBlanks() ) { return kFALSE; }
+
+  const char* start = &fBuffer[fPos];
+  const char* end = ParseDouble(start, value);
+  if ( end == start ) { return kFALSE; }
+  fPos += end - start;
+  return kTRUE;
+}
+// ------------------------------------------------------------------------
+
+
+
+// -----   Public method ReadFloat   --------------------------------------
+Bool_t FairGeneratorTextReader::ReadFloat(Float_t& value)
+{
+  Double_t result = 0.;
+  if ( ! ReadDouble(result) ) { return kFALSE; }
+  value = static_cast<Float_t>(result);
+  return kTRUE;
+}
+// ------------------------------------------------------------------------
+
+
+
+// -----   Public method Skip   -------------------------------------------
+void FairGeneratorTextReader::Skip(Int_t nChars)
+{
+  for (Int_t i = 0; i < nChars; ++i) {
+    if ( fPos == fEnd ) {
+      Fill(1);
+      if ( fPos == fEnd ) { return; }
+    }
+    if ( fBuffer[fPos++] == '\n' ) { return; }
+  }
+}
+// ------------------------------------------------------------------------
+
+
+
+// -----   Public method SkipLine   ---------------------------------------
+void FairGeneratorTextReader::SkipLine()
+{
+  for (;;) {
+    const char* begin = &fBuffer[fPos];
+    const char* newline = static_cast<const char*>(memchr(begin, '\n', fEnd - fPos));
+    if ( newline ) {
+      fPos += newline - begin + 1;
+      return;
+    }
+    fPos = fEnd;
+    if ( fEof ) { return; }
+    Fill(1);
+  }
+}
+// ------------------------------------------------------------------------
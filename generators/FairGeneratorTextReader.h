@@ -0,0 +1,83 @@
+/********************************************************************************
+ *    Copyright (C) 2014 GSI Helmholtzzentrum fuer Schwerionenforschung GmbH    *
+ *                                                                              *
+ *              This software is distributed under the terms of the             *
+ *         GNU Lesser General Public Licence version 3 (LGPL) version 3,        *
+ *                  copied verbatim in the file "LICENSE"                       *
+ ********************************************************************************/
+// -------------------------------------------------------------------------
+// -----             FairGeneratorTextReader header file               -----
+// -------------------------------------------------------------------------
+
+
+/** FairGeneratorTextReader.h
+ **
+ ** Reader for the text input of the Ascii event generators. The file is
+ ** read in large blocks into a buffer and numbers are converted directly
+ ** from the buffer, which is much faster than one fscanf or stream
+ ** extraction per value. Files with the extension .gz are decompressed
+ ** on the fly by reading them through gzip.
+ **
+ ** The functions follow the scanf conventions: ReadInt/ReadDouble skip
+ ** blanks and newlines before the number, Skip(n) behaves like fgets with
+ ** a buffer of n+1 characters.
+ **/
+
+
+#ifndef FAIRGENERATORTEXTREADER_H
+#define FAIRGENERATORTEXTREADER_H
+
+#include "Rtypes.h"                     // for Int_t, Bool_t, etc
+
+#include <stdio.h>                      // for FILE
+#include <vector>                       // for vector
+
+class FairGeneratorTextReader
+{
+  public:
+
+    FairGeneratorTextReader();
+    ~FairGeneratorTextReader();
+
+    /** Opens the file, compressed files (*.gz) are read through gzip **/
+    Bool_t Open(const char* fileName);
+    void Close();
+    Bool_t IsOpen() const { return fFile != NULL; }
+
+    /** kTRUE if there are no more characters in the file **/
+    Bool_t AtEnd();
+
+    /** Next character without consuming it, -1 at the end of the file **/
+    Int_t Peek();
+
+    /** Read the next number, kFALSE if there is none **/
+    Bool_t ReadInt(Int_t& value);
+    Bool_t ReadFloat(Float_t& value);
+    Bool_t ReadDouble(Double_t& value);
+
+    /** Skip at most nChars characters, but not beyond the end of the line **/
+    void Skip(Int_t nChars);
+
+    /** Skip the rest of the current line including the newline **/
+    void SkipLine();
+
+  private:
+
+    FILE* fFile;
+    Bool_t fPipe;                    // fFile is read from gzip
+    Bool_t fEof;                     // no more data in fFile
+    std::vector<char> fBuffer;
+    size_t fPos;                     // next character in fBuffer
+    size_t fEnd;                     // end of the valid data in fBuffer
+
+    /** Make at least nChars characters available, unless the file ends **/
+    void Fill(size_t nChars);
+
+    /** Skip blanks and newlines and make a complete number available **/
+    Bool_t SkipBlanks();
+
+    FairGeneratorTextReader(const FairGeneratorTextReader&);
+    FairGeneratorTextReader& operator=(const FairGeneratorTextReader&);
+};
+
+#endif
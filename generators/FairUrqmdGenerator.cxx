@@ -11,17 +11,15 @@
 // -------------------------------------------------------------------------
 #include "FairUrqmdGenerator.h"
 
+#include "FairGeneratorTextReader.h"   // for FairGeneratorTextReader
 #include "FairMCEventHeader.h"          // for FairMCEventHeader
 #include "FairPrimaryGenerator.h"       // for FairPrimaryGenerator
 #include "FairLogger.h"                 // for logging
 
-#include <iosfwd>                       // for ostream, ifstream
 #include "TDatabasePDG.h"               // for TDatabasePDG
-#include "TLorentzVector.h"             // for TLorentzVector
 #include "TMath.h"                      // for Sqrt, sqrt
 #include "TParticlePDG.h"               // for TParticlePDG
 #include "TString.h"                    // for TString, operator+
-#include "TVector3.h"                   // for TVector3
 
 #include <stdlib.h>                     // for getenv
 #include <climits>                      // for INT_MAX
@@ -31,6 +29,9 @@
 FairUrqmdGenerator::FairUrqmdGenerator()
   :FairGenerator(),
    fInputFile(NULL),
+   fCache(NULL),
+   fEvent(),
+   fTracks(),
    fParticleTable(),
    fFileName(NULL)
 {
@@ -43,34 +44,28 @@ FairUrqmdGenerator::FairUrqmdGenerator()
 FairUrqmdGenerator::FairUrqmdGenerator(const char* fileName)
   :FairGenerator(),
    fInputFile(NULL),
+   fCache(NULL),
+   fEvent(),
+   fTracks(),
    fParticleTable(),
    fFileName(fileName)
 {
   //  fFileName = fileName;
-  LOG(INFO) << "FairUrqmdGenerator: Opening input file " 
-	    << fileName << FairLogger::endl;
-  fInputFile = fopen(fFileName, "r");
-  if ( ! fInputFile ) { 
-    LOG(FATAL) << "Cannot open input file."
-	       << FairLogger::endl; 
-  }
+  OpenInput();
   ReadConversionTable();
 }
 // ------------------------------------------------------------------------
 FairUrqmdGenerator::FairUrqmdGenerator(const char* fileName,  const char* conversion_table)
 :FairGenerator(),
 fInputFile(NULL),
+fCache(NULL),
+fEvent(),
+fTracks(),
 fParticleTable(),
 fFileName(fileName)
 {
     //  fFileName = fileName;
-    LOG(INFO) << "FairUrqmdGenerator: Opening input file "
-    << fileName << FairLogger::endl;
-    fInputFile = fopen(fFileName, "r");
-    if ( ! fInputFile ) {
-        LOG(FATAL) << "Cannot open input file."
-	       << FairLogger::endl;
-    }
+    OpenInput();
     ReadConversionTable(conversion_table);
 }
 // ------------------------------------------------------------------------
@@ -83,10 +78,10 @@ FairUrqmdGenerator::~FairUrqmdGenerator()
 {
   //  LOG(DEBUG) << "Enter Destructor of FairUrqmdGenerator"
   //             << FairLogger::endl;
-  if ( fInputFile ) {
-    fclose(fInputFile);
-    fInputFile = NULL;
-  }
+  delete fInputFile;
+  fInputFile = NULL;
+  delete fCache;
+  fCache = NULL;
   fParticleTable.clear();
   //  LOG(DEBUG) << "Leave Destructor of FairUrqmdGenerator"
   //             << FairLogger::endl;
@@ -99,19 +94,126 @@ FairUrqmdGenerator::~FairUrqmdGenerator()
 Bool_t FairUrqmdGenerator::ReadEvent(FairPrimaryGenerator* primGen)
 {
 
+  // ---> Check for primary generator
+  if ( ! primGen ) {
+    LOG(ERROR) << "FairUrqmdGenerator::ReadEvent: "
+	       << "No PrimaryGenerator!" << FairLogger::endl;
+    return kFALSE;
+  }
+
+  // ---> Read the event from the cache or the input file
+  if ( ! NextEvent(kTRUE) ) { return kFALSE; }
+
+  LOG(INFO) << "FairUrqmdGenerator: Event " << fEvent.fEventId << ",  b = " << fEvent.fB
+	    << " fm,  multiplicity " << fEvent.fNTracks  << ", ekin: "
+	    << fEvent.fBeamEnergy << FairLogger::endl;
+
+  // Set event id and impact parameter in MCEvent if not yet done
+  FairMCEventHeader* event = primGen->GetEvent();
+  if ( event && (! event->IsSet()) ) {
+    event->SetEventID(fEvent.fEventId);
+    event->SetB(fEvent.fB);
+    event->MarkSet(kTRUE);
+  }
+
+  // ---> Give the tracks, already transformed to the lab, to PrimaryGenerator
+  for (size_t itrack=0; itrack<fTracks.size(); itrack++) {
+    const FairGeneratorCacheTrack& track = fTracks[itrack];
+    primGen->AddTrack(track.fPdg, track.fPx, track.fPy, track.fPz, 0., 0., 0.);
+  }
+
+  return kTRUE;
+}
+// ------------------------------------------------------------------------
+
+
+// -----   Public method ReadEvent   --------------------------------------
+Bool_t FairUrqmdGenerator::SkipEvents(Int_t count)
+{
+  if (count<=0) { return kTRUE; }
+
+  for(Int_t ii=0; ii<count; ii++) {
+    if ( ! NextEvent(kFALSE) ) { return kFALSE; }
+    LOG(INFO) << "FairUrqmdGenerator: Event " << fEvent.fEventId << " skipped!"
+	      << FairLogger::endl;
+  }
+  return kTRUE;
+}
+// ------------------------------------------------------------------------
+
+
+
+// -----   Public method SetCacheFile   -----------------------------------
+void FairUrqmdGenerator::SetCacheFile(const char* cacheName)
+{
+  if ( ! fFileName ) { return; }
+
+  TString name = cacheName ? TString(cacheName) : TString(fFileName) + ".fgc";
+  if ( ! fCache ) { fCache = new FairGeneratorCache(); }
+  if ( fCache->OpenRead(name, fFileName) ) {
+    // The text input is not needed any more
+    delete fInputFile;
+    fInputFile = NULL;
+  } else {
+    fCache->OpenWrite(name, fFileName);
+  }
+}
+// ------------------------------------------------------------------------
+
+
+
+// -----   Private method OpenInput   -------------------------------------
+void FairUrqmdGenerator::OpenInput()
+{
+  LOG(INFO) << "FairUrqmdGenerator: Opening input file "
+	    << fFileName << FairLogger::endl;
+  fInputFile = new FairGeneratorTextReader();
+  if ( ! fInputFile->Open(fFileName) ) {
+    delete fInputFile;
+    fInputFile = NULL;
+    LOG(FATAL) << "Cannot open input file."
+	       << FairLogger::endl;
+  }
+}
+// ------------------------------------------------------------------------
+
+
+
+// -----   Private method NextEvent   -------------------------------------
+Bool_t FairUrqmdGenerator::NextEvent(Bool_t readTracks)
+{
+  if ( fCache && fCache->IsReading() ) {
+    if ( fCache->ReadEvent(fEvent, fTracks) ) { return kTRUE; }
+    LOG(INFO) << "FairUrqmdGenerator : End of input file reached."
+	      << FairLogger::endl;
+    fCache->Close();
+    return kFALSE;
+  }
+
   // ---> Check for input file
   if ( ! fInputFile ) {
-    LOG(ERROR) << "FairUrqmdGenerator: Input file not open! " 
+    LOG(ERROR) << "FairUrqmdGenerator: Input file not open! "
 	       << FairLogger::endl;
     return kFALSE;
   }
 
-  // ---> Check for primary generator
-  if ( ! primGen ) {
-    LOG(ERROR) << "FairUrqmdGenerator::ReadEvent: "
-	       << "No PrimaryGenerator!" << FairLogger::endl;
+  Bool_t writeCache = fCache && fCache->IsWriting();
+  if ( ! ReadTextEvent(readTracks || writeCache) ) {
+    // The input file is closed at its end, then the cache is complete
+    if ( writeCache && ! fInputFile ) { fCache->Commit(); }
     return kFALSE;
   }
+  if ( writeCache ) { fCache->WriteEvent(fEvent, fTracks); }
+  return kTRUE;
+}
+// ------------------------------------------------------------------------
+
+
+
+// -----   Private method ReadTextEvent   ---------------------------------
+Bool_t FairUrqmdGenerator::ReadTextEvent(Bool_t readTracks)
+{
+  FairGeneratorTextReader& in = *fInputFile;
 
   // ---> Define event variables to be read from file
   int evnr=0, ntracks=0, aProj=0, zProj=0, aTarg=0, zTarg=0;
@@ -121,54 +223,56 @@ Bool_t FairUrqmdGenerator::ReadEvent(FairPrimaryGenerator* primGen)
   float ppx=0., ppy=0., ppz=0., m=0.;
 
   // ---> Read and check first event header line from input file
-  char read[200];
-  fgets(read, 200, fInputFile);
-  if ( feof(fInputFile) ) {
-    LOG(INFO) << "FairUrqmdGenerator : End of input file reached." 
+  if ( in.AtEnd() ) {
+    LOG(INFO) << "FairUrqmdGenerator : End of input file reached."
 	      << FairLogger::endl;
-    fclose(fInputFile);
+    delete fInputFile;
     fInputFile = NULL;
     return kFALSE;
   }
-  if ( read[0] != 'U' ) {
-    LOG(ERROR) << "FairUrqmdGenerator: Wrong event header" 
+  if ( in.Peek() != 'U' ) {
+    LOG(ERROR) << "FairUrqmdGenerator: Wrong event header"
 	       << FairLogger::endl;
     return kFALSE;
   }
-
-  Int_t retval = 0;
+  in.SkipLine();
 
   // ---> Read rest of event header
-  fgets(read, 26, fInputFile);
-  retval = fscanf(fInputFile, "%d", &aProj);
-  CheckReturnValue(retval);
-  retval = fscanf(fInputFile, "%d", &zProj);
-  CheckReturnValue(retval);
-  fgets(read, 25, fInputFile);
-  retval = fscanf(fInputFile, "%d", &aTarg);
-  CheckReturnValue(retval);
-  retval = fscanf(fInputFile, "%d", &zTarg);
-  CheckReturnValue(retval);
-  fgets(read, 200, fInputFile);
-  fgets(read, 200, fInputFile);
-  fgets(read, 36, fInputFile);
-  retval = fscanf(fInputFile, "%f", &b);
-  CheckReturnValue(retval);
-  fgets(read, 200, fInputFile);
-  fgets(read, 39, fInputFile);
-  retval = fscanf(fInputFile, "%e", &ekin);
-  CheckReturnValue(retval);
-  fgets(read, 200, fInputFile);
-  fgets(read, 7, fInputFile);
-  retval = fscanf(fInputFile, "%d", &evnr);
-  CheckReturnValue(retval);
-  fgets(read, 200, fInputFile);
-  for (int iline=0; iline<8; iline++)  { fgets(read, 200,fInputFile); }
-  retval = fscanf(fInputFile, "%d", &ntracks);
+  in.Skip(25);
+  CheckReturnValue(in.ReadInt(aProj));
+  CheckReturnValue(in.ReadInt(zProj));
+  in.Skip(24);
+  CheckReturnValue(in.ReadInt(aTarg));
+  CheckReturnValue(in.ReadInt(zTarg));
+  in.SkipLine();
+  in.SkipLine();
+  in.Skip(35);
+  CheckReturnValue(in.ReadFloat(b));
+  in.SkipLine();
+  in.Skip(38);
+  CheckReturnValue(in.ReadFloat(ekin));
+  in.SkipLine();
+  in.Skip(6);
+  CheckReturnValue(in.ReadInt(evnr));
+  in.SkipLine();
+  for (int iline=0; iline<8; iline++)  { in.SkipLine(); }
+  Bool_t ok = in.ReadInt(ntracks);
   if (ntracks < 0 || ntracks > (INT_MAX-1)) LOG(FATAL) << "Error reading the number of events from event header." << FairLogger::endl;
-  CheckReturnValue(retval);
-  fgets(read, 200, fInputFile);
-  fgets(read, 200, fInputFile);
+  CheckReturnValue(ok);
+  in.SkipLine();
+  in.SkipLine();
+
+  fEvent.fEventId = evnr;
+  fEvent.fNTracks = ntracks;
+  fEvent.fB = b;
+  fEvent.fBeamEnergy = ekin;
+  fEvent.fVx = fEvent.fVy = fEvent.fVz = 0.;
+  fTracks.clear();
+
+  if ( ! readTracks ) {
+    for(int itrack=0; itrack<ntracks; itrack++) { in.SkipLine(); }
+    return kTRUE;
+  }
 
   // ---> Calculate beta and gamma for Lorentztransformation
   TDatabasePDG* pdgDB = TDatabasePDG::Instance();
@@ -180,52 +284,34 @@ Bool_t FairUrqmdGenerator::ReadEvent(FairPrimaryGenerator* primGen)
   Double_t betaCM  = pBeam / (eBeam + kProtonMass);
   Double_t gammaCM = TMath::Sqrt( 1. / ( 1. - betaCM*betaCM) );
 
-  LOG(INFO) << "FairUrqmdGenerator: Event " << evnr << ",  b = " << b
-	    << " fm,  multiplicity " << ntracks  << ", ekin: " 
-	    << ekin << FairLogger::endl;
-
-  // Set event id and impact parameter in MCEvent if not yet done
-  FairMCEventHeader* event = primGen->GetEvent();
-  if ( event && (! event->IsSet()) ) {
-    event->SetEventID(evnr);
-    event->SetB(b);
-    event->MarkSet(kTRUE);
-  }
-
+  fTracks.reserve(ntracks);
 
   // ---> Loop over tracks in the current event
   for(int itrack=0; itrack<ntracks; itrack++) {
 
     // Read momentum and PID from file
-    fgets(read, 81, fInputFile);
-    retval = fscanf(fInputFile, "%e", &ppx);
-    CheckReturnValue(retval);
-    retval = fscanf(fInputFile, "%e", &ppy);
-    CheckReturnValue(retval);
-    retval = fscanf(fInputFile, "%e", &ppz);
-    CheckReturnValue(retval);
-    retval = fscanf(fInputFile, "%e", &m);
-    CheckReturnValue(retval);
-    retval = fscanf(fInputFile, "%d", &ityp);
-    CheckReturnValue(retval);
-    retval = fscanf(fInputFile, "%d", &i3);
-    CheckReturnValue(retval);
-    retval = fscanf(fInputFile, "%d", &ichg);
-    CheckReturnValue(retval);
-    fgets(read, 200, fInputFile);
+    in.Skip(80);
+    CheckReturnValue(in.ReadFloat(ppx));
+    CheckReturnValue(in.ReadFloat(ppy));
+    CheckReturnValue(in.ReadFloat(ppz));
+    CheckReturnValue(in.ReadFloat(m));
+    CheckReturnValue(in.ReadInt(ityp));
+    CheckReturnValue(in.ReadInt(i3));
+    CheckReturnValue(in.ReadInt(ichg));
+    in.SkipLine();
 
     // Convert UrQMD type and charge to unique pid identifier
     if (ityp >= 0) { pid =  1000 * (ichg+2) + ityp; }
     else { pid = -1000 * (ichg+2) + ityp; }
 
     // Convert Unique PID into PDG particle code
-    if (fParticleTable.find(pid) == fParticleTable.end()) {
+    std::map<Int_t,Int_t>::const_iterator entry = fParticleTable.find(pid);
+    if (entry == fParticleTable.end()) {
       LOG(WARNING) << "FairUrqmdGenerator: PID " << ityp << " charge "
-		   << ichg << " not found in table (" << pid << ")" 
+		   << ichg << " not found in table (" << pid << ")"
 		   << FairLogger::endl;
       continue;
     }
-    Int_t pdgID = fParticleTable[pid];
 
     // Lorentztransformation to lab
     Double_t mass = Double_t(m);
@@ -234,107 +320,15 @@ Bool_t FairUrqmdGenerator::ReadEvent(FairPrimaryGenerator* primGen)
     Double_t pz   = Double_t(ppz);
     Double_t e    = sqrt( mass*mass + px*px + py*py + pz*pz );
     pz = gammaCM * ( pz + betaCM * e );
-    Double_t ee = sqrt( mass*mass + px*px + py*py + pz*pz );
-
-    TVector3 aa(px,py,pz);
-    TLorentzVector pp;
-    pp.SetPx( px );
-    pp.SetPy( py );
-    pp.SetPz( pz);
-    pp.SetE( ee );
-
-    // Give track to PrimaryGenerator
-    primGen->AddTrack(pdgID, px, py, pz, 0., 0., 0.);
 
+    FairGeneratorCacheTrack track = { entry->second, 0, px, py, pz };
+    fTracks.push_back(track);
   }
 
   return kTRUE;
 }
 // ------------------------------------------------------------------------
 
-
-// -----   Public method ReadEvent   --------------------------------------
-Bool_t FairUrqmdGenerator::SkipEvents(Int_t count)
-{
-  if (count<=0) { return kTRUE; }
-
-  for(Int_t ii=0; ii<count; ii++) {
-    // ---> Check for input file
-    if ( ! fInputFile ) {
-      LOG(ERROR) << "FairUrqmdGenerator: Input file not open! " 
-		 << FairLogger::endl;
-      return kFALSE;
-    }
-
-    // ---> Define event variables to be read from file
-    int evnr=0, ntracks=0, aProj=0, zProj=0, aTarg=0, zTarg=0;
-    float b = 0., ekin = 0.;
-
-    // ---> Read and check first event header line from input file
-    char read[200];
-    fgets(read, 200, fInputFile);
-    if ( feof(fInputFile) ) {
-      LOG(INFO) << "FairUrqmdGenerator : End of input file reached." 
-		<< FairLogger::endl;
-      fclose(fInputFile);
-      fInputFile = NULL;
-      return kFALSE;
-    }
-    if ( read[0] != 'U' ) {
-      LOG(ERROR) << "FairUrqmdGenerator: Wrong event header" 
-		 << FairLogger::endl;
-      return kFALSE;
-    }
-
-    Int_t retval = 0;
-
-    // ---> Read rest of event header
-    fgets(read, 26, fInputFile);
-    retval = fscanf(fInputFile, "%d", &aProj);
-    CheckReturnValue(retval);
-    retval = fscanf(fInputFile, "%d", &zProj);
-    CheckReturnValue(retval);
-    fgets(read, 25, fInputFile);
-    retval = fscanf(fInputFile, "%d", &aTarg);
-    CheckReturnValue(retval);
-    retval = fscanf(fInputFile, "%d", &zTarg);
-    CheckReturnValue(retval);
-    fgets(read, 200, fInputFile);
-    fgets(read, 200, fInputFile);
-    fgets(read, 36, fInputFile);
-    retval = fscanf(fInputFile, "%f", &b);
-    CheckReturnValue(retval);
-    fgets(read, 200, fInputFile);
-    fgets(read, 39, fInputFile);
-    retval = fscanf(fInputFile, "%e", &ekin);
-    CheckReturnValue(retval);
-    fgets(read, 200, fInputFile);
-    fgets(read, 7, fInputFile);
-    retval = fscanf(fInputFile, "%d", &evnr);
-    CheckReturnValue(retval);
-    fgets(read, 200, fInputFile);
-    for (int iline=0; iline<8; iline++)  { fgets(read, 200,fInputFile); }
-    retval = fscanf(fInputFile, "%d", &ntracks);
-    if (ntracks < 0 || ntracks > (INT_MAX-1)) LOG(FATAL) << "Error reading the number of events from event header." << FairLogger::endl;
-    CheckReturnValue(retval);
-    fgets(read, 200, fInputFile);
-    fgets(read, 200, fInputFile);
-
-    LOG(INFO) << "FairUrqmdGenerator: Event " << evnr << " skipped!" 
-	      << FairLogger::endl;
-
-    // ---> Loop over tracks in the current event
-    for(int itrack=0; itrack<ntracks; itrack++) {
-
-      // Read momentum and PID from file
-      fgets(read, 81, fInputFile);
-      fgets(read, 200, fInputFile);
-    }
-  }
-  return kTRUE;
-}
-// ------------------------------------------------------------------------
-
 // -----   Private method ReadConverisonTable   ---------------------------
 void FairUrqmdGenerator::ReadConversionTable(TString conversion_table)
 {
@@ -18,6 +18,9 @@
  The FairUrqmdGenerator reads the output file 14 (ftn14) from UrQMD. The UrQMD
  calculation has to be performed in the CM system of the collision; Lorentz
  transformation into the lab is performed by this class.
+ The file can be compressed with gzip (extension .gz). With SetCacheFile
+ the events are converted once into a binary cache (see FairGeneratorCache),
+ which is read instead of the text file in the following runs.
  Derived from FairGenerator.
 **/
 
@@ -27,12 +30,14 @@
 #define FAIRURQMDGENERATOR_H
 
 #include "FairGenerator.h"              // for FairGenerator
+#include "FairGeneratorCache.h"         // for FairGeneratorCacheEvent, etc
 
 #include "Rtypes.h"                     // for Int_t, Bool_t, etc
 
-#include <stdio.h>                      // for FILE
 #include <map>                          // for map
+#include <vector>                       // for vector
 
+class FairGeneratorTextReader;
 class FairPrimaryGenerator;
 
 class FairUrqmdGenerator : public FairGenerator
@@ -70,9 +75,22 @@ class FairUrqmdGenerator : public FairGenerator
     /** Skip defined number of events in file **/
     Bool_t SkipEvents(Int_t count);
 
+    /** Read the events from a binary cache of the input file. If the cache
+     ** does not exist or is outdated, it is written while the input file is
+     ** read and becomes available when the end of the input file is reached.
+     ** Has to be called before the first event is read.
+     ** @param cacheName  name of the cache, default is the input name + ".fgc"
+     **/
+    void SetCacheFile(const char* cacheName=0);
+
   private:
 
-    FILE* fInputFile;                     //!  Input file
+    FairGeneratorTextReader* fInputFile;  //!  Input file
+
+    FairGeneratorCache* fCache;           //!  Binary copy of the input file
+
+    FairGeneratorCacheEvent fEvent;       //!  Current event
+    std::vector<FairGeneratorCacheTrack> fTracks;  //!  Tracks of the current event
 
     std::map<Int_t,Int_t> fParticleTable;      //!  Map from UrQMD PID to PDGPID
 
@@ -83,13 +101,24 @@ class FairUrqmdGenerator : public FairGenerator
         conversion map. Is called from the constructor. **/
     void ReadConversionTable(TString conversion_table="");
 
-    /** Check return value from fscanf call **/
+    /** Opens the input file, called from the constructors **/
+    void OpenInput();
+
+    /** Reads the next event from the cache or the input file into
+     ** fEvent and fTracks. The tracks are not converted if they are
+     ** not needed (readTracks=kFALSE and no cache is written). **/
+    Bool_t NextEvent(Bool_t readTracks);
+
+    /** Parses the next event of the input file **/
+    Bool_t ReadTextEvent(Bool_t readTracks);
+
+    /** Check return value from read call **/
     void CheckReturnValue(Int_t retval);
 
     FairUrqmdGenerator(const FairUrqmdGenerator&);
     FairUrqmdGenerator& operator=(const FairUrqmdGenerator&);
 
-    ClassDef(FairUrqmdGenerator,1);
+    ClassDef(FairUrqmdGenerator,2);
 
 };
 
@@ -88,6 +88,7 @@ class FairGeoNode : public FairGeoVolume
     void setVolumeType(EFairGeoNodeType t) {volumeType=t;}
     void setVolumePar(FairGeoNode&);
     void setShape(FairGeoBasicShape* s);
+    void setShapePointer(FairGeoBasicShape* s) { pShape=s; }
     void setMother(FairGeoNode* s);
     void setMedium(FairGeoMedium* med) {medium=med; }
     void setActive(Bool_t a=kTRUE) {active=a;}
@@ -138,6 +138,12 @@ Bool_t FairGenericParAsciiFileIo::readGenericSet(FairParGenericSet *pPar) {
   if (!pFile) {
     return kFALSE;
   }
+  // An ASCII file has only one version of a container, so a container read
+  // before from this input is unchanged for a new run. The input versions are
+  // reset, when a new input is set in the runtime database.
+  if (pPar->getInputVersion(inputNumber) == 1) {
+    return kTRUE;
+  }
   pFile->clear();
   pFile->seekg(0, ios::beg);
   const Text_t *name = (pPar->GetName());
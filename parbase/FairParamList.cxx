@@ -20,6 +20,7 @@
 #include "TBufferFile.h"                // for TBufferFile
 #include "TClass.h"                     // for TClass
 #include "TCollection.h"                // for TIter
+#include "THashList.h"                  // for THashList
 #include "TStreamerInfo.h"              // for TStreamerInfo
 
 #include <stdlib.h>                     // for NULL
@@ -53,6 +54,8 @@
 //  The class contains a list to stores objects of type FairParamObj
 //  The list objects store the name, the value, the parameter type and some
 //  additional information depending for the object type.
+//  The list is a THashList, so the fill functions find a parameter by its
+//  name without scanning the whole list.
 //
 //  All add/addObject functions add an initialized parameter to the list for
 //  writing. The functions create a new list element and copy the data into
@@ -479,7 +482,7 @@ template <class type> void FairParamObj::printData(type* val, Int_t nParams)
 
 FairParamList::FairParamList()
   :TObject(),
-   paramList(new TList()),
+   paramList(new THashList()),
    fLogger(FairLogger::GetLogger())
 {
   // Constructor
@@ -26,6 +26,7 @@
 #include "FairRtdbRun.h"
 
 #include "TCollection.h"                // for TIter
+#include "THashList.h"                  // for THashList
 #include "TList.h"                      // for TList
 
 #include <iomanip>                      // for setw, operator<<
@@ -49,7 +50,7 @@ FairParVersion::FairParVersion(Text_t* name)
 
 FairRtdbRun::FairRtdbRun(const Text_t* name,const Text_t* refName)
   : TNamed(name,"run parameters"),
-    parVersions(new TList()),
+    parVersions(new THashList()),
     refRun(refName)
 {
   // constructor with the run id and reference run as strings
@@ -60,7 +61,7 @@ FairRtdbRun::FairRtdbRun(const Text_t* name,const Text_t* refName)
 FairRtdbRun::FairRtdbRun(Int_t r,Int_t rr)
 //  :TNamed(r,""),
   :TNamed(),
-   parVersions(new TList()),
+   parVersions(new THashList()),
    refRun("")
 {
   char name[255];
@@ -71,7 +72,7 @@ FairRtdbRun::FairRtdbRun(Int_t r,Int_t rr)
 
 FairRtdbRun::FairRtdbRun(FairRtdbRun& run)
   :TNamed(run),
-   parVersions(new TList()),
+   parVersions(new THashList()),
    refRun(run.refRun)
 {
   // copy constructor
@@ -33,6 +33,8 @@
 #include "TClass.h"                     // for TClass
 #include "TCollection.h"                // for TIter
 #include "TFile.h"                      // for TFile, gFile
+#include "THashList.h"                  // for THashList
+#include "TStopwatch.h"                 // for TStopwatch
 
 #include <stdio.h>                      // for sprintf
 #include <string.h>                     // for strcmp, NULL, strlen
@@ -64,8 +66,8 @@ FairRuntimeDb* FairRuntimeDb::instance(void)
 
 FairRuntimeDb::FairRuntimeDb(void)
   :TObject(),
-   containerList(new TList()),
-   runs(new TList()),
+   containerList(new THashList()),
+   runs(new THashList()),
    firstInput(NULL),
    secondInput(NULL),
    output(NULL),
@@ -74,7 +76,10 @@ FairRuntimeDb::FairRuntimeDb(void)
    versionsChanged(kFALSE),
    isRootFileOutput(kFALSE),
    fLogger(FairLogger::GetLogger()),
-   ioType(UNKNOWN_Type)
+   ioType(UNKNOWN_Type),
+   initTime(0.),
+   nInitRuns(0),
+   contInitTimes()
 {
   gRtdb=this;
 }
@@ -516,6 +521,7 @@ Bool_t FairRuntimeDb::readAll()
 Bool_t FairRuntimeDb::initContainers(void)
 {
   // private function
+  TStopwatch timer;
   Text_t* refRunName=const_cast<char*>(currentRun->getRefRun());
   Int_t len=strlen(refRunName);
   if (len<1) {
@@ -526,6 +532,7 @@ Bool_t FairRuntimeDb::initContainers(void)
     if (firstInput) { firstInput->readVersions(refRun); }
     if (secondInput) { secondInput->readVersions(refRun); }
   }
+  TStopwatch contTimer;
   TIter next(containerList);
   FairParSet* cont;
   Bool_t rc=kTRUE;
@@ -540,8 +547,16 @@ Bool_t FairRuntimeDb::initContainers(void)
   cout<<'\n'<<"************************************************************* "<<'\n';
   while ((cont=static_cast<FairParSet*>(next()))) {
     cout << "-I- FairRunTimeDB::InitContainer() " << cont->GetName() << endl;
-    if (!cont->isStatic()) { rc=cont->init() && rc; }
+    if (!cont->isStatic()) {
+      contTimer.Start();
+      rc=cont->init() && rc;
+      contInitTimes[cont->GetName()]+=contTimer.RealTime();
+    }
   }
+  Double_t t=timer.RealTime();
+  initTime+=t;
+  nInitRuns++;
+  cout<<"     initialisation done in "<<t<<" s"<<'\n';
   if (!rc) { Error("initContainers()","Error occured during initialization"); }
   return rc;
 }
@@ -632,6 +647,21 @@ void FairRuntimeDb::print()
   } else { cout<<"output: none"<<'\n'; }
 }
 
+void FairRuntimeDb::printInitTimes()
+{
+  // prints the real time spent in the initialisation of the containers,
+  // summed over all runs
+  cout<<"--------------  initialisation times  ------------------------------------------\n";
+  cout.setf(ios::left,ios::adjustfield);
+  std::map<TString,Double_t>::const_iterator it;
+  for (it=contInitTimes.begin(); it!=contInitTimes.end(); ++it) {
+    cout<<setw(45)<<it->first<<setw(12)<<it->second<<" s\n";
+  }
+  cout<<setw(45)<<"total"<<setw(12)<<initTime<<" s in "<<nInitRuns
+      <<" initialisation(s)\n";
+  cout.setf(ios::right,ios::adjustfield);
+}
+
 void FairRuntimeDb::resetInputVersions()
 {
   // resets all input versions in the list of runs and in all containers which are not static
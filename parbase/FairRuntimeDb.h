@@ -14,6 +14,8 @@
 #include "TList.h"                      // for TList
 #include "TString.h"                    // for TString
 
+#include <map>                          // for map
+
 class FairContFact;
 class FairLogger;
 class FairParIo;
@@ -29,8 +31,8 @@ class FairRuntimeDb : public TObject
 
   protected:
     FairRuntimeDb(void);
-    TList* containerList;    // list of parameter containers
-    TList* runs;             // list of runs
+    TList* containerList;    // list of parameter containers (hashed by name)
+    TList* runs;             // list of runs (hashed by name)
     FairParIo* firstInput;    // first (prefered) input for parameters
     FairParIo* secondInput;   // second input (used if not found in first input)
     FairParIo* output;        // output for parameters
@@ -52,6 +54,10 @@ class FairRuntimeDb : public TObject
     } ParamIOType;
     ParamIOType ioType;//IO Type
 
+    Double_t initTime;       //! real time spent in initContainers(...) in s
+    Int_t nInitRuns;         //! number of initialisations
+    std::map<TString,Double_t> contInitTimes; //! real time spent in init() per container
+
   public:
     static FairRuntimeDb* instance(void);
     ~FairRuntimeDb(void);
@@ -104,6 +110,9 @@ class FairRuntimeDb : public TObject
     void activateParIo(FairParIo*);
     TList* getListOfContainers() {return containerList;}
     void print(void);
+    Double_t getInitTime() {return initTime;}
+    Int_t getNInitRuns() {return nInitRuns;}
+    void printInitTimes(void);
 
     Int_t findOutputVersion(FairParSet*);
 
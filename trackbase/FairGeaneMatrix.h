@@ -0,0 +1,138 @@
+/********************************************************************************
+ *    Copyright (C) 2014 GSI Helmholtzzentrum fuer Schwerionenforschung GmbH    *
+ *                                                                              *
+ *              This software is distributed under the terms of the             *
+ *         GNU Lesser General Public Licence version 3 (LGPL) version 3,        *
+ *                  copied verbatim in the file "LICENSE"                       *
+ ********************************************************************************/
+// Fixed-size matrix kernels for the GEANE frame changes
+//
+// FairSymMatrix<N> holds a symmetric NxN matrix in the packed upper
+// triangular form of GEANE (row by row, 15 elements for the 5x5 track
+// covariance). FairSimilarity computes R = A S A^T for a transformation A
+// of NxM elements.
+// All sizes are template parameters. The products are built from scalar
+// products of contiguous rows which are unrolled at compile time, so the
+// compiler can keep them in registers and vectorize them.
+//
+#ifndef FAIRGEANEMATRIX_H
+#define FAIRGEANEMATRIX_H
+
+#include "Rtypes.h"                     // for Double_t, Int_t
+
+template <Int_t N>
+class FairSymMatrix
+{
+  public:
+    enum { kSize = N* (N+1)/2 };
+
+    FairSymMatrix() {
+      for (Int_t i = 0; i < kSize; i++) { fData[i] = 0.; }
+    }
+
+    /** From the packed upper triangular form **/
+    explicit FairSymMatrix(const Double_t* packed) {
+      for (Int_t i = 0; i < kSize; i++) { fData[i] = packed[i]; }
+    }
+
+    /** Position of the element (i,j) in the packed form **/
+    static Int_t Index(Int_t i, Int_t j) {
+      if (i > j) { Int_t t = i; i = j; j = t; }
+      return i*N - i*(i-1)/2 + j - i;
+    }
+
+    Double_t operator()(Int_t i, Int_t j) const { return fData[Index(i, j)]; }
+    Double_t& operator()(Int_t i, Int_t j) { return fData[Index(i, j)]; }
+
+    const Double_t* Array() const { return fData; }
+    Double_t* Array() { return fData; }
+
+    /** Copies the packed form to packed **/
+    void Get(Double_t* packed) const {
+      for (Int_t i = 0; i < kSize; i++) { packed[i] = fData[i]; }
+    }
+
+    /** Full NxN matrix **/
+    void Unpack(Double_t (&A)[N][N]) const {
+      Int_t k = 0;
+      for (Int_t i = 0; i < N; i++) {
+        for (Int_t j = i; j < N; j++) {
+          A[i][j] = A[j][i] = fData[k++];
+        }
+      }
+    }
+
+    /** From the upper triangle of a full NxN matrix **/
+    void Pack(const Double_t (&A)[N][N]) {
+      Int_t k = 0;
+      for (Int_t i = 0; i < N; i++) {
+        for (Int_t j = i; j < N; j++) {
+          fData[k++] = A[i][j];
+        }
+      }
+    }
+
+  private:
+    Double_t fData[kSize];
+};
+
+/** Scalar product of two rows of K elements, unrolled at compile time **/
+template <Int_t K>
+struct FairRowDot {
+  static Double_t Eval(const Double_t* a, const Double_t* b) {
+    return FairRowDot<K-1>::Eval(a, b) + a[K-1]*b[K-1];
+  }
+};
+
+template <>
+struct FairRowDot<0> {
+  static Double_t Eval(const Double_t*, const Double_t*) { return 0.; }
+};
+
+/** R = A S A^T, S and R full symmetric matrices, R must not be S **/
+template <Int_t N, Int_t M>
+inline void FairSimilarity(const Double_t (&A)[N][M], const Double_t (*S)[M], Double_t (*R)[N])
+{
+  // T = A S, S symmetric: T[i][k] is row i of A times row k of S
+  Double_t T[N][M];
+  for (Int_t i = 0; i < N; i++) {
+    for (Int_t k = 0; k < M; k++) { T[i][k] = FairRowDot<M>::Eval(A[i], S[k]); }
+  }
+  // R = T A^T, only the upper triangle is computed
+  for (Int_t i = 0; i < N; i++) {
+    for (Int_t j = i; j < N; j++) {
+      R[i][j] = R[j][i] = FairRowDot<M>::Eval(T[i], A[j]);
+    }
+  }
+}
+
+/** R = A S A^T in packed form, R may be S **/
+template <Int_t N, Int_t M>
+inline void FairSimilarity(const Double_t (&A)[N][M], const FairSymMatrix<M>& S, FairSymMatrix<N>& R)
+{
+  Double_t full[M][M];
+  Double_t out[N][N];
+  S.Unpack(full);
+  FairSimilarity(A, full, out);
+  R.Pack(out);
+}
+
+/** Full R = A S A^T from the packed S **/
+template <Int_t N, Int_t M>
+inline void FairSimilarity(const Double_t (&A)[N][M], const FairSymMatrix<M>& S, Double_t (*R)[N])
+{
+  Double_t full[M][M];
+  S.Unpack(full);
+  FairSimilarity(A, full, R);
+}
+
+/** Packed R = A S A^T from the full S **/
+template <Int_t N, Int_t M>
+inline void FairSimilarity(const Double_t (&A)[N][M], const Double_t (*S)[M], FairSymMatrix<N>& R)
+{
+  Double_t out[N][N];
+  FairSimilarity(A, S, out);
+  R.Pack(out);
+}
+
+#endif
@@ -11,17 +11,148 @@
 // ------------------------------------------------------------------
 #include "FairGeaneUtil.h"
 
+#include "FairGeaneMatrix.h"            // for FairSymMatrix, FairSimilarity
+
 #include "TMath.h"                      // for Sqrt, Cos, Sin, Power, sqrt, etc
 #include "TMathBase.h"                  // for Abs, Sign
-#include "TMatrixT.h"                   // for TMatrixT, etc
-#include "TMatrixTBase.h"               // for TMatrixTBase
-#include "TMatrixTUtils.h"              // for TMatrixTRow
 
 #include <string.h>                     // for memset
 #include <cmath>                        // for pow
 
 using namespace std;
 
+namespace
+{
+
+// Rot[i][k]: component i in MARS of the axis k of the local cartesian
+// frame (DJ1, DK1, DJ1 x DK1)
+void LocalAxes(const Double_t DJ1[3], const Double_t DK1[3], Double_t Rot[3][3])
+{
+  for(Int_t I=0; I<3; I++) {
+    Rot[I][0] = DJ1[I];
+    Rot[I][1] = DK1[I];
+  }
+  Rot[0][2] = DJ1[1]*DK1[2]-DJ1[2]*DK1[1];
+  Rot[1][2] = DJ1[2]*DK1[0]-DJ1[0]*DK1[2];
+  Rot[2][2] = DJ1[0]*DK1[1]-DJ1[1]*DK1[0];
+}
+
+// MARS -> SD, see FairGeaneUtil::FromMarsToSD. The rotation to the local
+// cartesian frame and eq (79) of CMS 2006/001 are combined in one 5x6
+// Jacobian, so the error matrix is transformed once. Returns IERR.
+Int_t MarsToSD(const Double_t PD[3], const Double_t RD[6][6], Int_t CH,
+               const Double_t DJ1[3], const Double_t DK1[3],
+               Double_t& SP1, Double_t* PC, Double_t* RC)
+{
+  Double_t Rot[3][3], PDD[3];
+  LocalAxes(DJ1, DK1, Rot);
+
+  for(Int_t I=0; I<3; I++) {
+    PC[I]  = 0.;
+    PDD[I] = Rot[0][I]*PD[0]+Rot[1][I]*PD[1]+Rot[2][I]*PD[2];
+  }
+  for(Int_t I=0; I<15; I++) { RC[I] = 0.; }
+
+  // track in the detector plane
+  if(TMath::Abs(PDD[2]) < 1.e-08) { return 1; }
+
+  Double_t PM  = TMath::Sqrt(PDD[0]*PDD[0]+PDD[1]*PDD[1]+PDD[2]*PDD[2]);
+  Double_t PM3 = PM*PM*PM;
+
+  PC[0] = CH/PM;
+  PC[1] = PDD[0]/PDD[2];
+  PC[2] = PDD[1]/PDD[2];
+
+  // eq (79) in the local cartesian frame
+  Double_t M56[3][3];
+  M56[0][0] = - CH*PDD[0]/PM3;
+  M56[0][1] = - CH*PDD[1]/PM3;
+  M56[0][2] = - CH*PDD[2]/PM3;
+  M56[1][0] =   1./PDD[2];
+  M56[1][1] =   0.;
+  M56[1][2] = - PDD[0]/(PDD[2]*PDD[2]);
+  M56[2][0] =   0.;
+  M56[2][1] =   1./PDD[2];
+  M56[2][2] = - PDD[1]/(PDD[2]*PDD[2]);
+
+  // times the rotation MARS -> local, for momentum and position
+  Double_t J[5][6];
+  for(Int_t I=0; I<5; I++) {
+    for(Int_t K=0; K<6; K++) { J[I][K] = 0.; }
+  }
+  for(Int_t I=0; I<3; I++) {
+    for(Int_t K=0; K<3; K++) {
+      J[I][K] = M56[I][0]*Rot[K][0]+M56[I][1]*Rot[K][1]+M56[I][2]*Rot[K][2];
+    }
+  }
+  for(Int_t K=0; K<3; K++) {
+    J[3][K+3] = Rot[K][0];
+    J[4][K+3] = Rot[K][1];
+  }
+
+  FairSymMatrix<5> R;
+  FairSimilarity(J, RD, R);
+  R.Get(RC);
+
+  SP1 = TMath::Sign(1., PD[0]*Rot[0][2]+PD[1]*Rot[1][2]+PD[2]*Rot[2][2]);
+  return 0;
+}
+
+// SD -> MARS, see FairGeaneUtil::FromSDToMars. Eq (80) of CMS 2006/001
+// and the rotation to MARS are combined in one 6x5 Jacobian.
+void SDToMars(const Double_t PC[3], const Double_t RC[15], Int_t CH,
+              Double_t SPU, const Double_t DJ1[3], const Double_t DK1[3],
+              Double_t* PD, Double_t RD[6][6])
+{
+  Double_t Rot[3][3];
+  LocalAxes(DJ1, DK1, Rot);
+
+  Double_t PM = 1.e+30;
+  if(PC[0] != 0.) { PM = CH/PC[0]; }
+  Double_t PM2  = PM*PM;
+  Double_t PVW  = TMath::Sqrt(1.+PC[1]*PC[1]+PC[2]*PC[2]);
+  Double_t PVW3 = PVW*PVW*PVW;
+
+  // momentum in the local cartesian frame
+  Double_t PDD[3];
+  PDD[0] = SPU*PM*PC[1]/PVW;
+  PDD[1] = SPU*PM*PC[2]/PVW;
+  PDD[2] = SPU*PM/PVW;
+
+  // eq (80) in the local cartesian frame
+  Double_t M65[3][3];
+  M65[0][0] = - SPU*PM2*PC[1]/(CH*PVW);
+  M65[1][0] = - SPU*PM2*PC[2]/(CH*PVW);
+  M65[2][0] = - SPU*PM2/(CH*PVW);
+  M65[0][1] =   SPU*PM*(1.+PC[2]*PC[2])/PVW3;
+  M65[1][1] = - SPU*PM*PC[1]*PC[2]/PVW3;
+  M65[2][1] = - SPU*PM*PC[1]/PVW3;
+  M65[0][2] = - SPU*PM*PC[1]*PC[2]/PVW3;
+  M65[1][2] =   SPU*PM*(1.+PC[1]*PC[1])/PVW3;
+  M65[2][2] = - SPU*PM*PC[2]/PVW3;
+
+  // rotation local -> MARS of momentum and position
+  Double_t J[6][5];
+  for(Int_t I=0; I<3; I++) {
+    PD[I] = Rot[I][0]*PDD[0]+Rot[I][1]*PDD[1]+Rot[I][2]*PDD[2];
+    for(Int_t K=0; K<3; K++) {
+      J[I][K] = Rot[I][0]*M65[0][K]+Rot[I][1]*M65[1][K]+Rot[I][2]*M65[2][K];
+    }
+    J[I][3]   = 0.;
+    J[I][4]   = 0.;
+    J[I+3][0] = 0.;
+    J[I+3][1] = 0.;
+    J[I+3][2] = 0.;
+    J[I+3][3] = Rot[I][0];
+    J[I+3][4] = Rot[I][1];
+  }
+
+  FairSymMatrix<5> S(RC);
+  FairSimilarity(J, S, RD);
+}
+
+}
+
 FairGeaneUtil::FairGeaneUtil() : TObject() { }
 
 FairGeaneUtil::~FairGeaneUtil() { }
@@ -1165,6 +1296,24 @@ void FairGeaneUtil::FromSCToMars(Double_t PC[3], Double_t RC[15], Double_t H[3],
 
 }
 
+void FairGeaneUtil::FromSCToMars(Int_t n, Double_t* PC, Double_t* RC, Double_t* H, const Int_t* CH,
+                                 //  output
+                                 Double_t* PD, sixMat* RD)
+{
+  for(Int_t I=0; I<n; I++) {
+    FromSCToMars(PC+3*I, RC+15*I, H+3*I, CH[I], PD+3*I, RD[I]);
+  }
+}
+
+void FairGeaneUtil::FromMarsToSC(Int_t n, Double_t* PD, sixMat* RD, Double_t* H, const Int_t* CH,
+                                 //  output
+                                 Double_t* PC, Double_t* RC)
+{
+  for(Int_t I=0; I<n; I++) {
+    FromMarsToSC(PD+3*I, RD[I], H+3*I, CH[I], PC+3*I, RC+15*I);
+  }
+}
+
 void FairGeaneUtil::FromMarsToSD(Double_t PD[3], Double_t RD[6][6],
                                  Double_t[3] /*H[3]*/, Int_t CH,
                                  Double_t DJ1[3], Double_t DK1[3],
@@ -1212,203 +1361,19 @@ void FairGeaneUtil::FromMarsToSD(Double_t PD[3], Double_t RD[6][6],
 //
 // ---------------------------------------------------------------------
 
+  IERR = MarsToSD(PD, RD, CH, DJ1, DK1, SP1, PC, RC);
+}
 
-//  Double_t PDD[3], RDD[15];
-  Double_t PDD[3];
-  Double_t M56[5][6], M56T[6][5], AJ[5][5], AJT[6][5];
-  Double_t R6[6][6], RLC[6][6];
-//  Double_t SPU, PM, PM3, PT;
-  Double_t PM, PM3, PT;
-  Double_t Rot[3][3], Rmat[6][6], Rtra[6][6];
-  // ------------------------------------------------------------------
-
-  // reset
-
-  IERR=0;
-  memset(RC,0,sizeof(*RC));
-  memset(PC,0,sizeof(*PC));
-
-  for(Int_t I=0; I<5; I++) {
-    for(Int_t K=0; K<6; K++) {
-      AJT[K][I]=0.;
-      M56[I][K]=0.;
-      M56T[K][I]= 0.;
-      if(K != 5) { AJ[I][K]=0.; }
-    }
-  }
-
-  for(Int_t i=0; i<6; i++) {
-    for(Int_t k=0; k<6; k++) {
-      R6[i][k]   = 0.;
-      RLC[i][k]  = 0;
-      Rmat[i][k] = 0.;
-      Rtra[i][k] = 0.;
-    }
-  }
-
-  // to local cartesian frame
-
-  TVector3 MI(1.,0.,0.);
-  TVector3 MJ(0.,1.,0.);
-  TVector3 MK(0.,0.,1.);
-  //local cartesian
-  TVector3 DI(DJ1[0],DJ1[1],DJ1[2]);
-  TVector3 DJ(DK1[0],DK1[1],DK1[2]);
-  TVector3 DK= DI.Cross(DJ);
-
-  // rotation: D.. final versors, M.. initial
-  // vectors are  column matrices
-
-  Rot[0][0] = DI.Dot(MI);
-  Rot[0][1] = DI.Dot(MJ);
-  Rot[0][2] = DI.Dot(MK);
-  Rot[1][0] = DJ.Dot(MI);
-  Rot[1][1] = DJ.Dot(MJ);
-  Rot[1][2] = DJ.Dot(MK);
-  Rot[2][0] = DK.Dot(MI);
-  Rot[2][1] = DK.Dot(MJ);
-  Rot[2][2] = DK.Dot(MK);
-
-  TMatrixT<double> PD1(3,1);
-  PD1[0][0] = PD[0];
-  PD1[1][0] = PD[1];
-  PD1[2][0] = PD[2];
-
-  TMatrixT<double> Rot1(3,3);
-  for(int i = 0; i < 3; i++) for(int j = 0; j < 3; j++) {
-      Rot1[i][j] = Rot[i][j];
-    }
-
-  // momentum components in the lcl cartesian frame
-  // with the x-y plane on the detectorr one
-
-  TMatrixT<double> Rot1xPD1(Rot1,TMatrixT<double>::kMult,PD1);
-  PDD[0] = Rot1xPD1[0][0];
-  PDD[1] = Rot1xPD1[1][0];
-  PDD[2] = Rot1xPD1[2][0];
-
-  // jacobian for error matrix in MARS
-
-  Rmat[0][0] = Rot[0][0];
-  Rmat[0][1] = Rot[0][1];
-  Rmat[0][2] = Rot[0][2];
-  Rmat[1][0] = Rot[1][0];
-  Rmat[1][1] = Rot[1][1];
-  Rmat[1][2] = Rot[1][2];
-  Rmat[2][0] = Rot[2][0];
-  Rmat[2][1] = Rot[2][1];
-  Rmat[2][2] = Rot[2][2];
-
-  Rmat[3][3] = Rot[0][0];
-  Rmat[3][4] = Rot[0][1];
-  Rmat[3][5] = Rot[0][2];
-  Rmat[4][3] = Rot[1][0];
-  Rmat[4][4] = Rot[1][1];
-  Rmat[4][5] = Rot[1][2];
-  Rmat[5][3] = Rot[2][0];
-  Rmat[5][4] = Rot[2][1];
-  Rmat[5][5] = Rot[2][2];
-
-// transposed of the jacobian
-
-  for(Int_t I=0; I<6; I++) {
-    for(Int_t K=0; K<6; K++) {
-      Rtra[K][I]=Rmat[I][K];
-    }
-  }
-
-  // product (J)(RD)(J+)
-
-  for(Int_t i=0; i<6; i++) {
-    for(Int_t k=0; k<6; k++) {
-      for(Int_t l=0; l<6; l++) {
-        R6[i][k] += RD[i][l]*Rtra[l][k];
-      }
-    }
-  }
-
-  for(Int_t i=0; i<6; i++) {
-    for(Int_t k=0; k<6; k++) {
-      for(Int_t l=0; l<6; l++) {
-        RLC[i][k] += Rmat[i][l]*R6[l][k];
-      }
-    }
-  }
-  // go from local cartesian to the detector system SD
-  // x-y of local are v and w of SD.
-  // use of eq. (79) of the CMS report 2006/001 (Strandlie and Wittek)
-  //
-
-  PM  = TMath::Sqrt(PDD[0]*PDD[0]+PDD[1]*PDD[1]+PDD[2]*PDD[2]);
-  PM3 = TMath::Power(PM,3);
-  PT  = TMath::Sqrt(PDD[0]*PDD[0]+PDD[1]*PDD[1]);
-
-  //
-  // check if track lies in the x-y plane of the local cartesian frame
-  // if so, IERR=1 and exit
-  //
-
-  if(TMath::Abs(PDD[2]) < 1.e-08) {
-    IERR = 1;
-  }
-
-  else {
-
-    // output q/p, v' and w'  in SD
-
-    PC[0] = CH/PM;
-    PC[1] = PDD[0]/PDD[2];
-    PC[2] = PDD[1]/PDD[2];;
-
-    // Jacobian  Mars --> SD parallel to  Mars x-y plane
-    //  eq (79) of CMS note 2006/001 (Strandle and Wittek)
-
-    M56[0][0] = - CH*PDD[0]/PM3;
-    M56[0][1] = - CH*PDD[1]/PM3;
-    M56[0][2] = - CH*PDD[2]/PM3;
-
-    M56[1][0] =   1./PDD[2];
-    M56[1][1] =   0.;
-    M56[1][2] = - PDD[0]/(PDD[2]*PDD[2]);
-
-    M56[2][0] =   0.;
-    M56[2][1] =   1./PDD[2];
-    M56[2][2] = - PDD[1]/(PDD[2]*PDD[2]);
-
-    M56[3][3] =   1.;
-    M56[4][4] =   1.;
-
-
-    // matrix multiplication with  the Jacobian
-
-    for(Int_t k=0; k<5; k++) {
-      for(Int_t l=0; l<6; l++) {
-        M56T[l][k]= M56[k][l];
-      }
-    }
-
-    for(Int_t i=0; i<6; i++) {
-      for(Int_t k=0; k<5; k++) {
-        for(Int_t l=0; l<6; l++) {
-          AJT[i][k] += RLC[i][l]*M56T[l][k];
-        }
-      }
-    }
-
-    for(Int_t i=0; i<5; i++) {
-      for(Int_t k=0; k<5; k++) {
-        for(Int_t l=0; l<6; l++) {
-          AJ[i][k] += M56[i][l]*AJT[l][k];
-        }
-      }
-    }
-
-    //  SD  format output erro matrix RC(15)
-    FromMat25ToVec15(AJ,RC);
-
-    SP1 = TMath::Sign(1., PD[0]*(DJ1[1]*DK1[2]-DJ1[2]*DK1[1])+
-                      PD[1]*(DJ1[2]*DK1[0]-DJ1[0]*DK1[2])+
-                      PD[2]*(DJ1[0]*DK1[1]-DJ1[1]*DK1[0])  );
+void FairGeaneUtil::FromMarsToSD(Int_t n, const Double_t* PD, const sixMat* RD,
+                                 const Int_t* CH,
+                                 const Double_t* DJ1, const Double_t* DK1,
+                                 //  output
+                                 Int_t* IERR, Double_t* SP1,
+                                 Double_t* PC, Double_t* RC)
+{
+  for(Int_t I=0; I<n; I++) {
+    IERR[I] = MarsToSD(PD+3*I, RD[I], CH[I], DJ1+3*I, DK1+3*I,
+                       SP1[I], PC+3*I, RC+15*I);
   }
 }
 
@@ -1454,193 +1419,19 @@ void FairGeaneUtil::FromSDToMars(Double_t PC[3], Double_t RC[15],
 //
 // ---------------------------------------------------------------------------
 
-  Double_t M65[6][5], M65T[5][6], AJ[5][6];
-  Double_t RCM[5][5];
-  Double_t PDD[3];
-  Double_t Rot[3][3];
-
-  //    TVector3 PD1, PD2;
-  TVector3 PD2;
-
-  Double_t  RD1[6][6], Rmat[6][6], AJJ[6][6], Rtra[6][6];
-
-  Double_t SPU, PM, PM2, PVW, PVW3;
-
-  // -------------------------------------------------------------------------
-
-  memset(PD,0,sizeof(*PD));
-
-  // reset matrices
-  for(Int_t I=0; I<5; I++) {
-    for(Int_t K=0; K<6; K++) {
-      AJ[I][K]=0.;
-      M65[K][I]=0.;
-      M65T[I][K]=0.;
-      RD[I][K] = 0.;
-      RD1[I][K] = 0.;
-      Rmat[I][K] = 0.;
-      Rtra[I][K] = 0.;
-      AJJ[I][K] = 0.;
-      if (K < 5) RCM[I][K]=0.;
-    }
-  }
-  for(Int_t I=0; I<6; I++) {
-    RD[5][I]   = 0.;
-    RD1[5][I]  = 0.;
-    Rmat[5][I] = 0.;
-    Rtra[5][I] = 0.;
-    AJJ[5][I]  = 0.;
-  }
-  
-  SPU = SP1;
-
-  // jacobian from SD to local cartesian
-
-  PM = 1.e+30;
-  if(PC[0] != 0.) { PM =CH/PC[0]; }
-  PM2  = PM*PM;
-  PVW  = TMath::Sqrt(1.+PC[1]*PC[1]+PC[2]*PC[2]);
-  PVW3 = TMath::Power(PVW,3);
-
-  // output px, py, pz (cartesian)
-
-  PDD[0] = SPU*PM*PC[1]/PVW;
-  PDD[1] = SPU*PM*PC[2]/PVW;
-  PDD[2] = SPU*PM/PVW ;
-
-  // Jacobian SD -->  Mars
-  //  eq (80) of CMS note 2006/001 (Strandlie and Wittek)
-
-  M65[0][0] = - SPU*PM2*PC[1]/(CH*PVW);
-  M65[1][0] = - SPU*PM2*PC[2]/(CH*PVW);
-  M65[2][0] = - SPU*PM2/(CH*PVW);
-
-  M65[0][1] =   SPU*PM*(1.+PC[2]*PC[2])/PVW3;
-  M65[1][1] = - SPU*PM*PC[1]*PC[2]/PVW3;
-  M65[2][1] = - SPU*PM*PC[1]/PVW3;
-
-  M65[0][2] = - SPU*PM*PC[1]*PC[2]/PVW3;
-  M65[1][2] =   SPU*PM*(1.+PC[1]*PC[1])/PVW3;
-  M65[2][2] = - SPU*PM*PC[2]/PVW3;
-
-  M65[3][3] = 1.;
-  M65[4][4] = 1.;
-
-  FromVec15ToMat25(RC,RCM);
-
-
-  // transposed of the jacobian
-
-  for(Int_t I=0; I<6; I++) {
-    for(Int_t K=0; K<5; K++) {
-      M65T[K][I]=M65[I][K];
-    }
-  }
-
-  // product (J)(RCM)(J+)
-
-  for(Int_t i=0; i<5; i++) {
-    for(Int_t k=0; k<6; k++) {
-      for(Int_t l=0; l<5; l++) {
-        AJ[i][k] += RCM[i][l]*M65T[l][k];
-      }
-    }
-  }
-
-  for(Int_t i=0; i<6; i++) {
-    for(Int_t k=0; k<6; k++) {
-      for(Int_t l=0; l<5; l++) {
-        RD1[i][k] += M65[i][l]*AJ[l][k];
-      }
-    }
-  }
-
-
-  // now go from the local cartesian to MARS
-
-  // MARS
-  TVector3 MI(1.,0.,0.);
-  TVector3 MJ(0.,1.,0.);
-  TVector3 MK(0.,0.,1.);
-  //local cartesian
-  TVector3 DI(DJ1[0],DJ1[1],DJ1[2]);
-  TVector3 DJ(DK1[0],DK1[1],DK1[2]);
-  TVector3 DK= DI.Cross(DJ);
-
-  // rotation: M.. final  versors, D.. initial
-  // vectors are  column matrices
-
-  Rot[0][0] = MI.Dot(DI);
-  Rot[0][1] = MI.Dot(DJ);
-  Rot[0][2] = MI.Dot(DK);
-  Rot[1][0] = MJ.Dot(DI);
-  Rot[1][1] = MJ.Dot(DJ);
-  Rot[1][2] = MJ.Dot(DK);
-  Rot[2][0] = MK.Dot(DI);
-  Rot[2][1] = MK.Dot(DJ);
-  Rot[2][2] = MK.Dot(DK);
-
-  TMatrixT<double> PD1(3,1);
-  PD1[0][0] = PDD[0];
-  PD1[1][0] = PDD[1];
-  PD1[2][0] = PDD[2];
-
-  TMatrixT<double> Rot1(3,3);
-  for(int i = 0; i < 3; i++) for(int j = 0; j < 3; j++) {
-      Rot1[i][j] = Rot[i][j];
-    }
-
-  TMatrixT<double> Rot1xPD1(Rot1,TMatrixT<double>::kMult,PD1);
-  PD[0] = Rot1xPD1[0][0];
-  PD[1] = Rot1xPD1[1][0];
-  PD[2] = Rot1xPD1[2][0];
-
-  // jacobian for error matrix in MARS
-
-  Rmat[0][0] = Rot[0][0];
-  Rmat[0][1] = Rot[0][1];
-  Rmat[0][2] = Rot[0][2];
-  Rmat[1][0] = Rot[1][0];
-  Rmat[1][1] = Rot[1][1];
-  Rmat[1][2] = Rot[1][2];
-  Rmat[2][0] = Rot[2][0];
-  Rmat[2][1] = Rot[2][1];
-  Rmat[2][2] = Rot[2][2];
-
-  Rmat[3][3] = Rot[0][0];
-  Rmat[3][4] = Rot[0][1];
-  Rmat[3][5] = Rot[0][2];
-  Rmat[4][3] = Rot[1][0];
-  Rmat[4][4] = Rot[1][1];
-  Rmat[4][5] = Rot[1][2];
-  Rmat[5][3] = Rot[2][0];
-  Rmat[5][4] = Rot[2][1];
-  Rmat[5][5] = Rot[2][2];
-
-  // transposed of the jacobian
-
-  for(Int_t I=0; I<6; I++) {
-    for(Int_t K=0; K<6; K++) {
-      Rtra[K][I]=Rmat[I][K];
-    }
-  }
-
-  for(Int_t i=0; i<6; i++) {
-    for(Int_t k=0; k<6; k++) {
-      for(Int_t l=0; l<6; l++) {
-        AJJ[i][k] += RD1[i][l]*Rtra[l][k];
-      }
-    }
-  }
+  SDToMars(PC, RC, CH, SP1, DJ1, DK1, PD, RD);
+}
 
-  for(Int_t i=0; i<6; i++) {
-    for(Int_t k=0; k<6; k++) {
-      for(Int_t l=0; l<6; l++) {
-        RD[i][k] += Rmat[i][l]*AJJ[l][k];
-      }
-    }
+void FairGeaneUtil::FromSDToMars(Int_t n, const Double_t* PC, const Double_t* RC,
+                                 const Int_t* CH, const Double_t* SP1,
+                                 const Double_t* DJ1, const Double_t* DK1,
+                                 //  output
+                                 Double_t* PD, sixMat* RD)
+{
+  for(Int_t I=0; I<n; I++) {
+    SDToMars(PC+3*I, RC+15*I, CH[I], SP1[I], DJ1+3*I, DK1+3*I,
+             PD+3*I, RD[I]);
   }
-
 }
 
 
@@ -1774,73 +1565,15 @@ void FairGeaneUtil::SymmProd(Double_t A[25], Double_t S[15], Double_t* R)
 
 TVector3  FairGeaneUtil::FromMARSToSDCoord(TVector3 xyz, TVector3 o, TVector3 di, TVector3 dj, TVector3 dk)
 {
-
-  TMatrixT<double> matrix(3,3);
-  // rotation matrix (u,v,w) = (fmatrix) * (x,y,z)
-  matrix[0][0] = di[0];
-  matrix[0][1] = di[1];
-  matrix[0][2] = di[2];
-  matrix[1][0] = dj[0];
-  matrix[1][1] = dj[1];
-  matrix[1][2] = dj[2];
-  matrix[2][0] = dk[0];
-  matrix[2][1] = dk[1];
-  matrix[2][2] = dk[2];
-
-
-
-  TMatrixT<double> xyzvec(3,1);
-  xyzvec[0][0] = xyz.X();
-  xyzvec[1][0] = xyz.Y();
-  xyzvec[2][0] = xyz.Z();
-
-
-  TMatrixT<double> origin(3,1);
-  origin[0][0] = o.X();
-  origin[1][0] = o.Y();
-  origin[2][0] = o.Z();
-
-  xyzvec -= origin;
-
-  TMatrixT<double> uvwvec(matrix, TMatrixT<double>::kMult, xyzvec);
-
-  TVector3 uvw = TVector3(uvwvec[0][0], uvwvec[1][0], uvwvec[2][0]);
-  return uvw;
+  // (u,v,w) = (di,dj,dk) * (xyz - o)
+  TVector3 d = xyz - o;
+  return TVector3(di.Dot(d), dj.Dot(d), dk.Dot(d));
 }
 
 TVector3  FairGeaneUtil::FromSDToMARSCoord(TVector3 uvw, TVector3 o, TVector3 di, TVector3 dj, TVector3 dk)
 {
-  TMatrixT<double> matrix(3,3);
-  matrix[0][0] = di[0];
-  matrix[0][1] = di[1];
-  matrix[0][2] = di[2];
-  matrix[1][0] = dj[0];
-  matrix[1][1] = dj[1];
-  matrix[1][2] = dj[2];
-  matrix[2][0] = dk[0];
-  matrix[2][1] = dk[1];
-  matrix[2][2] = dk[2];
-
-
-  TMatrixT<double> uvwvec(3,1);
-  uvwvec[0][0] = uvw.X();
-  uvwvec[1][0] = uvw.Y();
-  uvwvec[2][0] = uvw.Z();
-
-  TMatrixT<double> uvwrot(matrix, TMatrixT<double>::kTransposeMult, uvwvec);
-
-  TMatrixT<double> origin(3,1);
-  origin[0][0] = o.X();
-  origin[1][0] = o.Y();
-  origin[2][0] = o.Z();
-
-  TMatrixT<double> xyzvec(3,1);
-  xyzvec = uvwrot + origin;
-
-
-  TVector3 xyz = TVector3(xyzvec[0][0], xyzvec[1][0], xyzvec[2][0]);
-
-  return xyz;
+  // xyz = (di,dj,dk)^T * (u,v,w) + o
+  return uvw.X()*di + uvw.Y()*dj + uvw.Z()*dk + o;
 }
 
 
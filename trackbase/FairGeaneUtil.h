@@ -70,6 +70,25 @@ class FairGeaneUtil : public TObject
                       Int_t& IERR, Double_t& SP1,
                       Double_t* PC, Double_t* RC);
 
+    // frame changes for n tracks at once, track I has its parameters at
+    // PC+3*I, RC+15*I, H+3*I, DJ1+3*I, DK1+3*I, PD+3*I and RD[I]
+    void FromSCToMars(Int_t n, Double_t* PC, Double_t* RC, Double_t* H, const Int_t* CH,
+                      Double_t* PD, sixMat* RD);
+
+    void FromMarsToSC(Int_t n, Double_t* PD, sixMat* RD, Double_t* H, const Int_t* CH,
+                      Double_t* PC, Double_t* RC);
+
+    void FromSDToMars(Int_t n, const Double_t* PC, const Double_t* RC,
+                      const Int_t* CH, const Double_t* SP1,
+                      const Double_t* DJ1, const Double_t* DK1,
+                      Double_t* PD, sixMat* RD);
+
+    void FromMarsToSD(Int_t n, const Double_t* PD, const sixMat* RD,
+                      const Int_t* CH,
+                      const Double_t* DJ1, const Double_t* DK1,
+                      Int_t* IERR, Double_t* SP1,
+                      Double_t* PC, Double_t* RC);
+
     //---------------------------------------
 
     void FromMat25ToVec15(Double_t A[5][5], Double_t* V);